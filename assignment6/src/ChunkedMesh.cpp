@@ -0,0 +1,436 @@
+#include "ChunkedMesh.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    // Vertex indices of an OBJ face line, without texture and normal indices
+    void parse_face(const string& line, vector<long>& indices) {
+        indices.clear();
+        const char* p = line.c_str() + 1;
+        while (true) {
+            while (*p == ' ' || *p == '\t')
+                p++;
+            char* end;
+            long index = strtol(p, &end, 10);
+            if (end == p)
+                return;
+            indices.push_back(index);
+            p = end;
+            while (*p && *p != ' ' && *p != '\t')
+                p++;
+        }
+    }
+}
+
+bool ChunkedMesh::read_obj(const string& filename) {
+    ifstream in(filename);
+    if (!in.is_open()) {
+        cout << "Error: Unable to open " << filename << endl;
+        return false;
+    }
+
+    // First pass: sizes and bounding box
+    size_t nv = 0, nf = 0;
+    RowVector3d lo = RowVector3d::Constant(numeric_limits<double>::infinity());
+    RowVector3d hi = -lo;
+    string line;
+    vector<long> indices;
+    while (getline(in, line)) {
+        if (line.size() > 1 && line[0] == 'v' && line[1] == ' ') {
+            const char* p = line.c_str() + 1;
+            for (int a = 0; a < 3; a++) {
+                char* end;
+                double x = strtod(p, &end);
+                lo(a) = min(lo(a), x);
+                hi(a) = max(hi(a), x);
+                p = end;
+            }
+            nv++;
+        } else if (line.size() > 1 && line[0] == 'f' && line[1] == ' ') {
+            parse_face(line, indices);
+            if (indices.size() >= 3)
+                nf += indices.size() - 2;
+        }
+    }
+
+    // Second pass: positions and triangles in file order
+    MappedArray<double> raw_V;
+    MappedArray<int> raw_F;
+    if (!raw_V.create(3 * nv, work_dir) || !raw_F.create(3 * nf, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    in.clear();
+    in.seekg(0);
+    size_t iv = 0, jf = 0;
+    while (getline(in, line)) {
+        if (line.size() > 1 && line[0] == 'v' && line[1] == ' ') {
+            const char* p = line.c_str() + 1;
+            for (int a = 0; a < 3; a++) {
+                char* end;
+                raw_V[3 * iv + a] = strtod(p, &end);
+                p = end;
+            }
+            iv++;
+        } else if (line.size() > 1 && line[0] == 'f' && line[1] == ' ') {
+            parse_face(line, indices);
+            for (long& index : indices) {
+                // Negative indices count back from the last vertex read
+                index = index < 0 ? (long)iv + index : index - 1;
+                if (index < 0 || index >= (long)nv) {
+                    cout << "Error: " << filename << " has a face with vertex index out of range" << endl;
+                    return false;
+                }
+            }
+            for (size_t k = 1; k + 1 < indices.size(); k++, jf++) {
+                raw_F[3 * jf + 0] = indices[0];
+                raw_F[3 * jf + 1] = indices[k];
+                raw_F[3 * jf + 2] = indices[k + 1];
+            }
+        }
+    }
+
+    // Coarse grid with several cells per chunk, cells visited in Morton order
+    int levels = 1;
+    while (levels < 6 && (size_t(1) << (3 * levels)) < 8 * nv / chunk_size)
+        levels++;
+    const size_t res = size_t(1) << levels;
+    auto cell_of = [&](size_t i) {
+        size_t code = 0;
+        for (int a = 0; a < 3; a++) {
+            const double extent = hi(a) - lo(a);
+            const size_t q = extent > 0 ?
+                min(res - 1, size_t((raw_V[3 * i + a] - lo(a)) / extent * res)) : 0;
+            for (int b = 0; b < levels; b++)
+                code |= ((q >> b) & 1) << (3 * b + a);
+        }
+        return code;
+    };
+    vector<size_t> cell_begin(res * res * res, 0);
+    for (size_t i = 0; i < nv; i++)
+        cell_begin[cell_of(i)]++;
+    vertex_begin.assign(1, 0);
+    size_t offset = 0, in_chunk = 0;
+    for (size_t& cell : cell_begin) {
+        const size_t count = cell;
+        cell = offset;
+        offset += count;
+        in_chunk += count;
+        if (in_chunk >= chunk_size) {
+            vertex_begin.push_back(offset);
+            in_chunk = 0;
+        }
+    }
+    if (vertex_begin.size() == 1 || vertex_begin.back() != nv)
+        vertex_begin.push_back(nv);
+
+    // Scatter vertices to their sorted position
+    MappedArray<int> order;
+    if (!order.create(nv, work_dir) || !V.create(3 * nv, work_dir) || !vertex_id.create(nv, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    for (size_t i = 0; i < nv; i++) {
+        const size_t j = cell_begin[cell_of(i)]++;
+        order[i] = j;
+        vertex_id[j] = i;
+        for (int a = 0; a < 3; a++)
+            V[3 * j + a] = raw_V[3 * i + a];
+    }
+    raw_V.release();
+
+    // Sort faces by the chunk of their smallest vertex
+    const int n_chunks = num_chunks();
+    face_begin.assign(n_chunks + 1, 0);
+    for (size_t f = 0; f < nf; f++) {
+        for (int k = 0; k < 3; k++)
+            raw_F[3 * f + k] = order[raw_F[3 * f + k]];
+        const int smallest = min(raw_F[3 * f], min(raw_F[3 * f + 1], raw_F[3 * f + 2]));
+        face_begin[chunk_of_vertex(smallest) + 1]++;
+    }
+    order.release();
+    for (int c = 0; c < n_chunks; c++)
+        face_begin[c + 1] += face_begin[c];
+    if (!F.create(3 * nf, work_dir) || !face_id.create(nf, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    vector<size_t> cursor(face_begin.begin(), face_begin.end() - 1);
+    for (size_t f = 0; f < nf; f++) {
+        const int smallest = min(raw_F[3 * f], min(raw_F[3 * f + 1], raw_F[3 * f + 2]));
+        const size_t g = cursor[chunk_of_vertex(smallest)]++;
+        face_id[g] = f;
+        for (int k = 0; k < 3; k++)
+            F[3 * g + k] = raw_F[3 * f + k];
+    }
+    VF_start.release();
+    VF.release();
+    return true;
+}
+
+ChunkedMesh::ChunkVertices ChunkedMesh::chunk_vertices(int c) const {
+    return ChunkVertices(V.data() + 3 * vertex_begin[c], vertex_begin[c + 1] - vertex_begin[c], 3);
+}
+
+ChunkedMesh::ChunkFaces ChunkedMesh::chunk_faces(int c) const {
+    return ChunkFaces(F.data() + 3 * face_begin[c], face_begin[c + 1] - face_begin[c], 3);
+}
+
+RowVector3d ChunkedMesh::vertex(size_t i) const {
+    return RowVector3d(V[3 * i], V[3 * i + 1], V[3 * i + 2]);
+}
+
+int ChunkedMesh::chunk_of_vertex(size_t i) const {
+    return int(upper_bound(vertex_begin.begin(), vertex_begin.end(), i) - vertex_begin.begin()) - 1;
+}
+
+bool ChunkedMesh::build_vertex_faces() {
+    const size_t nv = num_vertices(), nf = num_faces();
+    if (VF_start.size() == nv + 1)
+        return true;
+    if (!VF_start.create(nv + 1, work_dir) || !VF.create(3 * nf, work_dir)) {
+        VF_start.release();
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    for (size_t f = 0; f < 3 * nf; f++)
+        VF_start[F[f] + 1]++;
+    for (size_t i = 0; i < nv; i++)
+        VF_start[i + 1] += VF_start[i];
+    // Fill using the starts as cursors, then shift them back
+    for (size_t f = 0; f < 3 * nf; f++)
+        VF[VF_start[F[f]]++] = f / 3;
+    for (size_t i = nv; i > 0; i--)
+        VF_start[i] = VF_start[i - 1];
+    VF_start[0] = 0;
+    return true;
+}
+
+void ChunkedMesh::vertex_edges(int a, vector<pair<int, int>>& edges) const {
+    edges.clear();
+    for (int64_t k = VF_start[a]; k < VF_start[a + 1]; k++) {
+        const int f = VF[k];
+        for (int c = 0; c < 3; c++) {
+            const int b = F[3 * f + c];
+            if (b > a)
+                edges.emplace_back(b, f);
+        }
+    }
+    sort(edges.begin(), edges.end());
+}
+
+int ChunkedMesh::keep_largest_component() {
+    if (!build_vertex_faces())
+        return -1;
+    const size_t nv = num_vertices(), nf = num_faces();
+    // Union-find over faces, joining faces that share an edge
+    MappedArray<int> parent;
+    if (!parent.create(nf, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return -1;
+    }
+    for (size_t f = 0; f < nf; f++)
+        parent[f] = f;
+    auto find = [&parent](int f) {
+        while (parent[f] != f) {
+            parent[f] = parent[parent[f]];
+            f = parent[f];
+        }
+        return f;
+    };
+    vector<pair<int, int>> edges;
+    for (size_t a = 0; a < nv; a++) {
+        vertex_edges(a, edges);
+        for (size_t k = 1; k < edges.size(); k++) {
+            if (edges[k].first != edges[k - 1].first)
+                continue;
+            const int r = find(edges[k].second), s = find(edges[k - 1].second);
+            if (r != s)
+                parent[max(r, s)] = min(r, s);
+        }
+    }
+
+    // Count faces per component, and find the first face of each in the
+    // file: like igl::facet_components, ties go to the component which
+    // starts first
+    MappedArray<int> count, first;
+    if (!count.create(nf, work_dir) || !first.create(nf, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return -1;
+    }
+    int num_components = 0;
+    for (size_t f = 0; f < nf; f++) {
+        const int r = find(f);
+        if (r == (int)f) {
+            num_components++;
+            first[r] = face_id[f];
+        }
+        count[r]++;
+        first[r] = min(first[r], face_id[f]);
+    }
+    if (num_components <= 1)
+        return num_components;
+    int largest = 0;
+    for (size_t f = 1; f < nf; f++)
+        if (count[f] > count[largest] || (count[f] == count[largest] && first[f] < first[largest]))
+            largest = f;
+    count.release();
+    first.release();
+
+    MappedArray<char> keep;
+    if (!keep.create(nf, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return -1;
+    }
+    for (size_t f = 0; f < nf; f++)
+        keep[f] = find(f) == largest;
+    parent.release();
+    if (!compact(keep))
+        return -1;
+    return num_components;
+}
+
+bool ChunkedMesh::compact(const MappedArray<char>& keep) {
+    const size_t nv = num_vertices(), nf = num_faces();
+    // New index of every referenced vertex, -1 for the others
+    MappedArray<int> index;
+    if (!index.create(nv, work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    for (size_t f = 0; f < nf; f++)
+        if (keep[f])
+            for (int k = 0; k < 3; k++)
+                index[F[3 * f + k]] = 1;
+    vector<size_t> new_vertex_begin(1, 0);
+    size_t new_nv = 0;
+    for (int c = 0; c < num_chunks(); c++) {
+        for (size_t i = vertex_begin[c]; i < vertex_begin[c + 1]; i++)
+            index[i] = index[i] ? (int)new_nv++ : -1;
+        new_vertex_begin.push_back(new_nv);
+    }
+    size_t new_nf = 0;
+    for (size_t f = 0; f < nf; f++)
+        new_nf += keep[f];
+
+    // Kept vertices and faces stay in the order of the file, so their new
+    // position in it is their rank among the kept ones
+    MappedArray<double> new_V;
+    MappedArray<int> new_F, new_vertex_id, new_face_id, rank;
+    if (!new_V.create(3 * new_nv, work_dir) || !new_F.create(3 * new_nf, work_dir) ||
+        !new_vertex_id.create(new_nv, work_dir) || !new_face_id.create(new_nf, work_dir) ||
+        !rank.create(max(nv, nf), work_dir)) {
+        cout << "Error: Unable to map " << work_dir << endl;
+        return false;
+    }
+    for (size_t i = 0; i < nv; i++)
+        if (index[i] >= 0)
+            rank[vertex_id[i]] = 1;
+    for (size_t i = 0, r = 0; i < nv; i++)
+        rank[i] = rank[i] ? (int)r++ : -1;
+    for (size_t i = 0; i < nv; i++) {
+        if (index[i] < 0)
+            continue;
+        for (int a = 0; a < 3; a++)
+            new_V[3 * index[i] + a] = V[3 * i + a];
+        new_vertex_id[index[i]] = rank[vertex_id[i]];
+    }
+
+    // Removing vertices preserves their order, so faces stay in their chunk
+    fill(rank.data(), rank.data() + rank.size(), 0);
+    for (size_t f = 0; f < nf; f++)
+        if (keep[f])
+            rank[face_id[f]] = 1;
+    for (size_t f = 0, r = 0; f < nf; f++)
+        rank[f] = rank[f] ? (int)r++ : -1;
+    vector<size_t> new_face_begin(1, 0);
+    size_t g = 0;
+    for (int c = 0; c < num_chunks(); c++) {
+        for (size_t f = face_begin[c]; f < face_begin[c + 1]; f++) {
+            if (!keep[f])
+                continue;
+            for (int k = 0; k < 3; k++)
+                new_F[3 * g + k] = index[F[3 * f + k]];
+            new_face_id[g] = rank[face_id[f]];
+            g++;
+        }
+        new_face_begin.push_back(g);
+    }
+
+    V = move(new_V);
+    F = move(new_F);
+    vertex_id = move(new_vertex_id);
+    face_id = move(new_face_id);
+    vertex_begin = new_vertex_begin;
+    face_begin = new_face_begin;
+    VF_start.release();
+    VF.release();
+    return true;
+}
+
+bool ChunkedMesh::boundary_loop(VectorXi& L) {
+    if (!build_vertex_faces())
+        return false;
+    const size_t nv = num_vertices();
+    // Boundary edges, oriented as in their face
+    unordered_map<int, int> next;
+    vector<int> starts;
+    vector<pair<int, int>> edges;
+    for (size_t a = 0; a < nv; a++) {
+        vertex_edges(a, edges);
+        for (size_t k = 0; k < edges.size(); k++) {
+            const int b = edges[k].first;
+            if ((k > 0 && edges[k - 1].first == b) || (k + 1 < edges.size() && edges[k + 1].first == b))
+                continue;
+            const int* f = F.data() + 3 * edges[k].second;
+            int u = a, v = b;
+            for (int c = 0; c < 3; c++)
+                if (f[c] == b && f[(c + 1) % 3] == (int)a)
+                    swap(u, v);
+            next[u] = v;
+            starts.push_back(u);
+        }
+    }
+
+    // Follow the edges around each loop and keep the longest
+    unordered_set<int> visited;
+    vector<int> loop, longest;
+    for (const int start : starts) {
+        if (visited.count(start))
+            continue;
+        loop.clear();
+        int v = start;
+        while (!visited.count(v)) {
+            visited.insert(v);
+            loop.push_back(v);
+            auto it = next.find(v);
+            if (it == next.end())
+                break;
+            v = it->second;
+        }
+        if (loop.size() > longest.size())
+            longest.swap(loop);
+    }
+    L = Map<VectorXi>(longest.data(), longest.size());
+    return true;
+}
+
+void ChunkedMesh::to_matrices(MatrixXd& V_out, MatrixXi& F_out) const {
+    V_out.resize(num_vertices(), 3);
+    for (size_t i = 0; i < num_vertices(); i++)
+        V_out.row(vertex_id[i]) = vertex(i);
+    F_out.resize(num_faces(), 3);
+    for (size_t f = 0; f < num_faces(); f++)
+        for (int k = 0; k < 3; k++)
+            F_out(face_id[f], k) = vertex_id[F[3 * f + k]];
+}
+
+void ChunkedMesh::to_vector(const MappedArray<double>& D, VectorXd& D_out) const {
+    D_out.resize(num_vertices());
+    for (size_t i = 0; i < num_vertices(); i++)
+        D_out(vertex_id[i]) = D[i];
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <boost/filesystem.hpp>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Eigen;
+namespace fs = boost::filesystem;
+
+// Zero initialized array of T backed by an unlinked temporary file that is
+// memory mapped: the operating system loads pages on access and writes them
+// back under memory pressure, so only the recently used parts of arrays
+// larger than the memory stay resident. The file disappears with the mapping.
+template <typename T>
+class MappedArray {
+public:
+    MappedArray() = default;
+    MappedArray(const MappedArray&) = delete;
+    MappedArray& operator=(const MappedArray&) = delete;
+    MappedArray(MappedArray&& other) noexcept { swap(other); }
+    MappedArray& operator=(MappedArray&& other) noexcept {
+        release();
+        swap(other);
+        return *this;
+    }
+    ~MappedArray() { release(); }
+
+    // Allocate n elements in a new file in directory dir, returns false on
+    // failure
+    bool create(size_t n, const string& dir = fs::temp_directory_path().string()) {
+        release();
+        if (n == 0)
+            return true;
+        string path = dir + "/mapped_XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0)
+            return false;
+        unlink(path.c_str());
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, n * sizeof(T)) == 0)
+            p = mmap(nullptr, n * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        data_ = static_cast<T*>(p);
+        size_ = n;
+        return true;
+    }
+
+    void release() {
+        if (data_)
+            munmap(data_, size_ * sizeof(T));
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+
+    void swap(MappedArray& other) {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+};
+
+// Triangle mesh kept out of core for scans larger than the memory. Vertices
+// are sorted along a Morton curve over a coarse grid and split into chunks of
+// about chunk_size vertices; each face belongs to the chunk of its smallest
+// vertex index, so faces of a chunk mostly reference vertices of that chunk
+// and its neighbours. Vertices, faces and adjacency live in MappedArrays and
+// every operation below streams over them chunk by chunk, so peak memory is
+// set by the chunk size (plus the boundary) rather than by the mesh size.
+//
+// Vertex and face indices of the chunks are in this sorted order. The copies
+// into memory are in the order of the file instead (without the removed
+// vertices and faces), so that they match igl::read_triangle_mesh followed by
+// the in memory cleaning, and indices saved with them stay valid.
+class ChunkedMesh {
+public:
+    typedef Map<const Matrix<double, Dynamic, 3, RowMajor>> ChunkVertices;
+    typedef Map<const Matrix<int, Dynamic, 3, RowMajor>> ChunkFaces;
+
+    // Target number of vertices per chunk
+    size_t chunk_size = 1 << 16;
+    // Directory of the backing files
+    string work_dir = fs::temp_directory_path().string();
+
+    // Chunk c holds vertices [vertex_begin[c], vertex_begin[c+1]) and faces
+    // [face_begin[c], face_begin[c+1])
+    vector<size_t> vertex_begin;
+    vector<size_t> face_begin;
+
+    // Read an OBJ file in two streaming passes (polygons are triangulated as
+    // fans, texture coordinates and normals are ignored), returns false on
+    // failure
+    bool read_obj(const string& filename);
+
+    size_t num_vertices() const { return V.size() / 3; }
+    size_t num_faces() const { return F.size() / 3; }
+    int num_chunks() const { return (int)vertex_begin.size() - 1; }
+
+    // Vertices and faces (with global, sorted vertex indices) of chunk c,
+    // mapped without copies
+    ChunkVertices chunk_vertices(int c) const;
+    ChunkFaces chunk_faces(int c) const;
+    RowVector3d vertex(size_t i) const;
+
+    // Keep only the faces of the largest component (faces connected through
+    // edges, like igl::facet_components) and the vertices they reference.
+    // Returns the number of components, -1 on failure.
+    int keep_largest_component();
+
+    // Longest boundary loop in sorted indices, like igl::boundary_loop,
+    // returns false on failure
+    bool boundary_loop(VectorXi& L);
+
+    // Copy into memory in file order, e.g. for the stages that need the
+    // whole mesh
+    void to_matrices(MatrixXd& V_out, MatrixXi& F_out) const;
+    // Copy per vertex values D (in sorted order) into memory in file order
+    void to_vector(const MappedArray<double>& D, VectorXd& D_out) const;
+
+private:
+    // #V*3 and #F*3 row major positions and triangles
+    MappedArray<double> V;
+    MappedArray<int> F;
+    // Position in the file order of each vertex and face
+    MappedArray<int> vertex_id;
+    MappedArray<int> face_id;
+    // Faces incident on vertex i are VF[VF_start[i] .. VF_start[i+1]), built
+    // on demand
+    MappedArray<int64_t> VF_start;
+    MappedArray<int> VF;
+
+    bool build_vertex_faces();
+    // Edges (a,b) with b > a as (b, incident face) pairs sorted by b, so
+    // faces sharing an edge are adjacent
+    void vertex_edges(int a, vector<pair<int, int>>& edges) const;
+    // Keep faces with keep[f] and the vertices they reference, preserving
+    // the order of both
+    bool compact(const MappedArray<char>& keep);
+    int chunk_of_vertex(size_t i) const;
+};
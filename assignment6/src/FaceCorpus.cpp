@@ -0,0 +1,360 @@
+#include "FaceCorpus.h"
+#include <igl/read_triangle_mesh.h>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const string FaceCorpus::_defaultFileName = "faces.corpus";
+const vector<const char*> FaceCorpus::_encodingNames = {"double", "float", "16 bit delta"};
+
+namespace {
+    const char corpusMagic[8] = {'F', 'C', 'O', 'R', 'P', 'U', 'S', '\0'};
+
+    // Pad stream to a multiple of 8 bytes so that sections are aligned
+    void pad(ofstream& out) {
+        const char zeros[8] = {0};
+        size_t position = out.tellp();
+        if(position % 8 != 0) {
+            out.write(zeros, 8 - position % 8);
+        }
+    }
+}
+
+FaceCorpus::~FaceCorpus() {
+    close();
+}
+
+bool FaceCorpus::write(const string& path, const vector<string>& names, const vector<MatrixXd>& faces, const MatrixXi& F, Encoding encoding) {
+    if(faces.empty() || names.size() != faces.size()) {
+        cerr << "Corpus needs one name per face" << endl;
+        return false;
+    }
+    int n = faces[0].rows();
+    for(const MatrixXd& V : faces) {
+        if(V.rows() != n || V.cols() != 3) {
+            cerr << "All faces of a corpus must share the same vertices" << endl;
+            return false;
+        }
+    }
+    ofstream out(path, ios::binary);
+    if(!out) {
+        cerr << "Failed to open " << path << endl;
+        return false;
+    }
+
+    // Mean face, reference for delta coding
+    MatrixXd mean = MatrixXd::Zero(n, 3);
+    for(const MatrixXd& V : faces) {
+        mean += V;
+    }
+    mean /= faces.size();
+    double maxDelta = 0;
+    for(const MatrixXd& V : faces) {
+        maxDelta = max(maxDelta, (V - mean).cwiseAbs().maxCoeff());
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, corpusMagic, sizeof(corpusMagic));
+    header.version = 1;
+    header.encoding = encoding;
+    header.nVertices = n;
+    header.nFaces = F.rows();
+    header.nMeshes = faces.size();
+    header.quantizationStep = maxDelta > 0 ? maxDelta / 32767.0 : 1.0;
+    out.write((const char*) &header, sizeof(Header));
+
+    // Connectivity, stored once
+    pad(out);
+    header.facesOffset = out.tellp();
+    Matrix<int32_t, Dynamic, 3, RowMajor> F32 = F.cast<int32_t>();
+    out.write((const char*) F32.data(), F32.size() * sizeof(int32_t));
+
+    // Names as null terminated strings
+    pad(out);
+    header.namesOffset = out.tellp();
+    for(const string& name : names) {
+        out.write(name.c_str(), name.size() + 1);
+    }
+
+    pad(out);
+    header.meanOffset = out.tellp();
+    out.write((const char*) mean.data(), mean.size() * sizeof(double));
+
+    // Vertex positions of all faces, column major per face
+    pad(out);
+    header.dataOffset = out.tellp();
+    for(const MatrixXd& V : faces) {
+        switch(encoding) {
+            case ENCODING_FLOAT: {
+                MatrixXf Vf = V.cast<float>();
+                out.write((const char*) Vf.data(), Vf.size() * sizeof(float));
+                break;
+            }
+            case ENCODING_DELTA_INT16: {
+                Matrix<int16_t, Dynamic, Dynamic> Q = ((V - mean) / header.quantizationStep).array().round().cast<int16_t>();
+                out.write((const char*) Q.data(), Q.size() * sizeof(int16_t));
+                break;
+            }
+            default:
+                out.write((const char*) V.data(), V.size() * sizeof(double));
+                break;
+        }
+    }
+
+    // Rewrite header with section offsets
+    out.seekp(0);
+    out.write((const char*) &header, sizeof(Header));
+    return (bool) out;
+}
+
+bool FaceCorpus::listFolder(const string& folder, vector<string>& files) {
+    files.clear();
+    DIR *directory;
+    struct dirent *entry;
+    if ((directory = opendir(folder.c_str())) == NULL) {
+        cerr << "Failed to open folder: " << folder << endl;
+        return false;
+    }
+    while ((entry = readdir(directory)) != NULL) {
+        string current = entry->d_name;
+        if(current.size() >= 4 && current.compare(current.size() - 4, 4, ".obj") == 0) {
+            files.push_back(current);
+        }
+    }
+    closedir(directory);
+    sort(files.begin(), files.end());
+    return true;
+}
+
+// Build a corpus from all .obj files of a folder of registered faces
+bool FaceCorpus::importFolder(const string& folder, const string& path, Encoding encoding) {
+    vector<string> files;
+    if(!listFolder(folder, files)) {
+        return false;
+    }
+
+    vector<string> names;
+    vector<MatrixXd> faces;
+    MatrixXi F;
+    MatrixXd vertices;
+    MatrixXi triangles;
+    for(const string& file : files) {
+        if(!igl::read_triangle_mesh(folder + file, vertices, triangles)) {
+            cerr << "Failed to read " << folder + file << endl;
+            return false;
+        }
+        // Faces saved with vertices only share the connectivity of the others
+        if(triangles.rows() > 0) {
+            if(F.rows() > 0 && triangles != F) {
+                cerr << "Connectivity of " << folder + file << " differs from " << folder + names.front() << endl;
+                return false;
+            }
+            F = triangles;
+        }
+        names.push_back(file);
+        faces.push_back(vertices);
+    }
+    cout << "Import " << faces.size() << " faces from " << folder << " to " << path << endl;
+    return write(path, names, faces, F, encoding);
+}
+
+bool FaceCorpus::buildFolder(const string& folder, Encoding encoding) {
+    if(!importFolder(folder, folder + _defaultFileName, encoding)) {
+        cout << "Failed to build face corpus for " << folder << endl;
+        return false;
+    }
+    return true;
+}
+
+bool FaceCorpus::loadFolder(const string& folder, vector<string>& names, vector<MatrixXd>& faces, MatrixXi& F) {
+    FaceCorpus corpus;
+    if(!corpus.openFolder(folder)) {
+        return false;
+    }
+    cout << "Read corpus: " << folder + _defaultFileName << endl;
+    names = corpus.names();
+    corpus.getFaces(faces);
+    corpus.getF(F);
+    return true;
+}
+
+bool FaceCorpus::open(const string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(map == MAP_FAILED) {
+        return false;
+    }
+    _data = (const char*) map;
+    _size = st.st_size;
+    _modificationTime = st.st_mtime;
+    memcpy(&_header, _data, sizeof(Header));
+    if(!isValid()) {
+        cerr << "Invalid face corpus: " << path << endl;
+        close();
+        return false;
+    }
+    _names.clear();
+    const char* name = _data + _header.namesOffset;
+    for(uint32_t i = 0; i < _header.nMeshes; i++) {
+        _names.push_back(string(name));
+        name += _names.back().size() + 1;
+    }
+    return true;
+}
+
+// Check the header against the mapped size before anything is read through it
+bool FaceCorpus::isValid() const {
+    if(memcmp(_header.magic, corpusMagic, sizeof(corpusMagic)) != 0 || _header.version != 1 || _header.encoding > ENCODING_DELTA_INT16) {
+        return false;
+    }
+    // Section [offset, offset + bytes) inside the file and aligned for its values
+    auto inside = [&](uint64_t offset, uint64_t bytes, uint64_t alignment) {
+        return offset >= sizeof(Header) && offset % alignment == 0 && offset <= _size && bytes <= _size - offset;
+    };
+    const uint64_t nValues = (uint64_t) _header.nVertices * 3;
+    if(!inside(_header.facesOffset, (uint64_t) _header.nFaces * 3 * sizeof(int32_t), sizeof(int32_t)) ||
+       !inside(_header.meanOffset, nValues * sizeof(double), sizeof(double)) ||
+       !inside(_header.dataOffset, _header.nMeshes * nValues * bytesPerValue(), bytesPerValue()) ||
+       !inside(_header.namesOffset, 0, 1)) {
+        return false;
+    }
+    // One null terminated name per face, all inside the file
+    const char* name = _data + _header.namesOffset;
+    const char* end = _data + _size;
+    for(uint32_t i = 0; i < _header.nMeshes; i++) {
+        const char* terminator = (const char*) memchr(name, '\0', end - name);
+        if(terminator == nullptr) {
+            return false;
+        }
+        name = terminator + 1;
+    }
+    // Face indices must refer to vertices of the corpus
+    Map<const Matrix<int32_t, Dynamic, 1>> indices((const int32_t*) (_data + _header.facesOffset), (Index) _header.nFaces * 3);
+    return indices.size() == 0 || (indices.minCoeff() >= 0 && indices.maxCoeff() < (int32_t) _header.nVertices);
+}
+
+bool FaceCorpus::isUpToDate(const string& folder) const {
+    vector<string> files;
+    if(!isOpen() || !listFolder(folder, files)) {
+        return false;
+    }
+    vector<string> names = _names;
+    sort(names.begin(), names.end());
+    if(names != files) {
+        return false;
+    }
+    for(const string& file : files) {
+        struct stat st;
+        if(stat((folder + file).c_str(), &st) != 0 || st.st_mtime > _modificationTime) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FaceCorpus::openFolder(const string& folder) {
+    string path = folder + _defaultFileName;
+    if(!open(path)) {
+        return false;
+    }
+    if(isUpToDate(folder)) {
+        return true;
+    }
+    cout << "Face corpus is out of date, rebuilding: " << path << endl;
+    Encoding previous = encoding();
+    close();
+    return importFolder(folder, path, previous) && open(path);
+}
+
+void FaceCorpus::close() {
+    if(_data != nullptr) {
+        munmap((void*) _data, _size);
+    }
+    _data = nullptr;
+    _size = 0;
+    _modificationTime = 0;
+    _names.clear();
+}
+
+bool FaceCorpus::isOpen() const {
+    return _data != nullptr;
+}
+
+int FaceCorpus::size() const {
+    return isOpen() ? _header.nMeshes : 0;
+}
+
+int FaceCorpus::nVertices() const {
+    return isOpen() ? _header.nVertices : 0;
+}
+
+FaceCorpus::Encoding FaceCorpus::encoding() const {
+    return (Encoding) _header.encoding;
+}
+
+const vector<string>& FaceCorpus::names() const {
+    return _names;
+}
+
+void FaceCorpus::getF(MatrixXi& F) const {
+    F = Map<const Matrix<int32_t, Dynamic, 3, RowMajor>>((const int32_t*) (_data + _header.facesOffset), _header.nFaces, 3).cast<int>();
+}
+
+void FaceCorpus::getMeanFace(MatrixXd& V) const {
+    V = Map<const MatrixXd>((const double*) (_data + _header.meanOffset), _header.nVertices, 3);
+}
+
+void FaceCorpus::getFace(int i, MatrixXd& V) const {
+    size_t count = (size_t) _header.nVertices * 3;
+    const char* values = _data + _header.dataOffset + i * count * bytesPerValue();
+    switch(encoding()) {
+        case ENCODING_FLOAT:
+            V = Map<const MatrixXf>((const float*) values, _header.nVertices, 3).cast<double>();
+            break;
+        case ENCODING_DELTA_INT16:
+            getMeanFace(V);
+            V += _header.quantizationStep * Map<const Matrix<int16_t, Dynamic, Dynamic>>((const int16_t*) values, _header.nVertices, 3).cast<double>();
+            break;
+        default:
+            V = mapFace(i);
+            break;
+    }
+}
+
+void FaceCorpus::getFaces(vector<MatrixXd>& faces) const {
+    faces.resize(size());
+    for(int i = 0; i < size(); i++) {
+        getFace(i, faces[i]);
+    }
+}
+
+Map<const MatrixXd> FaceCorpus::mapFace(int i) const {
+    size_t count = (size_t) _header.nVertices * 3;
+    return Map<const MatrixXd>((const double*) (_data + _header.dataOffset) + i * count, _header.nVertices, 3);
+}
+
+size_t FaceCorpus::bytesPerValue() const {
+    switch(_header.encoding) {
+        case ENCODING_FLOAT: return sizeof(float);
+        case ENCODING_DELTA_INT16: return sizeof(int16_t);
+        default: return sizeof(double);
+    }
+}
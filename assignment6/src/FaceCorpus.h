@@ -0,0 +1,97 @@
+#ifndef ASSIGNMENT6_FACECORPUS_H
+#define ASSIGNMENT6_FACECORPUS_H
+// Includes
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include <Eigen/Core>
+
+using namespace std;
+using namespace Eigen;
+
+// Container for a set of registered faces sharing the template connectivity.
+// The faces F are stored once, followed by the mean face and the packed vertex
+// positions of every face. Positions are stored per face as [x; y; z] columns
+// (same layout as a column major #V x 3 MatrixXd) either as doubles, floats or
+// as 16 bit integers quantizing the offset to the mean face.
+// A corpus is read with a single memory mapping of the whole file.
+class FaceCorpus {
+public:
+    enum Encoding {
+        ENCODING_DOUBLE = 0,
+        ENCODING_FLOAT = 1,
+        ENCODING_DELTA_INT16 = 2
+    };
+
+    // File layout, all offsets in bytes from the start of the file
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t encoding;
+        uint32_t nVertices;
+        uint32_t nFaces;
+        uint32_t nMeshes;
+        uint32_t reserved;
+        double quantizationStep;
+        uint64_t facesOffset;
+        uint64_t namesOffset;
+        uint64_t meanOffset;
+        uint64_t dataOffset;
+    };
+
+    // Default corpus file name inside a folder of registered faces
+    static const string _defaultFileName;
+    // Names of the encodings for display, indexed by Encoding
+    static const vector<const char*> _encodingNames;
+
+    FaceCorpus() {}
+    ~FaceCorpus();
+    FaceCorpus(const FaceCorpus&) = delete;
+    FaceCorpus& operator=(const FaceCorpus&) = delete;
+
+    // Writing
+    static bool write(const string& path, const vector<string>& names, const vector<MatrixXd>& faces, const MatrixXi& F, Encoding encoding = ENCODING_DOUBLE);
+    static bool importFolder(const string& folder, const string& path, Encoding encoding = ENCODING_DOUBLE);
+    // Sorted names of the .obj files of a folder
+    static bool listFolder(const string& folder, vector<string>& files);
+    // Build the default corpus of a folder
+    static bool buildFolder(const string& folder, Encoding encoding);
+    // Names, faces and connectivity of a folder read from its default corpus
+    // (see openFolder), false if the folder has none
+    static bool loadFolder(const string& folder, vector<string>& names, vector<MatrixXd>& faces, MatrixXi& F);
+
+    // Reading
+    bool open(const string& path);
+    // Whether the open corpus holds exactly the .obj files of folder and is
+    // newer than all of them
+    bool isUpToDate(const string& folder) const;
+    // Open the default corpus of a folder, rebuilding it first (with the same
+    // encoding) if .obj files were added, removed or modified since
+    bool openFolder(const string& folder);
+    void close();
+    bool isOpen() const;
+    int size() const;
+    int nVertices() const;
+    Encoding encoding() const;
+    const vector<string>& names() const;
+    void getF(MatrixXi& F) const;
+    void getMeanFace(MatrixXd& V) const;
+    void getFace(int i, MatrixXd& V) const;
+    void getFaces(vector<MatrixXd>& faces) const;
+    // Positions of face i without copy, only for ENCODING_DOUBLE
+    Map<const MatrixXd> mapFace(int i) const;
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+    time_t _modificationTime = 0;
+    Header _header;
+    vector<string> _names;
+
+    size_t bytesPerValue() const;
+    bool isValid() const;
+};
+
+
+#endif //ASSIGNMENT6_FACECORPUS_H
@@ -0,0 +1,9 @@
+#include "FaceCorpusMenu.h"
+#include <imgui/imgui.h>
+
+void drawFaceCorpusMenu(const string& folder, int& encoding) {
+    ImGui::Combo("Corpus encoding", &encoding, FaceCorpus::_encodingNames.data(), FaceCorpus::_encodingNames.size());
+    if (ImGui::Button("Build face corpus", ImVec2(-1,0))) {
+        FaceCorpus::buildFolder(folder, (FaceCorpus::Encoding) encoding);
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef ASSIGNMENT6_FACECORPUSMENU_H
+#define ASSIGNMENT6_FACECORPUSMENU_H
+// Includes
+#include "FaceCorpus.h"
+
+// Encoding combo and button building the face corpus of folder, shared by the
+// menus of the face models
+void drawFaceCorpusMenu(const string& folder, int& encoding);
+
+#endif //ASSIGNMENT6_FACECORPUSMENU_H
@@ -5,11 +5,13 @@
 #include <igl/octree.h>
 #include <igl/slice_mask.h>
 #include <igl/slice.h>
-#include <igl/slice_into.h>
-#include <igl/boundary_loop.h>
-#include <igl/cotmatrix.h>
+#include <igl/cotmatrix_massmatrix.h>
+#include <igl/min_quad_with_fixed_session.h>
 #include <igl/knn.h>
-#include <igl/cat.h>
+#include <igl/AABB.h>
+#include <igl/procrustes.h>
+#include <igl/parallel_for.h>
+#include <igl/fast_writeOBJ.h>
 #include "FaceRegistor.h"
 #include <boost/filesystem.hpp>
 
@@ -45,17 +47,33 @@ vector<Landmark> FaceRegistor::get_template_landmarks() {
     return selector->get_landmarks_from_file(tmpl_file_path);
 }
 
+void FaceRegistor::build_template_model(TemplateModel &model, const MatrixXd &V_tmpl, const MatrixXi &F_tmpl) {
+    model.build(tmpl_names[tmpl_id], V_tmpl, F_tmpl, get_template_landmarks());
+}
+
 MatrixXd FaceRegistor::get_template_landmarks_matrix(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl) {
+    if(tmpl_model && tmpl_model->matches(F_tmpl)) {
+        return tmpl_model->landmark_positions(V_tmpl);
+    }
     string tmpl_file_path = tmpl_folder_path + tmpl_names[tmpl_id] + "_landmarks.txt";
     return selector->get_landmarks_from_file(tmpl_file_path, V_tmpl, F_tmpl);
 }
 
 string FaceRegistor::save_registered_scan(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl) {
     string save_file_path = save_folder_path + scan_names[scan_id] + "_aligned.obj";
-    igl::writeOBJ(save_file_path, V_tmpl, F_tmpl);
+    igl::fast_writeOBJ(save_file_path, V_tmpl, save_vertices_only ? MatrixXi() : F_tmpl);
     return save_file_path;
 }
 
+// Write a batch of registered scans (all sharing F_tmpl) concurrently
+bool FaceRegistor::save_registered_scans(const vector<int> &ids, const vector<MatrixXd> &V_tmpls, const MatrixXi &F_tmpl) {
+    vector<string> save_file_paths;
+    for(int id : ids) {
+        save_file_paths.push_back(save_folder_path + scan_names[id] + "_aligned.obj");
+    }
+    return igl::fast_writeOBJ(save_file_paths, V_tmpls, save_vertices_only ? MatrixXi() : F_tmpl);
+}
+
 void FaceRegistor::center_and_rescale_mesh(MatrixXd &V, const MatrixXd &P, double factor) {
     RowVector3d bc = P.colwise().mean();
     V = factor * (V.rowwise() - bc);
@@ -88,46 +106,99 @@ void FaceRegistor::align_rigid(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, M
     V = V * R;
 }
 
+void FaceRegistor::align_icp(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, MatrixXd &V) {
+    // Scan vertices are matched to the template, which covers more of the head
+    // than the scan, so that every sample has a true correspondence
+    igl::AABB<MatrixXd, 3> tree;
+    tree.init(V_tmpl, F_tmpl);
+    const int step = max(1, (int)(V.rows() / max(1, icp_num_samples)));
+    MatrixXd X0(V.rows() / step, 3);
+    for(int i=0; i<X0.rows(); i++) {
+        X0.row(i) = V.row(i * step);
+    }
+    const int n = X0.rows();
+    const int num_kept = min(n, max(3, (int)(icp_trim * n)));
+    if(num_kept < 3) {
+        cout << "ICP: not enough scan vertices!" << endl;
+        return;
+    }
+
+    // Similarity mapping the scan samples onto the template, |s X0 R + t - Y|
+    double s = 1.0;
+    Matrix3d R = Matrix3d::Identity();
+    RowVector3d t = RowVector3d::Zero();
+    VectorXd sqrD(n);
+    MatrixXd Y(n, 3);
+    double first_error = -1.0, error = numeric_limits<double>::infinity();
+    int iter = 0;
+    for(; iter<icp_max_iter; iter++) {
+        // Closest points of the moved samples
+        igl::parallel_for(n, [&](const int i) {
+            RowVector3d x = s * X0.row(i) * R + t, c;
+            int f;
+            sqrD(i) = tree.squared_distance(V_tmpl, F_tmpl, x, f, c);
+            Y.row(i) = c;
+        }, 500);
+
+        // Drop the farthest correspondences (hair, neck, holes, noise)
+        VectorXd sorted = sqrD;
+        nth_element(sorted.data(), sorted.data() + num_kept - 1, sorted.data() + n);
+        const double max_sqrD = sorted(num_kept - 1);
+        MatrixXd Xk(num_kept, 3), Yk(num_kept, 3);
+        double sum = 0.0;
+        for(int i=0, k=0; i<n && k<num_kept; i++) {
+            if(sqrD(i) <= max_sqrD) {
+                Xk.row(k) = X0.row(i);
+                Yk.row(k) = Y.row(i);
+                sum += sqrD(i);
+                k++;
+            }
+        }
+        const double prev_error = error;
+        error = sqrt(sum / num_kept);
+        if(first_error < 0) {
+            first_error = error;
+        }
+        if(prev_error - error < icp_tolerance * prev_error) {
+            break;
+        }
+
+        Vector3d tv;
+        igl::procrustes(Xk, Yk, icp_scaling, false, s, R, tv);
+        t = tv.transpose();
+    }
+    cout << "ICP: " << iter << " iterations, trimmed RMS error " << first_error << " -> " << error << endl;
+
+    // Keep the scale of the scan: rigid motion for V, 1/s for the template
+    V = (V * R).rowwise() + t / s;
+    V_tmpl /= s;
+}
+
 void FaceRegistor::align_non_rigid_step(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &V, const MatrixXi &F) {
-    // Fetch landmarks
-    vector<Landmark> landmarks_tmpl = get_template_landmarks();
+    // Boundary, landmark selection and Laplacian pattern only depend on the template
+    if(!tmpl_model || !tmpl_model->matches(F_tmpl)) {
+        cout << "Align non-rigid: template model was not built for this template!" << endl;
+        return;
+    }
+    const TemplateModel &model = *tmpl_model;
     MatrixXd P = get_scan_landmarks_matrix(V, F);
-    
-    // Laplacian matrix 
+
+    // Laplacian matrix, only values are recomputed while the template deforms
     SparseMatrix<double> Laplacian;
-    igl::cotmatrix(V_tmpl, F_tmpl, Laplacian);
+    igl::cotmatrix_massmatrix(V_tmpl, model.laplacian_data, Laplacian);
     MatrixXd Lx = Laplacian * V_tmpl;
     //cout << "Laplacian matrix done: L: " << Laplacian.rows() << " x " << Laplacian.cols() << " Lx: " << Lx.rows() << " x " << Lx.cols() << endl;
 
-    // Boundary constraints
-    SparseMatrix<double> Csb; // Csb = boundary constraints
+    // Boundary constraints keep the boundary in place (Csb = boundary constraints)
     MatrixXd Cwsb; // corresponding right hand side
-    VectorXi Bi; // boundary indices
-    igl::boundary_loop(F_tmpl, Bi);
-    SparseMatrix<double> Id(V_tmpl.rows(), V_tmpl.rows());
-    Id.setIdentity();
-    igl::slice(Id, Bi, 1, Csb);
-    igl::slice(V_tmpl, Bi, 1, Cwsb);
-    MatrixXi Bi_mask = MatrixXi::Ones(V_tmpl.rows(), 1);
-    igl::slice_into(MatrixXi::Zero(Bi.rows(), 1), Bi, 1, Bi_mask);
-    //cout << "boundary constraints done: Csb: " << Csb.rows() << " x " << Csb.cols() << " Cwsb: " << Cwsb.rows() << " x " << Cwsb.cols() << endl;
-
-    // Target landmarks constraints
-    SparseMatrix<double> Csl(23, V_tmpl.rows()); // Csl = landmark constraints (target)
+    igl::slice(V_tmpl, model.boundary, 1, Cwsb);
+
+    // Target landmarks constraints (Csl = landmark constraints)
     MatrixXd Cwsl = P; // corresponding right hand side
-    vector<T> tripletList;
-    tripletList.reserve(23 * 3);
-    int index = 0;
-    for(LandmarkSelector::Landmark landmark : landmarks_tmpl) {
-        RowVector3i vi = F_tmpl.row(landmark.face_index);
-        Vector3f bc(landmark.bary0, landmark.bary1, landmark.bary2);
-        tripletList.push_back(T(index, vi(0), bc(0)));
-        tripletList.push_back(T(index, vi(1), bc(1)));
-        tripletList.push_back(T(index, vi(2), bc(2)));
-        index++;
-    }
-    Csl.setFromTriplets(tripletList.begin(), tripletList.end());
-    //cout << "landmarks constraints done: Csl: " << Csl.rows() << " x " << Csl.cols() << " Cwsl: " << Cwsl.rows() << " x " << Cwsl.cols() << endl;
+    if(useLandmarks && Cwsl.rows() != model.Csl.rows()) {
+        cout << "Align non-rigid: scan and template have different numbers of landmarks!" << endl;
+        return;
+    }
 
     // Query dynamic constraints (close to target face)
     VectorXi I(V_tmpl.rows());
@@ -139,31 +210,35 @@ void FaceRegistor::align_non_rigid_step(MatrixXd &V_tmpl, const MatrixXi &F_tmpl
         kd_tree->index->findNeighbors(resultSet, RowVector3d(V_tmpl.row(i)).data(), SearchParams(10));
         I(i) = ret_index[0];
     }
-    SparseMatrix<double> Cd;
-    MatrixXd C, Cwd; // C = position of nearest neighbor (#V_tmpl x 3), Cwd = reduced C
+    MatrixXd C; // C = position of nearest neighbor (#V_tmpl x 3)
     igl::slice(V, I, 1, C);
-    Array<bool, Dynamic, 1> c_mask = ((V_tmpl - C).rowwise().norm().array() < m_epsilon) * (Bi_mask.cast<bool>().array());
-    igl::slice_mask(C, c_mask, 1, Cwd);
-    igl::slice_mask(Id, c_mask, 1, Cd);
-    //cout << "dynamic constraints done: Cd: " << Cd.rows() << " x " << Cd.cols() << " Cwd: " << Cwd.rows() << " x " << Cwd.cols() << endl;
-
-    // Set up whole matrix and right hand side
-    SparseMatrix<double> Snd = useLandmarks? m_lambda * igl::cat(1, Csb, igl::cat(1, Csl, Cd)) : m_lambda * igl::cat(1, Csb, Cd);
-    SparseMatrix<double> A = igl::cat(1, Laplacian, Snd);
-    MatrixXd b(A.rows(), 3);
+    Array<bool, Dynamic, 1> c_mask = ((V_tmpl - C).rowwise().norm().array() < m_epsilon) * model.interior_mask;
+    //cout << "dynamic constraints done: " << c_mask.count() << " of " << c_mask.rows() << endl;
+
+    // Set up normal equations of |L x - Lx|^2 + lambda^2 |Cs x - Cws|^2 + lambda^2 |x(c_mask) - C(c_mask)|^2.
+    // The dynamic constraints are soft diagonal weights, so the pattern of Q stays the same from one iteration
+    // to the next and the solver session only refactorizes numerically.
+    // Cs' Cs and Cs' Cws are summed over the boundary and landmark blocks.
+    SparseMatrix<double> LT = Laplacian.transpose();
+    SparseMatrix<double> CsTCs = useLandmarks ? SparseMatrix<double>(model.CsbTCsb + model.CslTCsl) : model.CsbTCsb;
+    MatrixXd CsTCws = model.CsbT * Cwsb;
     if(useLandmarks){
-        b << Lx, m_lambda * Cwsb, m_lambda * Cwsl, m_lambda * Cwd;
-    } else {
-        b << Lx, m_lambda * Cwsb, m_lambda * Cwd;
+        CsTCws += model.CslT * Cwsl;
     }
-    //cout << "whole matrix set up done: A: " << A.rows() << " x " << A.cols() << " b: " << b.rows() << " x " << b.cols() << endl;
+    SparseMatrix<double> Q = LT * Laplacian + (m_lambda * m_lambda) * CsTCs;
+    MatrixXd B = -(LT * Lx + (m_lambda * m_lambda) * CsTCws);
+    VectorXd W = (m_lambda * m_lambda) * c_mask.cast<double>().matrix();
+    //cout << "whole matrix set up done: Q: " << Q.rows() << " x " << Q.cols() << " B: " << B.rows() << " x " << B.cols() << endl;
 
     // Solve system
-    Eigen::SimplicialLDLT<SparseMatrix<double> > solver; //solve for A'Ax = A'b instead of Ax = b
-    solver.compute(A.transpose() * A);
-    //cout << "Solver compute success: " << int(solver.info() == Success) << endl;
-    MatrixXd V_sol = solver.solve(A.transpose() * b);
-    cout << "Solver solve success: " << int(solver.info() == Success) << endl;
+    bool factorized = solver_session.update(Q, VectorXi(), W);
+    //cout << "Solver compute success: " << int(factorized) << endl;
+    MatrixXd V_sol;
+    bool solved = factorized && solver_session.solve(B, MatrixXd(), C, V_sol);
+    cout << "Solver solve success: " << int(solved) << endl;
+    if(!solved) {
+        return;
+    }
     V_tmpl = V_sol;
     //cout << "system solve done: V_sol: " << V_sol.rows() << " x " << V_sol.cols() << endl;
 
@@ -226,6 +301,9 @@ void FaceRegistor::register_face(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, Matri
     center_and_rescale_scan(V, F);
     center_and_rescale_template(V_tmpl, F_tmpl, V, F);
     align_rigid(V_tmpl, F_tmpl, V, F);
+    if(useICP) {
+        align_icp(V_tmpl, F_tmpl, V);
+    }
     build_octree(V);
 
     m_lambda = lambda;
@@ -236,4 +314,9 @@ void FaceRegistor::register_face(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, Matri
     for(int i=0; i<num_iter-1; i++){
         align_non_rigid_step(V_tmpl, F_tmpl, V, F);
     }
-}
\ No newline at end of file
+}
+
+void FaceRegistor::evaluate_registration(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &V, const MatrixXi &F) {
+    MatrixXd P_tmpl = get_template_landmarks_matrix(V_tmpl, F_tmpl);
+    metrics.evaluate(V_tmpl, F_tmpl, P_tmpl, V, F);
+}
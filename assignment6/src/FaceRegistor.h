@@ -4,7 +4,11 @@
 #include <imgui/imgui.h>
 #include <vector>
 #include <nanoflann.hpp>
+#include <igl/cotmatrix_massmatrix.h>
+#include <igl/min_quad_with_fixed_session.h>
 #include "LandmarkSelector.h"
+#include "RegistrationMetrics.h"
+#include "TemplateModel.h"
 #include <boost/filesystem.hpp>
 
 using namespace std;
@@ -21,6 +25,8 @@ class FaceRegistor {
 private:
     KDTree *kd_tree;
     LandmarkSelector* selector;
+    // Factorization of the non-rigid step's system, analyzed once per pattern
+    igl::min_quad_with_fixed_session<double> solver_session;
 public:
     string scan_folder_path = "../data/preprocessed_faces/";
     vector<string> scan_names;
@@ -29,13 +35,34 @@ public:
     string tmpl_folder_path = "../data/face_template/";
     vector<string> tmpl_names;
     int tmpl_id = 3;
+    // Operators of the selected template, shared with other registrations
+    const TemplateModel* tmpl_model = nullptr;
 
     string save_folder_path = "../data/aligned_faces/";
+    // Only write vertex positions, faces are those of the template
+    bool save_vertices_only = false;
 
     float m_lambda = 1.0f;
     float m_epsilon = 0.01f;
     bool useLandmarks = true;
 
+    // Trimmed ICP refining the landmark based rigid alignment with the surfaces.
+    // Off by default: it helps on noisy scans but can be worse than the
+    // landmarks alone at low noise.
+    bool useICP = false;
+    // Also fit the scale of the template
+    bool icp_scaling = true;
+    int icp_max_iter = 20;
+    // Scan vertices used as correspondences
+    int icp_num_samples = 1000;
+    // Fraction of closest correspondences kept at every iteration
+    float icp_trim = 0.8f;
+    // Stop once the trimmed RMS error improves by less than this fraction
+    float icp_tolerance = 1e-3f;
+
+    // Distances between registered template and scan of the last evaluation
+    RegistrationMetrics metrics;
+
     FaceRegistor(LandmarkSelector* landmarkSelector) : selector(landmarkSelector) {
         fill_file_names(scan_names, scan_folder_path, ".obj");
         fill_file_names(tmpl_names, tmpl_folder_path, ".obj");
@@ -49,10 +76,15 @@ public:
 
     vector<Landmark> get_template_landmarks();
 
+    // Template of tmpl_id with its operators, to be built once per selection
+    void build_template_model(TemplateModel &model, const MatrixXd &V_tmpl, const MatrixXi &F_tmpl);
+
     MatrixXd get_template_landmarks_matrix(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl);
 
     string save_registered_scan(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl);
 
+    bool save_registered_scans(const vector<int> &ids, const vector<MatrixXd> &V_tmpls, const MatrixXi &F_tmpl);
+
     void center_and_rescale_mesh(MatrixXd &V, const MatrixXd &P, double factor=1.0);
 
     void center_and_rescale_scan(MatrixXd &V, const MatrixXi &F);
@@ -61,12 +93,18 @@ public:
 
     void align_rigid(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, MatrixXd &V, const MatrixXi &F);
 
+    // Refine align_rigid: moves V rigidly and rescales V_tmpl (both centered)
+    void align_icp(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, MatrixXd &V);
+
     void align_non_rigid_step(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &V, const MatrixXi &F);
 
     void build_octree(const MatrixXd &V);
 
     void subdivide_template(MatrixXd &V_tmpl, MatrixXi &F_tmpl); //not used currently
 
+    // Fill metrics for the registered template, regions are those of the template landmarks
+    void evaluate_registration(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &V, const MatrixXi &F);
+
     void register_face(MatrixXd &V_tmpl, const MatrixXi &F_tmpl, MatrixXd &V, const MatrixXi &F, int num_iter = 5, float lambda = 1.0f, float epsilon1 = 0.01f, float epsilon2 = 3.0f);
 
 };
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "MorphAnimator.h"
+#include <fstream>
+#include <cstdint>
+#include <sys/stat.h>
+
+void MorphAnimator::addKeyframe(const VectorXd& w) {
+    if(!_keyframes.empty() && _keyframes[0].rows() != w.rows()) {
+        cout << "Keyframe dimension changed, clear previous keyframes" << endl;
+        _keyframes.clear();
+    }
+    _keyframes.push_back(w);
+    cout << "Added keyframe " << _keyframes.size() - 1 << endl;
+}
+
+void MorphAnimator::clearKeyframes() {
+    _keyframes.clear();
+    _frameStart = 0;
+    _frameCount = 0;
+    _currentFrame = -1;
+    _playing = false;
+}
+
+// Sample the path through all keyframes, columns of W hold one weight vector per frame
+void MorphAnimator::computePath(MatrixXd& W) {
+    if(_keyframes.size() < 2) {
+        cout << "At least two keyframes are needed for a morph sequence" << endl;
+        W.resize(0,0);
+        return;
+    }
+    int nFrames = max(2, _nFrames);
+    int nSegments = _keyframes.size() - 1;
+    W.resize(_keyframes[0].rows(), nFrames);
+    for(int i = 0; i < nFrames; i++) {
+        // Global parameter in [0, #segments]
+        double s = (double) i / (nFrames - 1) * nSegments;
+        int segment = min((int) s, nSegments - 1);
+        double t = s - segment;
+        const VectorXd& a = _keyframes[segment];
+        const VectorXd& b = _keyframes[segment + 1];
+        switch(_pathType) {
+            case PATH_SPHERICAL: W.col(i) = interpolateSpherical(a, b, t); break;
+            case PATH_SPLINE: W.col(i) = interpolateSpline(segment, t); break;
+            default: W.col(i) = (1 - t) * a + t * b; break;
+        }
+    }
+}
+
+// Evaluate all frames of the path in one batched reconstruction
+void MorphAnimator::evaluate(const Reconstruction& reconstruct) {
+    MatrixXd W;
+    computePath(W);
+    if(W.cols() == 0) {
+        return;
+    }
+    auto start = chrono::high_resolution_clock::now();
+    MatrixXd X;
+    reconstruct(W, X);
+    if(X.rows() == 0) {
+        return;
+    }
+    pushFrames(X);
+    auto end = chrono::high_resolution_clock::now();
+    cout << "Evaluated " << W.cols() << " frames in " << chrono::duration_cast<chrono::milliseconds> (end-start).count() << " ms" << endl;
+}
+
+// Append frames to the ring buffer, overwriting the oldest ones when it is full
+void MorphAnimator::pushFrames(const MatrixXd& X) {
+    int capacity = max(_nFrames, 2);
+    if(_frames.rows() != X.rows() || _frames.cols() != capacity) {
+        _frames.resize(X.rows(), capacity);
+        _frameStart = 0;
+        _frameCount = 0;
+    }
+    // Frame indices now refer to other frames, the next play() has to show one
+    _currentFrame = -1;
+    for(int i = 0; i < X.cols(); i++) {
+        int slot = (_frameStart + _frameCount) % capacity;
+        _frames.col(slot) = X.col(i);
+        if(_frameCount < capacity) {
+            _frameCount++;
+        }
+        else {
+            _frameStart = (_frameStart + 1) % capacity;
+        }
+    }
+}
+
+// Copy frame i (0 is the oldest frame in the buffer) to a #V x 3 matrix
+void MorphAnimator::getFrame(int i, MatrixXd& V) {
+    int slot = (_frameStart + i) % _frames.cols();
+    V = Map<const MatrixXd>(_frames.col(slot).data(), _frames.rows() / 3, 3);
+}
+
+void MorphAnimator::startPlayback() {
+    if(_frameCount == 0) {
+        cout << "No morph sequence evaluated" << endl;
+        _playing = false;
+        return;
+    }
+    _playing = true;
+    _currentFrame = -1;
+    _playStart = chrono::high_resolution_clock::now();
+}
+
+void MorphAnimator::stopPlayback() {
+    _playing = false;
+}
+
+// Show the frame corresponding to the elapsed time, to be called once per draw.
+// Only the vertex positions are updated since the connectivity is shared.
+// Returns true iff a new frame has been shown
+bool MorphAnimator::play(Viewer& viewer, MatrixXi& F) {
+    if(!_playing || _frameCount == 0) {
+        return false;
+    }
+    double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - _playStart).count();
+    int tick = (int) (elapsed * _fps);
+    int frame;
+    if(_pingPong && _frameCount > 1) {
+        int period = 2 * (_frameCount - 1);
+        frame = tick % period;
+        frame = frame < _frameCount ? frame : period - frame;
+    }
+    else {
+        frame = tick % _frameCount;
+    }
+    // Most draws fall within the same frame: nothing to upload, and the
+    // normals are only recomputed below when the frame changes
+    if(frame == _currentFrame) {
+        return false;
+    }
+    MatrixXd V;
+    getFrame(frame, V);
+    if(viewer.data().V.rows() == V.rows() && viewer.data().F.rows() == F.rows()) {
+        viewer.data().set_vertices(V);
+        viewer.data().compute_normals();
+    }
+    else {
+        viewer.data().clear();
+        viewer.data().set_mesh(V, F);
+    }
+    _currentFrame = frame;
+    return true;
+}
+
+// Write all frames to a compact binary file: a small header, the shared faces
+// once, then the vertex positions of every frame as 32-bit floats
+string MorphAnimator::exportAnimation(const MatrixXi& F) {
+    if(_frameCount == 0) {
+        cout << "No morph sequence evaluated" << endl;
+        return "";
+    }
+    struct stat buffer;
+    if(stat (_animationResults.c_str(), &buffer) != 0) {
+        if(mkdir(_animationResults.c_str(), 0777) == -1) {
+            cout << "Folder creation failed" << endl;
+            return "";
+        }
+    }
+    string fileName = _animationResults + to_string(chrono::system_clock::now().time_since_epoch().count()) + ".morph";
+    ofstream out(fileName, ios::binary);
+    if(!out) {
+        cout << "Failed to open " << fileName << endl;
+        return "";
+    }
+    const char magic[4] = {'M', 'R', 'P', 'H'};
+    int32_t header[4] = {1, (int32_t) (_frames.rows() / 3), (int32_t) F.rows(), (int32_t) _frameCount};
+    out.write(magic, sizeof(magic));
+    out.write((const char*) header, sizeof(header));
+    out.write((const char*) &_fps, sizeof(float));
+
+    Matrix<int32_t, Dynamic, 3, RowMajor> faces = F.cast<int32_t>();
+    out.write((const char*) faces.data(), faces.size() * sizeof(int32_t));
+    MatrixXd V;
+    Matrix<float, Dynamic, 3, RowMajor> Vf;
+    for(int i = 0; i < _frameCount; i++) {
+        getFrame(i, V);
+        Vf = V.cast<float>();
+        out.write((const char*) Vf.data(), Vf.size() * sizeof(float));
+    }
+    cout << "Writing " << _frameCount << " frames to " << fileName << endl;
+    return fileName;
+}
+
+// Interpolate along the great arc between a and b, interpolating the norm linearly
+VectorXd MorphAnimator::interpolateSpherical(const VectorXd& a, const VectorXd& b, double t) {
+    double na = a.norm();
+    double nb = b.norm();
+    if(na < 1e-12 || nb < 1e-12) {
+        return (1 - t) * a + t * b;
+    }
+    double cosOmega = max(-1.0, min(1.0, a.dot(b) / (na * nb)));
+    double omega = acos(cosOmega);
+    if(omega < 1e-6) {
+        return (1 - t) * a + t * b;
+    }
+    VectorXd direction = (sin((1 - t) * omega) * a / na + sin(t * omega) * b / nb) / sin(omega);
+    return ((1 - t) * na + t * nb) * direction;
+}
+
+// Catmull-Rom spline through the keyframes, end points are repeated
+VectorXd MorphAnimator::interpolateSpline(int segment, double t) {
+    int last = _keyframes.size() - 1;
+    const VectorXd& p0 = _keyframes[max(segment - 1, 0)];
+    const VectorXd& p1 = _keyframes[segment];
+    const VectorXd& p2 = _keyframes[segment + 1];
+    const VectorXd& p3 = _keyframes[min(segment + 2, last)];
+    double t2 = t * t;
+    double t3 = t2 * t;
+    return 0.5 * ((2 * p1) + (p2 - p0) * t + (2 * p0 - 5 * p1 + 4 * p2 - p3) * t2 + (3 * p1 - p0 - 3 * p2 + p3) * t3);
+}
@@ -0,0 +1,78 @@
+#ifndef ASSIGNMENT6_MORPHANIMATOR_H
+#define ASSIGNMENT6_MORPHANIMATOR_H
+// Includes
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <igl/opengl/glfw/Viewer.h>
+
+using namespace std;
+using namespace Eigen;
+using Viewer = igl::opengl::glfw::Viewer;
+
+// Precomputes a morph sequence along a path in PCA weight or VAE latent space.
+// All frames of the path are reconstructed in one batch into a ring buffer
+// which can be played back at display rate or exported to an animation file.
+class MorphAnimator {
+public:
+    // Reconstructs a batch of faces: columns of W hold the weights/latent variables,
+    // columns of X receive the vertex positions stacked as [x; y; z] (#V*3 x #frames)
+    typedef function<void(const MatrixXd& W, MatrixXd& X)> Reconstruction;
+
+    enum PathType {
+        PATH_LINEAR = 0,
+        PATH_SPHERICAL = 1,
+        PATH_SPLINE = 2
+    };
+
+    // Variables
+    // Keyframes in weight/latent space, the path passes through all of them
+    vector<VectorXd> _keyframes = vector<VectorXd>();
+    // Interpolation between keyframes
+    int _pathType = PATH_LINEAR;
+    // Amount of frames evaluated for the whole path
+    int _nFrames = 60;
+    // Playback rate in frames per second
+    float _fps = 30.0f;
+    // Play frames in reverse once the end is reached
+    bool _pingPong = true;
+    // Playback state
+    bool _playing = false;
+
+    // Ring buffer of frames #V*3 x capacity
+    MatrixXd _frames = MatrixXd(0,0);
+    // Index of the oldest frame in the ring buffer
+    int _frameStart = 0;
+    // Amount of valid frames in the ring buffer
+    int _frameCount = 0;
+    // Frame shown last by play()
+    int _currentFrame = -1;
+    chrono::high_resolution_clock::time_point _playStart;
+
+    const vector<const char*> _pathTypes = {
+            "Linear",
+            "Spherical",
+            "Spline"
+    };
+    const string _animationResults = "../data/animation-results/";
+
+    // Functions
+    void addKeyframe(const VectorXd& w);
+    void clearKeyframes();
+    void computePath(MatrixXd& W);
+    void evaluate(const Reconstruction& reconstruct);
+    void pushFrames(const MatrixXd& X);
+    void getFrame(int i, MatrixXd& V);
+    void startPlayback();
+    void stopPlayback();
+    bool play(Viewer& viewer, MatrixXi& F);
+    string exportAnimation(const MatrixXi& F);
+
+private:
+    VectorXd interpolateSpherical(const VectorXd& a, const VectorXd& b, double t);
+    VectorXd interpolateSpline(int segment, double t);
+};
+
+
+#endif //ASSIGNMENT6_MORPHANIMATOR_H
@@ -3,6 +3,7 @@
 //
 
 #include "PCA.h"
+#include <igl/fast_writeOBJ.h>
 
 void PCA::convert3Dto1D(MatrixXd& m) {
     if(m.cols() != 3) {
@@ -51,35 +52,45 @@ void PCA::initializeParameters() {
 void PCA::loadFaces(Viewer& viewer, MatrixXi& F, bool init) {
     cout << "Load faces from " << _dataExamples[_currentData] << endl;
     _faceFiles = set<string>();
-    DIR *directory;
-    struct dirent *entry;
-    if ((directory = opendir(_dataExamples[_currentData])) != NULL) {
-        // Get all file paths and store in _faceFiles
-        while ((entry = readdir(directory)) != NULL) {
-            string current = entry->d_name;
-            if(endsWith(current, ".obj")) {
-                _faceFiles.insert(current);
-            }
-        }
-        closedir (directory);
+    vector<string> names;
+    if(FaceCorpus::loadFolder(_dataExamples[_currentData], names, _faceList, F)) {
+        _faceFiles = set<string>(names.begin(), names.end());
+        cout << "Loaded " << _faceList.size() << " faces from corpus" << endl;
     }
     else {
-        cerr << "Failed to load faces: " << _dataExamples[_currentData] << endl;
-        return;
-    }
+        DIR *directory;
+        struct dirent *entry;
+        if ((directory = opendir(_dataExamples[_currentData])) != NULL) {
+            // Get all file paths and store in _faceFiles
+            while ((entry = readdir(directory)) != NULL) {
+                string current = entry->d_name;
+                if(endsWith(current, ".obj")) {
+                    _faceFiles.insert(current);
+                }
+            }
+            closedir (directory);
+        }
+        else {
+            cerr << "Failed to load faces: " << _dataExamples[_currentData] << endl;
+            return;
+        }
 
-    // Store faces in a list
-    MatrixXd vertices;
-    MatrixXi faces;
-    _faceList = vector<MatrixXd>(_faceFiles.size());
-    int i = 0;
-    for(auto it = _faceFiles.begin(); it != _faceFiles.end(); it++){
-        string file = _dataExamples[_currentData] + *it;
-        cout << "Read file: " << file << "\n";
-        igl::read_triangle_mesh(file,vertices,faces);
-        _faceList[i++] = vertices;
-    }
-    F = faces;
+        // Store faces in a list
+        MatrixXd vertices;
+        MatrixXi faces;
+        _faceList = vector<MatrixXd>(_faceFiles.size());
+        int i = 0;
+        for(auto it = _faceFiles.begin(); it != _faceFiles.end(); it++){
+            string file = _dataExamples[_currentData] + *it;
+            cout << "Read file: " << file << "\n";
+            igl::read_triangle_mesh(file,vertices,faces);
+            _faceList[i++] = vertices;
+            // Faces saved with vertices only share the connectivity of the others
+            if(faces.rows() > 0) {
+                F = faces;
+            }
+        }
+    }
     initializeParameters();
     recomputeAll();
     updateFaceIndex(viewer, F);
@@ -425,6 +436,37 @@ void PCA::saveMesh(Viewer& viewer) {
     }
     string fileName = _PCA_Results + to_string(chrono::system_clock::now().time_since_epoch().count()) + ".obj";
     cout << "Writing current mesh to " << fileName << endl;
-    igl::writeOBJ(fileName,viewer.data().V,viewer.data().F);
+    igl::fast_writeOBJ(fileName,viewer.data().V,viewer.data().F);
     cout << endl;
+}
+
+// Unnormalized coefficients of the first #Eigen faces, for the current slider
+// weights if faceIndex is -1
+VectorXd PCA::getEigenFaceCoefficients(int faceIndex) {
+    // There are at most as many Eigen faces as faces
+    int nEigenFaces = min(_nEigenFaces, (int) min(_eigenFaces.cols(), _weightEigenFacesMinMax.rows()));
+    VectorXd c = VectorXd::Zero(max(nEigenFaces, 0));
+    for(int j = 0; j < nEigenFaces; j++) {
+        double weight = faceIndex == -1 ? _weightEigenFaces(j) : _weightEigenFacesPerFace(j,faceIndex);
+        if(weight < 0) {
+            c(j) = weight * _weightEigenFacesMinMax(j,0);
+        }
+        else if(0 < weight) {
+            c(j) = weight * _weightEigenFacesMinMax(j,1);
+        }
+    }
+    return c;
+}
+
+// Reconstruct a batch of faces from Eigen face coefficients (one face per column)
+// with a single matrix product, columns of X hold the faces in 1D
+void PCA::reconstructFaces(const MatrixXd& W, MatrixXd& X) {
+    if(_eigenFaces.cols() == 0) {
+        cout << "No Eigen faces computed" << endl;
+        X.resize(0, W.cols());
+        return;
+    }
+    int nEigenFaces = min((int) W.rows(), (int) _eigenFaces.cols());
+    X = _eigenFaces.leftCols(nEigenFaces) * W.topRows(nEigenFaces);
+    X.colwise() += Map<const VectorXd>(_meanFace.data(), _meanFace.size());
 }
\ No newline at end of file
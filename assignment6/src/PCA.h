@@ -11,6 +11,7 @@
 #include <sys/stat.h>
 #include <igl/opengl/glfw/Viewer.h>
 #include <igl/read_triangle_mesh.h>
+#include "FaceCorpus.h"
 
 using namespace std;
 using namespace Eigen;
@@ -40,6 +41,8 @@ public:
     int _nEigenFaces = 10;
     // Data folder
     int _currentData = 0;
+    // Encoding of the face corpus built for the data folder
+    int _corpusEncoding = FaceCorpus::ENCODING_DOUBLE;
     // Face index chosen by user
     int _faceIndex = 0;
     // Weights of the face displayed in [0,1]
@@ -93,6 +96,8 @@ public:
     void showMorphedFace(Viewer& viewer, MatrixXi& F);
     void showError(Viewer& viewer);
     void saveMesh(Viewer& viewer);
+    VectorXd getEigenFaceCoefficients(int faceIndex);
+    void reconstructFaces(const MatrixXd& W, MatrixXd& X);
 };
 
 
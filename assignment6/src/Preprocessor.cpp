@@ -6,8 +6,7 @@
 #include <igl/collapse_small_triangles.h>
 #include <igl/slice_mask.h>
 #include <igl/slice_into.h>
-#include <igl/cotmatrix.h>
-#include <igl/massmatrix.h>
+#include <igl/cotmatrix_massmatrix.h>
 #include <igl/adjacency_matrix.h>
 #include <igl/sum.h>
 #include <igl/diag.h>
@@ -19,11 +18,13 @@
 #include <igl/repmat.h>
 #include <igl/exact_geodesic.h>
 #include <igl/cut_mesh.h>
-#include <igl/remove_duplicate_vertices.h>
 #include <igl/boundary_loop.h>
 #include <igl/is_edge_manifold.h>
+#include <igl/fast_writeOBJ.h>
 #include <vector>
+#include <limits>
 #include "Preprocessor.h"
+#include "RemeshWeld.h"
 
 using namespace std;
 using namespace Eigen;
@@ -90,21 +91,69 @@ void Preprocessor::compute_distance_to_boundary(Viewer& viewer, MatrixXd &V, Mat
     viewer.data().set_colors(C);
 }
 
+bool Preprocessor::clean_connected_components(ChunkedMesh &mesh) {
+    int num_components = mesh.keep_largest_component();
+    if (num_components < 0)
+        return false;
+    cout << "Found " << num_components << " connected components" << endl;
+    return true;
+}
+
+bool Preprocessor::compute_distance_to_boundary(ChunkedMesh &mesh, MappedArray<double> &D) {
+    // only the boundary is loaded in memory
+    VectorXi L;
+    if (!mesh.boundary_loop(L))
+        return false;
+    MatrixXd BV(L.rows(), 3);
+    for (int i = 0; i < L.rows(); i++)
+        BV.row(i) = mesh.vertex(L(i));
+
+    KDTree kd_tree(3, cref(BV), 10);
+    kd_tree.index->buildIndex();
+
+    // nearby vertices are queried together, chunk by chunk
+    if (!D.create(mesh.num_vertices(), mesh.work_dir)) {
+        cout << "Error: Unable to map " << mesh.work_dir << endl;
+        return false;
+    }
+    double min_dist = numeric_limits<double>::infinity();
+    max_dist = 0.0;
+    for (int c = 0; c < mesh.num_chunks(); c++) {
+        ChunkedMesh::ChunkVertices CV = mesh.chunk_vertices(c);
+        for (int i = 0; i < CV.rows(); i++) {
+            size_t ret_index;
+            double out_dist_sqr;
+            KNNResultSet<double> resultSet(1);
+            resultSet.init(&ret_index, &out_dist_sqr);
+            kd_tree.index->findNeighbors(resultSet, CV.row(i).data(), SearchParams(10));
+            double dist = (CV.row(i) - BV.row(ret_index)).norm();
+            D[mesh.vertex_begin[c] + i] = dist;
+            min_dist = min(min_dist, dist);
+            max_dist = max(max_dist, dist);
+        }
+    }
+    cout << "Scalar field distance range = [ " << min_dist << " ; " << max_dist << " ]" << endl;
+    return true;
+}
+
 void Preprocessor::smooth_distance_field(Viewer& viewer, MatrixXd &V, MatrixXi&F, int num_iter, float w) {
     if(scalar_field.rows() != V.rows()){
         cout << "Smooth: scalar_field has wrong size!" << endl;
         return;
     }
     // smooth scalar distance field by energy optimization
+    // The mesh does not change between iterations: operators are assembled
+    // in one fused pass and the system is factored once
+    igl::cotmatrix_massmatrix_data<double> data;
+    igl::cotmatrix_massmatrix_precompute(V.rows(), F, data);
+    Eigen::SparseMatrix<double> L, M;
+    igl::cotmatrix_massmatrix(V, igl::MASSMATRIX_TYPE_VORONOI, data, L, M);
+    // Solve (L'ML + w*M) X = w*M X
+    const Eigen::SparseMatrix<double> A = L.transpose() * M * L + w * M;
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double > > solver(A);
+    assert(solver.info() == Eigen::Success);
     for (int i=0; i< num_iter; i++) {
         cout << "Smoothing distance field iteration " << i << endl;
-        Eigen::SparseMatrix<double> L, M;
-        igl::cotmatrix(V, F, L);
-        igl::massmatrix(V, F, igl::MASSMATRIX_TYPE_VORONOI, M);
-        // Solve (L'ML + w*M) X = w*M X
-        const auto & A = L.transpose() * M * L + w * M;
-        Eigen::SimplicialLLT<Eigen::SparseMatrix<double > > solver(A);
-        assert(solver.info() == Eigen::Success);
         scalar_field = solver.solve(w * M*scalar_field).eval();  
         assert(solver.info() == Eigen::Success);
     }
@@ -141,7 +190,7 @@ void Preprocessor::remesh(Viewer& viewer, MatrixXd &V, MatrixXi&F) {
     MatrixXd SV;
     VectorXi SVI, SVJ;
     MatrixXi SF;
-    igl::remove_duplicate_vertices(U, G, 1e-10, SV, SVI, SVJ, SF);
+    weld_remeshed_vertices(U, G, SV, SVI, SVJ, SF);
 
     cout << "Is edge manifold (after remove duplicate): " << (igl::is_edge_manifold(SF) ? "true" : "false") << endl;
     if(!igl::is_edge_manifold(SF)){
@@ -182,8 +231,36 @@ void Preprocessor::preprocess(Viewer& viewer, MatrixXd &V, MatrixXi&F, int num_i
     iso_value = prev_iso;
 }
 
+bool Preprocessor::preprocess_file(Viewer& viewer, const string &filename, MatrixXd &V, MatrixXi&F, int num_iter, float w) {
+    ChunkedMesh mesh;
+    if (!mesh.read_obj(filename))
+        return false;
+    MappedArray<double> D;
+    if (!clean_connected_components(mesh) || !compute_distance_to_boundary(mesh, D))
+        return false;
+
+    // smoothing and remeshing solve global systems and need the whole mesh,
+    // loaded in the order of the file like in preprocess
+    mesh.to_matrices(V, F);
+    mesh.to_vector(D, scalar_field);
+    D.release();
+    viewer.data().clear();
+    viewer.data().set_mesh(V, F);
+    MatrixXd C;
+    igl::colormap(igl::COLOR_MAP_TYPE_JET, scalar_field, true, C);
+    viewer.data().set_colors(C);
+
+    smooth_distance_field(viewer, V, F, num_iter, w);
+    double prev_iso = iso_value;
+    iso_value = 0.03 * max_dist;
+    remesh(viewer, V, F);
+    clean_connected_components(viewer, V, F);
+    iso_value = prev_iso;
+    return true;
+}
+
 string Preprocessor::save_mesh(MatrixXd &V, MatrixXi&F) {
     string save_file_path = save_folder_path + mesh_names[mesh_id] + "_preprocessed.obj";
-    igl::writeOBJ(save_file_path, V, F);
+    igl::fast_writeOBJ(save_file_path, V, F);
     return save_file_path;
 }
@@ -1,6 +1,7 @@
 #include <igl/opengl/glfw/Viewer.h>
 #include <nanoflann.hpp>
 #include <boost/filesystem.hpp>
+#include "ChunkedMesh.h"
 
 using namespace std;
 using namespace Eigen;
@@ -33,12 +34,23 @@ public:
 
     void compute_distance_to_boundary(Viewer& viewer, MatrixXd &V, MatrixXi&F);
 
+    // Out of core versions of the two stages above for scans that do not
+    // fit in memory, streaming over the chunks of the mesh. They return false
+    // if the backing files cannot be mapped.
+    bool clean_connected_components(ChunkedMesh &mesh);
+
+    bool compute_distance_to_boundary(ChunkedMesh &mesh, MappedArray<double> &D);
+
     void smooth_distance_field(Viewer& viewer, MatrixXd &V, MatrixXi&F, int num_iter=1, float w = 0.02);
 
     void remesh(Viewer& viewer, MatrixXd &V, MatrixXi&F);
 
     void preprocess(Viewer& viewer, MatrixXd &V, MatrixXi&F, int num_iter=1, float w = 0.02);
 
+    // Same as preprocess, but reads the scan from filename and runs the
+    // cleaning and distance stages out of core before loading the mesh
+    bool preprocess_file(Viewer& viewer, const string &filename, MatrixXd &V, MatrixXi&F, int num_iter=1, float w = 0.02);
+
     string save_mesh(MatrixXd &V, MatrixXi&F);
 
 };
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "RegistrationMetrics.h"
+#include <igl/barycentric_coordinates.h>
+#include <igl/triangle_triangle_adjacency.h>
+#include <igl/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+bool RegistrationMetrics::update_tree(igl::AABB<MatrixXd, 3> &tree, MatrixXi &tree_F, const MatrixXd &V, const MatrixXi &F) {
+    const bool rebuilt = tree_F.rows() != F.rows() || tree_F != F;
+    if(rebuilt) {
+        tree.deinit();
+        tree.init(V, F);
+        tree_F = F;
+    } else {
+        tree.refit(V, F);
+    }
+    return rebuilt;
+}
+
+void RegistrationMetrics::evaluate(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &P_tmpl, const MatrixXd &V, const MatrixXi &F) {
+    update_tree(scan_tree, tree_F, V, F);
+    if(update_tree(tmpl_tree, tree_F_tmpl, V_tmpl, F_tmpl)) {
+        igl::triangle_triangle_adjacency(F_tmpl, TT_tmpl);
+    }
+
+    // Both directions, queries are spread over all threads by AABB
+    VectorXd sqrD_tmpl, sqrD_scan;
+    VectorXi I_tmpl, I_scan;
+    MatrixXd C_tmpl, C_scan;
+    scan_tree.squared_distance(V, F, V_tmpl, sqrD_tmpl, I_tmpl, C_tmpl);
+    tmpl_tree.squared_distance(V_tmpl, F_tmpl, V, sqrD_scan, I_scan, C_scan);
+    tmpl_to_scan = sqrD_tmpl.cwiseSqrt();
+    scan_to_tmpl = sqrD_scan.cwiseSqrt();
+
+    // Template vertices belong to the region of their closest landmark
+    const int num_regions = P_tmpl.rows();
+    tmpl_region = VectorXi::Zero(V_tmpl.rows());
+    igl::parallel_for(V_tmpl.rows(), [&](const int i) {
+        double best = numeric_limits<double>::infinity();
+        for(int l = 0; l < num_regions; l++) {
+            const double d = (P_tmpl.row(l) - V_tmpl.row(i)).squaredNorm();
+            if(d < best) {
+                best = d;
+                tmpl_region(i) = l;
+            }
+        }
+    }, 1000);
+
+    // Scan vertices belong to the region of the template corner closest to
+    // their closest point
+    scan_region = VectorXi::Zero(V.rows());
+    igl::parallel_for(V.rows(), [&](const int i) {
+        const int f = I_scan(i);
+        RowVector3d L;
+        igl::barycentric_coordinates(
+            C_scan.row(i), V_tmpl.row(F_tmpl(f, 0)), V_tmpl.row(F_tmpl(f, 1)), V_tmpl.row(F_tmpl(f, 2)), L);
+        if(exclude_beyond_boundary) {
+            for(int k = 0; k < 3; k++) {
+                // Edge k goes from corner k to corner k+1
+                if(TT_tmpl(f, k) == -1 && L((k + 2) % 3) < 1e-6) {
+                    scan_region(i) = -1;
+                    return;
+                }
+            }
+        }
+        int corner;
+        L.maxCoeff(&corner);
+        scan_region(i) = num_regions > 0 ? tmpl_region(F_tmpl(f, corner)) : 0;
+    }, 1000);
+
+    // Statistics over all vertices and per region
+    vector<double> tmpl_d(tmpl_to_scan.data(), tmpl_to_scan.data() + tmpl_to_scan.size());
+    vector<double> scan_d;
+    vector<vector<double>> region_d(num_regions);
+    scan_d.reserve(V.rows());
+    for(int i = 0; i < V_tmpl.rows(); i++) {
+        if(num_regions > 0) {
+            region_d[tmpl_region(i)].push_back(tmpl_to_scan(i));
+        }
+    }
+    for(int i = 0; i < V.rows(); i++) {
+        if(scan_region(i) == -1) {
+            continue;
+        }
+        scan_d.push_back(scan_to_tmpl(i));
+        if(num_regions > 0) {
+            region_d[scan_region(i)].push_back(scan_to_tmpl(i));
+        }
+    }
+    tmpl_summary = summarize(tmpl_d);
+    scan_summary = summarize(scan_d);
+    hausdorff = max(tmpl_summary.max, scan_summary.max);
+    tmpl_histogram = histogram(tmpl_d, num_bins, histogram_range);
+    scan_histogram = histogram(scan_d, num_bins, histogram_range);
+    region_summaries.resize(num_regions);
+    region_histograms.resize(num_regions);
+    for(int l = 0; l < num_regions; l++) {
+        region_summaries[l] = summarize(region_d[l]);
+        region_histograms[l] = histogram(region_d[l], num_bins, histogram_range);
+    }
+}
+
+RegistrationMetrics::Summary RegistrationMetrics::summarize(const vector<double> &d) {
+    Summary s;
+    s.count = d.size();
+    if(d.empty()) {
+        return s;
+    }
+    vector<double> sorted = d;
+    sort(sorted.begin(), sorted.end());
+    double sum = 0.0, sum_sqr = 0.0;
+    for(double x : sorted) {
+        sum += x;
+        sum_sqr += x * x;
+    }
+    // Nearest rank percentile
+    const auto percentile = [&sorted](double p) {
+        int rank = (int) ceil(p * sorted.size()) - 1;
+        return sorted[max(0, min(rank, (int) sorted.size() - 1))];
+    };
+    s.mean = sum / s.count;
+    s.rms = sqrt(sum_sqr / s.count);
+    s.median = percentile(0.5);
+    s.p90 = percentile(0.9);
+    s.p95 = percentile(0.95);
+    s.p99 = percentile(0.99);
+    s.max = sorted.back();
+    return s;
+}
+
+VectorXi RegistrationMetrics::histogram(const vector<double> &d, int num_bins, double range) {
+    VectorXi H = VectorXi::Zero(num_bins);
+    for(double x : d) {
+        int bin = (int) (x / range * num_bins);
+        H(max(0, min(bin, num_bins - 1)))++;
+    }
+    return H;
+}
+
+void RegistrationMetrics::print_summary(ostream &out) const {
+    const auto print = [&out](const string &label, const Summary &s) {
+        out << label << " mean " << s.mean << " rms " << s.rms << " median " << s.median << " p95 " << s.p95
+            << " max " << s.max << " (" << s.count << " vertices)" << endl;
+    };
+    print("Template to scan:", tmpl_summary);
+    print("Scan to template:", scan_summary);
+    out << "Hausdorff: " << hausdorff << endl;
+    for(size_t l = 0; l < region_summaries.size(); l++) {
+        print("  Landmark region " + to_string(l) + ":", region_summaries[l]);
+    }
+}
+
+void RegistrationMetrics::write_csv_header(ostream &out) {
+    out << "name,hausdorff";
+    for(const string direction : {"tmpl_to_scan", "scan_to_tmpl"}) {
+        for(const string stat : {"mean", "rms", "median", "p90", "p95", "p99", "max"}) {
+            out << "," << direction << "_" << stat;
+        }
+    }
+    out << endl;
+}
+
+void RegistrationMetrics::write_csv_row(ostream &out, const string &name) const {
+    out << name << "," << hausdorff;
+    for(const Summary &s : {tmpl_summary, scan_summary}) {
+        out << "," << s.mean << "," << s.rms << "," << s.median << "," << s.p90 << "," << s.p95 << "," << s.p99 << ","
+            << s.max;
+    }
+    out << endl;
+}
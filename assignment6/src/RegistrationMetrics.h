@@ -0,0 +1,89 @@
+#pragma once
+
+#include <igl/AABB.h>
+#include <Eigen/Core>
+#include <vector>
+#include <string>
+#include <ostream>
+
+using namespace std;
+using namespace Eigen;
+
+// Accuracy of a registered template against its scan, measured as point to
+// surface distances in both directions: from every template vertex to the
+// scan surface and from every scan vertex to the template surface. Like
+// igl::hausdorff, only vertices are used as query points.
+// The bounding volume hierarchies of both meshes are kept between calls and
+// only refit when the connectivity is unchanged, so evaluating all faces
+// registered with the same template rebuilds only the scan hierarchy.
+class RegistrationMetrics {
+public:
+    struct Summary {
+        int count = 0;
+        double mean = 0.0;
+        double rms = 0.0;
+        double median = 0.0;
+        double p90 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    // Histogram bins split [0, histogram_range], the last bin also counts
+    // larger distances
+    int num_bins = 20;
+    double histogram_range = 4.0;
+    // Ignore scan vertices whose closest template point lies on the template
+    // boundary, i.e. scan parts the template does not cover
+    bool exclude_beyond_boundary = true;
+
+    // Per-vertex fields of the last evaluation
+    // #V_tmpl distances from template vertices to the scan
+    VectorXd tmpl_to_scan;
+    // #V distances from scan vertices to the template
+    VectorXd scan_to_tmpl;
+    // #V_tmpl index of the closest template landmark
+    VectorXi tmpl_region;
+    // #V region of the closest template point, -1 for excluded vertices
+    VectorXi scan_region;
+
+    // Statistics of the last evaluation
+    Summary tmpl_summary;
+    Summary scan_summary;
+    double hausdorff = 0.0;
+    VectorXi tmpl_histogram;
+    VectorXi scan_histogram;
+    // Both directions together, one entry per landmark region
+    vector<Summary> region_summaries;
+    vector<VectorXi> region_histograms;
+
+    // Compute distances and statistics
+    //
+    // V_tmpl, F_tmpl  registered template
+    // P_tmpl  #landmarks x 3 landmark positions on the registered template,
+    //     defining the regions (may be empty)
+    // V, F  scan, in the frame of the registered template
+    void evaluate(const MatrixXd &V_tmpl, const MatrixXi &F_tmpl, const MatrixXd &P_tmpl, const MatrixXd &V, const MatrixXi &F);
+
+    void print_summary(ostream &out) const;
+
+    // One line per evaluated face, see write_csv_row
+    static void write_csv_header(ostream &out);
+    void write_csv_row(ostream &out, const string &name) const;
+
+    static Summary summarize(const vector<double> &d);
+    static VectorXi histogram(const vector<double> &d, int num_bins, double range);
+
+private:
+    igl::AABB<MatrixXd, 3> tmpl_tree;
+    igl::AABB<MatrixXd, 3> scan_tree;
+    // Connectivity the trees were built for
+    MatrixXi tree_F_tmpl;
+    MatrixXi tree_F;
+    // Template triangle adjacency, -1 across boundary edges
+    MatrixXi TT_tmpl;
+
+    // Refit tree to V if F is the connectivity it was built for, rebuild it
+    // otherwise. Returns whether it was rebuilt.
+    bool update_tree(igl::AABB<MatrixXd, 3> &tree, MatrixXi &tree_F, const MatrixXd &V, const MatrixXi &F);
+};
@@ -0,0 +1,6 @@
+#include "RemeshWeld.h"
+#include <igl/remove_duplicate_vertices.h>
+
+void weld_remeshed_vertices(const MatrixXd &U, const MatrixXi &G, MatrixXd &SV, VectorXi &SVI, VectorXi &SVJ, MatrixXi &SF) {
+    igl::remove_duplicate_vertices(U, G, remesh_weld_epsilon, igl::REMOVE_DUPLICATE_VERTICES_DISTANCE, SV, SVI, SVJ, SF);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Eigen/Core>
+
+using namespace Eigen;
+
+// igl::remesh_along_isoline gives every face its own copy of the new
+// vertices on the isoline. These are merged back by distance: copies closer
+// than remesh_weld_epsilon are welded, whichever side of a rounding cell
+// border they fall on. The tolerance is the cell size of the rounding weld
+// used before, igl::remove_duplicate_vertices(U, G, 1e-10, ...), which
+// rounds to cells of 10 * 1e-10.
+const double remesh_weld_epsilon = 1e-9;
+
+// Weld the duplicate vertices of the remeshed (U, G) into (SV, SF), see
+// igl::remove_duplicate_vertices for SVI and SVJ
+void weld_remeshed_vertices(const MatrixXd &U, const MatrixXi &G, MatrixXd &SV, VectorXi &SVI, VectorXi &SVJ, MatrixXi &SF);
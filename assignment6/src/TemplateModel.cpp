@@ -0,0 +1,52 @@
+#include <igl/boundary_loop.h>
+#include "TemplateModel.h"
+
+using namespace std;
+using namespace Eigen;
+
+void TemplateModel::build(const string &name, const MatrixXd &V, const MatrixXi &F, const vector<Landmark> &landmarks) {
+    this->name = name;
+    this->V = V;
+    this->F = F;
+    this->landmarks = landmarks;
+    const int n = V.rows();
+
+    // Boundary constraints: rows of the identity at the boundary vertices
+    igl::boundary_loop(F, boundary);
+    interior_mask.setConstant(n, true);
+    vector<Triplet<double>> tripletList;
+    tripletList.reserve(boundary.rows());
+    for (int i = 0; i < boundary.rows(); i++) {
+        tripletList.emplace_back(i, boundary(i), 1.0);
+        interior_mask(boundary(i)) = false;
+    }
+    Csb.resize(boundary.rows(), n);
+    Csb.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    // Landmark constraints: barycentric combination of the face corners
+    tripletList.clear();
+    tripletList.reserve(landmarks.size() * 3);
+    for (int i = 0; i < (int)landmarks.size(); i++) {
+        RowVector3i vi = F.row(landmarks[i].face_index);
+        tripletList.emplace_back(i, vi(0), landmarks[i].bary0);
+        tripletList.emplace_back(i, vi(1), landmarks[i].bary1);
+        tripletList.emplace_back(i, vi(2), landmarks[i].bary2);
+    }
+    Csl.resize(landmarks.size(), n);
+    Csl.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    CsbT = Csb.transpose();
+    CslT = Csl.transpose();
+    CsbTCsb = CsbT * Csb;
+    CslTCsl = CslT * Csl;
+
+    igl::cotmatrix_massmatrix_precompute(n, F, laplacian_data);
+}
+
+bool TemplateModel::matches(const MatrixXi &F) const {
+    return this->F.rows() == F.rows() && this->F.cols() == F.cols() && this->F == F;
+}
+
+MatrixXd TemplateModel::landmark_positions(const MatrixXd &V_tmpl) const {
+    return Csl * V_tmpl;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <vector>
+#include <string>
+#include <igl/cotmatrix_massmatrix.h>
+#include "LandmarkSelector.h"
+
+using namespace std;
+using namespace Eigen;
+using Landmark = LandmarkSelector::Landmark;
+
+// Operators of a template face that only depend on its connectivity and its
+// landmarks. Built once when the template is selected, then only read by the
+// registrations using that template, so several of them may share it (also
+// concurrently). Per registration state such as the factorization stays in
+// FaceRegistor.
+class TemplateModel {
+public:
+    string name;
+    // Positions as loaded, every registration starts from them
+    MatrixXd V;
+    MatrixXi F;
+    vector<Landmark> landmarks;
+
+    // Longest boundary loop
+    VectorXi boundary;
+    // false for boundary vertices, which are never dynamic constraints
+    Array<bool, Dynamic, 1> interior_mask;
+    // Boundary selection (#boundary x #V) and barycentric landmark
+    // selection (#landmarks x #V) matrices, with their normal matrices
+    SparseMatrix<double> Csb, Csl;
+    SparseMatrix<double> CsbT, CslT;
+    SparseMatrix<double> CsbTCsb, CslTCsl;
+    // Laplacian sparsity pattern, only values change as the template deforms
+    igl::cotmatrix_massmatrix_data<double> laplacian_data;
+
+    void build(const string &name, const MatrixXd &V, const MatrixXi &F, const vector<Landmark> &landmarks);
+
+    // Whether the model was built for faces F
+    bool matches(const MatrixXi &F) const;
+
+    // Landmark positions on the template deformed to V_tmpl
+    MatrixXd landmark_positions(const MatrixXd &V_tmpl) const;
+};
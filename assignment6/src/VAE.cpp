@@ -17,7 +17,11 @@ void VAE::initializeParameters() {
         cout << "Read file: " << file << "\n";
         ifstream infile(file);
         int rows, cols;
-        infile >> rows >> cols;
+        if(!(infile >> rows >> cols)) {
+            cerr << "Failed to read model file: " << file << endl;
+            _modelWeights.push_back(MatrixXd(0,0));
+            continue;
+        }
         MatrixXd W(rows, cols);
         double value;
         int i = 0;
@@ -38,7 +42,11 @@ void VAE::initializeParameters() {
         cout << "Read file: " << file << "\n";
         ifstream infile(file);
         int rows, cols;
-        infile >> rows >> cols;
+        if(!(infile >> rows >> cols)) {
+            cerr << "Failed to read model file: " << file << endl;
+            _modelBiases.push_back(VectorXd(0));
+            continue;
+        }
         VectorXd B(rows);
         double value;
         int i = 0;
@@ -55,54 +63,95 @@ void VAE::loadFaces(Viewer& viewer, MatrixXi& F) {
     cout << "Load faces from " << _dataExamples[_currentData] << endl;
     _realFaceFiles = set<string>();
     _vaeFeatureFiles = set<string>();
-    DIR *directory;
-    struct dirent *entry;
-    if ((directory = opendir(_dataExamples[_currentData])) != NULL) {
-        // Get all file paths and store in _faceFiles
-        while ((entry = readdir(directory)) != NULL) {
-            string current = entry->d_name;
-            if(endsWith(current, ".obj")) {
-                _realFaceFiles.insert(current);
-            } else if(endsWith(current, "_features.txt")) {
-                _vaeFeatureFiles.insert(current);
+    vector<string> names;
+    if(FaceCorpus::loadFolder(_dataExamples[_currentData], names, _realFaceList, F)) {
+        // Latent variables saved next to the faces
+        struct stat buffer;
+        for(const string& name : names) {
+            _realFaceFiles.insert(name);
+            string features = name.substr(0, name.size() - 4) + "_features.txt";
+            if(stat((_dataExamples[_currentData] + features).c_str(), &buffer) == 0) {
+                _vaeFeatureFiles.insert(features);
             }
         }
-        closedir (directory);
+        cout << "Loaded " << _realFaceList.size() << " faces from corpus" << endl;
     }
     else {
-        cerr << "Failed to load faces: " << _dataExamples[_currentData] << endl;
-        return;
-    }
+        DIR *directory;
+        struct dirent *entry;
+        if ((directory = opendir(_dataExamples[_currentData])) != NULL) {
+            // Get all file paths and store in _faceFiles
+            while ((entry = readdir(directory)) != NULL) {
+                string current = entry->d_name;
+                if(endsWith(current, ".obj")) {
+                    _realFaceFiles.insert(current);
+                } else if(endsWith(current, "_features.txt")) {
+                    _vaeFeatureFiles.insert(current);
+                }
+            }
+            closedir (directory);
+        }
+        else {
+            cerr << "Failed to load faces: " << _dataExamples[_currentData] << endl;
+            return;
+        }
 
-    // Store faces in a list
-    MatrixXd vertices;
-    MatrixXi faces;
-    _realFaceList = vector<MatrixXd>(_realFaceFiles.size());
-    int i = 0;
-    for(auto it = _realFaceFiles.begin(); it != _realFaceFiles.end(); it++){
-        string file = _dataExamples[_currentData] + *it;
-        cout << "Read file: " << file << "\n";
-        igl::read_triangle_mesh(file,vertices,faces);
-        _realFaceList[i++] = vertices;
+        // Store faces in a list
+        MatrixXd vertices;
+        MatrixXi faces;
+        _realFaceList = vector<MatrixXd>(_realFaceFiles.size());
+        int i = 0;
+        for(auto it = _realFaceFiles.begin(); it != _realFaceFiles.end(); it++){
+            string file = _dataExamples[_currentData] + *it;
+            cout << "Read file: " << file << "\n";
+            igl::read_triangle_mesh(file,vertices,faces);
+            _realFaceList[i++] = vertices;
+            // Faces saved with vertices only share the connectivity of the others
+            if(faces.rows() > 0) {
+                F = faces;
+            }
+        }
     }
-    F = faces;
 
     //load the feature weights
     _weightFeaturesPerFace.resize((int) _nFeatures, (int) _realFaceList.size());
     _weightFeaturesMinMax.resize((int) _nFeatures, 2);
     _weightFeaturesMinMax.setZero();
 
-    int face_idx = 0;
-    for(string file : _vaeFeatureFiles){
-        cout << "Read file: " << file << "\n";
-        ifstream infile(_dataExamples[_currentData] + file);
-        double value;
-        int feature_idx = 0;
-        while (infile >> value){
-            _weightFeaturesPerFace(feature_idx, face_idx) = value;
-            feature_idx++;
+    if(_vaeFeatureFiles.size() != _realFaceList.size() && hasEncoder()) {
+        // Some faces have no precomputed latent variable: embed all of them natively.
+        // Faces with another template than the model's keep the prior mean.
+        vector<MatrixXd> encodable;
+        vector<int> columns;
+        for(int i = 0; i < (int) _realFaceList.size(); i++) {
+            if(_realFaceList[i].rows() * 3 != _modelWeights[0].cols()) {
+                cout << "Cannot encode face " << *next(_realFaceFiles.begin(), i) << " with " << _realFaceList[i].rows() << " vertices, model expects " << _modelWeights[0].cols() / 3 << endl;
+                continue;
+            }
+            encodable.push_back(_realFaceList[i]);
+            columns.push_back(i);
+        }
+        cout << "Encode " << encodable.size() << " faces with VAE encoder" << endl;
+        MatrixXd Z;
+        encodeFaces(encodable, Z);
+        _weightFeaturesPerFace.setZero();
+        for(int j = 0; j < (int) columns.size(); j++) {
+            _weightFeaturesPerFace.col(columns[j]) = Z.col(j);
+        }
+    }
+    else {
+        int face_idx = 0;
+        for(string file : _vaeFeatureFiles){
+            cout << "Read file: " << file << "\n";
+            ifstream infile(_dataExamples[_currentData] + file);
+            double value;
+            int feature_idx = 0;
+            while (infile >> value){
+                _weightFeaturesPerFace(feature_idx, face_idx) = value;
+                feature_idx++;
+            }
+            face_idx++;
         }
-        face_idx++;
     }
 
     _weightFeaturesMinMax.col(0) = _weightFeaturesPerFace.rowwise().minCoeff();
@@ -191,6 +240,89 @@ void VAE::showError(Viewer& viewer) {
     cout << "Mean error: " << error.mean() << endl;
 }
 
+// Check that all encoder weights and biases have been loaded
+bool VAE::hasEncoder() {
+    if(_modelWeights.size() < 4 || _modelBiases.size() < 4) {
+        return false;
+    }
+    for(int i = 0; i < 4; i++) {
+        if(_modelWeights[i].size() == 0 || _modelBiases[i].size() == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Flatten a set of vertex positions to the interleaved xyz layout used by the model
+void VAE::faceToInput(const MatrixXd& V, VectorXd& x) {
+    x.resize(V.rows() * 3);
+    for(int i=0; i<V.rows(); i++){
+        for(int j=0; j<3; j++){
+            x(3*i+j) = V(i,j);
+        }
+    }
+}
+
+// Pass a batch of flattened faces (one per column) through the encoder
+// and outputs the mean and log variance of their latent variables
+void VAE::forwardEncoder(const MatrixXd& X, MatrixXd& mu, MatrixXd& logVar) {
+    MatrixXd x1 = _modelWeights[0] * X;
+    x1.colwise() += _modelBiases[0];
+    x1 = x1.cwiseMax(0); // x1 = relu(enc1(x))
+    MatrixXd x2 = _modelWeights[1] * x1;
+    x2.colwise() += _modelBiases[1];
+    x2 = x2.cwiseMax(0); // x2 = relu(enc2(x1))
+    mu = _modelWeights[2] * x2; // mu = enc_mu(x2)
+    mu.colwise() += _modelBiases[2];
+    logVar = _modelWeights[3] * x2; // logVar = enc_var(x2)
+    logVar.colwise() += _modelBiases[3];
+}
+
+// Embed a list of faces in one batch, columns of Z hold the latent means #features x #faces
+void VAE::encodeFaces(const vector<MatrixXd>& faces, MatrixXd& Z) {
+    if(faces.empty()) {
+        Z.resize(_nFeatures, 0);
+        return;
+    }
+    MatrixXd X(faces[0].rows() * 3, faces.size());
+    VectorXd x;
+    for(size_t i = 0; i < faces.size(); i++) {
+        faceToInput(faces[i], x);
+        X.col(i) = x;
+    }
+    MatrixXd logVar;
+    forwardEncoder(X, Z, logVar);
+}
+
+// Embed a newly registered face, show its reconstruction colored by the error
+// and return the mean error
+double VAE::embedFace(Viewer& viewer, const MatrixXd& V, MatrixXi& F) {
+    if(!hasEncoder()) {
+        cout << "No VAE encoder loaded" << endl;
+        return -1;
+    }
+    if(V.rows() * 3 != _modelWeights[0].cols()) {
+        cout << "Cannot embed face with " << V.rows() << " vertices, model expects " << _modelWeights[0].cols() / 3 << endl;
+        return -1;
+    }
+    MatrixXd Z;
+    encodeFaces(vector<MatrixXd>(1, V), Z);
+    MatrixXd Vrec;
+    forwardDecoder(Z.col(0), Vrec);
+    if(_weightFeaturesMinMax.rows() == _nFeatures) {
+        _weightFeatures = normalizeWeight(Z.col(0)).cast<float>();
+    }
+
+    VectorXd error = (Vrec - V).rowwise().norm();
+    MatrixXd C;
+    igl::colormap(igl::COLOR_MAP_TYPE_JET, error, 0.0, 4.0, C); //empirical range
+    viewer.data().clear();
+    viewer.data().set_mesh(Vrec, F);
+    viewer.data().set_colors(C);
+    cout << "Mean error: " << error.mean() << endl;
+    return error.mean();
+}
+
 // Pass a latent variable through the decoder and outputs a set of vertex positions
 void VAE::forwardDecoder(VectorXd z, MatrixXd& out) {
     VectorXd x1 = (_modelWeights[4] * z + _modelBiases[4]).cwiseMax(0); // x1 = relu(dec1(z))
@@ -204,8 +336,43 @@ void VAE::forwardDecoder(VectorXd z, MatrixXd& out) {
     }
 }
 
+// Pass a batch of latent variables (one per column) through the decoder,
+// columns of X hold the flattened vertex positions
+void VAE::forwardDecoderBatch(const MatrixXd& Z, MatrixXd& X) {
+    MatrixXd x1 = _modelWeights[4] * Z;
+    x1.colwise() += _modelBiases[4];
+    x1 = x1.cwiseMax(0); // x1 = relu(dec1(z))
+    MatrixXd x2 = _modelWeights[5] * x1;
+    x2.colwise() += _modelBiases[5];
+    x2 = x2.cwiseMax(0); // x2 = relu(dec2(x1))
+    X = _modelWeights[6] * x2; // x = dec3(x2)
+    X.colwise() += _modelBiases[6];
+}
+
+// Decode a batch of latent variables, columns of X hold the vertex positions
+// stacked as [x; y; z] like the PCA faces in 1D
+void VAE::reconstructFaces(const MatrixXd& Z, MatrixXd& X) {
+    MatrixXd interleaved;
+    forwardDecoderBatch(Z, interleaved);
+    int n = interleaved.rows() / 3;
+    X.resize(interleaved.rows(), interleaved.cols());
+    for(int k=0; k<X.cols(); k++){
+        for(int i=0; i<n; i++){
+            for(int j=0; j<3; j++){
+                X(j*n+i, k) = interleaved(3*i+j, k);
+            }
+        }
+    }
+}
+
 // Convert weights in range (-1, 1) to real weight values
 VectorXd VAE::denormalizeWeight(VectorXd w) {
     VectorXd r = (0.5 * (w.array() + 1.0) * (_weightFeaturesMinMax.col(1) - _weightFeaturesMinMax.col(0)).array() +  _weightFeaturesMinMax.col(0).array()).matrix();
     return r;
+}
+
+// Convert real weight values to range (-1, 1)
+VectorXd VAE::normalizeWeight(VectorXd z) {
+    VectorXd r = (2 * (z - _weightFeaturesMinMax.col(0)).array() / (_weightFeaturesMinMax.col(1) - _weightFeaturesMinMax.col(0)).array() - 1.0).matrix();
+    return r;
 }
\ No newline at end of file
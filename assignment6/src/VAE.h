@@ -7,6 +7,7 @@
 #include <sys/stat.h>
 #include <igl/opengl/glfw/Viewer.h>
 #include <igl/read_triangle_mesh.h>
+#include "FaceCorpus.h"
 
 using namespace std;
 using namespace Eigen;
@@ -23,6 +24,8 @@ public:
     const int _nFeatures = 16;
     // Data folder
     int _currentData = 0;
+    // Encoding of the face corpus built for the data folder
+    int _corpusEncoding = FaceCorpus::ENCODING_DOUBLE;
     // Face index chosen by user
     int _faceIndex = 0;
     // Weights of the face displayed in [-1,1]
@@ -71,8 +74,16 @@ public:
     void showReconstructedFace(Viewer& viewer, MatrixXi& F);
     void setWeightsReconstructedFace();
     void showError(Viewer& viewer);
+    bool hasEncoder();
+    void faceToInput(const MatrixXd& V, VectorXd& x);
+    void forwardEncoder(const MatrixXd& X, MatrixXd& mu, MatrixXd& logVar);
     void forwardDecoder(VectorXd z, MatrixXd& out);
+    void forwardDecoderBatch(const MatrixXd& Z, MatrixXd& X);
+    void reconstructFaces(const MatrixXd& Z, MatrixXd& X);
+    void encodeFaces(const vector<MatrixXd>& faces, MatrixXd& Z);
+    double embedFace(Viewer& viewer, const MatrixXd& V, MatrixXi& F);
     VectorXd denormalizeWeight(VectorXd w);
+    VectorXd normalizeWeight(VectorXd z);
 };
 
 
@@ -2,16 +2,21 @@
 #include <igl/read_triangle_mesh.h>
 #include <igl/opengl/glfw/Viewer.h>
 #include <igl/opengl/glfw/imgui/ImGuiMenu.h>
+#include <igl/colormap.h>
+#include <igl/get_seconds.h>
 #include <imgui/imgui.h>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <fstream>
 
 #include "Preprocessor.h"
 #include "LandmarkSelector.h"
 #include "FaceRegistor.h"
 #include "PCA.h"
 #include "VAE.h"
+#include "MorphAnimator.h"
+#include "FaceCorpusMenu.h"
 
 using namespace std;
 using namespace Eigen;
@@ -49,6 +54,7 @@ static int selected_landmark_file_id = 0;
 Eigen::MatrixXd V_tmpl(0, 3);
 Eigen::MatrixXi F_tmpl(0, 3);
 FaceRegistor faceRegistor = FaceRegistor(&landmarkSelector);
+TemplateModel templateModel;
 
 // PCA computation
 PCA *pca = new PCA();
@@ -56,6 +62,10 @@ PCA *pca = new PCA();
 // VAE computation
 VAE *vae = new VAE();
 
+// Morph animations in PCA weight and VAE latent space
+MorphAnimator pcaAnimator = MorphAnimator();
+MorphAnimator vaeAnimator = MorphAnimator();
+
 bool callback_mouse_down(Viewer &viewer, int button, int modifier) {
 
     if (button == (int) Viewer::MouseButton::Right)
@@ -105,6 +115,15 @@ bool load_mesh(string filename, Eigen::MatrixXd& _V = V, Eigen::MatrixXi& _F = F
     return true;
 }
 
+// Load the selected template and build its operators, once per selection
+bool load_template() {
+    string tmpl_file_path = faceRegistor.tmpl_folder_path + faceRegistor.tmpl_names[faceRegistor.tmpl_id]+".obj";
+    load_mesh(tmpl_file_path, V_tmpl, F_tmpl, 0);
+    faceRegistor.build_template_model(templateModel, V_tmpl, F_tmpl);
+    faceRegistor.tmpl_model = &templateModel;
+    return true;
+}
+
 void draw_full_viewer_window(ImGuiMenu &menu) {
     float menu_width = 200.f * menu.menu_scaling();
     ImGui::SetNextWindowPos(ImVec2(0.0f, 20.0f), ImGuiCond_FirstUseEver);
@@ -285,11 +304,10 @@ void draw_preprocessing_window(ImGuiMenu &menu) {
         int prev_id = preprocessor.mesh_id;
         for (int i = 0; i < preprocessor.mesh_names.size(); i++) {
             preprocessor.mesh_id = i;
-            // load a scanned face
+            // stream the scanned face from disk and preprocess it
             string mesh_file_path = preprocessor.mesh_folder_path + preprocessor.mesh_names[i]+".obj";
-            load_mesh(mesh_file_path, V, F, 0);
-            // preprocess it
-            preprocessor.preprocess(viewer, V, F, 3);
+            if (!preprocessor.preprocess_file(viewer, mesh_file_path, V, F, 3))
+                continue;
             // save mesh
             string save_path = preprocessor.save_mesh(V, F);
             cout << "Saved preprocessed face to " << save_path << endl << endl;
@@ -411,6 +429,12 @@ void draw_face_registration_window(ImGuiMenu &menu) {
         set_mesh(V, F, 1);
         cout << "Align Rigid" << endl;
     }
+    if (ImGui::Button("Align ICP", ImVec2(-1, 0))) {
+        faceRegistor.align_icp(V_tmpl, F_tmpl, V);
+        set_mesh(V_tmpl, F_tmpl, 0);
+        set_mesh(V, F, 1);
+        cout << "Align ICP" << endl;
+    }
     if (ImGui::Button("Align Non-Rigid", ImVec2(-1, 0))) {
         faceRegistor.build_octree(V);
         faceRegistor.align_non_rigid_step(V_tmpl, F_tmpl, V, F);
@@ -433,6 +457,22 @@ void draw_face_registration_window(ImGuiMenu &menu) {
         string save_path = faceRegistor.save_registered_scan(V_tmpl, F_tmpl);
         cout << "Saved registered face to " << save_path << endl;
     }
+
+    if (ImGui::Button("Show registration error", ImVec2(-1, 0)) && viewer.data_list.size() > 1) {
+        RegistrationMetrics &metrics = faceRegistor.metrics;
+        faceRegistor.evaluate_registration(V_tmpl, F_tmpl, V, F);
+        metrics.print_summary(cout);
+        MatrixXd C;
+        igl::colormap(igl::COLOR_MAP_TYPE_JET, metrics.tmpl_to_scan, 0.0, metrics.histogram_range, C);
+        viewer.data_list[0].set_colors(C);
+        igl::colormap(igl::COLOR_MAP_TYPE_JET, metrics.scan_to_tmpl, 0.0, metrics.histogram_range, C);
+        viewer.data_list[1].set_colors(C);
+    }
+    if (faceRegistor.metrics.tmpl_histogram.size() > 0) {
+        const VectorXf H = faceRegistor.metrics.tmpl_histogram.cast<float>();
+        ImGui::Text("Template to scan, Hausdorff %.3f", faceRegistor.metrics.hausdorff);
+        ImGui::PlotHistogram("##error", H.data(), H.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1, 60));
+    }
     ImGui::PushItemWidth(0.4*menu_width);
     if (ImGui::InputFloat("lambda", &faceRegistor.m_lambda))
     {
@@ -444,6 +484,7 @@ void draw_face_registration_window(ImGuiMenu &menu) {
         faceRegistor.m_epsilon = std::max(0.0f, std::min(1000.0f, faceRegistor.m_epsilon));
     }
     ImGui::PopItemWidth();
+    ImGui::Checkbox("ICP before non-rigid", &faceRegistor.useICP);
 
     ImGui::PushItemWidth(0.9*menu_width);
     ImGui::Text("Template Face");
@@ -454,8 +495,7 @@ void draw_face_registration_window(ImGuiMenu &menu) {
             bool is_selected = (faceRegistor.tmpl_id == n); // You can store your selection however you want, outside or inside your objects
             if (ImGui::Selectable(&faceRegistor.tmpl_names[n][0], is_selected)) {
                 faceRegistor.tmpl_id = n;
-                string tmpl_file_path = faceRegistor.tmpl_folder_path + faceRegistor.tmpl_names[faceRegistor.tmpl_id]+".obj";
-                load_mesh(tmpl_file_path, V_tmpl, F_tmpl, 0);
+                load_template();
             }
 
             if (is_selected)
@@ -476,24 +516,61 @@ void draw_face_registration_window(ImGuiMenu &menu) {
     }
     ImGui::EndChild();
 
+    ImGui::Checkbox("Save vertices only", &faceRegistor.save_vertices_only);
+
     if (ImGui::Button("Register all", ImVec2(-1, 0))) {
         int prev_id = faceRegistor.scan_id;
+        // Registered faces are written in small batches (concurrently) so only
+        // a few copies of the template are kept in memory
+        const int save_batch_size = 8;
+        vector<int> registered_ids;
+        vector<MatrixXd> registered_faces;
+        int num_saved = 0;
+        const auto save_batch = [&]() {
+            if (!registered_ids.empty() && faceRegistor.save_registered_scans(registered_ids, registered_faces, F_tmpl)) {
+                num_saved += registered_ids.size();
+            }
+            registered_ids.clear();
+            registered_faces.clear();
+        };
+        // Batch QA: distances of every registered face to its scan, one line per face
+        string metrics_path = faceRegistor.save_folder_path + "registration_metrics.csv";
+        ofstream metrics_file(metrics_path);
+        if (metrics_file.is_open()) {
+            RegistrationMetrics::write_csv_header(metrics_file);
+        } else {
+            cout << "Failed to open " << metrics_path << ", registration metrics are not written" << endl;
+        }
+        double metrics_time = 0.0;
         for (int i = 0; i < faceRegistor.scan_names.size(); i++) {
             faceRegistor.scan_id = i;
             // load a scanned face
             string scan_file_path = faceRegistor.scan_folder_path + faceRegistor.scan_names[i]+".obj";
             load_mesh(scan_file_path, V, F, 1);
-            // reload template face
-            string tmpl_file_path = faceRegistor.tmpl_folder_path + faceRegistor.tmpl_names[faceRegistor.tmpl_id]+".obj";
-            load_mesh(tmpl_file_path, V_tmpl, F_tmpl, 0);
+            // restart from the template face, its operators are reused
+            V_tmpl = templateModel.V;
+            F_tmpl = templateModel.F;
             // register it (same code as register)
             faceRegistor.register_face(V_tmpl, F_tmpl, V, F, 4);
             set_mesh(V_tmpl, F_tmpl, 0);
             set_mesh(V, F, 1);
-            // save mesh
-            string save_path = faceRegistor.save_registered_scan(V_tmpl, F_tmpl);
-            cout << "Saved registered face to " << save_path << endl;
+            registered_ids.push_back(i);
+            registered_faces.push_back(V_tmpl);
+            if (registered_ids.size() >= save_batch_size) {
+                save_batch();
+            }
+            if (metrics_file.is_open()) {
+                double t = igl::get_seconds();
+                faceRegistor.evaluate_registration(V_tmpl, F_tmpl, V, F);
+                metrics_time += igl::get_seconds() - t;
+                faceRegistor.metrics.write_csv_row(metrics_file, faceRegistor.scan_names[i]);
+            }
+        }
+        save_batch();
+        if (metrics_file.is_open()) {
+            cout << "Registration metrics written to " << metrics_path << " (" << metrics_time << "s)" << endl;
         }
+        cout << "Saved " << num_saved << " registered faces to " << faceRegistor.save_folder_path << endl;
         faceRegistor.scan_id = prev_id;
         cout << "Registered all faces using selected template" << endl;
     }
@@ -501,6 +578,40 @@ void draw_face_registration_window(ImGuiMenu &menu) {
     ImGui::End();
 }
 
+void draw_morph_animation_menu(MorphAnimator &animator, const VectorXd &keyframe, const MorphAnimator::Reconstruction &reconstruct) {
+    if (ImGui::CollapsingHeader("Morph animation"))
+    {
+        if (ImGui::Button("Add keyframe with current weights", ImVec2(-1,0))) {
+            animator.addKeyframe(keyframe);
+        }
+        if (ImGui::Button("Clear keyframes", ImVec2(-1,0))) {
+            animator.clearKeyframes();
+        }
+        ImGui::Text("Keyframes: %d", (int) animator._keyframes.size());
+        ImGui::Combo("Path", &animator._pathType, animator._pathTypes.data(), animator._pathTypes.size());
+        if (ImGui::InputInt("#Frames", &animator._nFrames)) {
+            animator._nFrames = min(max(2, animator._nFrames), 1000);
+        }
+        ImGui::InputFloat("FPS", &animator._fps);
+        animator._fps = max(1.0f, animator._fps);
+        ImGui::Checkbox("Ping-pong", &animator._pingPong);
+        if (ImGui::Button("Compute animation", ImVec2(-1,0))) {
+            animator.evaluate(reconstruct);
+        }
+        if (ImGui::Button(animator._playing ? "Stop animation" : "Play animation", ImVec2(-1,0))) {
+            if (animator._playing) {
+                animator.stopPlayback();
+            } else {
+                animator.startPlayback();
+            }
+        }
+        if (ImGui::Button("Export animation", ImVec2(-1,0))) {
+            animator.exportAnimation(F);
+        }
+    }
+    animator.play(viewer, F);
+}
+
 void draw_pca_computation_window(ImGuiMenu &menu) {
     float menu_width = 200.f * menu.menu_scaling();
     ImGui::SetNextWindowPos(ImVec2(0.0f, 20.0f), ImGuiCond_FirstUseEver);
@@ -519,6 +630,8 @@ void draw_pca_computation_window(ImGuiMenu &menu) {
         pca->loadFaces(viewer, F, false);
     }
 
+    drawFaceCorpusMenu(pca->_dataExamples[pca->_currentData], pca->_corpusEncoding);
+
     if (ImGui::Button("Show average face", ImVec2(-1,0))) {
         pca->showAverageFace(viewer, F);
     }
@@ -583,6 +696,14 @@ void draw_pca_computation_window(ImGuiMenu &menu) {
         pca->saveMesh(viewer);
     }
 
+    ImGui::Separator();
+
+    if (pca->_eigenFaces.cols() > 0 && pca->_weightEigenFacesMinMax.rows() == pca->_eigenFaces.cols()) {
+        draw_morph_animation_menu(pcaAnimator, pca->getEigenFaceCoefficients(-1), [](const MatrixXd &W, MatrixXd &X) {
+            pca->reconstructFaces(W, X);
+        });
+    }
+
     pca->showError(viewer);
 
     ImGui::End();
@@ -608,6 +729,8 @@ void draw_bonus_task_window(ImGuiMenu &menu) {
         vae->loadFaces(viewer, F);
     }
 
+    drawFaceCorpusMenu(vae->_dataExamples[vae->_currentData], vae->_corpusEncoding);
+
     if(ImGui::InputInt("Face index", &vae->_faceIndex)) {
         vae->updateFaceIndex(viewer, F);
     }
@@ -637,6 +760,21 @@ void draw_bonus_task_window(ImGuiMenu &menu) {
         vae->showError(viewer);
     }
 
+    if (ImGui::Button("Embed registered face", ImVec2(-1,0))) {
+        if(vae->_modelWeights.empty()) {
+            vae->initializeParameters();
+        }
+        vae->embedFace(viewer, V_tmpl, F_tmpl);
+    }
+
+    ImGui::Separator();
+
+    if (vae->_weightFeaturesMinMax.rows() == vae->_nFeatures) {
+        draw_morph_animation_menu(vaeAnimator, vae->denormalizeWeight((vae->_weightFeatures).cast<double>()), [](const MatrixXd &W, MatrixXd &X) {
+            vae->reconstructFaces(W, X);
+        });
+    }
+
     ImGui::End();
 }
 
@@ -688,8 +826,7 @@ void setup_gui(ImGuiMenu &menu) {
                 if (ImGui::MenuItem("Face Registration")) {
                     if(current_mode != 0 || prev_mode != 3){
                         reset_visibility_and_clear_all_data();
-                        string tmpl_file_path = faceRegistor.tmpl_folder_path + faceRegistor.tmpl_names[faceRegistor.tmpl_id]+".obj";
-                        load_mesh(tmpl_file_path, V_tmpl, F_tmpl, 0);
+                        load_template();
                     }
                     prev_mode = current_mode;
                     current_mode = 3;
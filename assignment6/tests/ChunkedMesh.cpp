@@ -0,0 +1,154 @@
+#include "ChunkedMesh.h"
+#include <igl/boundary_loop.h>
+#include <igl/facet_components.h>
+#include <igl/read_triangle_mesh.h>
+#include <igl/remove_unreferenced.h>
+#include <igl/slice_mask.h>
+#include <igl/triangle_triangle_adjacency.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <random>
+
+namespace {
+    // n by n grid of vertices in the plane z = 0 with lower left corner at
+    // (x, y), appended to V and F
+    void add_grid(int n, double x, double y, vector<RowVector3d>& V, vector<RowVector3i>& F) {
+        const int offset = V.size();
+        for(int j = 0; j < n; j++) {
+            for(int i = 0; i < n; i++) {
+                V.emplace_back(x + i, y + j, 0.01 * ((i * 7 + j * 3) % 5));
+            }
+        }
+        for(int j = 0; j + 1 < n; j++) {
+            for(int i = 0; i + 1 < n; i++) {
+                const int a = offset + i + n * j;
+                F.emplace_back(a, a + 1, a + 1 + n);
+                F.emplace_back(a, a + 1 + n, a + n);
+            }
+        }
+    }
+
+    // Write the mesh with the vertices shuffled, so that the order of the
+    // file is not that of the chunks. The vertex in the middle of the first
+    // grid is left unreferenced.
+    string write_shuffled(const string& name, const vector<RowVector3d>& V, const vector<RowVector3i>& F) {
+        vector<int> order(V.size());
+        for(int i = 0; i < (int)order.size(); i++) {
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), mt19937(5));
+        vector<int> position(V.size());
+        for(int i = 0; i < (int)order.size(); i++) {
+            position[order[i]] = i;
+        }
+        const string path = ::testing::TempDir() + name;
+        ofstream out(path);
+        for(const int i : order) {
+            out << "v " << V[i](0) << " " << V[i](1) << " " << V[i](2) << "\n";
+        }
+        for(const RowVector3i& f : F) {
+            out << "f " << position[f(0)] + 1 << " " << position[f(1)] + 1 << " " << position[f(2)] + 1 << "\n";
+        }
+        return path;
+    }
+
+    // In memory cleaning of Preprocessor::clean_connected_components
+    int keep_largest_component(MatrixXd& V, MatrixXi& F) {
+        vector<vector<vector<int>>> TT;
+        igl::triangle_triangle_adjacency(F, TT);
+        VectorXi C, counts;
+        igl::facet_components(TT, C, counts);
+        int max_id;
+        counts.maxCoeff(&max_id);
+        MatrixXi NF;
+        igl::slice_mask(F, (C.array() == max_id).eval(), 1, NF);
+        VectorXi I;
+        MatrixXd oldV = V;
+        igl::remove_unreferenced(oldV, NF, V, F, I);
+        return counts.rows();
+    }
+
+    // Check the chunked mesh in path against the in memory cleaning
+    void check_against_igl(const string& path) {
+        MatrixXd gt_V;
+        MatrixXi gt_F;
+        ASSERT_TRUE(igl::read_triangle_mesh(path, gt_V, gt_F));
+        const int gt_num_components = keep_largest_component(gt_V, gt_F);
+        VectorXi gt_L;
+        igl::boundary_loop(gt_F, gt_L);
+
+        ChunkedMesh mesh;
+        mesh.chunk_size = 16;
+        mesh.work_dir = ::testing::TempDir();
+        ASSERT_TRUE(mesh.read_obj(path));
+        ASSERT_GT(mesh.num_chunks(), 4);
+        ASSERT_EQ(mesh.keep_largest_component(), gt_num_components);
+
+        // Same vertices and faces in the same order
+        MatrixXd V;
+        MatrixXi F;
+        mesh.to_matrices(V, F);
+        ASSERT_EQ(V.rows(), gt_V.rows());
+        ASSERT_EQ(F.rows(), gt_F.rows());
+        ASSERT_TRUE(V == gt_V);
+        ASSERT_TRUE(F == gt_F);
+
+        // Boundary loop in sorted indices, same cycle of positions
+        VectorXi L;
+        ASSERT_TRUE(mesh.boundary_loop(L));
+        ASSERT_EQ(L.rows(), gt_L.rows());
+        int start = 0;
+        while(start < L.rows() && mesh.vertex(L(start)) != gt_V.row(gt_L(0)))
+            start++;
+        ASSERT_LT(start, L.rows());
+        for(int i = 0; i < L.rows(); i++) {
+            ASSERT_EQ(mesh.vertex(L((start + i) % L.rows())), gt_V.row(gt_L(i)));
+        }
+
+        // Per vertex values follow the vertices
+        MappedArray<double> D;
+        ASSERT_TRUE(D.create(mesh.num_vertices(), mesh.work_dir));
+        for(size_t i = 0; i < mesh.num_vertices(); i++) {
+            D[i] = mesh.vertex(i)(1);
+        }
+        VectorXd D_out;
+        mesh.to_vector(D, D_out);
+        ASSERT_TRUE(D_out == gt_V.col(1));
+    }
+}
+
+TEST(ChunkedMesh, largest_component) {
+    // A large grid with a hole, a smaller grid and a single triangle
+    vector<RowVector3d> V;
+    vector<RowVector3i> F;
+    add_grid(12, 0, 0, V, F);
+    F.erase(remove_if(F.begin(), F.end(), [](const RowVector3i& f) {
+        return (f.array() == 5 + 12 * 5).any();
+    }), F.end());
+    add_grid(6, 20, 0, V, F);
+    V.emplace_back(0, 20, 0);
+    V.emplace_back(1, 20, 0);
+    V.emplace_back(0, 21, 0);
+    F.emplace_back(V.size() - 3, V.size() - 2, V.size() - 1);
+    check_against_igl(write_shuffled("chunked_largest_component.obj", V, F));
+}
+
+TEST(ChunkedMesh, ties_keep_first_component) {
+    // Two grids of the same size, the second one nearer the origin
+    vector<RowVector3d> V;
+    vector<RowVector3i> F;
+    add_grid(8, 20, 20, V, F);
+    add_grid(8, 0, 0, V, F);
+    check_against_igl(write_shuffled("chunked_ties.obj", V, F));
+}
+
+TEST(ChunkedMesh, unmappable_work_dir) {
+    vector<RowVector3d> V;
+    vector<RowVector3i> F;
+    add_grid(4, 0, 0, V, F);
+    const string path = write_shuffled("chunked_unmappable.obj", V, F);
+    ChunkedMesh mesh;
+    mesh.work_dir = ::testing::TempDir() + "does_not_exist";
+    ASSERT_FALSE(mesh.read_obj(path));
+}
@@ -0,0 +1,209 @@
+#include "FaceCorpus.h"
+#include <igl/writeOBJ.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+namespace {
+    // Fresh folder in the test temp directory
+    string make_folder(const string& name) {
+        string folder = ::testing::TempDir() + name + "/";
+        mkdir(folder.c_str(), 0755);
+        vector<string> files;
+        FaceCorpus::listFolder(folder, files);
+        for(const string& file : files) {
+            remove((folder + file).c_str());
+        }
+        remove((folder + FaceCorpus::_defaultFileName).c_str());
+        return folder;
+    }
+
+    void faces(vector<string>& names, vector<MatrixXd>& V, MatrixXi& F) {
+        F.resize(2, 3);
+        F << 0, 1, 2, 0, 2, 3;
+        names = {"a.obj", "b.obj", "c.obj"};
+        V.clear();
+        for(int i = 0; i < 3; i++) {
+            V.push_back(MatrixXd::Random(4, 3));
+        }
+    }
+
+    // Set the modification time of a file, seconds since the epoch
+    void touch(const string& path, time_t time) {
+        struct timeval times[2] = {{time, 0}, {time, 0}};
+        utimes(path.c_str(), times);
+    }
+
+    vector<char> read_bytes(const string& path) {
+        ifstream in(path, ios::binary);
+        return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    void write_bytes(const string& path, const vector<char>& bytes) {
+        ofstream(path, ios::binary).write(bytes.data(), bytes.size());
+    }
+}
+
+TEST(FaceCorpus, round_trip) {
+    vector<string> names;
+    vector<MatrixXd> V;
+    MatrixXi F;
+    faces(names, V, F);
+    const double tolerance[] = {0.0, 1e-6, 1e-4};
+    for(int encoding = 0; encoding <= FaceCorpus::ENCODING_DELTA_INT16; encoding++) {
+        string path = ::testing::TempDir() + "round_trip_" + to_string(encoding) + ".corpus";
+        ASSERT_TRUE(FaceCorpus::write(path, names, V, F, (FaceCorpus::Encoding) encoding));
+        FaceCorpus corpus;
+        ASSERT_TRUE(corpus.open(path));
+        ASSERT_EQ(corpus.size(), 3);
+        ASSERT_EQ(corpus.nVertices(), 4);
+        ASSERT_EQ(corpus.encoding(), encoding);
+        ASSERT_EQ(corpus.names(), names);
+        MatrixXi G;
+        corpus.getF(G);
+        ASSERT_EQ(G, F);
+        for(int i = 0; i < 3; i++) {
+            MatrixXd U;
+            corpus.getFace(i, U);
+            ASSERT_LE((U - V[i]).cwiseAbs().maxCoeff(), tolerance[encoding]);
+        }
+    }
+}
+
+TEST(FaceCorpus, rejects_invalid_files) {
+    vector<string> names;
+    vector<MatrixXd> V;
+    MatrixXi F;
+    faces(names, V, F);
+    string path = ::testing::TempDir() + "valid.corpus";
+    ASSERT_TRUE(FaceCorpus::write(path, names, V, F));
+    const vector<char> valid = read_bytes(path);
+    FaceCorpus::Header header;
+    memcpy(&header, valid.data(), sizeof(header));
+
+    vector<vector<char>> invalid;
+    // Truncated data
+    invalid.push_back(vector<char>(valid.begin(), valid.end() - 8));
+    // Truncated header
+    invalid.push_back(vector<char>(valid.begin(), valid.begin() + sizeof(header) / 2));
+    // Sections outside of the file
+    for(uint64_t FaceCorpus::Header::*offset : {&FaceCorpus::Header::facesOffset, &FaceCorpus::Header::namesOffset, &FaceCorpus::Header::meanOffset, &FaceCorpus::Header::dataOffset}) {
+        FaceCorpus::Header h = header;
+        h.*offset = valid.size() + 8;
+        invalid.push_back(valid);
+        memcpy(invalid.back().data(), &h, sizeof(h));
+        // Also wrapping around
+        h.*offset = ~uint64_t(0) - 7;
+        invalid.push_back(valid);
+        memcpy(invalid.back().data(), &h, sizeof(h));
+    }
+    // Names not terminated before the end of the file
+    {
+        FaceCorpus::Header h = header;
+        h.namesOffset = valid.size() - 8;
+        invalid.push_back(valid);
+        memcpy(invalid.back().data(), &h, sizeof(h));
+        for(size_t i = valid.size() - 8; i < valid.size(); i++) {
+            invalid.back()[i] = 'x';
+        }
+    }
+    // More meshes than stored
+    {
+        FaceCorpus::Header h = header;
+        h.nMeshes = 4;
+        invalid.push_back(valid);
+        memcpy(invalid.back().data(), &h, sizeof(h));
+    }
+    // Face index out of range
+    {
+        invalid.push_back(valid);
+        int32_t index = 4;
+        memcpy(invalid.back().data() + header.facesOffset, &index, sizeof(index));
+    }
+
+    for(int i = 0; i < (int) invalid.size(); i++) {
+        write_bytes(path, invalid[i]);
+        FaceCorpus corpus;
+        EXPECT_FALSE(corpus.open(path)) << "case " << i;
+        EXPECT_FALSE(corpus.isOpen());
+    }
+    write_bytes(path, valid);
+    FaceCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+}
+
+TEST(FaceCorpus, rebuilds_out_of_date_corpus) {
+    vector<string> names;
+    vector<MatrixXd> V;
+    MatrixXi F;
+    faces(names, V, F);
+    string folder = make_folder("face_corpus_folder");
+    const time_t now = time(nullptr);
+    for(int i = 0; i < 2; i++) {
+        igl::writeOBJ(folder + names[i], V[i], F);
+        touch(folder + names[i], now - 100);
+    }
+    ASSERT_TRUE(FaceCorpus::importFolder(folder, folder + FaceCorpus::_defaultFileName, FaceCorpus::ENCODING_FLOAT));
+    touch(folder + FaceCorpus::_defaultFileName, now - 50);
+
+    FaceCorpus corpus;
+    ASSERT_TRUE(corpus.openFolder(folder));
+    ASSERT_TRUE(corpus.isUpToDate(folder));
+    ASSERT_EQ(corpus.size(), 2);
+
+    // Additional face
+    igl::writeOBJ(folder + names[2], V[2], F);
+    touch(folder + names[2], now - 100);
+    ASSERT_TRUE(corpus.open(folder + FaceCorpus::_defaultFileName));
+    ASSERT_FALSE(corpus.isUpToDate(folder));
+    ASSERT_TRUE(corpus.openFolder(folder));
+    ASSERT_EQ(corpus.size(), 3);
+    // Encoding is kept when rebuilding
+    ASSERT_EQ(corpus.encoding(), FaceCorpus::ENCODING_FLOAT);
+    touch(folder + FaceCorpus::_defaultFileName, now - 50);
+    ASSERT_TRUE(corpus.openFolder(folder));
+    ASSERT_TRUE(corpus.isUpToDate(folder));
+
+    // Face modified after the corpus was built
+    MatrixXd moved = V[1] * 2.0;
+    igl::writeOBJ(folder + names[1], moved, F);
+    touch(folder + names[1], now);
+    ASSERT_FALSE(corpus.isUpToDate(folder));
+    ASSERT_TRUE(corpus.openFolder(folder));
+    MatrixXd U;
+    corpus.getFace(1, U);
+    ASSERT_LE((U - moved).cwiseAbs().maxCoeff(), 1e-5);
+
+    // Removed face
+    remove((folder + names[0]).c_str());
+    ASSERT_FALSE(corpus.isUpToDate(folder));
+    ASSERT_TRUE(corpus.openFolder(folder));
+    ASSERT_EQ(corpus.size(), 2);
+}
+
+TEST(FaceCorpus, rejects_different_connectivity) {
+    vector<string> names;
+    vector<MatrixXd> V;
+    MatrixXi F;
+    faces(names, V, F);
+    string folder = make_folder("face_corpus_connectivity");
+    igl::writeOBJ(folder + names[0], V[0], F);
+    // Same vertices, other diagonal of the quad
+    MatrixXi G(2, 3);
+    G << 0, 1, 3, 1, 2, 3;
+    igl::writeOBJ(folder + names[1], V[1], G);
+    ASSERT_FALSE(FaceCorpus::importFolder(folder, folder + FaceCorpus::_defaultFileName));
+
+    // Faces saved with vertices only are accepted, the corpus holds F
+    igl::writeOBJ(folder + names[1], V[1], MatrixXi());
+    ASSERT_TRUE(FaceCorpus::importFolder(folder, folder + FaceCorpus::_defaultFileName));
+    vector<string> loaded;
+    vector<MatrixXd> U;
+    MatrixXi H;
+    ASSERT_TRUE(FaceCorpus::loadFolder(folder, loaded, U, H));
+    ASSERT_EQ(loaded, vector<string>({names[0], names[1]}));
+    ASSERT_EQ(U.size(), 2u);
+    ASSERT_TRUE(H == F);
+}
@@ -0,0 +1,53 @@
+#include "RemeshWeld.h"
+#include <igl/is_edge_manifold.h>
+#include <igl/read_triangle_mesh.h>
+#include <igl/remesh_along_isoline.h>
+#include <igl/remove_duplicate_vertices.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+TEST(RemeshWeld, same_as_rounding_on_templates) {
+    // Cut every face template across the middle along each axis and weld
+    // the result as remesh did before, by rounding, and by distance: the same
+    // vertices must be merged
+    const std::vector<std::string> templates = {
+        "headtemplate.obj",
+        "headtemplate_large.obj",
+        "headtemplate_noneck.obj",
+        "headtemplate_noneck_lesshead_4k.obj",
+        "template_rigid_aligned_scaled.obj"};
+    for(const std::string& name : templates) {
+        MatrixXd V;
+        MatrixXi F;
+        ASSERT_TRUE(igl::read_triangle_mesh(std::string(ASSIGNMENT6_DATA_DIR) + "face_template/" + name, V, F));
+        for(int axis = 0; axis < 3; axis++) {
+            const VectorXd S = V.col(axis);
+            const double iso = 0.5 * (S.minCoeff() + S.maxCoeff()) + 1e-3;
+            MatrixXd U;
+            MatrixXi G;
+            VectorXd SU;
+            VectorXi J;
+            SparseMatrix<double> BC;
+            VectorXd L;
+            igl::remesh_along_isoline(V, F, S, iso, U, G, SU, J, BC, L);
+            ASSERT_GT(U.rows(), V.rows()) << name;
+
+            MatrixXd gt_SV, SV;
+            VectorXi gt_SVI, gt_SVJ, SVI, SVJ;
+            MatrixXi gt_SF, SF;
+            igl::remove_duplicate_vertices(U, G, 1e-10, gt_SV, gt_SVI, gt_SVJ, gt_SF);
+            weld_remeshed_vertices(U, G, SV, SVI, SVJ, SF);
+            ASSERT_EQ(SV.rows(), gt_SV.rows()) << name << " axis " << axis;
+            // Same groups of vertices, only numbered differently
+            std::map<int, int> welded;
+            for(int i = 0; i < U.rows(); i++) {
+                const auto it = welded.emplace(gt_SVJ(i), SVJ(i)).first;
+                ASSERT_EQ(it->second, SVJ(i)) << name << " axis " << axis << " vertex " << i;
+            }
+            ASSERT_EQ((int) welded.size(), SV.rows());
+            ASSERT_EQ(igl::is_edge_manifold(SF), igl::is_edge_manifold(gt_SF));
+        }
+    }
+}
@@ -8,11 +8,9 @@
 #include "AABB.h"
 #include "EPS.h"
 #include "barycenter.h"
-#include "colon.h"
 #include "doublearea.h"
 #include "point_simplex_squared_distance.h"
 #include "project_to_line_segment.h"
-#include "sort.h"
 #include "volume.h"
 #include "ray_box_intersect.h"
 #include "parallel_for.h"
@@ -59,45 +57,165 @@ IGL_INLINE void igl::AABB<DerivedV,DIM>::init(
     }
   }else
   {
-    VectorXi allI = colon<int>(0,Ele.rows()-1);
-    MatrixXDIMS BC;
-    if(Ele.cols() == 1)
-    {
-      // points
-      BC = V;
-    }else
+    init(V,Ele);
+  }
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+void igl::AABB<DerivedV,DIM>::init(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedEle> & Ele)
+{
+  using namespace Eigen;
+  using namespace std;
+  deinit();
+  if(V.size() == 0 || Ele.size() == 0)
+  {
+    return;
+  }
+  assert(DIM == V.cols() && "V.cols() should matched declared dimension");
+  const int m = Ele.rows();
+  MatrixXDIMS BC;
+  if(Ele.cols() == 1)
+  {
+    // points
+    BC = V;
+  }else
+  {
+    // Simplices
+    barycenter(V,Ele,BC);
+  }
+  typedef AlignedBox<Scalar,DIM> Box;
+  std::vector<Box,aligned_allocator<Box> > boxes(m);
+  igl::parallel_for(m,[&](const int e)
+  {
+    for(int c = 0;c<Ele.cols();c++)
     {
-      // Simplices
-      barycenter(V,Ele,BC);
+      boxes[e].extend(V.row(Ele(e,c)).transpose());
     }
-    MatrixXi SI(BC.rows(),BC.cols());
+  },10000);
+
+  // A node over the elements order(begin:end-1) is split at the median of
+  // their barycenters along the longest side of its box (ties broken by
+  // index, as the ranks SI of the recursive init). Its left child, over the
+  // first (n+1)/2 elements, directly follows it in depth-first order and its
+  // right child follows the 2*(n+1)/2-1 nodes of the left subtree, so that
+  // the nodes of one level can be split independently.
+  struct Range
+  {
+    int node,begin,end;
+  };
+  if(m > 1)
+  {
+    m_num_nodes = 2*m-2;
+    m_nodes = new AABB[m_num_nodes];
+  }
+  std::vector<int> order(m);
+  for(int e = 0;e<m;e++)
+  {
+    order[e] = e;
+  }
+  std::vector<Range> level(1,Range{0,0,m}),next;
+  while(!level.empty())
+  {
+    next.assign(2*level.size(),Range{-1,0,0});
+    igl::parallel_for(level.size(),[&](const int r)
     {
-      MatrixXDIMS _;
-      MatrixXi IS;
-      igl::sort(BC,1,true,_,IS);
-      // Need SI(i) to tell which place i would be sorted into
-      const int dim = IS.cols();
-      for(int i = 0;i<IS.rows();i++)
+      const Range R = level[r];
+      AABB & node = R.node == 0 ? *this : m_nodes[R.node-1];
+      for(int k = R.begin;k<R.end;k++)
+      {
+        node.m_box.extend(boxes[order[k]]);
+      }
+      if(R.end-R.begin == 1)
       {
-        for(int d = 0;d<dim;d++)
+        node.m_primitive = order[R.begin];
+        return;
+      }
+      int max_d = -1;
+      node.m_box.diagonal().maxCoeff(&max_d);
+      const int mid = R.begin+(R.end-R.begin+1)/2;
+      std::nth_element(
+        order.begin()+R.begin,order.begin()+mid,order.begin()+R.end,
+        [&BC,max_d](const int a,const int b)
         {
-          SI(IS(i,d),d) = i;
-        }
+          return BC(a,max_d)<BC(b,max_d) ||
+            (BC(a,max_d)==BC(b,max_d) && a<b);
+        });
+      const int left = R.node+1;
+      const int right = R.node+2*(mid-R.begin);
+      node.m_left = m_nodes+left-1;
+      node.m_right = m_nodes+right-1;
+      next[2*r] = Range{left,R.begin,mid};
+      next[2*r+1] = Range{right,mid,R.end};
+    },m<10000 ? level.size()+1 : 2);
+    level.clear();
+    for(const Range & R : next)
+    {
+      if(R.node >= 0)
+      {
+        level.push_back(R);
       }
     }
-    init(V,Ele,SI,allI);
   }
 }
 
 template <typename DerivedV, int DIM>
 template <typename DerivedEle>
-void igl::AABB<DerivedV,DIM>::init(
+IGL_INLINE void igl::AABB<DerivedV,DIM>::refit(
     const Eigen::MatrixBase<DerivedV> & V,
     const Eigen::MatrixBase<DerivedEle> & Ele)
 {
-  using namespace Eigen;
-  // deinit will be immediately called...
-  return init(V,Ele,MatrixXDIMS(),MatrixXDIMS(),VectorXi(),0);
+  const auto & leaf_box = [&V,&Ele](AABB & node)
+  {
+    node.m_box = Eigen::AlignedBox<Scalar,DIM>();
+    for(int c = 0;c<Ele.cols();c++)
+    {
+      node.m_box.extend(V.row(Ele(node.m_primitive,c)).transpose());
+    }
+  };
+  if(m_primitive == -1 && m_left == NULL && m_right == NULL)
+  {
+    // Empty tree
+    return;
+  }
+  if(m_nodes == NULL)
+  {
+    // Tree built node by node
+    if(is_leaf())
+    {
+      leaf_box(*this);
+      return;
+    }
+    m_box = Eigen::AlignedBox<Scalar,DIM>();
+    for(AABB * child : {m_left,m_right})
+    {
+      if(child != NULL)
+      {
+        child->refit(V,Ele);
+        m_box.extend(child->m_box);
+      }
+    }
+    return;
+  }
+  igl::parallel_for(m_num_nodes,[&](const int k)
+  {
+    if(m_nodes[k].is_leaf())
+    {
+      leaf_box(m_nodes[k]);
+    }
+  },10000);
+  // Children come after their parent in depth-first order
+  for(int k = m_num_nodes-1;k>=0;k--)
+  {
+    AABB & node = m_nodes[k];
+    if(!node.is_leaf())
+    {
+      node.m_box = node.m_left->m_box.merged(node.m_right->m_box);
+    }
+  }
+  m_box = m_left->m_box.merged(m_right->m_box);
 }
 
   template <typename DerivedV, int DIM>
@@ -484,14 +602,35 @@ IGL_INLINE void igl::AABB<DerivedV,DIM>::squared_distance(
   // O( #P * log #Ele ), where log #Ele is really the depth of this AABB
   // hierarchy
   //for(int p = 0;p<P.rows();p++)
-  igl::parallel_for(P.rows(),[&](int p)
+  // Each thread works on runs of consecutive queries: the distance to the
+  // previous query's closest primitive bounds the search of the next one.
+  // The bound is loosened to strictly above that distance so that the
+  // search still reaches every primitive it would reach unbounded before
+  // the closest one, and ties resolve to the same primitive whatever the
+  // seed (i.e., whatever the number of threads).
+  std::vector<int> prev;
+  igl::parallel_for(
+    P.rows(),
+    [&prev](const size_t nthreads){ prev.assign(nthreads,-1); },
+    [&](const int p, const size_t t)
     {
       RowVectorDIMS Pp = P.row(p), c;
-      int Ip;
-      sqrD(p) = squared_distance(V,Ele,Pp,Ip,c);
+      int Ip = prev[t];
+      Scalar up_sqr_d = std::numeric_limits<Scalar>::infinity();
+      if(Ip >= 0)
+      {
+        igl::point_simplex_squared_distance<DIM>(Pp,V,Ele,Ip,up_sqr_d,c);
+        up_sqr_d +=
+          up_sqr_d*1024*std::numeric_limits<Scalar>::epsilon()+
+          std::numeric_limits<Scalar>::min();
+        Ip = -1;
+      }
+      sqrD(p) = squared_distance(V,Ele,Pp,up_sqr_d,Ip,c);
       I(p) = Ip;
+      prev[t] = Ip;
       C.row(p).head(DIM) = c;
     },
+    [](const size_t){},
     10000);
 }
 
@@ -1072,4 +1211,5 @@ template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::init<Eigen
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::init<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
 template double igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, double, int&, Eigen::PlainObjectBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> >&) const;
 template bool igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_ray<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, igl::Hit&) const;
+template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::refit<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
 #endif
@@ -38,9 +38,18 @@ public:
       int m_primitive;
       //Scalar m_low_sqr_d;
       //int m_depth;
+private:
+      // Nodes below the root of a tree built by init(V,Ele): one array in
+      // depth-first order (a left child directly follows its parent) owned by
+      // the root, so that traversals walk mostly contiguous memory. NULL for
+      // trees built node by node (copies, serializations).
+      AABB * m_nodes;
+      int m_num_nodes;
+public:
       AABB():
         m_left(NULL), m_right(NULL),
-        m_box(), m_primitive(-1)
+        m_box(), m_primitive(-1),
+        m_nodes(NULL), m_num_nodes(0)
         //m_low_sqr_d(std::numeric_limits<double>::infinity()),
         //m_depth(0)
     {}
@@ -49,7 +58,8 @@ public:
         m_left(other.m_left ? new AABB(*other.m_left) : NULL),
         m_right(other.m_right ? new AABB(*other.m_right) : NULL),
         m_box(other.m_box),
-        m_primitive(other.m_primitive)
+        m_primitive(other.m_primitive),
+        m_nodes(NULL), m_num_nodes(0)
         //m_low_sqr_d(other.m_low_sqr_d),
         //m_depth(std::max(
         //   m_left ? m_left->m_depth + 1 : 0,
@@ -65,6 +75,8 @@ public:
         swap(first.m_right,second.m_right);
         swap(first.m_box,second.m_box);
         swap(first.m_primitive,second.m_primitive);
+        swap(first.m_nodes,second.m_nodes);
+        swap(first.m_num_nodes,second.m_num_nodes);
         //swap(first.m_low_sqr_d,second.m_low_sqr_d);
         //swap(first.m_depth,second.m_depth);
       }
@@ -86,9 +98,23 @@ public:
       {
         m_primitive = -1;
         m_box = Eigen::AlignedBox<Scalar,DIM>();
-        delete m_left;
+        if(m_nodes != NULL)
+        {
+          // Pooled children must not delete each other
+          for(int k = 0;k<m_num_nodes;k++)
+          {
+            m_nodes[k].m_left = NULL;
+            m_nodes[k].m_right = NULL;
+          }
+          delete[] m_nodes;
+          m_nodes = NULL;
+          m_num_nodes = 0;
+        }else
+        {
+          delete m_left;
+          delete m_right;
+        }
         m_left = NULL;
-        delete m_right;
         m_right = NULL;
       }
       ~AABB()
@@ -117,11 +143,32 @@ public:
             const Eigen::MatrixBase<Derivedbb_maxs> & bb_maxs,
             const Eigen::MatrixBase<Derivedelements> & elements,
             const int i = 0);
-      // Wrapper for root with empty serialization
+      // Build an Axis-Aligned Bounding Box tree for a given mesh: same splits
+      // as the recursive init below (median of barycenters along the longest
+      // side of each box), but elements are partitioned in place and all
+      // nodes of a level are split in parallel. Nodes are allocated in a
+      // single depth-first array.
+      //
+      // Inputs:
+      //   V  #V by dim list of mesh vertex positions. 
+      //   Ele  #Ele by dim+1 list of mesh indices into #V. 
       template <typename DerivedEle>
       IGL_INLINE void init(
           const Eigen::MatrixBase<DerivedV> & V,
           const Eigen::MatrixBase<DerivedEle> & Ele);
+      // Recompute all bounding boxes bottom-up for new vertex positions,
+      // keeping the tree topology. Much cheaper than init for deforming
+      // meshes, at the price of looser boxes when elements move far relative
+      // to each other.
+      //
+      // Inputs:
+      //   V  #V by dim list of new mesh vertex positions
+      //   Ele  #Ele by dim+1 list of mesh indices into #V, same as used to
+      //     build the tree
+      template <typename DerivedEle>
+      IGL_INLINE void refit(
+          const Eigen::MatrixBase<DerivedV> & V,
+          const Eigen::MatrixBase<DerivedEle> & Ele);
       // Build an Axis-Aligned Bounding Box tree for a given mesh.
       //
       // Inputs:
@@ -269,7 +316,9 @@ public:
 public:
       // Compute the squared distance from all query points in P to the
       // _closest_ points on the primitives stored in the AABB hierarchy for
-      // the mesh (V,Ele).
+      // the mesh (V,Ele). Each query starts from the closest primitive of the
+      // previous query of the same thread as upper bound, so spatially
+      // coherent P (mesh vertices, grid points) prune most of the traversals.
       //
       // Inputs:
       //   V  #V by dim list of vertex positions
@@ -0,0 +1,475 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "FastWindingNumber.h"
+#include "octree.h"
+#include "parallel_for.h"
+#include "PI.h"
+#include <Eigen/Geometry>
+#include <cassert>
+#include <cmath>
+#include <functional>
+
+template <typename Scalar>
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::set_mesh(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F)
+{
+  assert(V.cols() == 3 && "V should have 3d positions");
+  assert(F.cols() == 3 && "F should contain triangles");
+  m_mesh = true;
+  m_F = F.template cast<int>();
+  m_order.resize(F.rows());
+  for(int s = 0;s<int(F.rows());s++)
+  {
+    m_order[s] = s;
+  }
+  set_triangles(V);
+  build();
+  fit();
+}
+
+template <typename Scalar>
+template <typename DerivedP, typename DerivedN, typename DerivedA>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::set_points(
+  const Eigen::MatrixBase<DerivedP> & P,
+  const Eigen::MatrixBase<DerivedN> & N,
+  const Eigen::MatrixBase<DerivedA> & A)
+{
+  assert(P.cols() == 3 && "P should have 3d positions");
+  assert(N.rows() == P.rows() && A.size() == P.rows());
+  m_mesh = false;
+  m_F.resize(0,3);
+  m_T0.resize(0,3);
+  m_T1.resize(0,3);
+  m_T2.resize(0,3);
+  m_order.resize(P.rows());
+  for(int s = 0;s<int(P.rows());s++)
+  {
+    m_order[s] = s;
+  }
+  set_slots(P,N,A);
+  build();
+  fit();
+}
+
+template <typename Scalar>
+template <typename DerivedV>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::refit(
+  const Eigen::MatrixBase<DerivedV> & V)
+{
+  assert(m_mesh && "refit(V) needs a mesh, see set_mesh");
+  set_triangles(V);
+  fit();
+}
+
+template <typename Scalar>
+template <typename DerivedP, typename DerivedN, typename DerivedA>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::refit(
+  const Eigen::MatrixBase<DerivedP> & P,
+  const Eigen::MatrixBase<DerivedN> & N,
+  const Eigen::MatrixBase<DerivedA> & A)
+{
+  assert(!m_mesh && "refit(P,N,A) needs a point cloud, see set_points");
+  assert(P.rows() == size() && "Number of points should not change");
+  set_slots(P,N,A);
+  fit();
+}
+
+template <typename Scalar>
+IGL_INLINE int igl::FastWindingNumber<Scalar>::size() const
+{
+  return int(m_order.size());
+}
+
+template <typename Scalar>
+template <typename DerivedV>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::set_triangles(
+  const Eigen::MatrixBase<DerivedV> & V)
+{
+  const int n = m_F.rows();
+  m_T0.resize(n,3);
+  m_T1.resize(n,3);
+  m_T2.resize(n,3);
+  m_P.resize(n,3);
+  m_AN.resize(n,3);
+  m_A.resize(n);
+  parallel_for(n,[&](const int s)
+  {
+    const RowVector3S a = V.row(m_F(s,0)).template cast<Scalar>();
+    const RowVector3S b = V.row(m_F(s,1)).template cast<Scalar>();
+    const RowVector3S c = V.row(m_F(s,2)).template cast<Scalar>();
+    m_T0.row(s) = a;
+    m_T1.row(s) = b;
+    m_T2.row(s) = c;
+    m_P.row(s) = (a+b+c)/3.;
+    m_AN.row(s) = 0.5*(b-a).cross(c-a);
+    m_A(s) = m_AN.row(s).norm();
+  },10000);
+}
+
+template <typename Scalar>
+template <typename DerivedP, typename DerivedN, typename DerivedA>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::set_slots(
+  const Eigen::MatrixBase<DerivedP> & P,
+  const Eigen::MatrixBase<DerivedN> & N,
+  const Eigen::MatrixBase<DerivedA> & A)
+{
+  const int n = m_order.size();
+  m_P.resize(n,3);
+  m_AN.resize(n,3);
+  m_A.resize(n);
+  parallel_for(n,[&](const int s)
+  {
+    const int i = m_order[s];
+    m_P.row(s) = P.row(i).template cast<Scalar>();
+    m_A(s) = Scalar(A(i));
+    m_AN.row(s) = m_A(s)*N.row(i).template cast<Scalar>();
+  },10000);
+}
+
+template <typename Scalar>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::build()
+{
+  const int n = size();
+  if(n == 0)
+  {
+    m_CH.resize(0,8);
+    m_begin.resize(0);
+    m_end.resize(0);
+    return;
+  }
+  std::vector<std::vector<int> > point_indices;
+  MatrixX3S CN;
+  Eigen::Matrix<Scalar,Eigen::Dynamic,1> W;
+  octree(m_P,point_indices,m_CH,CN,W);
+
+  // Depth first order of the leaves' points makes every cell contiguous
+  std::vector<int> perm;
+  perm.reserve(n);
+  m_begin.resize(m_CH.rows());
+  m_end.resize(m_CH.rows());
+  std::function<void(const int)> helper;
+  helper = [&](const int c)
+  {
+    m_begin(c) = perm.size();
+    if(m_CH(c,0) == -1)
+    {
+      perm.insert(perm.end(),point_indices[c].begin(),point_indices[c].end());
+    }else
+    {
+      for(int k = 0;k<8;k++)
+      {
+        helper(m_CH(c,k));
+      }
+    }
+    m_end(c) = perm.size();
+  };
+  helper(0);
+  assert(int(perm.size()) == n);
+
+  const auto permute = [&](MatrixX3S & X)
+  {
+    if(X.rows() == 0)
+    {
+      return;
+    }
+    MatrixX3S Y(n,3);
+    for(int s = 0;s<n;s++)
+    {
+      Y.row(s) = X.row(perm[s]);
+    }
+    X.swap(Y);
+  };
+  permute(m_P);
+  permute(m_AN);
+  permute(m_T0);
+  permute(m_T1);
+  permute(m_T2);
+  const Eigen::Matrix<Scalar,Eigen::Dynamic,1> A = m_A;
+  const Eigen::Matrix<int,Eigen::Dynamic,3> F = m_F;
+  const std::vector<int> order = m_order;
+  for(int s = 0;s<n;s++)
+  {
+    m_A(s) = A(perm[s]);
+    m_order[s] = order[perm[s]];
+    if(F.rows() > 0)
+    {
+      m_F.row(s) = F.row(perm[s]);
+    }
+  }
+}
+
+template <typename Scalar>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::fit()
+{
+  const int m = m_CH.rows();
+  const int num_terms = expansion_order<=0 ? 3 : expansion_order==1 ? 12 : 39;
+  m_CM.resize(m,3);
+  m_R.resize(m);
+  m_EC.setZero(m,num_terms);
+  parallel_for(m,[&](const int c)
+  {
+    const int begin = m_begin(c);
+    const int end = m_end(c);
+    if(begin == end)
+    {
+      m_CM.row(c).setZero();
+      m_R(c) = 0;
+      return;
+    }
+    Scalar area = 0;
+    RowVector3S cm(0,0,0);
+    for(int s = begin;s<end;s++)
+    {
+      area += m_A(s);
+      cm += m_A(s)*m_P.row(s);
+    }
+    if(area > 0)
+    {
+      cm /= area;
+    }else
+    {
+      cm = m_P.middleRows(begin,end-begin).colwise().mean();
+    }
+    m_CM.row(c) = cm;
+
+    // Radius bounds the elements (triangle corners) around the center
+    Scalar sqr_r = 0;
+    for(int s = begin;s<end;s++)
+    {
+      if(m_mesh)
+      {
+        sqr_r = std::max(sqr_r,(m_T0.row(s)-cm).squaredNorm());
+        sqr_r = std::max(sqr_r,(m_T1.row(s)-cm).squaredNorm());
+        sqr_r = std::max(sqr_r,(m_T2.row(s)-cm).squaredNorm());
+      }else
+      {
+        sqr_r = std::max(sqr_r,(m_P.row(s)-cm).squaredNorm());
+      }
+    }
+    m_R(c) = std::sqrt(sqr_r);
+
+    // Taylor coefficients about the center, 3x3 blocks stored column major
+    Scalar * ec = m_EC.data()+c*num_terms;
+    for(int s = begin;s<end;s++)
+    {
+      const RowVector3S p = m_P.row(s)-cm;
+      const RowVector3S an = m_AN.row(s);
+      for(int j = 0;j<3;j++)
+      {
+        ec[j] += an(j);
+      }
+      if(num_terms < 12)
+      {
+        continue;
+      }
+      for(int j = 0;j<3;j++)
+      {
+        for(int i = 0;i<3;i++)
+        {
+          ec[3+3*j+i] += p(i)*an(j);
+        }
+      }
+      if(num_terms < 39)
+      {
+        continue;
+      }
+      for(int k = 0;k<3;k++)
+      {
+        for(int j = 0;j<3;j++)
+        {
+          for(int i = 0;i<3;i++)
+          {
+            ec[12+9*k+3*j+i] += 0.5*p(k)*p(i)*an(j);
+          }
+        }
+      }
+    }
+  },100);
+}
+
+template <typename Scalar>
+IGL_INLINE Scalar igl::FastWindingNumber<Scalar>::direct(
+  const int begin,
+  const int end,
+  const RowVector3S & q,
+  const bool exact) const
+{
+  const int n = size();
+  const Scalar qx = q(0), qy = q(1), qz = q(2);
+  Scalar wn = 0;
+  if(exact)
+  {
+    // Solid angle of each triangle [Van Oosterom & Strackee 1983]
+    const Scalar *ax = m_T0.data(), *ay = ax+n, *az = ay+n;
+    const Scalar *bx = m_T1.data(), *by = bx+n, *bz = by+n;
+    const Scalar *cx = m_T2.data(), *cy = cx+n, *cz = cy+n;
+    for(int s = begin;s<end;s++)
+    {
+      const Scalar a0 = ax[s]-qx, a1 = ay[s]-qy, a2 = az[s]-qz;
+      const Scalar b0 = bx[s]-qx, b1 = by[s]-qy, b2 = bz[s]-qz;
+      const Scalar c0 = cx[s]-qx, c1 = cy[s]-qy, c2 = cz[s]-qz;
+      const Scalar la = std::sqrt(a0*a0+a1*a1+a2*a2);
+      const Scalar lb = std::sqrt(b0*b0+b1*b1+b2*b2);
+      const Scalar lc = std::sqrt(c0*c0+c1*c1+c2*c2);
+      const Scalar det =
+        a0*(b1*c2-b2*c1) - a1*(b0*c2-b2*c0) + a2*(b0*c1-b1*c0);
+      const Scalar ab = a0*b0+a1*b1+a2*b2;
+      const Scalar bc = b0*c0+b1*c1+b2*c2;
+      const Scalar ca = c0*a0+c1*a1+c2*a2;
+      wn += std::atan2(det,la*lb*lc+ab*lc+bc*la+ca*lb);
+    }
+    return wn/(2.*igl::PI);
+  }
+  // Dipoles
+  const Scalar *px = m_P.data(), *py = px+n, *pz = py+n;
+  const Scalar *nx = m_AN.data(), *ny = nx+n, *nz = ny+n;
+  for(int s = begin;s<end;s++)
+  {
+    const Scalar d0 = px[s]-qx, d1 = py[s]-qy, d2 = pz[s]-qz;
+    const Scalar r2 = d0*d0+d1*d1+d2*d2;
+    // A query on a point counts as on the boundary
+    wn += r2 > 0 ?
+      (d0*nx[s]+d1*ny[s]+d2*nz[s])/(4.*igl::PI*r2*std::sqrt(r2)) : 0.5;
+  }
+  return wn;
+}
+
+template <typename Scalar>
+IGL_INLINE Scalar igl::FastWindingNumber<Scalar>::expansion(
+  const int c,
+  const RowVector3S & q) const
+{
+  const int num_terms = m_EC.cols();
+  const Scalar * ec = m_EC.data()+c*num_terms;
+  const RowVector3S d = m_CM.row(c)-q;
+  const Scalar r2 = d.squaredNorm();
+  const Scalar r = std::sqrt(r2);
+  const Scalar k3 = 1./(4.*igl::PI*r2*r);
+  Scalar wn = k3*(d(0)*ec[0]+d(1)*ec[1]+d(2)*ec[2]);
+  if(num_terms >= 12)
+  {
+    // Hessian of the kernel: (I - 3 d d^T/r^2)/(4 pi r^3)
+    const Scalar * T = ec+3;
+    Scalar dTd = 0;
+    for(int j = 0;j<3;j++)
+    {
+      for(int i = 0;i<3;i++)
+      {
+        dTd += d(i)*T[3*j+i]*d(j);
+      }
+    }
+    wn += k3*(T[0]+T[4]+T[8]-3.*dTd/r2);
+  }
+  if(num_terms >= 39)
+  {
+    // Third derivatives of the kernel
+    const Scalar k5 = k3/r2;
+    const Scalar k7 = k5/r2;
+    for(int k = 0;k<3;k++)
+    {
+      const Scalar * U = ec+12+9*k;
+      Scalar dUd = 0, row = 0, col = 0;
+      for(int j = 0;j<3;j++)
+      {
+        for(int i = 0;i<3;i++)
+        {
+          dUd += d(i)*U[3*j+i]*d(j);
+        }
+        row += U[3*j+k]*d(j);
+        col += U[3*k+j]*d(j);
+      }
+      wn += 15.*k7*d(k)*dUd - 3.*k5*(row+col+d(k)*(U[0]+U[4]+U[8]));
+    }
+  }
+  return wn;
+}
+
+template <typename Scalar>
+IGL_INLINE Scalar igl::FastWindingNumber<Scalar>::winding_number(
+  const RowVector3S & q,
+  std::vector<int> & stack) const
+{
+  if(size() == 0)
+  {
+    return 0;
+  }
+  if(beta <= 0)
+  {
+    return direct(0,size(),q,m_mesh);
+  }
+  Scalar wn = 0;
+  stack.clear();
+  stack.push_back(0);
+  while(!stack.empty())
+  {
+    const int c = stack.back();
+    stack.pop_back();
+    if(m_CH(c,0) == -1 || m_end(c)-m_begin(c) <= leaf_size)
+    {
+      wn += direct(m_begin(c),m_end(c),q,m_mesh);
+      continue;
+    }
+    for(int k = 0;k<8;k++)
+    {
+      const int child = m_CH(c,k);
+      if(m_begin(child) == m_end(child))
+      {
+        continue;
+      }
+      if((m_CM.row(child)-q).norm() > beta*m_R(child))
+      {
+        wn += m_CH(child,0) == -1 ?
+          direct(m_begin(child),m_end(child),q,false) : expansion(child,q);
+      }else
+      {
+        stack.push_back(child);
+      }
+    }
+  }
+  return wn;
+}
+
+template <typename Scalar>
+IGL_INLINE Scalar igl::FastWindingNumber<Scalar>::winding_number(
+  const RowVector3S & q) const
+{
+  std::vector<int> stack;
+  return winding_number(q,stack);
+}
+
+template <typename Scalar>
+template <typename DerivedQ, typename DerivedW>
+IGL_INLINE void igl::FastWindingNumber<Scalar>::winding_number(
+  const Eigen::MatrixBase<DerivedQ> & Q,
+  Eigen::PlainObjectBase<DerivedW> & W) const
+{
+  assert(Q.cols() == 3 && "Q should have 3d positions");
+  W.resize(Q.rows(),1);
+  // One traversal stack per thread
+  std::vector<std::vector<int> > stacks;
+  parallel_for(
+    Q.rows(),
+    [&](const int nthreads){ stacks.resize(nthreads); },
+    [&](const int i,const int t)
+    {
+      W(i) = winding_number(
+        RowVector3S(Q.row(i).template cast<Scalar>()),stacks[t]);
+    },
+    [](const int){},
+    1000);
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template class igl::FastWindingNumber<double>;
+template void igl::FastWindingNumber<double>::set_mesh<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template void igl::FastWindingNumber<double>::refit<Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&);
+template void igl::FastWindingNumber<double>::set_points<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> > const&);
+template void igl::FastWindingNumber<double>::refit<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> > const&);
+template void igl::FastWindingNumber<double>::winding_number<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&) const;
+#endif
@@ -0,0 +1,151 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_FASTWINDINGNUMBER_H
+#define IGL_FASTWINDINGNUMBER_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <vector>
+
+namespace igl
+{
+  // Fast winding number [Barill et al. 2018] of a triangle mesh or of an
+  // oriented point cloud, keeping the octree and the per-cell expansion
+  // coefficients between queries (see fast_winding_number.h for the
+  // functional interface to the point cloud version).
+  //
+  // Elements (triangles or points) are stored in octree order so that the
+  // elements of every cell are contiguous, as columns of separate arrays.
+  // Cells with at most leaf_size elements are evaluated directly; for a mesh
+  // with the exact solid angle of each triangle, so queries near or on the
+  // surface are accurate.
+  //
+  // Example:
+  //   igl::FastWindingNumber<double> fwn;
+  //   fwn.set_mesh(V,F);
+  //   fwn.winding_number(Q,W); // inside where W > 0.5
+  //   ... move V ...
+  //   fwn.refit(V);
+  //
+  // Templates:
+  //   Scalar  floating point type of positions and winding numbers
+  template <typename Scalar>
+  class FastWindingNumber
+  {
+  public:
+    typedef Eigen::Matrix<Scalar,1,3> RowVector3S;
+    typedef Eigen::Matrix<Scalar,Eigen::Dynamic,3> MatrixX3S;
+    // Cells further than beta times their radius from a query are evaluated
+    // with their expansion; beta <= 0 evaluates all elements directly {2}
+    Scalar beta;
+    // Order of the expansion, 0, 1 or 2, used by the next set_mesh or
+    // set_points {2}
+    int expansion_order;
+    // Cells with at most this many elements are evaluated directly {8}
+    int leaf_size;
+  private:
+    bool m_mesh;
+    // Octree order: element in each slot
+    std::vector<int> m_order;
+    // Per slot: centers, areas and area weighted normals
+    MatrixX3S m_P, m_AN;
+    Eigen::Matrix<Scalar,Eigen::Dynamic,1> m_A;
+    // Per slot triangle corners and triangles (mesh only)
+    MatrixX3S m_T0, m_T1, m_T2;
+    Eigen::Matrix<int,Eigen::Dynamic,3> m_F;
+    // Per cell: children (-1 for leaves), range of slots, center of mass,
+    // radius and expansion coefficients
+    Eigen::Matrix<int,Eigen::Dynamic,8> m_CH;
+    Eigen::VectorXi m_begin, m_end;
+    MatrixX3S m_CM;
+    Eigen::Matrix<Scalar,Eigen::Dynamic,1> m_R;
+    Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> m_EC;
+  public:
+    FastWindingNumber():
+      beta(2),expansion_order(2),leaf_size(8),m_mesh(false){}
+    // Build for a triangle mesh
+    //
+    // Inputs:
+    //   V  #V by 3 list of vertex positions
+    //   F  #F by 3 list of triangle indices
+    template <typename DerivedV, typename DerivedF>
+    IGL_INLINE void set_mesh(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedF> & F);
+    // Build for an oriented point cloud
+    //
+    // Inputs:
+    //   P  #P by 3 list of point positions
+    //   N  #P by 3 list of unit point normals
+    //   A  #P list of point areas
+    template <typename DerivedP, typename DerivedN, typename DerivedA>
+    IGL_INLINE void set_points(
+      const Eigen::MatrixBase<DerivedP> & P,
+      const Eigen::MatrixBase<DerivedN> & N,
+      const Eigen::MatrixBase<DerivedA> & A);
+    // Update the expansions after the vertices of the mesh moved, keeping the
+    // octree. Results are exact for any motion; queries slow down as the
+    // cells of the octree spread apart.
+    //
+    // Inputs:
+    //   V  #V by 3 list of new vertex positions
+    template <typename DerivedV>
+    IGL_INLINE void refit(const Eigen::MatrixBase<DerivedV> & V);
+    // Update the expansions after the points moved, see above
+    template <typename DerivedP, typename DerivedN, typename DerivedA>
+    IGL_INLINE void refit(
+      const Eigen::MatrixBase<DerivedP> & P,
+      const Eigen::MatrixBase<DerivedN> & N,
+      const Eigen::MatrixBase<DerivedA> & A);
+    // Number of triangles or points
+    IGL_INLINE int size() const;
+    // Inputs:
+    //   q  query point
+    // Returns winding number at q
+    IGL_INLINE Scalar winding_number(const RowVector3S & q) const;
+    // Winding numbers of many query points, in parallel
+    //
+    // Inputs:
+    //   Q  #Q by 3 list of query points
+    // Outputs:
+    //   W  #Q list of winding numbers
+    template <typename DerivedQ, typename DerivedW>
+    IGL_INLINE void winding_number(
+      const Eigen::MatrixBase<DerivedQ> & Q,
+      Eigen::PlainObjectBase<DerivedW> & W) const;
+  private:
+    // Fill the per slot arrays of a mesh from V and m_F
+    template <typename DerivedV>
+    IGL_INLINE void set_triangles(const Eigen::MatrixBase<DerivedV> & V);
+    // Fill the per slot arrays of a point cloud, slot s holding point
+    // m_order[s]
+    template <typename DerivedP, typename DerivedN, typename DerivedA>
+    IGL_INLINE void set_slots(
+      const Eigen::MatrixBase<DerivedP> & P,
+      const Eigen::MatrixBase<DerivedN> & N,
+      const Eigen::MatrixBase<DerivedA> & A);
+    // Octree of m_P, sets m_order, m_CH, m_begin and m_end and permutes the
+    // per slot arrays
+    IGL_INLINE void build();
+    // Centers of mass, radii and expansions of all cells
+    IGL_INLINE void fit();
+    IGL_INLINE Scalar winding_number(
+      const RowVector3S & q,
+      std::vector<int> & stack) const;
+    // Sum over the slots [begin,end), exact triangles if exact
+    IGL_INLINE Scalar direct(
+      const int begin,
+      const int end,
+      const RowVector3S & q,
+      const bool exact) const;
+    IGL_INLINE Scalar expansion(const int c, const RowVector3S & q) const;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "FastWindingNumber.cpp"
+#endif
+
+#endif
@@ -0,0 +1,445 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "RayBVH.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE void igl::RayBVH::init(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F)
+{
+  assert(V.cols() == 3 && "V should have 3d positions");
+  assert(F.cols() == 3 && "F should contain triangles");
+  const int m = F.rows();
+  m_nodes.clear();
+  m_id.resize(m);
+  std::iota(m_id.begin(),m_id.end(),0);
+  Eigen::Matrix<float,Eigen::Dynamic,3> lo(m,3),hi(m,3),C(m,3);
+  for(int f = 0;f<m;f++)
+  {
+    lo.row(f) = V.row(F(f,0)).template cast<float>();
+    hi.row(f) = lo.row(f);
+    for(int k = 1;k<3;k++)
+    {
+      lo.row(f) = lo.row(f).cwiseMin(V.row(F(f,k)).template cast<float>());
+      hi.row(f) = hi.row(f).cwiseMax(V.row(F(f,k)).template cast<float>());
+    }
+  }
+  C = 0.5f*(lo+hi);
+  if(m > 0)
+  {
+    m_nodes.reserve(2*m);
+    build(lo,hi,C,0,m,0);
+  }
+  m_T.resize(m,9);
+  for(int s = 0;s<m;s++)
+  {
+    const int f = m_id[s];
+    m_T.block(s,0,1,3) = V.row(F(f,0)).template cast<float>();
+    m_T.block(s,3,1,3) = (V.row(F(f,1))-V.row(F(f,0))).template cast<float>();
+    m_T.block(s,6,1,3) = (V.row(F(f,2))-V.row(F(f,0))).template cast<float>();
+  }
+}
+
+IGL_INLINE int igl::RayBVH::size() const
+{
+  return int(m_id.size());
+}
+
+IGL_INLINE void igl::RayBVH::build(
+  const Eigen::Matrix<float,Eigen::Dynamic,3> & lo,
+  const Eigen::Matrix<float,Eigen::Dynamic,3> & hi,
+  const Eigen::Matrix<float,Eigen::Dynamic,3> & C,
+  const int begin,
+  const int end,
+  const int depth)
+{
+  const int num_bins = 16;
+  // Traversal stacks hold 64 entries
+  const int max_depth = 60;
+  const int index = m_nodes.size();
+  m_nodes.emplace_back();
+  Node node;
+  float cmin[3],cmax[3];
+  for(int a = 0;a<3;a++)
+  {
+    node.lo[a] = cmin[a] = std::numeric_limits<float>::infinity();
+    node.hi[a] = cmax[a] = -std::numeric_limits<float>::infinity();
+  }
+  for(int s = begin;s<end;s++)
+  {
+    const int f = m_id[s];
+    for(int a = 0;a<3;a++)
+    {
+      node.lo[a] = std::min(node.lo[a],lo(f,a));
+      node.hi[a] = std::max(node.hi[a],hi(f,a));
+      cmin[a] = std::min(cmin[a],C(f,a));
+      cmax[a] = std::max(cmax[a],C(f,a));
+    }
+  }
+  const auto half_area = [](const float * l, const float * h)->float
+  {
+    const float x = h[0]-l[0], y = h[1]-l[1], z = h[2]-l[2];
+    return x*y+y*z+z*x;
+  };
+  const auto bin = [&](const int f, const int a)->int
+  {
+    return std::min(num_bins-1,
+      int(num_bins*(C(f,a)-cmin[a])/(cmax[a]-cmin[a])));
+  };
+
+  // Binned surface area heuristic: cost of a split relative to testing one
+  // triangle, with traversing a node costing as much as a triangle
+  const int count = end-begin;
+  int best_axis = -1, best_split = 0;
+  float best_cost = std::numeric_limits<float>::infinity();
+  if(count > 2 && depth < max_depth)
+  {
+    for(int a = 0;a<3;a++)
+    {
+      if(!(cmax[a] > cmin[a]))
+      {
+        continue;
+      }
+      int bin_count[num_bins] = {0};
+      float bin_lo[num_bins][3],bin_hi[num_bins][3];
+      for(int b = 0;b<num_bins;b++)
+      {
+        for(int c = 0;c<3;c++)
+        {
+          bin_lo[b][c] = std::numeric_limits<float>::infinity();
+          bin_hi[b][c] = -std::numeric_limits<float>::infinity();
+        }
+      }
+      for(int s = begin;s<end;s++)
+      {
+        const int f = m_id[s];
+        const int b = bin(f,a);
+        bin_count[b]++;
+        for(int c = 0;c<3;c++)
+        {
+          bin_lo[b][c] = std::min(bin_lo[b][c],lo(f,c));
+          bin_hi[b][c] = std::max(bin_hi[b][c],hi(f,c));
+        }
+      }
+      // right_cost[b]: cost of bins [b,num_bins)
+      float right_cost[num_bins];
+      int right_count = 0;
+      float l[3],h[3];
+      std::copy(bin_lo[num_bins-1],bin_lo[num_bins-1]+3,l);
+      std::copy(bin_hi[num_bins-1],bin_hi[num_bins-1]+3,h);
+      for(int b = num_bins-1;b>0;b--)
+      {
+        right_count += bin_count[b];
+        for(int c = 0;c<3;c++)
+        {
+          l[c] = std::min(l[c],bin_lo[b][c]);
+          h[c] = std::max(h[c],bin_hi[b][c]);
+        }
+        right_cost[b] = right_count ? right_count*half_area(l,h) : 0;
+      }
+      int left_count = 0;
+      std::copy(bin_lo[0],bin_lo[0]+3,l);
+      std::copy(bin_hi[0],bin_hi[0]+3,h);
+      for(int b = 1;b<num_bins;b++)
+      {
+        left_count += bin_count[b-1];
+        for(int c = 0;c<3;c++)
+        {
+          l[c] = std::min(l[c],bin_lo[b-1][c]);
+          h[c] = std::max(h[c],bin_hi[b-1][c]);
+        }
+        if(left_count == 0 || left_count == count)
+        {
+          continue;
+        }
+        const float cost = left_count*half_area(l,h)+right_cost[b];
+        if(cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = a;
+          best_split = b;
+        }
+      }
+    }
+  }
+  const float area = half_area(node.lo,node.hi);
+  if(best_axis < 0 || (count <= 8 && best_cost+area >= count*area))
+  {
+    node.first = begin;
+    node.count = count;
+    node.axis = 0;
+    m_nodes[index] = node;
+    return;
+  }
+  const int mid = std::partition(
+    m_id.begin()+begin,
+    m_id.begin()+end,
+    [&](const int f){ return bin(f,best_axis) < best_split; })-m_id.begin();
+  node.count = 0;
+  node.axis = best_axis;
+  build(lo,hi,C,begin,mid,depth+1);
+  node.first = m_nodes.size();
+  build(lo,hi,C,mid,end,depth+1);
+  m_nodes[index] = node;
+}
+
+IGL_INLINE void igl::RayBVH::clear(Packet & p)
+{
+  for(int r = 0;r<PACKET_SIZE;r++)
+  {
+    p.ox[r] = p.oy[r] = p.oz[r] = 0;
+    p.dx[r] = p.dy[r] = p.dz[r] = 1;
+    p.ix[r] = p.iy[r] = p.iz[r] = 1;
+    // Empty segment
+    p.tnear[r] = std::numeric_limits<float>::infinity();
+    p.t[r] = -std::numeric_limits<float>::infinity();
+    p.u[r] = p.v[r] = 0;
+    p.id[r] = -1;
+  }
+}
+
+IGL_INLINE void igl::RayBVH::load(
+  const int r,
+  const float * o,
+  const float * d,
+  const float tnear,
+  const float tfar,
+  Packet & p)
+{
+  // Avoid 0*inf in the slab tests of axis aligned rays
+  const auto inverse = [](const float x)->float
+  {
+    const float tiny = 1e-30f;
+    return 1.f/(std::abs(x) > tiny ? x : std::copysign(tiny,x));
+  };
+  p.ox[r] = o[0];
+  p.oy[r] = o[1];
+  p.oz[r] = o[2];
+  p.dx[r] = d[0];
+  p.dy[r] = d[1];
+  p.dz[r] = d[2];
+  p.ix[r] = inverse(d[0]);
+  p.iy[r] = inverse(d[1]);
+  p.iz[r] = inverse(d[2]);
+  p.tnear[r] = tnear;
+  p.t[r] = tfar;
+  p.id[r] = -1;
+}
+
+template <bool any>
+IGL_INLINE void igl::RayBVH::trace(Packet & p) const
+{
+  if(m_nodes.empty())
+  {
+    return;
+  }
+  const int n = size();
+  const float * x0 = m_T.data(), * y0 = x0+n, * z0 = y0+n;
+  const float * x1 = z0+n, * y1 = x1+n, * z1 = y1+n;
+  const float * x2 = z1+n, * y2 = x2+n, * z2 = y2+n;
+  const float inf = std::numeric_limits<float>::infinity();
+  int stack[64];
+  int sp = 0;
+  int index = 0;
+  while(true)
+  {
+    const Node & node = m_nodes[index];
+    // Slab test of all lanes
+    bool active = false;
+    for(int r = 0;r<PACKET_SIZE;r++)
+    {
+      const float tx0 = (node.lo[0]-p.ox[r])*p.ix[r];
+      const float tx1 = (node.hi[0]-p.ox[r])*p.ix[r];
+      const float ty0 = (node.lo[1]-p.oy[r])*p.iy[r];
+      const float ty1 = (node.hi[1]-p.oy[r])*p.iy[r];
+      const float tz0 = (node.lo[2]-p.oz[r])*p.iz[r];
+      const float tz1 = (node.hi[2]-p.oz[r])*p.iz[r];
+      const float tmin = std::max(
+        std::max(std::min(tx0,tx1),std::min(ty0,ty1)),
+        std::max(std::min(tz0,tz1),p.tnear[r]));
+      const float tmax = std::min(
+        std::min(std::max(tx0,tx1),std::max(ty0,ty1)),
+        std::min(std::max(tz0,tz1),p.t[r]));
+      active |= tmin <= tmax;
+    }
+    if(active && node.count == 0)
+    {
+      // Near child first, by the direction of the first ray
+      const float d =
+        node.axis == 0 ? p.dx[0] : node.axis == 1 ? p.dy[0] : p.dz[0];
+      const int left = index+1;
+      stack[sp++] = d < 0 ? left : node.first;
+      index = d < 0 ? node.first : left;
+      continue;
+    }
+    if(active)
+    {
+      // Moller-Trumbore test of all lanes against each triangle
+      for(int s = node.first;s<node.first+node.count;s++)
+      {
+        const int id = m_id[s];
+        for(int r = 0;r<PACKET_SIZE;r++)
+        {
+          const float px = p.dy[r]*z2[s]-p.dz[r]*y2[s];
+          const float py = p.dz[r]*x2[s]-p.dx[r]*z2[s];
+          const float pz = p.dx[r]*y2[s]-p.dy[r]*x2[s];
+          const float det = x1[s]*px+y1[s]*py+z1[s]*pz;
+          const float inv_det = 1.f/det;
+          const float tx = p.ox[r]-x0[s];
+          const float ty = p.oy[r]-y0[s];
+          const float tz = p.oz[r]-z0[s];
+          const float u = (tx*px+ty*py+tz*pz)*inv_det;
+          const float qx = ty*z1[s]-tz*y1[s];
+          const float qy = tz*x1[s]-tx*z1[s];
+          const float qz = tx*y1[s]-ty*x1[s];
+          const float v = (p.dx[r]*qx+p.dy[r]*qy+p.dz[r]*qz)*inv_det;
+          const float t = (x2[s]*qx+y2[s]*qy+z2[s]*qz)*inv_det;
+          const bool hit = det != 0 && u >= 0 && v >= 0 && u+v <= 1 &&
+            t >= p.tnear[r] && t < p.t[r];
+          p.t[r] = hit ? t : p.t[r];
+          p.u[r] = hit ? u : p.u[r];
+          p.v[r] = hit ? v : p.v[r];
+          p.id[r] = hit ? id : p.id[r];
+          if(any)
+          {
+            p.tnear[r] = hit ? inf : p.tnear[r];
+          }
+        }
+      }
+      if(any)
+      {
+        bool alive = false;
+        for(int r = 0;r<PACKET_SIZE;r++)
+        {
+          alive |= p.tnear[r] != inf;
+        }
+        if(!alive)
+        {
+          return;
+        }
+      }
+    }
+    if(sp == 0)
+    {
+      return;
+    }
+    index = stack[--sp];
+  }
+}
+
+IGL_INLINE bool igl::RayBVH::intersect_ray(
+  const Eigen::Vector3f & origin,
+  const Eigen::Vector3f & dir,
+  igl::Hit & hit,
+  const float tnear,
+  const float tfar) const
+{
+  Packet p;
+  clear(p);
+  load(0,origin.data(),dir.data(),tnear,tfar,p);
+  trace<false>(p);
+  if(p.id[0] < 0)
+  {
+    return false;
+  }
+  hit.id = p.id[0];
+  hit.gid = 0;
+  hit.u = p.u[0];
+  hit.v = p.v[0];
+  hit.t = p.t[0];
+  return true;
+}
+
+IGL_INLINE bool igl::RayBVH::intersect_any(
+  const Eigen::Vector3f & origin,
+  const Eigen::Vector3f & dir,
+  const float tnear,
+  const float tfar) const
+{
+  Packet p;
+  clear(p);
+  load(0,origin.data(),dir.data(),tnear,tfar,p);
+  trace<true>(p);
+  return p.id[0] >= 0;
+}
+
+template <typename DerivedO, typename DerivedD>
+IGL_INLINE void igl::RayBVH::intersect_rays(
+  const Eigen::MatrixBase<DerivedO> & O,
+  const Eigen::MatrixBase<DerivedD> & D,
+  std::vector<igl::Hit> & hits,
+  const float tnear,
+  const float tfar) const
+{
+  assert(O.rows() == D.rows());
+  const int n = O.rows();
+  hits.resize(n);
+  const int num_packets = (n+PACKET_SIZE-1)/PACKET_SIZE;
+  parallel_for(num_packets,[&](const int k)
+  {
+    const int begin = k*PACKET_SIZE;
+    const int end = std::min(n,begin+PACKET_SIZE);
+    Packet p;
+    clear(p);
+    for(int i = begin;i<end;i++)
+    {
+      const Eigen::RowVector3f o = O.row(i).template cast<float>();
+      const Eigen::RowVector3f d = D.row(i).template cast<float>();
+      load(i-begin,o.data(),d.data(),tnear,tfar,p);
+    }
+    trace<false>(p);
+    for(int i = begin;i<end;i++)
+    {
+      const int r = i-begin;
+      hits[i] = {p.id[r],0,p.u[r],p.v[r],p.t[r]};
+    }
+  },100);
+}
+
+template <typename DerivedO, typename DerivedD, typename DerivedH>
+IGL_INLINE void igl::RayBVH::intersect_any(
+  const Eigen::MatrixBase<DerivedO> & O,
+  const Eigen::MatrixBase<DerivedD> & D,
+  Eigen::PlainObjectBase<DerivedH> & H,
+  const float tnear,
+  const float tfar) const
+{
+  assert(O.rows() == D.rows());
+  const int n = O.rows();
+  H.resize(n,1);
+  const int num_packets = (n+PACKET_SIZE-1)/PACKET_SIZE;
+  parallel_for(num_packets,[&](const int k)
+  {
+    const int begin = k*PACKET_SIZE;
+    const int end = std::min(n,begin+PACKET_SIZE);
+    Packet p;
+    clear(p);
+    for(int i = begin;i<end;i++)
+    {
+      const Eigen::RowVector3f o = O.row(i).template cast<float>();
+      const Eigen::RowVector3f d = D.row(i).template cast<float>();
+      load(i-begin,o.data(),d.data(),tnear,tfar,p);
+    }
+    trace<true>(p);
+    for(int i = begin;i<end;i++)
+    {
+      H(i) = p.id[i-begin] >= 0;
+    }
+  },100);
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template void igl::RayBVH::init<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template void igl::RayBVH::init<Eigen::Matrix<float, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template void igl::RayBVH::intersect_rays<Eigen::Matrix<float, -1, 3, 0, -1, 3>, Eigen::Matrix<float, -1, 3, 0, -1, 3> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, std::vector<igl::Hit, std::allocator<igl::Hit> >&, float, float) const;
+template void igl::RayBVH::intersect_any<Eigen::Matrix<float, -1, 3, 0, -1, 3>, Eigen::Matrix<float, -1, 3, 0, -1, 3>, Eigen::Array<bool, -1, 1, 0, -1, 1> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Array<bool, -1, 1, 0, -1, 1> >&, float, float) const;
+#endif
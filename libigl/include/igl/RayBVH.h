@@ -0,0 +1,160 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_RAYBVH_H
+#define IGL_RAYBVH_H
+#include "igl_inline.h"
+#include "Hit.h"
+#include <Eigen/Core>
+#include <limits>
+#include <vector>
+
+namespace igl
+{
+  // Bounding volume hierarchy for tracing many rays against a triangle mesh,
+  // without external dependencies (compare to embree/EmbreeIntersector.h).
+  //
+  // The tree is built with a binned surface area heuristic and flattened in
+  // depth first order. Triangles are stored in single precision, in tree
+  // order, as separate coordinate arrays of (v0, v1-v0, v2-v0). Rays are
+  // traced in packets of PACKET_SIZE: each node is tested against all rays of
+  // the packet at once and each triangle of a leaf against all rays of the
+  // packet, in plain loops that the compiler vectorizes. Packets of rays with
+  // a common origin (ambient occlusion, shape diameter function) traverse
+  // mostly the same nodes.
+  //
+  // Example:
+  //   igl::RayBVH bvh;
+  //   bvh.init(V,F);
+  //   igl::Hit hit;
+  //   if(bvh.intersect_ray(origin,dir,hit)) ... hit.id, hit.t ...
+  class RayBVH
+  {
+  public:
+    enum { PACKET_SIZE = 8 };
+  private:
+    struct Node
+    {
+      // Bounding box
+      float lo[3], hi[3];
+      // Leaves: first slot and number of triangles. Inner nodes: index of the
+      // second child (the first one follows its parent) and count 0
+      int first, count;
+      // Split axis of inner nodes
+      int axis;
+    };
+    // Rays of a packet, one entry per lane
+    struct Packet
+    {
+      float ox[PACKET_SIZE], oy[PACKET_SIZE], oz[PACKET_SIZE];
+      float dx[PACKET_SIZE], dy[PACKET_SIZE], dz[PACKET_SIZE];
+      float ix[PACKET_SIZE], iy[PACKET_SIZE], iz[PACKET_SIZE];
+      float tnear[PACKET_SIZE], t[PACKET_SIZE];
+      float u[PACKET_SIZE], v[PACKET_SIZE];
+      int id[PACKET_SIZE];
+    };
+    std::vector<Node> m_nodes;
+    // Triangle in each slot
+    std::vector<int> m_id;
+    // Per slot: v0, e1 = v1-v0 and e2 = v2-v0
+    Eigen::Matrix<float,Eigen::Dynamic,9> m_T;
+  public:
+    // Build the hierarchy of a mesh
+    //
+    // Inputs:
+    //   V  #V by 3 list of vertex positions
+    //   F  #F by 3 list of triangle indices into V
+    template <typename DerivedV, typename DerivedF>
+    IGL_INLINE void init(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedF> & F);
+    // Number of triangles
+    IGL_INLINE int size() const;
+    // First hit of a ray
+    //
+    // Inputs:
+    //   origin  ray origin
+    //   dir  ray direction (need not be unit)
+    //   tnear  start of the ray segment, in multiples of dir
+    //   tfar  end of the ray segment
+    // Outputs:
+    //   hit  first hit (id, barycentric u,v of corners 1 and 2, t)
+    // Returns true if the segment hits the mesh
+    IGL_INLINE bool intersect_ray(
+      const Eigen::Vector3f & origin,
+      const Eigen::Vector3f & dir,
+      igl::Hit & hit,
+      const float tnear = 0,
+      const float tfar = std::numeric_limits<float>::infinity()) const;
+    // Returns true if the segment hits the mesh anywhere (occlusion test,
+    // stops at the first hit found)
+    IGL_INLINE bool intersect_any(
+      const Eigen::Vector3f & origin,
+      const Eigen::Vector3f & dir,
+      const float tnear = 0,
+      const float tfar = std::numeric_limits<float>::infinity()) const;
+    // First hits of a stream of rays, traced in packets of consecutive rays,
+    // in parallel for long streams
+    //
+    // Inputs:
+    //   O  #O by 3 list of ray origins
+    //   D  #O by 3 list of ray directions
+    //   tnear  start of the ray segments
+    //   tfar  end of the ray segments
+    // Outputs:
+    //   hits  #O list of first hits, with id -1 for rays missing the mesh
+    template <typename DerivedO, typename DerivedD>
+    IGL_INLINE void intersect_rays(
+      const Eigen::MatrixBase<DerivedO> & O,
+      const Eigen::MatrixBase<DerivedD> & D,
+      std::vector<igl::Hit> & hits,
+      const float tnear = 0,
+      const float tfar = std::numeric_limits<float>::infinity()) const;
+    // Occlusion tests of a stream of rays
+    //
+    // Outputs:
+    //   H  #O list of whether each segment hits the mesh
+    template <typename DerivedO, typename DerivedD, typename DerivedH>
+    IGL_INLINE void intersect_any(
+      const Eigen::MatrixBase<DerivedO> & O,
+      const Eigen::MatrixBase<DerivedD> & D,
+      Eigen::PlainObjectBase<DerivedH> & H,
+      const float tnear = 0,
+      const float tfar = std::numeric_limits<float>::infinity()) const;
+  private:
+    // Sort the triangles in slots [begin,end) into a subtree, appending its
+    // nodes
+    //
+    // Inputs:
+    //   lo,hi  #F by 3 triangle bounding boxes
+    //   C  #F by 3 triangle box centers
+    IGL_INLINE void build(
+      const Eigen::Matrix<float,Eigen::Dynamic,3> & lo,
+      const Eigen::Matrix<float,Eigen::Dynamic,3> & hi,
+      const Eigen::Matrix<float,Eigen::Dynamic,3> & C,
+      const int begin,
+      const int end,
+      const int depth);
+    // Load lane r of a packet; lanes that are not loaded are inactive
+    IGL_INLINE static void load(
+      const int r,
+      const float * o,
+      const float * d,
+      const float tnear,
+      const float tfar,
+      Packet & p);
+    IGL_INLINE static void clear(Packet & p);
+    // Trace the active lanes of a packet. Hits are recorded in t, u, v and id
+    // (-1 if none). If any, lanes stop at their first hit found.
+    template <bool any>
+    IGL_INLINE void trace(Packet & p) const;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "RayBVH.cpp"
+#endif
+
+#endif
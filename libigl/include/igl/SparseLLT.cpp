@@ -0,0 +1,70 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "SparseLLT.h"
+#include "parallel_for.h"
+#include <cassert>
+
+template <typename T>
+IGL_INLINE void igl::SparseLLT<T>::analyzePattern(const SparseMatrixT & A)
+{
+  m_solver.analyzePattern(A);
+}
+
+template <typename T>
+IGL_INLINE void igl::SparseLLT<T>::factorize(const SparseMatrixT & A)
+{
+  m_solver.factorize(A);
+}
+
+template <typename T>
+IGL_INLINE igl::SparseLLT<T> & igl::SparseLLT<T>::compute(
+  const SparseMatrixT & A)
+{
+  m_solver.compute(A);
+  return *this;
+}
+
+template <typename T>
+IGL_INLINE Eigen::ComputationInfo igl::SparseLLT<T>::info() const
+{
+  return m_solver.info();
+}
+
+template <typename T>
+IGL_INLINE Eigen::Index igl::SparseLLT<T>::rows() const
+{
+  return m_solver.rows();
+}
+
+template <typename T>
+template <typename DerivedB>
+IGL_INLINE typename igl::SparseLLT<T>::MatrixXT igl::SparseLLT<T>::solve(
+  const Eigen::MatrixBase<DerivedB> & B) const
+{
+  assert(B.rows() == rows() && "B should have one row per row of A");
+  const MatrixXT TB = B.template cast<T>();
+  MatrixXT X(TB.rows(),TB.cols());
+  if(supernodal || TB.cols() < 2 || TB.rows() < min_parallel_rows)
+  {
+    // CHOLMOD handles a block of columns at once (and is not reentrant)
+    X = m_solver.solve(TB);
+    return X;
+  }
+  // Solving only reads the factor, so columns can be solved concurrently
+  igl::parallel_for(TB.cols(),[&](const int j)
+  {
+    const Eigen::Matrix<T,Eigen::Dynamic,1> x = m_solver.solve(TB.col(j));
+    X.col(j) = x;
+  },2);
+  return X;
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template class igl::SparseLLT<double>;
+template igl::SparseLLT<double>::MatrixXT igl::SparseLLT<double>::solve<Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&) const;
+template igl::SparseLLT<double>::MatrixXT igl::SparseLLT<double>::solve<Eigen::Matrix<double, -1, 1, 0, -1, 1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> > const&) const;
+#endif
@@ -0,0 +1,79 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_SPARSE_LLT_H
+#define IGL_SPARSE_LLT_H
+#include "igl_inline.h"
+
+#define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#ifdef CHOLMOD
+#  include <Eigen/CholmodSupport>
+#endif
+#include <type_traits>
+
+namespace igl
+{
+  // Sparse Cholesky factorization of a symmetric positive definite matrix
+  // meant for the many right hand side columns of geometry systems (e.g. #V
+  // by 3 positions). With CHOLMOD defined, double matrices are factorized
+  // with CHOLMOD's supernodal LLT (multithreaded through its BLAS) and all
+  // columns are solved in one call; otherwise Eigen's SimplicialLLT is used
+  // and the columns are solved concurrently with igl::parallel_for. The
+  // latter uses at most one thread per column, so #V by 3 right hand sides
+  // gain at most 3x.
+  //
+  // Exposes the subset of Eigen's sparse solver interface used in libigl
+  // (analyzePattern, factorize, compute, info, solve), so it can stand in
+  // for an Eigen::SimplicialLLT member.
+  //
+  // Templates:
+  //   T  scalar type of the sparse matrix (e.g. double)
+  template <typename T>
+  class SparseLLT
+  {
+  public:
+    typedef Eigen::SparseMatrix<T> SparseMatrixT;
+    typedef Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> MatrixXT;
+#ifdef CHOLMOD
+    // Whether the supernodal backend is used for this scalar type
+    static const bool supernodal = std::is_same<T,double>::value;
+    typedef typename std::conditional<
+      supernodal,
+      Eigen::CholmodSupernodalLLT<SparseMatrixT>,
+      Eigen::SimplicialLLT<SparseMatrixT> >::type Solver;
+#else
+    static const bool supernodal = false;
+    typedef Eigen::SimplicialLLT<SparseMatrixT> Solver;
+#endif
+    // Fewest rows for which columns are solved on separate threads {1000}
+    int min_parallel_rows;
+  private:
+    Solver m_solver;
+  public:
+    SparseLLT():min_parallel_rows(1000){}
+    // Inputs:
+    //   A  n by n symmetric positive definite matrix (only the lower
+    //     triangle is read)
+    IGL_INLINE void analyzePattern(const SparseMatrixT & A);
+    IGL_INLINE void factorize(const SparseMatrixT & A);
+    IGL_INLINE SparseLLT & compute(const SparseMatrixT & A);
+    // Returns Eigen::Success if the last factorization succeeded
+    IGL_INLINE Eigen::ComputationInfo info() const;
+    IGL_INLINE Eigen::Index rows() const;
+    // Inputs:
+    //   B  n by k right hand side
+    // Returns n by k solution X of A X = B
+    template <typename DerivedB>
+    IGL_INLINE MatrixXT solve(const Eigen::MatrixBase<DerivedB> & B) const;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "SparseLLT.cpp"
+#endif
+
+#endif
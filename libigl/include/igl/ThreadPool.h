@@ -0,0 +1,177 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_THREADPOOL_H
+#define IGL_THREADPOOL_H
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace igl
+{
+  // Process-wide pool of persistent worker threads behind parallel_for.
+  // Workers sleep on a condition variable between jobs, so dispatching a job
+  // costs a wake-up instead of creating and joining threads.
+  //
+  // A job is a function called once by every participating thread with its
+  // thread id t in [0,num_threads): the calling thread always takes t=0 and
+  // works alongside the workers, so jobs should distribute their iterations
+  // dynamically (see parallel_for). Only one job runs at a time. A job
+  // submitted from inside a running job (nested parallel_for) or while
+  // another thread's job is running is rejected so that the caller can run
+  // it serially instead of deadlocking.
+  //
+  // Workers are (re)started lazily whenever a job asks for a different number
+  // of threads than the previous one.
+  class ThreadPool
+  {
+  public:
+    typedef std::function<void(const size_t)> Job;
+    // The pool shared by all parallel_for calls
+    inline static ThreadPool & instance()
+    {
+      static ThreadPool pool;
+      return pool;
+    }
+    // Returns true iff the current thread is executing a job of the pool
+    inline static bool in_job()
+    {
+      return job_flag();
+    }
+    // Run job on num_threads threads and wait for it to finish.
+    //
+    // Inputs:
+    //   num_threads  number of threads including the calling thread
+    //   job  function called once per thread with the thread id t <
+    //     num_threads
+    // Returns false (without calling job) iff the pool is busy or called from
+    //   within a job
+    inline bool run(const size_t num_threads, const Job & job);
+    inline ~ThreadPool();
+  private:
+    ThreadPool():current(nullptr),generation(0),active(0),stop(false){}
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+    inline static bool & job_flag()
+    {
+      static thread_local bool flag = false;
+      return flag;
+    }
+    inline void resize(const size_t num_workers);
+    inline void join();
+    inline void work(const size_t t, std::uint64_t seen);
+    // Serializes jobs (and resizing)
+    std::mutex run_mutex;
+    // Protects the fields below
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Job * current;
+    std::uint64_t generation;
+    size_t active;
+    bool stop;
+    std::vector<std::thread> workers;
+  };
+}
+
+// Implementation
+
+inline bool igl::ThreadPool::run(const size_t num_threads, const Job & job)
+{
+  if(in_job())
+  {
+    return false;
+  }
+  std::unique_lock<std::mutex> run_lock(run_mutex,std::try_to_lock);
+  if(!run_lock.owns_lock())
+  {
+    return false;
+  }
+  const size_t num_workers = num_threads>0?num_threads-1:0;
+  if(workers.size() != num_workers)
+  {
+    resize(num_workers);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = &job;
+    generation++;
+  }
+  wake.notify_all();
+  job_flag() = true;
+  job(0);
+  job_flag() = false;
+  // Workers that have not picked up the job yet will skip it: the caller
+  // only returns once all work has been claimed
+  std::unique_lock<std::mutex> lock(mutex);
+  current = nullptr;
+  done.wait(lock,[this]{ return active == 0; });
+  return true;
+}
+
+inline igl::ThreadPool::~ThreadPool()
+{
+  join();
+}
+
+inline void igl::ThreadPool::resize(const size_t num_workers)
+{
+  join();
+  stop = false;
+  workers.reserve(num_workers);
+  for(size_t w = 0;w<num_workers;w++)
+  {
+    workers.emplace_back(&ThreadPool::work,this,w+1,generation);
+  }
+}
+
+inline void igl::ThreadPool::join()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  wake.notify_all();
+  for(std::thread & worker : workers)
+  {
+    worker.join();
+  }
+  workers.clear();
+}
+
+inline void igl::ThreadPool::work(const size_t t, std::uint64_t seen)
+{
+  // Nested parallel_for calls made by jobs run serially on this thread
+  job_flag() = true;
+  std::unique_lock<std::mutex> lock(mutex);
+  while(true)
+  {
+    wake.wait(lock,[&]{ return stop || generation != seen; });
+    if(stop)
+    {
+      return;
+    }
+    seen = generation;
+    const Job * job = current;
+    if(job == nullptr)
+    {
+      continue;
+    }
+    active++;
+    lock.unlock();
+    (*job)(t);
+    lock.lock();
+    if(--active == 0)
+    {
+      done.notify_all();
+    }
+  }
+}
+
+#endif
@@ -7,7 +7,6 @@
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "ambient_occlusion.h"
 #include "random_dir.h"
-#include "ray_mesh_intersect.h"
 #include "EPS.h"
 #include "Hit.h"
 #include "parallel_for.h"
@@ -93,6 +92,38 @@ IGL_INLINE void igl::ambient_occlusion(
 
 }
 
+template <
+  typename DerivedP,
+  typename DerivedN,
+  typename DerivedS >
+IGL_INLINE void igl::ambient_occlusion(
+  const igl::RayBVH & bvh,
+  const Eigen::PlainObjectBase<DerivedP> & P,
+  const Eigen::PlainObjectBase<DerivedN> & N,
+  const int num_samples,
+  Eigen::PlainObjectBase<DerivedS> & S)
+{
+  using namespace Eigen;
+  const int n = P.rows();
+  S.resize(n,1);
+  const MatrixXf D = random_dir_stratified(num_samples).cast<float>();
+  parallel_for(n,[&](const int p)
+  {
+    const RowVector3f origin = P.row(p).template cast<float>();
+    const RowVector3f normal = N.row(p).template cast<float>();
+    Matrix<float,Dynamic,3> O(num_samples,3),Dp(num_samples,3);
+    for(int s = 0;s<num_samples;s++)
+    {
+      // reverse rays below the tangent plane
+      Dp.row(s) = (D.row(s).dot(normal) < 0 ? -1.f : 1.f)*D.row(s);
+      O.row(s) = origin+1e-4f*Dp.row(s);
+    }
+    Array<bool,Dynamic,1> H;
+    bvh.intersect_any(O,Dp,H);
+    S(p) = (double)H.count()/(double)num_samples;
+  },1000);
+}
+
 template <
   typename DerivedV,
   typename DerivedF,
@@ -107,22 +138,9 @@ IGL_INLINE void igl::ambient_occlusion(
   const int num_samples,
   Eigen::PlainObjectBase<DerivedS> & S)
 {
-  if(F.rows() < 100)
-  {
-    // Super naive
-    const auto & shoot_ray = [&V,&F](
-      const Eigen::Vector3f& _s,
-      const Eigen::Vector3f& dir)->bool
-    {
-      Eigen::Vector3f s = _s+1e-4*dir;
-      igl::Hit hit;
-      return ray_mesh_intersect(s,dir,V,F,hit);
-    };
-    return ambient_occlusion(shoot_ray,P,N,num_samples,S);
-  }
-  AABB<DerivedV,3> aabb;
-  aabb.init(V,F);
-  return ambient_occlusion(aabb,V,F,P,N,num_samples,S);
+  RayBVH bvh;
+  bvh.init(V,F);
+  return ambient_occlusion(bvh,P,N,num_samples,S);
 }
 
 #ifdef IGL_STATIC_LIBRARY
@@ -9,6 +9,7 @@
 #define IGL_AMBIENT_OCCLUSION_H
 #include "igl_inline.h"
 #include "AABB.h"
+#include "RayBVH.h"
 #include <Eigen/Core>
 #include <functional>
 namespace igl
@@ -56,6 +57,19 @@ namespace igl
     const int num_samples,
     Eigen::PlainObjectBase<DerivedS> & S);
   // Inputs:
+  //   bvh  ray tracing hierarchy around the mesh. The samples of each point
+  //     are traced together as packets of rays from a common origin.
+  template <
+    typename DerivedP,
+    typename DerivedN,
+    typename DerivedS >
+  IGL_INLINE void ambient_occlusion(
+    const igl::RayBVH & bvh,
+    const Eigen::PlainObjectBase<DerivedP> & P,
+    const Eigen::PlainObjectBase<DerivedN> & N,
+    const int num_samples,
+    Eigen::PlainObjectBase<DerivedS> & S);
+  // Inputs:
   //    V  #V by 3 list of mesh vertex positions
   //    F  #F by 3 list of mesh face indices into V
   template <
@@ -26,7 +26,15 @@
 #include "marching_cubes.h"
 #include "marching_cubes_tables.h"
 
+#include "../parallel_for.h"
+#include "../default_num_threads.h"
+#include "../sparse_voxel_grid.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <unordered_map>
+#include <vector>
 
 
 extern const int edgeTable[256];
@@ -62,33 +70,50 @@ class MarchingCubes
   typedef std::unordered_map<EdgeKey, unsigned, EdgeHash> MyMap;
   typedef typename MyMap::const_iterator                  MyMapIterator;
 
-public:
-  // Dense index grid version
-  MarchingCubes(const Eigen::MatrixBase<DerivedValues> &values,
-                const Eigen::MatrixBase<DerivedPoints> &points,
-                const unsigned x_res,
-                const unsigned y_res,
-                const unsigned z_res,
-                const double isovalue,
-                Eigen::PlainObjectBase<DerivedVertices> &vertices,
-                Eigen::PlainObjectBase<DerivedFaces> &faces)
-  {
-    assert(values.cols() == 1);
-    assert(points.cols() == 3);
-
-    if(x_res <2 || y_res<2 ||z_res<2)
-      return;
-    faces.resize(10000,3);
-    int num_faces = 0;
-
-    vertices.resize(10000,3);
-    int num_vertices = 0;
+  typedef typename DerivedVertices::Scalar VertexScalar;
 
+  // Part of the dense grid extracted by one thread
+  struct Slab
+  {
+    // Range of z-layers of cubes [z_begin, z_end)
+    unsigned z_begin, z_end;
+    // Vertex positions (x,y,z per vertex) and triangles in local indices
+    std::vector<VertexScalar> V;
+    std::vector<int> F;
+    // Local index of the vertex on each x- and y-edge of the bottom and of the
+    // top plane of the slab, -1 if there is none. The edges leaving grid point
+    // x + y*x_res are stored at 2*(x + y*x_res) (x-edge) and the entry after
+    // it (y-edge).
+    std::vector<int> bottom, top;
+    // Index into the concatenated output of each local vertex
+    std::vector<int> global;
+  };
 
-    unsigned n_cubes  = (x_res-1) * (y_res-1) * (z_res-1);
-    assert(unsigned(points.rows()) == x_res * y_res * z_res);
+  // Minimum number of layers per slab
+  static const unsigned min_slab_layers = 4;
 
-    unsigned int         offsets_[8];
+  static void extract_slab(const Eigen::MatrixBase<DerivedValues> &values,
+                           const Eigen::MatrixBase<DerivedPoints> &points,
+                           const unsigned x_res,
+                           const unsigned y_res,
+                           const double isovalue,
+                           Slab &slab)
+  {
+    // For each cube edge: its two corners, the array indexing it (0: x- and
+    // y-edges of the lower plane, 1: of the upper plane, 2: z-edges) and its
+    // slot relative to the cube's first corner in that array
+    static const int edge_corners[12][2] = {
+      {0,1}, {1,2}, {3,2}, {0,3}, {4,5}, {5,6}, {7,6}, {4,7},
+      {0,4}, {1,5}, {2,6}, {3,7}};
+    static const int edge_array[12] = {0,0,0,0, 1,1,1,1, 2,2,2,2};
+    const int plane = int(x_res*y_res);
+    const int x_edge = 0, y_edge = 1;
+    const int edge_slot[12] = {
+      x_edge, 2+y_edge, 2*int(x_res)+x_edge, y_edge,
+      x_edge, 2+y_edge, 2*int(x_res)+x_edge, y_edge,
+      0, 1, 1+int(x_res), int(x_res)};
+
+    unsigned int offsets_[8];
     offsets_[0] = 0;
     offsets_[1] = 1;
     offsets_[2] = 1 + x_res;
@@ -98,91 +123,176 @@ public:
     offsets_[6] = 1 + x_res + x_res*y_res;
     offsets_[7] =     x_res + x_res*y_res;
 
-    for (unsigned cube_it =0 ; cube_it < n_cubes; ++cube_it)
+    // The bottom plane is kept for the merge, the other plane arrays rotate
+    std::vector<int> upper(2*plane,-1), spare, z_edges(plane);
+    slab.bottom.assign(2*plane,-1);
+    std::vector<int> *lower_plane = &slab.bottom, *upper_plane = &upper;
+    for (unsigned z=slab.z_begin; z<slab.z_end; ++z)
     {
-
-      unsigned         corner[8];
-      typename DerivedFaces::Scalar samples[12];
-      unsigned char    cubetype(0);
-      unsigned int     i;
-
-
-      // get point indices of corner vertices
-      for (i=0; i<8; ++i)
+      if (z > slab.z_begin)
       {
-        // get cube coordinates
-        unsigned int _idx = cube_it;
-        unsigned int X(x_res-1), Y(y_res-1);
-        unsigned int x = _idx % X;  _idx /= X;
-        unsigned int y = _idx % Y;  _idx /= Y;
-        unsigned int z = _idx;
-
-        // transform to point coordinates
-        _idx = x + y*x_res + z*x_res*y_res;
-
-        // add offset
-        corner[i] = _idx + offsets_[i];
+        std::vector<int> *next = lower_plane == &slab.bottom ? &spare : lower_plane;
+        lower_plane = upper_plane;
+        upper_plane = next;
+        upper_plane->assign(2*plane,-1);
       }
+      std::fill(z_edges.begin(), z_edges.end(), -1);
+      int *edge_arrays[3] = {lower_plane->data(), upper_plane->data(), z_edges.data()};
 
+      for (unsigned y=0; y<y_res-1; ++y)
+      {
+        for (unsigned x=0; x<x_res-1; ++x)
+        {
+          const unsigned base = x + y*x_res;
+          const unsigned first = base + z*x_res*y_res;
+          unsigned char cubetype(0);
+
+          // determine cube type
+          for (int i=0; i<8; ++i)
+            if (values(first + offsets_[i]) > isovalue)
+              cubetype |= (1<<i);
+
+          // trivial reject ?
+          if (cubetype == 0 || cubetype == 255)
+            continue;
+
+          // compute samples on cube's edges
+          int samples[12];
+          for (int e=0; e<12; ++e)
+          {
+            if (!(edgeTable[cubetype] & (1<<e)))
+              continue;
+            const int slot = (edge_array[e] == 2 ? 1 : 2)*base + edge_slot[e];
+            int &v = edge_arrays[edge_array[e]][slot];
+            if (v < 0)
+            {
+              const unsigned i0 = first + offsets_[edge_corners[e][0]];
+              const unsigned i1 = first + offsets_[edge_corners[e][1]];
+              v = int(slab.V.size()/3);
+              interpolate(values, points, i0, i1, slab.V);
+            }
+            samples[e] = v;
+          }
+
+          // connect samples by triangles
+          for (int i=0; triTable[cubetype][0][i] != -1; ++i)
+            slab.F.push_back(samples[triTable[cubetype][0][i]]);
+        }
+      }
+    }
+    slab.top = std::move(*upper_plane);
+  }
 
-      // determine cube type
-      for (i=0; i<8; ++i)
-        if (values(corner[i]) > isovalue)
-          cubetype |= (1<<i);
+  // Append the point where the isosurface crosses the grid edge (i0,i1) to V
+  static void interpolate(const Eigen::MatrixBase<DerivedValues> &values,
+                          const Eigen::MatrixBase<DerivedPoints> &points,
+                          unsigned int i0,
+                          unsigned int i1,
+                          std::vector<VertexScalar> &V)
+  {
+    const Eigen::Matrix<typename DerivedPoints::Scalar, 1, 3> & p0 = points.row(i0);
+    const Eigen::Matrix<typename DerivedPoints::Scalar, 1, 3> & p1 = points.row(i1);
 
+    typename DerivedValues::Scalar s0 = fabs(values[i0]);
+    typename DerivedValues::Scalar s1 = fabs(values[i1]);
+    typename DerivedValues::Scalar t  = s0 / (s0+s1);
 
-      // trivial reject ?
-      if (cubetype == 0 || cubetype == 255)
-        continue;
+    // Linear interpolation based on linearly interpolating values
+    const Eigen::Matrix<VertexScalar, 1, 3> p = ((1.0f-t)*p0 + t*p1).template cast<VertexScalar>();
+    V.insert(V.end(), p.data(), p.data()+3);
+  }
 
+public:
+  // Dense index grid version
+  //
+  // The cubes are cut into slabs of whole z-layers which are extracted
+  // concurrently. Instead of hashing edges, each slab indexes the vertices on
+  // the x- and y-edges of the two grid planes bounding its current layer and
+  // on the z-edges of the layer in flat arrays. A vertex on the plane shared by
+  // two slabs is generated by both; the copy of the upper slab is dropped when
+  // the slabs are concatenated in order, so the output is the same as that of
+  // a serial sweep over the cubes.
+  MarchingCubes(const Eigen::MatrixBase<DerivedValues> &values,
+                const Eigen::MatrixBase<DerivedPoints> &points,
+                const unsigned x_res,
+                const unsigned y_res,
+                const unsigned z_res,
+                const double isovalue,
+                Eigen::PlainObjectBase<DerivedVertices> &vertices,
+                Eigen::PlainObjectBase<DerivedFaces> &faces)
+  {
+    assert(values.cols() == 1);
+    assert(points.cols() == 3);
 
-      // compute samples on cube's edges
-      if (edgeTable[cubetype]&1)
-        samples[0]  = add_vertex(values, points, corner[0], corner[1], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&2)
-        samples[1]  = add_vertex(values, points, corner[1], corner[2], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&4)
-        samples[2]  = add_vertex(values, points, corner[3], corner[2], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&8)
-        samples[3]  = add_vertex(values, points, corner[0], corner[3], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&16)
-        samples[4]  = add_vertex(values, points, corner[4], corner[5], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&32)
-        samples[5]  = add_vertex(values, points, corner[5], corner[6], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&64)
-        samples[6]  = add_vertex(values, points, corner[7], corner[6], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&128)
-        samples[7]  = add_vertex(values, points, corner[4], corner[7], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&256)
-        samples[8]  = add_vertex(values, points, corner[0], corner[4], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&512)
-        samples[9]  = add_vertex(values, points, corner[1], corner[5], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&1024)
-        samples[10] = add_vertex(values, points, corner[2], corner[6], vertices, num_vertices, edge2vertex);
-      if (edgeTable[cubetype]&2048)
-        samples[11] = add_vertex(values, points, corner[3], corner[7], vertices, num_vertices, edge2vertex);
+    if(x_res <2 || y_res<2 ||z_res<2)
+      return;
+    assert(unsigned(points.rows()) == x_res * y_res * z_res);
 
+    const unsigned n_layers = z_res-1;
+    // A few slabs per thread balance layers of uneven cost
+    const unsigned n_slabs = std::max(1u,
+      std::min(n_layers/min_slab_layers, 4*igl::default_num_threads()));
+    std::vector<Slab> slabs(n_slabs);
+    for (unsigned s=0; s<n_slabs; ++s)
+    {
+      slabs[s].z_begin = unsigned(uint64_t(n_layers)*s/n_slabs);
+      slabs[s].z_end   = unsigned(uint64_t(n_layers)*(s+1)/n_slabs);
+    }
+    igl::parallel_for(n_slabs, [&](const int s)
+    {
+      extract_slab(values, points, x_res, y_res, isovalue, slabs[s]);
+    }, 2);
 
+    // Vertices of a slab's bottom plane duplicate those of the previous top
+    std::vector<int> vertex_offset(n_slabs+1,0), face_offset(n_slabs+1,0);
+    for (unsigned s=0; s<n_slabs; ++s)
+    {
+      int n_dup = 0;
+      if (s > 0)
+        n_dup = std::count_if(slabs[s].bottom.begin(), slabs[s].bottom.end(),
+          [](const int v){ return v >= 0; });
+      vertex_offset[s+1] = vertex_offset[s] + int(slabs[s].V.size()/3) - n_dup;
+      face_offset[s+1]   = face_offset[s]   + int(slabs[s].F.size()/3);
+    }
 
-      // connect samples by triangles
-      for (i=0; triTable[cubetype][0][i] != -1; i+=3 )
+    // Global indices of the vertices each slab owns
+    igl::parallel_for(n_slabs, [&](const int s)
+    {
+      Slab & slab = slabs[s];
+      slab.global.assign(slab.V.size()/3, 0);
+      if (s > 0)
+        for (const int v : slab.bottom)
+          if (v >= 0)
+            slab.global[v] = -1;
+      int next = vertex_offset[s];
+      for (int & g : slab.global)
+        if (g == 0)
+          g = next++;
+    }, 2);
+
+    vertices.resize(vertex_offset[n_slabs], 3);
+    faces.resize(face_offset[n_slabs], 3);
+    igl::parallel_for(n_slabs, [&](const int s)
+    {
+      Slab & slab = slabs[s];
+      if (s > 0)
       {
-        num_faces++;
-        if (num_faces > faces.rows())
-          faces.conservativeResize(faces.rows()+10000, Eigen::NoChange);
-
-        faces.row(num_faces-1) <<
-        samples[triTable[cubetype][0][i  ]],
-        samples[triTable[cubetype][0][i+1]],
-        samples[triTable[cubetype][0][i+2]];
-
+        const Slab & below = slabs[s-1];
+        for (size_t e=0; e<slab.bottom.size(); ++e)
+          if (slab.bottom[e] >= 0)
+          {
+            assert(below.top[e] >= 0);
+            slab.global[slab.bottom[e]] = below.global[below.top[e]];
+          }
       }
-
-    }
-
-    vertices.conservativeResize(num_vertices, Eigen::NoChange);
-    faces.conservativeResize(num_faces, Eigen::NoChange);
-
+      for (size_t v=0; v<slab.global.size(); ++v)
+        if (slab.global[v] >= vertex_offset[s])
+          for (int c=0; c<3; ++c)
+            vertices(slab.global[v],c) = slab.V[3*v+c];
+      for (size_t f=0; f<slab.F.size()/3; ++f)
+        for (int c=0; c<3; ++c)
+          faces(face_offset[s]+f,c) = slab.global[slab.F[3*f+c]];
+    }, 2);
   }
 
   // Sparse index grid version
@@ -379,6 +489,23 @@ IGL_INLINE void igl::copyleft::marching_cubes(
   MarchingCubes<DerivedValues, DerivedPoints, DerivedVertices, DerivedIndices, DerivedFaces> mc(values, points, indices, 0.0 /*isovalue*/, vertices, faces);
 }
 
+template <typename DerivedP0, typename Func, typename DerivedVertices, typename DerivedFaces>
+IGL_INLINE void igl::copyleft::marching_cubes(
+  const Eigen::MatrixBase<DerivedP0> &p0,
+  const Func &scalarFunc,
+  const double eps,
+  const int expected_number_of_cubes,
+  Eigen::PlainObjectBase<DerivedVertices> &vertices,
+  Eigen::PlainObjectBase<DerivedFaces> &faces)
+{
+  typedef typename DerivedVertices::Scalar Scalar;
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> CS;
+  Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> CV;
+  Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> CI;
+  igl::sparse_voxel_grid(p0, scalarFunc, eps, expected_number_of_cubes, CS, CV, CI);
+  igl::copyleft::marching_cubes(CS, CV, CI, 0.0 /*isovalue*/, vertices, faces);
+}
+
 #ifdef IGL_STATIC_LIBRARY
 // Explicit template instantiation
 
@@ -399,4 +526,5 @@ template void igl::copyleft::marching_cubes<Eigen::Matrix<double, -1, 1, 0, -1,
 template void igl::copyleft::marching_cubes<Eigen::Matrix<double, -1, 1, 0, -1, 1>,Eigen::Matrix<double, -1, -1, 0, -1, -1>,Eigen::Matrix<double, -1, -1, 0, -1, -1>,Eigen::Matrix<int, -1, -1, 0, -1, -1>,Eigen::Matrix<int, -1, 3, 0, -1, 3> >(const Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&,const Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&,const Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&,Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&,Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 3, 0, -1, 3> >&);
 template void igl::copyleft::marching_cubes<Eigen::Matrix<double, -1, 1, 0, -1, 1>,Eigen::Matrix<double, -1, -1, 0, -1, -1>,Eigen::Matrix<double, -1, -1, 0, -1, -1>,Eigen::Matrix<int, -1, 8, 0, -1, 8>,Eigen::Matrix<int, -1, 3, 0, -1, 3> >(const Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&,const Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&,const Eigen::MatrixBase<Eigen::Matrix<int, -1, 8, 0, -1, 8> >&,Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&,Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 3, 0, -1, 3> >&);
 template void igl::copyleft::marching_cubes<Eigen::Matrix<double, -1, 1, 0, -1, 1>,Eigen::Matrix<double, -1, 3, 0, -1, 3>,Eigen::Matrix<double, -1, 3, 0, -1, 3>,Eigen::Matrix<int, -1, 8, 0, -1, 8>,Eigen::Matrix<int, -1, 3, 0, -1, 3> >(const Eigen::MatrixBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&,const Eigen::MatrixBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&,const Eigen::MatrixBase<Eigen::Matrix<int, -1, 8, 0, -1, 8> >&,Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&,Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 3, 0, -1, 3> >&);
+template void igl::copyleft::marching_cubes<Eigen::Matrix<double, 1, 3, 1, 1, 3>, std::function<double (Eigen::Matrix<double, 1, 3, 1, 1, 3> const&)>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> > const&, std::function<double (Eigen::Matrix<double, 1, 3, 1, 1, 3> const&)> const&, double, int, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
 #endif
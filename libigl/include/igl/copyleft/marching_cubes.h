@@ -39,6 +39,9 @@ namespace igl
     //   vertices  #V by 3 list of mesh vertex positions
     //   faces  #F by 3 list of mesh triangle indices
     //
+    // Slabs of z-layers are extracted in parallel (see igl::parallel_for); the
+    // output does not depend on the number of threads.
+    //
     template <typename DerivedValues, typename DerivedPoints, typename DerivedVertices, typename DerivedFaces>
     IGL_INLINE void marching_cubes(
         const Eigen::MatrixBase<DerivedValues> &values,
@@ -101,6 +104,32 @@ namespace igl
       Eigen::PlainObjectBase<DerivedVertices> &vertices,
       Eigen::PlainObjectBase<DerivedFaces> &faces);
 
+    // marching_cubes( p0, scalarFunc, eps, expected_number_of_cubes, vertices, faces )
+    //
+    // Sparse mode: reconstruct the zero level set of scalarFunc evaluating it
+    // only near the surface. The cubes crossing the surface are found with
+    // igl::sparse_voxel_grid by growing a shell of cubes from p0, so only the
+    // connected part of the surface through p0 is reconstructed.
+    //
+    // Input:
+    //  p0  1 by 3 point on the surface (scalarFunc(p0) = 0)
+    //  scalarFunc  function from a 1 by 3 point to a scalar (<0 inside the
+    //    surface, 0 on the border, >0 outside)
+    //  eps  edge length of the cubes
+    //  expected_number_of_cubes  number of cubes to allocate space for
+    // Output:
+    //   vertices  #V by 3 list of mesh vertex positions
+    //   faces  #F by 3 list of mesh triangle indices
+    //
+    template <typename DerivedP0, typename Func, typename DerivedVertices, typename DerivedFaces>
+    IGL_INLINE void marching_cubes(
+      const Eigen::MatrixBase<DerivedP0> &p0,
+      const Func &scalarFunc,
+      const double eps,
+      const int expected_number_of_cubes,
+      Eigen::PlainObjectBase<DerivedVertices> &vertices,
+      Eigen::PlainObjectBase<DerivedFaces> &faces);
+
   }
 
 }
@@ -0,0 +1,256 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "cotmatrix_massmatrix.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace igl
+{
+  namespace cotmatrix_massmatrix_helpers
+  {
+    // Compressed lists of the items k (in increasing order) mapped to each
+    // target: items of target i are item(start(i):start(i+1)-1)
+    inline void invert_map(
+      const std::vector<int> & target,
+      const int num_targets,
+      Eigen::VectorXi & start,
+      Eigen::VectorXi & item)
+    {
+      start = Eigen::VectorXi::Zero(num_targets+1);
+      for(const int t : target)
+      {
+        start(t+1)++;
+      }
+      for(int t = 0;t<num_targets;t++)
+      {
+        start(t+1) += start(t);
+      }
+      item.resize(target.size());
+      std::vector<int> next(start.data(),start.data()+num_targets);
+      for(int k = 0;k<(int)target.size();k++)
+      {
+        item(next[target[k]]++) = k;
+      }
+    }
+
+    // Index of (row,col) among the values of compressed column major X
+    template <typename Scalar>
+    inline int value_index(
+      const Eigen::SparseMatrix<Scalar> & X,
+      const int row,
+      const int col)
+    {
+      const int * begin = X.innerIndexPtr()+X.outerIndexPtr()[col];
+      const int * end = X.innerIndexPtr()+X.outerIndexPtr()[col+1];
+      const int * found = std::lower_bound(begin,end,row);
+      assert(found != end && *found == row);
+      return found - X.innerIndexPtr();
+    }
+
+    // Reset X to the pattern P unless it already has it
+    template <typename Scalar>
+    inline void match_pattern(
+      const Eigen::SparseMatrix<Scalar> & P,
+      Eigen::SparseMatrix<Scalar> & X)
+    {
+      if(X.rows() != P.rows() || X.cols() != P.cols() ||
+        !X.isCompressed() || X.nonZeros() != P.nonZeros())
+      {
+        X = P;
+      }
+    }
+  }
+}
+
+template <typename DerivedF, typename Scalar>
+IGL_INLINE void igl::cotmatrix_massmatrix_precompute(
+  const int n,
+  const Eigen::MatrixBase<DerivedF> & F,
+  cotmatrix_massmatrix_data<Scalar> & data)
+{
+  using namespace cotmatrix_massmatrix_helpers;
+  assert(F.cols() == 3 && "Only triangle meshes are supported");
+  const int m = F.rows();
+  data.n = n;
+  data.F = F.template cast<int>();
+  // Same edge order and triplet order as cotmatrix so that values are summed
+  // in the same order
+  const int edges[3][2] = {{1,2},{2,0},{0,1}};
+  std::vector<Eigen::Triplet<Scalar> > IJV;
+  IJV.reserve(m*12);
+  for(int f = 0;f<m;f++)
+  {
+    for(int e = 0;e<3;e++)
+    {
+      const int source = data.F(f,edges[e][0]);
+      const int dest = data.F(f,edges[e][1]);
+      IJV.emplace_back(source,dest,0);
+      IJV.emplace_back(dest,source,0);
+      IJV.emplace_back(source,source,0);
+      IJV.emplace_back(dest,dest,0);
+    }
+  }
+  data.L.resize(n,n);
+  data.L.setFromTriplets(IJV.begin(),IJV.end());
+  data.L.makeCompressed();
+  std::vector<int> slot(IJV.size());
+  igl::parallel_for(IJV.size(),[&](const size_t k)
+  {
+    slot[k] = value_index(data.L,IJV[k].row(),IJV[k].col());
+  },10000);
+  invert_map(slot,data.L.nonZeros(),data.L_start,data.L_contrib);
+
+  // Mass matrix: one diagonal entry per referenced vertex, corners ordered
+  // as in massmatrix
+  IJV.clear();
+  std::vector<int> corner_vertex(3*m);
+  for(int c = 0;c<3;c++)
+  {
+    for(int f = 0;f<m;f++)
+    {
+      corner_vertex[c*m+f] = data.F(f,c);
+      IJV.emplace_back(data.F(f,c),data.F(f,c),0);
+    }
+  }
+  data.M.resize(n,n);
+  data.M.setFromTriplets(IJV.begin(),IJV.end());
+  data.M.makeCompressed();
+  invert_map(corner_vertex,n,data.M_start,data.M_corner);
+}
+
+template <typename DerivedV, typename Scalar>
+IGL_INLINE void igl::cotmatrix_massmatrix(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const MassMatrixType type,
+  const cotmatrix_massmatrix_data<Scalar> & data,
+  Eigen::SparseMatrix<Scalar> & L,
+  Eigen::SparseMatrix<Scalar> & M)
+{
+  using namespace cotmatrix_massmatrix_helpers;
+  assert(V.rows() == data.n && "V does not match precomputed data");
+  assert(type != MASSMATRIX_TYPE_FULL && "Not supported");
+  const Eigen::MatrixXi & F = data.F;
+  const int m = F.rows();
+  const bool voronoi = type != MASSMATRIX_TYPE_BARYCENTRIC;
+  const bool mass = &L != &M;
+  // Per face cotangent weights (as cotmatrix_entries) and corner areas (as
+  // massmatrix), one pass
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3,Eigen::RowMajor> C(m,3);
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3> A(mass?m:0,3);
+  igl::parallel_for(m,[&](const int f)
+  {
+    Scalar l2[3],l[3];
+    for(int e = 0;e<3;e++)
+    {
+      l2[e] = (V.row(F(f,(e+1)%3))-V.row(F(f,(e+2)%3))).squaredNorm();
+      l[e] = std::sqrt(l2[e]);
+    }
+    // Kahan's Heron's formula on sorted lengths, see doublearea
+    Scalar s[3] = {l[0],l[1],l[2]};
+    std::sort(s,s+3,[](const Scalar a,const Scalar b){ return a>b; });
+    const Scalar arg =
+      (s[0]+(s[1]+s[2]))*
+      (s[2]-(s[0]-s[1]))*
+      (s[2]+(s[0]-s[1]))*
+      (s[0]+(s[1]-s[2]));
+    Scalar dblA = 2.0*0.25*std::sqrt(arg);
+    if(dblA != dblA)
+    {
+      dblA = 0;
+    }
+    C(f,0) = (l2[1] + l2[2] - l2[0])/dblA/4.0;
+    C(f,1) = (l2[2] + l2[0] - l2[1])/dblA/4.0;
+    C(f,2) = (l2[0] + l2[1] - l2[2])/dblA/4.0;
+    if(!mass)
+    {
+      return;
+    }
+    if(!voronoi)
+    {
+      A(f,0) = A(f,1) = A(f,2) = dblA/6.0;
+      return;
+    }
+    Scalar cosines[3],partial[3];
+    for(int e = 0;e<3;e++)
+    {
+      const Scalar a = l[(e+1)%3];
+      const Scalar b = l[(e+2)%3];
+      cosines[e] = (b*b+a*a-l[e]*l[e])/(a*b*2.0);
+      partial[e] = cosines[e]*l[e];
+    }
+    // Same summation order as normalize_row_sums
+    const Scalar sum = partial[0]+(partial[1]+partial[2]);
+    for(int e = 0;e<3;e++)
+    {
+      partial[e] = partial[e]/sum*(dblA*0.5);
+    }
+    A(f,0) = (partial[1]+partial[2])*0.5;
+    A(f,1) = (partial[2]+partial[0])*0.5;
+    A(f,2) = (partial[0]+partial[1])*0.5;
+    // Obtuse triangles
+    for(int e = 0;e<3;e++)
+    {
+      if(cosines[e] < 0)
+      {
+        A(f,0) = 0.125*dblA;
+        A(f,1) = 0.125*dblA;
+        A(f,2) = 0.125*dblA;
+        A(f,e) = 0.25*dblA;
+      }
+    }
+  },1000);
+
+  // Gather: every nonzero sums its own contributions, no write conflicts
+  match_pattern(data.L,L);
+  Scalar * Lv = L.valuePtr();
+  igl::parallel_for(data.L.nonZeros(),[&](const int k)
+  {
+    Scalar v = 0;
+    for(int c = data.L_start(k);c<data.L_start(k+1);c++)
+    {
+      const int contrib = data.L_contrib(c);
+      const Scalar w = C.data()[contrib/4];
+      v += contrib%4 < 2 ? w : -w;
+    }
+    Lv[k] = v;
+  },10000);
+  if(!mass)
+  {
+    return;
+  }
+  match_pattern(data.M,M);
+  Scalar * Mv = M.valuePtr();
+  const int * Mi = M.innerIndexPtr();
+  igl::parallel_for(data.M.nonZeros(),[&](const int k)
+  {
+    const int i = Mi[k];
+    Scalar v = 0;
+    for(int c = data.M_start(i);c<data.M_start(i+1);c++)
+    {
+      v += A.data()[data.M_corner(c)];
+    }
+    Mv[k] = v;
+  },10000);
+}
+
+template <typename DerivedV, typename Scalar>
+IGL_INLINE void igl::cotmatrix_massmatrix(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const cotmatrix_massmatrix_data<Scalar> & data,
+  Eigen::SparseMatrix<Scalar> & L)
+{
+  // Passing L twice skips the mass matrix
+  return cotmatrix_massmatrix(V,MASSMATRIX_TYPE_VORONOI,data,L,L);
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template void igl::cotmatrix_massmatrix_precompute<Eigen::Matrix<int, -1, -1, 0, -1, -1>, double>(int, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::cotmatrix_massmatrix_data<double>&);
+template void igl::cotmatrix_massmatrix<Eigen::Matrix<double, -1, -1, 0, -1, -1>, double>(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, igl::MassMatrixType, igl::cotmatrix_massmatrix_data<double> const&, Eigen::SparseMatrix<double, 0, int>&, Eigen::SparseMatrix<double, 0, int>&);
+template void igl::cotmatrix_massmatrix<Eigen::Matrix<double, -1, -1, 0, -1, -1>, double>(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, igl::cotmatrix_massmatrix_data<double> const&, Eigen::SparseMatrix<double, 0, int>&);
+#endif
@@ -0,0 +1,94 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_COTMATRIX_MASSMATRIX_H
+#define IGL_COTMATRIX_MASSMATRIX_H
+#include "igl_inline.h"
+#include "massmatrix.h"
+
+#define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+namespace igl
+{
+  template <typename Scalar>
+  struct cotmatrix_massmatrix_data;
+  // Precompute the sparsity patterns of cotmatrix and massmatrix for a fixed
+  // triangle mesh connectivity, so that repeated assembly for changing vertex
+  // positions only refills values (no triplet sorting, see sparse_cached).
+  //
+  // Inputs:
+  //   n  number of vertices
+  //   F  #F by 3 list of triangle indices into rows of V
+  // Outputs:
+  //   data  precomputed patterns and scatter maps
+  //
+  // See also: cotmatrix, massmatrix, sparse_cached
+  template <typename DerivedF, typename Scalar>
+  IGL_INLINE void cotmatrix_massmatrix_precompute(
+    const int n,
+    const Eigen::MatrixBase<DerivedF> & F,
+    cotmatrix_massmatrix_data<Scalar> & data);
+  // Assemble the cotangent Laplacian and the mass matrix of (V,F) with
+  // F fixed by cotmatrix_massmatrix_precompute. Cotangent weights and
+  // corner areas are computed in a single parallel pass over the faces,
+  // then each nonzero gathers its contributions in parallel. Values match
+  // cotmatrix(V,F,L) and massmatrix(V,F,type,M) up to round-off (the
+  // summation order is the same).
+  //
+  // Inputs:
+  //   V  #V by dim list of mesh vertex positions
+  //   type  MASSMATRIX_TYPE_BARYCENTRIC or MASSMATRIX_TYPE_VORONOI
+  //     (MASSMATRIX_TYPE_DEFAULT is voronoi)
+  //   data  precomputed patterns
+  //   L  if L has the pattern of a previous call, only its values are
+  //     overwritten
+  //   M  same as L
+  // Outputs:
+  //   L  #V by #V cotangent matrix, see cotmatrix
+  //   M  #V by #V diagonal mass matrix, see massmatrix
+  template <typename DerivedV, typename Scalar>
+  IGL_INLINE void cotmatrix_massmatrix(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const MassMatrixType type,
+    const cotmatrix_massmatrix_data<Scalar> & data,
+    Eigen::SparseMatrix<Scalar> & L,
+    Eigen::SparseMatrix<Scalar> & M);
+  // Same as above, only assembling the cotangent Laplacian
+  template <typename DerivedV, typename Scalar>
+  IGL_INLINE void cotmatrix_massmatrix(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const cotmatrix_massmatrix_data<Scalar> & data,
+    Eigen::SparseMatrix<Scalar> & L);
+}
+
+template <typename Scalar>
+struct igl::cotmatrix_massmatrix_data
+{
+  // Number of vertices
+  int n;
+  // #F by 3 triangles
+  Eigen::MatrixXi F;
+  // Compressed patterns with zero values
+  Eigen::SparseMatrix<Scalar> L;
+  Eigen::SparseMatrix<Scalar> M;
+  // Contributions to the k-th nonzero of L are the entries
+  // L_contrib(L_start(k):L_start(k+1)-1) of the 12 per face element
+  // contributions (f*12 + edge*4 + {off-diagonal x2, diagonal x2})
+  Eigen::VectorXi L_start;
+  Eigen::VectorXi L_contrib;
+  // Corners c*#F+f incident on vertex i are
+  // M_corner(M_start(i):M_start(i+1)-1)
+  Eigen::VectorXi M_start;
+  Eigen::VectorXi M_corner;
+  cotmatrix_massmatrix_data():n(0){}
+};
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "cotmatrix_massmatrix.cpp"
+#endif
+
+#endif
@@ -15,6 +15,9 @@
 #include "connect_boundary_to_infinity.h"
 #include "max_faces_stopping_condition.h"
 #include "shortest_edge_and_midpoint.h"
+#include <functional>
+#include <tuple>
+#include <vector>
 
 IGL_INLINE bool igl::decimate(
   const Eigen::MatrixXd & V,
@@ -74,31 +77,8 @@ IGL_INLINE bool igl::decimate(
 IGL_INLINE bool igl::decimate(
   const Eigen::MatrixXd & OV,
   const Eigen::MatrixXi & OF,
-  const std::function<void(
-    const int,
-    const Eigen::MatrixXd &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::VectorXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    double &,
-    Eigen::RowVectorXd &)> & cost_and_placement,
-  const std::function<bool(
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const std::set<std::pair<double,int> > &,
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,
-      const Eigen::MatrixXd &,
-      const int,
-      const int,
-      const int,
-      const int,
-      const int)> & stopping_condition,
+  const decimate_cost_and_placement_callback & cost_and_placement,
+  const decimate_stopping_condition_callback & stopping_condition,
   Eigen::MatrixXd & U,
   Eigen::MatrixXi & G,
   Eigen::VectorXi & J,
@@ -112,8 +92,8 @@ IGL_INLINE bool igl::decimate(
     const Eigen::VectorXi &                                         ,/*EMAP*/
     const Eigen::MatrixXi &                                         ,/*EF*/
     const Eigen::MatrixXi &                                         ,/*EI*/
-    const std::set<std::pair<double,int> > &                        ,/*Q*/
-    const std::vector<std::set<std::pair<double,int> >::iterator > &,/*Qit*/
+    const decimate_queue &                                          ,/*Q*/
+    const Eigen::VectorXi &                                         ,/*EQ*/
     const Eigen::MatrixXd &                                         ,/*C*/
     const int                                                        /*e*/
     ) -> bool { return true;};
@@ -124,8 +104,8 @@ IGL_INLINE bool igl::decimate(
     const Eigen::VectorXi &                                         ,/*EMAP*/
     const Eigen::MatrixXi &                                         ,  /*EF*/
     const Eigen::MatrixXi &                                         ,  /*EI*/
-    const std::set<std::pair<double,int> > &                        ,   /*Q*/
-    const std::vector<std::set<std::pair<double,int> >::iterator > &, /*Qit*/
+    const decimate_queue &                                          ,   /*Q*/
+    const Eigen::VectorXi &                                         ,  /*EQ*/
     const Eigen::MatrixXd &                                         ,   /*C*/
     const int                                                       ,   /*e*/
     const int                                                       ,  /*e1*/
@@ -141,60 +121,10 @@ IGL_INLINE bool igl::decimate(
 IGL_INLINE bool igl::decimate(
   const Eigen::MatrixXd & OV,
   const Eigen::MatrixXi & OF,
-  const std::function<void(
-    const int,
-    const Eigen::MatrixXd &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::VectorXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    double &,
-    Eigen::RowVectorXd &)> & cost_and_placement,
-  const std::function<bool(
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const std::set<std::pair<double,int> > &,
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,
-      const Eigen::MatrixXd &,
-      const int,
-      const int,
-      const int,
-      const int,
-      const int)> & stopping_condition,
-    const std::function<bool(
-      const Eigen::MatrixXd &                                         ,/*V*/
-      const Eigen::MatrixXi &                                         ,/*F*/
-      const Eigen::MatrixXi &                                         ,/*E*/
-      const Eigen::VectorXi &                                         ,/*EMAP*/
-      const Eigen::MatrixXi &                                         ,/*EF*/
-      const Eigen::MatrixXi &                                         ,/*EI*/
-      const std::set<std::pair<double,int> > &                        ,/*Q*/
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,/*Qit*/
-      const Eigen::MatrixXd &                                         ,/*C*/
-      const int                                                        /*e*/
-      )> & pre_collapse,
-    const std::function<void(
-      const Eigen::MatrixXd &                                         ,   /*V*/
-      const Eigen::MatrixXi &                                         ,   /*F*/
-      const Eigen::MatrixXi &                                         ,   /*E*/
-      const Eigen::VectorXi &                                         ,/*EMAP*/
-      const Eigen::MatrixXi &                                         ,  /*EF*/
-      const Eigen::MatrixXi &                                         ,  /*EI*/
-      const std::set<std::pair<double,int> > &                        ,   /*Q*/
-      const std::vector<std::set<std::pair<double,int> >::iterator > &, /*Qit*/
-      const Eigen::MatrixXd &                                         ,   /*C*/
-      const int                                                       ,   /*e*/
-      const int                                                       ,  /*e1*/
-      const int                                                       ,  /*e2*/
-      const int                                                       ,  /*f1*/
-      const int                                                       ,  /*f2*/
-      const bool                                                  /*collapsed*/
-      )> & post_collapse,
+  const decimate_cost_and_placement_callback & cost_and_placement,
+  const decimate_stopping_condition_callback & stopping_condition,
+    const decimate_pre_collapse_callback & pre_collapse,
+    const decimate_post_collapse_callback & post_collapse,
   Eigen::MatrixXd & U,
   Eigen::MatrixXi & G,
   Eigen::VectorXi & J,
@@ -217,60 +147,10 @@ IGL_INLINE bool igl::decimate(
 IGL_INLINE bool igl::decimate(
   const Eigen::MatrixXd & OV,
   const Eigen::MatrixXi & OF,
-  const std::function<void(
-    const int,
-    const Eigen::MatrixXd &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::VectorXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    double &,
-    Eigen::RowVectorXd &)> & cost_and_placement,
-  const std::function<bool(
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const std::set<std::pair<double,int> > &,
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,
-      const Eigen::MatrixXd &,
-      const int,
-      const int,
-      const int,
-      const int,
-      const int)> & stopping_condition,
-    const std::function<bool(
-      const Eigen::MatrixXd &                                         ,/*V*/
-      const Eigen::MatrixXi &                                         ,/*F*/
-      const Eigen::MatrixXi &                                         ,/*E*/
-      const Eigen::VectorXi &                                         ,/*EMAP*/
-      const Eigen::MatrixXi &                                         ,/*EF*/
-      const Eigen::MatrixXi &                                         ,/*EI*/
-      const std::set<std::pair<double,int> > &                        ,/*Q*/
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,/*Qit*/
-      const Eigen::MatrixXd &                                         ,/*C*/
-      const int                                                        /*e*/
-      )> & pre_collapse,
-    const std::function<void(
-      const Eigen::MatrixXd &                                         ,   /*V*/
-      const Eigen::MatrixXi &                                         ,   /*F*/
-      const Eigen::MatrixXi &                                         ,   /*E*/
-      const Eigen::VectorXi &                                         ,/*EMAP*/
-      const Eigen::MatrixXi &                                         ,  /*EF*/
-      const Eigen::MatrixXi &                                         ,  /*EI*/
-      const std::set<std::pair<double,int> > &                        ,   /*Q*/
-      const std::vector<std::set<std::pair<double,int> >::iterator > &, /*Qit*/
-      const Eigen::MatrixXd &                                         ,   /*C*/
-      const int                                                       ,   /*e*/
-      const int                                                       ,  /*e1*/
-      const int                                                       ,  /*e2*/
-      const int                                                       ,  /*f1*/
-      const int                                                       ,  /*f2*/
-      const bool                                                  /*collapsed*/
-      )> & post_collapse,
+  const decimate_cost_and_placement_callback & cost_and_placement,
+  const decimate_stopping_condition_callback & stopping_condition,
+    const decimate_pre_collapse_callback & pre_collapse,
+    const decimate_post_collapse_callback & post_collapse,
   const Eigen::MatrixXi & OE,
   const Eigen::VectorXi & OEMAP,
   const Eigen::MatrixXi & OEF,
@@ -292,46 +172,42 @@ IGL_INLINE bool igl::decimate(
   Eigen::VectorXi EMAP = OEMAP;
   Eigen::MatrixXi EF = OEF;
   Eigen::MatrixXi EI = OEI;
-  typedef std::set<std::pair<double,int> > PriorityQueue;
-  PriorityQueue Q;
-  std::vector<PriorityQueue::iterator > Qit;
-  Qit.resize(E.rows());
   // If an edge were collapsed, we'd collapse it to these points:
   MatrixXd C(E.rows(),V.cols());
+  // Initial costs, filled into the heap at once
+  std::vector<std::tuple<double,int,int> > costs(E.rows());
   for(int e = 0;e<E.rows();e++)
   {
     double cost = e;
     RowVectorXd p(1,3);
     cost_and_placement(e,V,F,E,EMAP,EF,EI,cost,p);
     C.row(e) = p;
-    Qit[e] = Q.insert(std::pair<double,int>(cost,e)).first;
+    costs[e] = std::make_tuple(cost,e,0);
   }
+  decimate_queue Q(std::greater<std::tuple<double,int,int> >(),std::move(costs));
+  Eigen::VectorXi EQ = Eigen::VectorXi::Zero(E.rows());
   int prev_e = -1;
   bool clean_finish = false;
 
   while(true)
   {
-    if(Q.empty())
-    {
-      break;
-    }
-    if(Q.begin()->first == std::numeric_limits<double>::infinity())
-    {
-      // min cost edge is infinite cost
-      break;
-    }
     int e,e1,e2,f1,f2;
     if(collapse_edge(
        cost_and_placement, pre_collapse, post_collapse,
-       V,F,E,EMAP,EF,EI,Q,Qit,C,e,e1,e2,f1,f2))
+       V,F,E,EMAP,EF,EI,Q,EQ,C,e,e1,e2,f1,f2))
     {
-      if(stopping_condition(V,F,E,EMAP,EF,EI,Q,Qit,C,e,e1,e2,f1,f2))
+      if(stopping_condition(V,F,E,EMAP,EF,EI,Q,EQ,C,e,e1,e2,f1,f2))
       {
         clean_finish = true;
         break;
       }
     }else
     {
+      if(e == -1)
+      {
+        // Q is empty or only holds infinite costs
+        break;
+      }
       if(prev_e == e)
       {
         assert(false && "Edge collapse no progress... bad stopping condition?");
@@ -0,0 +1,101 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_DECIMATE_CALLBACK_TYPES_H
+#define IGL_DECIMATE_CALLBACK_TYPES_H
+#include "min_heap.h"
+#include <Eigen/Core>
+#include <functional>
+#include <tuple>
+namespace igl
+{
+  // Priority queue of edge collapses used by decimate and collapse_edge:
+  // entries (cost,e,timestamp) where an entry is current only if its
+  // timestamp matches EQ(e) (EQ(e) = -1 for removed edges).
+  //
+  // Breaking change: callbacks used to receive the queue as
+  //   const std::set<std::pair<double,int> > & Q,
+  //   const std::vector<std::set<std::pair<double,int> >::iterator > & Qit
+  // and now receive
+  //   const igl::decimate_queue & Q,
+  //   const Eigen::VectorXi & EQ
+  // A set can not be kept in sync with the heap at no cost, so there is no
+  // overload for the old signature. Callbacks that only count or ignore the
+  // queue need the parameter types changed. Tests of Qit[e] == Q.end()
+  // become EQ(e) == -1, which holds for e, e1 and e2 after a successful
+  // collapse. The edge being collapsed keeps its timestamp while
+  // pre_collapse and post_collapse run (its entry is already popped), and
+  // an edge whose collapse failed is pushed back with a new timestamp.
+  // Q.size() now also counts stale entries.
+  typedef igl::min_heap< std::tuple<double,int,int> > decimate_queue;
+  // Function computing cost of collapsing edge e and the position where the
+  // merged vertex should be placed:
+  //   cost_and_placement(e,V,F,E,EMAP,EF,EI,cost,placement);
+  typedef std::function<void(
+    const int              /*e*/,
+    const Eigen::MatrixXd &/*V*/,
+    const Eigen::MatrixXi &/*F*/,
+    const Eigen::MatrixXi &/*E*/,
+    const Eigen::VectorXi &/*EMAP*/,
+    const Eigen::MatrixXi &/*EF*/,
+    const Eigen::MatrixXi &/*EI*/,
+    double &               /*cost*/,
+    Eigen::RowVectorXd &   /*p*/
+    )> decimate_cost_and_placement_callback;
+  // Function returning whether to stop collapsing edges, called after
+  // _successfully_ collapsing edge e removing edges (e,e1,e2) and faces
+  // (f1,f2):
+  //   should_stop = stopping_condition(V,F,E,EMAP,EF,EI,Q,EQ,C,e,e1,e2,f1,f2);
+  typedef std::function<bool(
+    const Eigen::MatrixXd &,/*V*/
+    const Eigen::MatrixXi &,/*F*/
+    const Eigen::MatrixXi &,/*E*/
+    const Eigen::VectorXi &,/*EMAP*/
+    const Eigen::MatrixXi &,/*EF*/
+    const Eigen::MatrixXi &,/*EI*/
+    const decimate_queue  &,/*Q*/
+    const Eigen::VectorXi &,/*EQ*/
+    const Eigen::MatrixXd &,/*C*/
+    const int              ,/*e*/
+    const int              ,/*e1*/
+    const int              ,/*e2*/
+    const int              ,/*f1*/
+    const int               /*f2*/
+    )> decimate_stopping_condition_callback;
+  // Function called with index of edge whose collapse is about to be
+  // attempted, returning whether to proceed with the collapse
+  typedef std::function<bool(
+    const Eigen::MatrixXd &,/*V*/
+    const Eigen::MatrixXi &,/*F*/
+    const Eigen::MatrixXi &,/*E*/
+    const Eigen::VectorXi &,/*EMAP*/
+    const Eigen::MatrixXi &,/*EF*/
+    const Eigen::MatrixXi &,/*EI*/
+    const decimate_queue  &,/*Q*/
+    const Eigen::VectorXi &,/*EQ*/
+    const Eigen::MatrixXd &,/*C*/
+    const int               /*e*/
+    )> decimate_pre_collapse_callback;
+  // Function called with index of edge whose collapse was just attempted and
+  // a flag revealing whether this was successful
+  typedef std::function<void(
+    const Eigen::MatrixXd &,/*V*/
+    const Eigen::MatrixXi &,/*F*/
+    const Eigen::MatrixXi &,/*E*/
+    const Eigen::VectorXi &,/*EMAP*/
+    const Eigen::MatrixXi &,/*EF*/
+    const Eigen::MatrixXi &,/*EI*/
+    const decimate_queue  &,/*Q*/
+    const Eigen::VectorXi &,/*EQ*/
+    const Eigen::MatrixXd &,/*C*/
+    const int              ,/*e*/
+    const int              ,/*e1*/
+    const int              ,/*e2*/
+    const int              ,/*f1*/
+    const int              ,/*f2*/
+    const bool              /*collapsed*/
+    )> decimate_post_collapse_callback;
+}
+#endif
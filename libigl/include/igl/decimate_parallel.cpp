@@ -0,0 +1,323 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "decimate_parallel.h"
+#include "circulation.h"
+#include "collapse_edge.h"
+#include "connect_boundary_to_infinity.h"
+#include "edge_flaps.h"
+#include "is_edge_manifold.h"
+#include "max_faces_stopping_condition.h"
+#include "parallel_for.h"
+#include "remove_unreferenced.h"
+#include "shortest_edge_and_midpoint.h"
+#include "slice.h"
+#include "slice_mask.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+IGL_INLINE bool igl::decimate_parallel(
+  const Eigen::MatrixXd & V,
+  const Eigen::MatrixXi & F,
+  const size_t max_m,
+  Eigen::MatrixXd & U,
+  Eigen::MatrixXi & G,
+  Eigen::VectorXi & J,
+  Eigen::VectorXi & I)
+{
+  // Same as decimate
+  const int orig_m = F.rows();
+  int m = F.rows();
+  Eigen::MatrixXd VO;
+  Eigen::MatrixXi FO;
+  igl::connect_boundary_to_infinity(V,F,VO,FO);
+  if(!is_edge_manifold(FO))
+  {
+    return false;
+  }
+  bool ret = decimate_parallel(
+    VO,
+    FO,
+    shortest_edge_and_midpoint,
+    max_faces_stopping_condition(m,orig_m,max_m),
+    U,
+    G,
+    J,
+    I);
+  const Eigen::Array<bool,Eigen::Dynamic,1> keep = (J.array()<orig_m);
+  igl::slice_mask(Eigen::MatrixXi(G),keep,1,G);
+  igl::slice_mask(Eigen::VectorXi(J),keep,1,J);
+  Eigen::VectorXi _1,I2;
+  igl::remove_unreferenced(Eigen::MatrixXd(U),Eigen::MatrixXi(G),U,G,_1,I2);
+  igl::slice(Eigen::VectorXi(I),I2,1,I);
+  return ret;
+}
+
+IGL_INLINE bool igl::decimate_parallel(
+  const Eigen::MatrixXd & OV,
+  const Eigen::MatrixXi & OF,
+  const decimate_cost_and_placement_callback & cost_and_placement,
+  const decimate_stopping_condition_callback & stopping_condition,
+  Eigen::MatrixXd & U,
+  Eigen::MatrixXi & G,
+  Eigen::VectorXi & J,
+  Eigen::VectorXi & I)
+{
+  const auto always_try = [](
+    const Eigen::MatrixXd &,/*V*/
+    const Eigen::MatrixXi &,/*F*/
+    const Eigen::MatrixXi &,/*E*/
+    const Eigen::VectorXi &,/*EMAP*/
+    const Eigen::MatrixXi &,/*EF*/
+    const Eigen::MatrixXi &,/*EI*/
+    const decimate_queue  &,/*Q*/
+    const Eigen::VectorXi &,/*EQ*/
+    const Eigen::MatrixXd &,/*C*/
+    const int               /*e*/
+    ) -> bool { return true;};
+  const auto never_care = [](
+    const Eigen::MatrixXd &,/*V*/
+    const Eigen::MatrixXi &,/*F*/
+    const Eigen::MatrixXi &,/*E*/
+    const Eigen::VectorXi &,/*EMAP*/
+    const Eigen::MatrixXi &,/*EF*/
+    const Eigen::MatrixXi &,/*EI*/
+    const decimate_queue  &,/*Q*/
+    const Eigen::VectorXi &,/*EQ*/
+    const Eigen::MatrixXd &,/*C*/
+    const int              ,/*e*/
+    const int              ,/*e1*/
+    const int              ,/*e2*/
+    const int              ,/*f1*/
+    const int              ,/*f2*/
+    const bool              /*collapsed*/
+    )-> void { };
+  Eigen::VectorXi EMAP;
+  Eigen::MatrixXi E,EF,EI;
+  edge_flaps(OF,E,EMAP,EF,EI);
+  return decimate_parallel(
+    OV,OF,
+    cost_and_placement,stopping_condition,always_try,never_care,
+    E,EMAP,EF,EI,
+    U,G,J,I);
+}
+
+IGL_INLINE bool igl::decimate_parallel(
+  const Eigen::MatrixXd & OV,
+  const Eigen::MatrixXi & OF,
+  const decimate_cost_and_placement_callback & cost_and_placement,
+  const decimate_stopping_condition_callback & stopping_condition,
+  const decimate_pre_collapse_callback & pre_collapse,
+  const decimate_post_collapse_callback & post_collapse,
+  const Eigen::MatrixXi & OE,
+  const Eigen::VectorXi & OEMAP,
+  const Eigen::MatrixXi & OEF,
+  const Eigen::MatrixXi & OEI,
+  Eigen::MatrixXd & U,
+  Eigen::MatrixXi & G,
+  Eigen::VectorXi & J,
+  Eigen::VectorXi & I)
+{
+  using namespace Eigen;
+  using namespace std;
+  typedef std::tuple<double,int,int> Entry;
+  // Working copies
+  MatrixXd V = OV;
+  MatrixXi F = OF;
+  MatrixXi E = OE;
+  VectorXi EMAP = OEMAP;
+  MatrixXi EF = OEF;
+  MatrixXi EI = OEI;
+  const int m = F.rows();
+  // Initial costs and placements
+  MatrixXd C(E.rows(),V.cols());
+  std::vector<Entry> costs(E.rows());
+  igl::parallel_for(E.rows(),[&](const int e)
+  {
+    double cost = e;
+    RowVectorXd p(1,3);
+    cost_and_placement(e,V,F,E,EMAP,EF,EI,cost,p);
+    C.row(e) = p;
+    costs[e] = std::make_tuple(cost,e,0);
+  },1000);
+  decimate_queue Q(std::greater<Entry>(),std::move(costs));
+  VectorXi EQ = VectorXi::Zero(E.rows());
+
+  // An edge kept for collapsing in the current round
+  struct Collapse
+  {
+    int e,e1,e2,f1,f2;
+    bool collapsed;
+    // Faces incident on either endpoint of e before the collapse
+    std::vector<int> N;
+    // New costs and placements of the edges of N after the collapse
+    std::vector<std::pair<int,double> > updated;
+    std::vector<Eigen::RowVectorXd> placements;
+  };
+  std::vector<Entry> candidates;
+  std::vector<std::vector<int> > rings;
+  std::vector<Collapse> collapses;
+  // Last round in which each face belonged to the one-ring of a kept edge
+  VectorXi claimed = VectorXi::Constant(m,-1);
+  int num_edges = E.rows();
+  bool clean_finish = false;
+  for(int round = 0;!clean_finish;round++)
+  {
+    // Cheapest current entries. Rounds cover a small fraction of the
+    // remaining edges so that collapses still follow the cost order closely.
+    const int max_candidates = std::max(128,num_edges/64);
+    candidates.clear();
+    while(!Q.empty() && (int)candidates.size()<max_candidates)
+    {
+      const Entry & top = Q.top();
+      if(std::get<0>(top) == std::numeric_limits<double>::infinity())
+      {
+        break;
+      }
+      if(std::get<2>(top) == EQ(std::get<1>(top)))
+      {
+        candidates.push_back(top);
+      }
+      Q.pop();
+    }
+    if(candidates.empty())
+    {
+      // Q is empty or only holds infinite costs
+      break;
+    }
+    rings.resize(candidates.size());
+    igl::parallel_for(candidates.size(),[&](const int c)
+    {
+      const int e = std::get<1>(candidates[c]);
+      rings[c] = circulation(e,true,F,E,EMAP,EF,EI);
+      const std::vector<int> Nd = circulation(e,false,F,E,EMAP,EF,EI);
+      rings[c].insert(rings[c].end(),Nd.begin(),Nd.end());
+    },64);
+    // Greedy independent set in cost order
+    collapses.clear();
+    for(int c = 0;c<(int)candidates.size();c++)
+    {
+      const std::vector<int> & N = rings[c];
+      if(std::any_of(N.begin(),N.end(),
+        [&](const int f){ return claimed(f) == round; }))
+      {
+        // Still current, retry next round
+        Q.push(candidates[c]);
+        continue;
+      }
+      for(const int f : N)
+      {
+        claimed(f) = round;
+      }
+      collapses.emplace_back();
+      collapses.back().e = std::get<1>(candidates[c]);
+      collapses.back().N.swap(rings[c]);
+    }
+
+    // Collapse concurrently: the one-rings are disjoint, so are all the
+    // entries of (V,F,E,EMAP,EF,EI) written by different edges. Edges on the
+    // border of two one-rings are updated by both, so placements are only
+    // stored in C afterwards.
+    igl::parallel_for(collapses.size(),[&](const int k)
+    {
+      Collapse & c = collapses[k];
+      c.e1 = c.e2 = c.f1 = c.f2 = -1;
+      c.collapsed = false;
+      if(pre_collapse(V,F,E,EMAP,EF,EI,Q,EQ,C,c.e))
+      {
+        c.collapsed = collapse_edge(
+          c.e,C.row(c.e),V,F,E,EMAP,EF,EI,c.e1,c.e2,c.f1,c.f2);
+      }
+      post_collapse(
+        V,F,E,EMAP,EF,EI,Q,EQ,C,c.e,c.e1,c.e2,c.f1,c.f2,c.collapsed);
+      c.updated.clear();
+      c.placements.clear();
+      if(!c.collapsed)
+      {
+        return;
+      }
+      std::vector<int> N_edges;
+      for(const int n : c.N)
+      {
+        if(F(n,0) != IGL_COLLAPSE_EDGE_NULL ||
+            F(n,1) != IGL_COLLAPSE_EDGE_NULL ||
+            F(n,2) != IGL_COLLAPSE_EDGE_NULL)
+        {
+          for(int v = 0;v<3;v++)
+          {
+            N_edges.push_back(EMAP(v*m+n));
+          }
+        }
+      }
+      // Interior edges of the one-ring are shared by two faces
+      std::sort(N_edges.begin(),N_edges.end());
+      N_edges.erase(std::unique(N_edges.begin(),N_edges.end()),N_edges.end());
+      for(const int ei : N_edges)
+      {
+        double cost;
+        RowVectorXd place;
+        cost_and_placement(ei,V,F,E,EMAP,EF,EI,cost,place);
+        c.updated.emplace_back(ei,cost);
+        c.placements.push_back(place);
+      }
+    },16);
+
+    // Update the queue and query the stopping condition in cost order
+    for(const Collapse & c : collapses)
+    {
+      if(c.collapsed)
+      {
+        EQ(c.e1) = -1;
+        EQ(c.e2) = -1;
+        num_edges -= 3;
+        for(int u = 0;u<(int)c.updated.size();u++)
+        {
+          const int ei = c.updated[u].first;
+          EQ(ei)++;
+          Q.emplace(c.updated[u].second,ei,EQ(ei));
+          C.row(ei) = c.placements[u];
+        }
+        // Keep querying after a stop so that stateful conditions (e.g.,
+        // max_faces_stopping_condition) account for the whole round
+        if(stopping_condition(
+          V,F,E,EMAP,EF,EI,Q,EQ,C,c.e,c.e1,c.e2,c.f1,c.f2))
+        {
+          clean_finish = true;
+        }
+      }else
+      {
+        // Same as collapse_edge: un-collapsable until a neighbor changes
+        EQ(c.e)++;
+        Q.emplace(std::numeric_limits<double>::infinity(),c.e,EQ(c.e));
+      }
+    }
+  }
+
+  // remove all IGL_COLLAPSE_EDGE_NULL faces
+  MatrixXi F2(F.rows(),3);
+  J.resize(F.rows());
+  int num_faces = 0;
+  for(int f = 0;f<F.rows();f++)
+  {
+    if(
+      F(f,0) != IGL_COLLAPSE_EDGE_NULL ||
+      F(f,1) != IGL_COLLAPSE_EDGE_NULL ||
+      F(f,2) != IGL_COLLAPSE_EDGE_NULL)
+    {
+      F2.row(num_faces) = F.row(f);
+      J(num_faces) = f;
+      num_faces++;
+    }
+  }
+  F2.conservativeResize(num_faces,F2.cols());
+  J.conservativeResize(num_faces);
+  VectorXi _1;
+  remove_unreferenced(V,F2,U,G,_1,I);
+  return clean_finish;
+}
@@ -0,0 +1,98 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_DECIMATE_PARALLEL_H
+#define IGL_DECIMATE_PARALLEL_H
+#include "igl_inline.h"
+#include "decimate_callback_types.h"
+#include <Eigen/Core>
+namespace igl
+{
+  // Parallel version of decimate: collapses edges in rounds. Each round pops
+  // the cheapest edges from the queue, greedily keeps those (in cost order)
+  // whose one-rings (faces incident on either endpoint) are disjoint from the
+  // one-rings of the edges already kept, and collapses the kept edges
+  // concurrently. Conflicting edges are put back in the queue for the next
+  // round. The result does not depend on the number of threads.
+  //
+  // Because a round is collapsed at once, the mesh can end up with a few more
+  // collapses than the point where stopping_condition first returns true
+  // (at most one round, which is a small fraction of the remaining edges).
+  //
+  // Inputs:
+  //   V  #V by dim list of vertex positions
+  //   F  #F by 3 list of face indices into V.
+  //   max_m  desired number of output faces
+  // Outputs:
+  //   U  #U by dim list of output vertex posistions (can be same ref as V)
+  //   G  #G by 3 list of output face indices into U (can be same ref as G)
+  //   J  #G list of indices into F of birth face
+  //   I  #U list of indices into V of birth vertices
+  // Returns true if m was reached (otherwise #G > m)
+  //
+  // See also: decimate
+  IGL_INLINE bool decimate_parallel(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    const size_t max_m,
+    Eigen::MatrixXd & U,
+    Eigen::MatrixXi & G,
+    Eigen::VectorXi & J,
+    Eigen::VectorXi & I);
+  // Assumes a **closed** manifold mesh, see decimate.
+  //
+  // Inputs:
+  //   cost_and_placement  function computing cost of collapsing an edge and 3d
+  //     position where it should be placed (see decimate_callback_types).
+  //     Called concurrently: it may only read E(e,:) and data of the two
+  //     endpoints of e, as shortest_edge_and_midpoint and the qslim callbacks
+  //     do.
+  //   stopping_condition  function returning whether to stop collapsing
+  //     edges, called serially after each successful collapse of a round in
+  //     cost order
+  IGL_INLINE bool decimate_parallel(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    const decimate_cost_and_placement_callback & cost_and_placement,
+    const decimate_stopping_condition_callback & stopping_condition,
+    Eigen::MatrixXd & U,
+    Eigen::MatrixXi & G,
+    Eigen::VectorXi & J,
+    Eigen::VectorXi & I);
+  // Inputs:
+  //   pre_collapse  callback called with index of edge whose collapse is about
+  //     to be attempted (see collapse_edge). Called concurrently for the
+  //     edges of a round, so it may only write data of the edge itself (and
+  //     not state shared between edges).
+  //   post_collapse  callback called with index of edge whose collapse was
+  //     just attempted and a flag revealing whether this was successful (see
+  //     collapse_edge). Called concurrently, it may only write data of the
+  //     vertices of the collapsed edge.
+  //   E  #E by 2 list of edge indices into V
+  //   EMAP #F*3 list of indices into E, mapping each directed edge to unique
+  //     unique edge in E
+  //   EF  #E by 2 list of edge flaps, see edge_flaps
+  //   EI  #E by 2 list of edge flap corners (see above).
+  IGL_INLINE bool decimate_parallel(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    const decimate_cost_and_placement_callback & cost_and_placement,
+    const decimate_stopping_condition_callback & stopping_condition,
+    const decimate_pre_collapse_callback & pre_collapse,
+    const decimate_post_collapse_callback & post_collapse,
+    const Eigen::MatrixXi & E,
+    const Eigen::VectorXi & EMAP,
+    const Eigen::MatrixXi & EF,
+    const Eigen::MatrixXi & EI,
+    Eigen::MatrixXd & U,
+    Eigen::MatrixXi & G,
+    Eigen::VectorXi & J,
+    Eigen::VectorXi & I);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "decimate_parallel.cpp"
+#endif
+#endif
@@ -0,0 +1,34 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "default_num_threads.h"
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+IGL_INLINE unsigned int igl::default_num_threads(
+  const unsigned int force_num_threads)
+{
+  const auto & initial = []()->unsigned int
+  {
+    if(const char * env = std::getenv("IGL_NUM_THREADS"))
+    {
+      const long n = std::strtol(env,nullptr,10);
+      if(n > 0)
+      {
+        return (unsigned int)n;
+      }
+    }
+    // http://ideone.com/Z7zldb
+    const unsigned int sthc = std::thread::hardware_concurrency();
+    return sthc==0?8:sthc;
+  };
+  static std::atomic<unsigned int> num_threads(initial());
+  if(force_num_threads > 0)
+  {
+    num_threads = force_num_threads;
+  }
+  return num_threads;
+}
@@ -0,0 +1,33 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_DEFAULT_NUM_THREADS_H
+#define IGL_DEFAULT_NUM_THREADS_H
+#include "igl_inline.h"
+
+namespace igl
+{
+  // Number of threads used by parallel_for (including the calling thread).
+  // On first use this is read from the environment variable IGL_NUM_THREADS
+  // if it is set to a positive integer, otherwise it is the number of
+  // hardware threads (or 8 if that cannot be determined).
+  //
+  // Inputs:
+  //   force_num_threads  if positive, replaces the current number of threads
+  //     for all subsequent calls {0}
+  // Returns the current number of threads
+  //
+  // Example:
+  //   // run all following parallel_for loops on 4 threads
+  //   igl::default_num_threads(4);
+  IGL_INLINE unsigned int default_num_threads(
+    const unsigned int force_num_threads = 0);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "default_num_threads.cpp"
+#endif
+
+#endif
@@ -0,0 +1,711 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "fast_readOBJ.h"
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#  include <fstream>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace igl
+{
+  namespace fast_obj
+  {
+    // Read-only view of a whole file, memory mapped where available
+    class MappedFile
+    {
+      public:
+        const char * data;
+        size_t size;
+      private:
+        std::vector<char> buffer;
+        void * map;
+      public:
+        MappedFile():data(nullptr),size(0),map(nullptr){}
+        ~MappedFile()
+        {
+#if !defined(_WIN32)
+          if(map)
+          {
+            munmap(map,size);
+          }
+#endif
+        }
+        inline bool open(const std::string & file_name)
+        {
+#if defined(_WIN32)
+          std::ifstream in(file_name,std::ios::binary|std::ios::ate);
+          if(!in)
+          {
+            return false;
+          }
+          size = (size_t)in.tellg();
+          buffer.resize(size);
+          in.seekg(0);
+          in.read(buffer.data(),size);
+          data = buffer.data();
+          return true;
+#else
+          const int fd = ::open(file_name.c_str(),O_RDONLY);
+          if(fd < 0)
+          {
+            return false;
+          }
+          struct stat st;
+          if(fstat(fd,&st) != 0)
+          {
+            ::close(fd);
+            return false;
+          }
+          size = (size_t)st.st_size;
+          if(size > 0)
+          {
+            map = mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+            if(map == MAP_FAILED)
+            {
+              map = nullptr;
+              ::close(fd);
+              return false;
+            }
+#  ifdef MADV_SEQUENTIAL
+            madvise(map,size,MADV_SEQUENTIAL);
+#  endif
+            data = static_cast<const char *>(map);
+          }
+          ::close(fd);
+          return true;
+#endif
+        }
+    };
+
+    inline bool is_space(const char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline void skip_space(const char * & p, const char * end)
+    {
+      while(p < end && is_space(*p)) p++;
+    }
+
+    inline const char * next_line(const char * p, const char * end)
+    {
+      const char * n =
+        static_cast<const char *>(memchr(p,'\n',end-p));
+      return n ? n+1 : end;
+    }
+
+    // Parse a floating point number starting at p (no leading white space).
+    // Numbers with at most 19 significant digits and a decimal exponent
+    // within [-22,22] whose mantissa is exactly representable are computed
+    // with a single correctly rounded multiplication/division (Clinger's fast
+    // path). Everything else falls back to strtod.
+    inline bool parse_double(const char * & p, const char * end, double & x)
+    {
+      static const double pow10[] = {
+        1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,
+        1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+      const char * s = p;
+      bool neg = false;
+      if(p < end && (*p == '-' || *p == '+'))
+      {
+        neg = *p == '-';
+        p++;
+      }
+      uint64_t mantissa = 0;
+      int digits = 0;
+      int exponent = 0;
+      bool any = false;
+      while(p < end && *p >= '0' && *p <= '9')
+      {
+        any = true;
+        if(digits < 19)
+        {
+          mantissa = mantissa*10 + (*p-'0');
+          digits += mantissa != 0;
+        }else
+        {
+          exponent++;
+        }
+        p++;
+      }
+      if(p < end && *p == '.')
+      {
+        p++;
+        while(p < end && *p >= '0' && *p <= '9')
+        {
+          any = true;
+          if(digits < 19)
+          {
+            mantissa = mantissa*10 + (*p-'0');
+            digits += mantissa != 0;
+            exponent--;
+          }
+          p++;
+        }
+      }
+      bool fast = any;
+      if(any && p < end && (*p == 'e' || *p == 'E'))
+      {
+        const char * e = p+1;
+        bool eneg = false;
+        if(e < end && (*e == '-' || *e == '+'))
+        {
+          eneg = *e == '-';
+          e++;
+        }
+        if(e < end && *e >= '0' && *e <= '9')
+        {
+          int ex = 0;
+          while(e < end && *e >= '0' && *e <= '9')
+          {
+            ex = std::min(ex*10 + (*e-'0'),100000);
+            e++;
+          }
+          exponent += eneg ? -ex : ex;
+          p = e;
+        }
+      }
+      if(fast && mantissa <= (uint64_t(1)<<53) &&
+        exponent >= -22 && exponent <= 22)
+      {
+        x = (double)mantissa;
+        x = exponent < 0 ? x/pow10[-exponent] : x*pow10[exponent];
+        x = neg ? -x : x;
+        return true;
+      }
+      // Slow path: long mantissas, large exponents, inf/nan. Copy the token
+      // since the mapped file is not null terminated.
+      const char * t = s;
+      while(t < end && !is_space(*t) && *t != '\n' && *t != '/') t++;
+      char token[128];
+      const size_t len = std::min((size_t)(t-s),sizeof(token)-1);
+      if(len == 0)
+      {
+        return false;
+      }
+      memcpy(token,s,len);
+      token[len] = '\0';
+      char * token_end;
+      x = strtod(token,&token_end);
+      if(token_end == token)
+      {
+        return false;
+      }
+      p = s + (token_end-token);
+      return true;
+    }
+
+    inline bool parse_index(const char * & p, const char * end, long & i)
+    {
+      bool neg = false;
+      if(p < end && (*p == '-' || *p == '+'))
+      {
+        neg = *p == '-';
+        p++;
+      }
+      if(p >= end || *p < '0' || *p > '9')
+      {
+        return false;
+      }
+      long v = 0;
+      while(p < end && *p >= '0' && *p <= '9')
+      {
+        v = v*10 + (*p-'0');
+        p++;
+      }
+      i = neg ? -v : v;
+      return true;
+    }
+
+    // Number of white space separated words until the end of the line
+    inline int count_words(const char * p, const char * end)
+    {
+      int n = 0;
+      while(true)
+      {
+        skip_space(p,end);
+        if(p >= end || *p == '\n' || *p == '#')
+        {
+          return n;
+        }
+        n++;
+        while(p < end && !is_space(*p) && *p != '\n') p++;
+      }
+    }
+
+    enum LineType
+    {
+      LINE_OTHER = 0,
+      LINE_V = 1,
+      LINE_VT = 2,
+      LINE_VN = 3,
+      LINE_F = 4
+    };
+
+    // Classify the line starting at p and advance p past the keyword
+    inline LineType line_type(const char * & p, const char * end)
+    {
+      skip_space(p,end);
+      if(p+1 >= end)
+      {
+        return LINE_OTHER;
+      }
+      if(p[0] == 'v')
+      {
+        if(is_space(p[1]))
+        {
+          p += 1;
+          return LINE_V;
+        }
+        if(p+2 < end && is_space(p[2]))
+        {
+          if(p[1] == 't')
+          {
+            p += 2;
+            return LINE_VT;
+          }
+          if(p[1] == 'n')
+          {
+            p += 2;
+            return LINE_VN;
+          }
+        }
+      }else if(p[0] == 'f' && is_space(p[1]))
+      {
+        p += 1;
+        return LINE_F;
+      }
+      return LINE_OTHER;
+    }
+
+    // Face corner format: bit 0 texture index, bit 1 normal index
+    inline int corner_format(const char * p, const char * end)
+    {
+      skip_space(p,end);
+      int slashes = 0;
+      bool empty_tc = false;
+      for(;p < end && !is_space(*p) && *p != '\n';p++)
+      {
+        if(*p == '/')
+        {
+          slashes++;
+          if(slashes == 2 && p[-1] == '/')
+          {
+            empty_tc = true;
+          }
+        }
+      }
+      if(slashes == 0) return 0;
+      if(slashes == 1) return 1;
+      return empty_tc ? 2 : 3;
+    }
+
+    // Element counts and per-line dimensions of one chunk
+    struct ChunkInfo
+    {
+      long begin,end;
+      long nv,ntc,nn,nf;
+      int vdim,tcdim,degree,format;
+      // Same dimension for all vertices (and texture coordinates), same
+      // degree and corner format for all faces
+      bool consistent,faces_consistent;
+      ChunkInfo():
+        begin(0),end(0),nv(0),ntc(0),nn(0),nf(0),
+        vdim(-1),tcdim(-1),degree(-1),format(-1),
+        consistent(true),faces_consistent(true){}
+    };
+
+    // Combine a per-line dimension into the chunk's dimension
+    inline void merge_dim(int & dim, const int d, bool & consistent)
+    {
+      if(dim == -1)
+      {
+        dim = d;
+      }else if(dim != d)
+      {
+        consistent = false;
+      }
+    }
+
+    template <typename Derived>
+    inline bool fits(const Eigen::PlainObjectBase<Derived> & /*M*/, const int cols)
+    {
+      return
+        Derived::ColsAtCompileTime == Eigen::Dynamic ||
+        Derived::ColsAtCompileTime == cols;
+    }
+
+    template <typename Derived>
+    inline void clear(Eigen::PlainObjectBase<Derived> & M)
+    {
+      M.resize(0,
+        Derived::ColsAtCompileTime == Eigen::Dynamic ?
+        0 : Derived::ColsAtCompileTime);
+    }
+
+    template <
+      typename DerivedV,
+      typename DerivedTC,
+      typename DerivedCN,
+      typename DerivedF,
+      typename DerivedFTC,
+      typename DerivedFN>
+    inline FastReadOBJStatus read(
+      const std::string obj_file_name,
+      Eigen::PlainObjectBase<DerivedV>& V,
+      Eigen::PlainObjectBase<DerivedTC>& TC,
+      Eigen::PlainObjectBase<DerivedCN>& CN,
+      Eigen::PlainObjectBase<DerivedF>& F,
+      Eigen::PlainObjectBase<DerivedFTC>& FTC,
+      Eigen::PlainObjectBase<DerivedFN>& FN,
+      std::vector<std::vector<int> > * P);
+  }
+}
+
+// Common implementation, without printing. If P is not null, faces of mixed
+// degree or corner format are written to it instead of being rejected.
+template <
+  typename DerivedV,
+  typename DerivedTC,
+  typename DerivedCN,
+  typename DerivedF,
+  typename DerivedFTC,
+  typename DerivedFN>
+inline igl::FastReadOBJStatus igl::fast_obj::read(
+  const std::string obj_file_name,
+  Eigen::PlainObjectBase<DerivedV>& V,
+  Eigen::PlainObjectBase<DerivedTC>& TC,
+  Eigen::PlainObjectBase<DerivedCN>& CN,
+  Eigen::PlainObjectBase<DerivedF>& F,
+  Eigen::PlainObjectBase<DerivedFTC>& FTC,
+  Eigen::PlainObjectBase<DerivedFN>& FN,
+  std::vector<std::vector<int> > * P)
+{
+  using namespace std;
+  using namespace igl;
+  using namespace igl::fast_obj;
+  MappedFile file;
+  if(!file.open(obj_file_name))
+  {
+    return FAST_READOBJ_CANNOT_OPEN;
+  }
+  const char * const data = file.data;
+  const char * const data_end = file.data + file.size;
+
+  // Split file into chunks at line boundaries, a few per thread for balance
+  const size_t min_chunk = 1<<16;
+  const size_t nthreads = std::max<size_t>(std::thread::hardware_concurrency(),1);
+  const long nchunks = (long)std::max<size_t>(1,
+    std::min(4*nthreads,file.size/min_chunk));
+  vector<ChunkInfo> chunks(nchunks);
+  for(long c = 0;c<nchunks;c++)
+  {
+    const long start = (long)(file.size*c/nchunks);
+    chunks[c].begin = c == 0 ? 0 : (long)(next_line(data+start,data_end)-data);
+  }
+  for(long c = 0;c<nchunks;c++)
+  {
+    chunks[c].end = c+1 < nchunks ? chunks[c+1].begin : (long)file.size;
+    chunks[c].end = std::max(chunks[c].end,chunks[c].begin);
+  }
+
+  // Pass 1: count elements and check that the data is rectangular
+  igl::parallel_for(nchunks,[&](const long c)
+  {
+    ChunkInfo & info = chunks[c];
+    const char * end = data + info.end;
+    for(const char * line = data + info.begin;line < end;)
+    {
+      const char * p = line;
+      const char * eol = next_line(line,end);
+      switch(line_type(p,eol))
+      {
+        case LINE_V:
+          info.nv++;
+          merge_dim(info.vdim,count_words(p,eol),info.consistent);
+          break;
+        case LINE_VT:
+          info.ntc++;
+          merge_dim(info.tcdim,count_words(p,eol),info.consistent);
+          break;
+        case LINE_VN:
+          info.nn++;
+          break;
+        case LINE_F:
+          info.nf++;
+          merge_dim(info.degree,count_words(p,eol),info.faces_consistent);
+          merge_dim(info.format,corner_format(p,eol),info.faces_consistent);
+          break;
+        default:
+          break;
+      }
+      line = eol;
+    }
+  },1);
+
+  // Reduce counts into global sizes and per-chunk offsets
+  ChunkInfo total;
+  vector<long> v_off(nchunks),tc_off(nchunks),n_off(nchunks),f_off(nchunks);
+  for(long c = 0;c<nchunks;c++)
+  {
+    const ChunkInfo & info = chunks[c];
+    v_off[c] = total.nv;
+    tc_off[c] = total.ntc;
+    n_off[c] = total.nn;
+    f_off[c] = total.nf;
+    total.nv += info.nv;
+    total.ntc += info.ntc;
+    total.nn += info.nn;
+    total.nf += info.nf;
+    total.consistent = total.consistent && info.consistent;
+    total.faces_consistent = total.faces_consistent && info.faces_consistent;
+    if(info.vdim != -1) merge_dim(total.vdim,info.vdim,total.consistent);
+    if(info.tcdim != -1) merge_dim(total.tcdim,info.tcdim,total.consistent);
+    if(info.degree != -1)
+      merge_dim(total.degree,info.degree,total.faces_consistent);
+    if(info.format != -1)
+      merge_dim(total.format,info.format,total.faces_consistent);
+  }
+  const bool polygons = P && !total.faces_consistent;
+  if(!total.consistent || !(total.faces_consistent || polygons))
+  {
+    return FAST_READOBJ_NOT_RECTANGULAR;
+  }
+  const int vdim = std::max(total.vdim,0);
+  const int tcdim = std::max(total.tcdim,0);
+  const int degree = polygons ? 0 : std::max(total.degree,0);
+  const bool has_ftc = !polygons && (total.format == 1 || total.format == 3);
+  const bool has_fn = !polygons && (total.format == 2 || total.format == 3);
+  if(!fits(V,vdim) || !fits(TC,tcdim) || !fits(CN,3) ||
+    (!polygons && !fits(F,degree)) ||
+    (has_ftc && !fits(FTC,degree)) || (has_fn && !fits(FN,degree)))
+  {
+    return FAST_READOBJ_WRONG_FIXED_SIZE;
+  }
+  V.resize(total.nv,vdim);
+  if(total.ntc > 0) TC.resize(total.ntc,tcdim); else clear(TC);
+  if(total.nn > 0) CN.resize(total.nn,3); else clear(CN);
+  if(polygons) clear(F); else F.resize(total.nf,degree);
+  if(has_ftc) FTC.resize(total.nf,degree); else clear(FTC);
+  if(has_fn) FN.resize(total.nf,degree); else clear(FN);
+  if(P)
+  {
+    P->clear();
+    // Threads fill disjoint faces
+    if(polygons) P->resize(total.nf);
+  }
+
+  // Pass 2: parse directly into outputs
+  vector<char> ok(nchunks,1);
+  igl::parallel_for(nchunks,[&](const long c)
+  {
+    const ChunkInfo & info = chunks[c];
+    const char * end = data + info.end;
+    long v = v_off[c], tc = tc_off[c], n = n_off[c], f = f_off[c];
+    // Negative indices are relative to the elements read so far
+    const auto shift = [](const long i, const long count)->long
+    {
+      return i<0 ? i+count : i-1;
+    };
+    const auto read_numbers = [&](const char * & p, const char * eol,
+      const int dim, double * x)->bool
+    {
+      for(int d = 0;d<dim;d++)
+      {
+        skip_space(p,eol);
+        if(!parse_double(p,eol,x[d]))
+        {
+          return false;
+        }
+      }
+      return true;
+    };
+    double x[16];
+    for(const char * line = data + info.begin;line < end && ok[c];)
+    {
+      const char * p = line;
+      const char * eol = next_line(line,end);
+      switch(line_type(p,eol))
+      {
+        case LINE_V:
+          if(vdim > 16 || !read_numbers(p,eol,vdim,x))
+          {
+            ok[c] = 0;
+            break;
+          }
+          for(int d = 0;d<vdim;d++) V(v,d) = x[d];
+          v++;
+          break;
+        case LINE_VT:
+          if(tcdim > 16 || !read_numbers(p,eol,tcdim,x))
+          {
+            ok[c] = 0;
+            break;
+          }
+          for(int d = 0;d<tcdim;d++) TC(tc,d) = x[d];
+          tc++;
+          break;
+        case LINE_VN:
+          if(!read_numbers(p,eol,3,x))
+          {
+            ok[c] = 0;
+            break;
+          }
+          for(int d = 0;d<3;d++) CN(n,d) = x[d];
+          n++;
+          break;
+        case LINE_F:
+          if(polygons)
+          {
+            // Vertex indices only, skipping texture and normal indices
+            vector<int> & poly = (*P)[f];
+            poly.resize(count_words(p,eol));
+            for(size_t k = 0;k<poly.size();k++)
+            {
+              long i;
+              skip_space(p,eol);
+              if(!parse_index(p,eol,i))
+              {
+                ok[c] = 0;
+                break;
+              }
+              poly[k] = (int)shift(i,v);
+              while(p < eol && !is_space(*p) && *p != '\n') p++;
+            }
+            f++;
+            break;
+          }
+          for(int k = 0;k<degree;k++)
+          {
+            long i,it = 0,in = 0;
+            skip_space(p,eol);
+            if(!parse_index(p,eol,i))
+            {
+              ok[c] = 0;
+              break;
+            }
+            if(p < eol && *p == '/')
+            {
+              p++;
+              if(has_ftc && !parse_index(p,eol,it))
+              {
+                ok[c] = 0;
+                break;
+              }
+              if(p < eol && *p == '/')
+              {
+                p++;
+                if(!parse_index(p,eol,in))
+                {
+                  ok[c] = 0;
+                  break;
+                }
+              }
+            }
+            F(f,k) = shift(i,v);
+            if(has_ftc) FTC(f,k) = shift(it,tc);
+            if(has_fn) FN(f,k) = shift(in,n);
+          }
+          f++;
+          break;
+        default:
+          break;
+      }
+      line = eol;
+    }
+  },1);
+  for(long c = 0;c<nchunks;c++)
+  {
+    if(!ok[c])
+    {
+      return FAST_READOBJ_PARSE_ERROR;
+    }
+  }
+  return FAST_READOBJ_SUCCESS;
+}
+
+template <
+  typename DerivedV,
+  typename DerivedTC,
+  typename DerivedCN,
+  typename DerivedF,
+  typename DerivedFTC,
+  typename DerivedFN>
+IGL_INLINE bool igl::fast_readOBJ(
+  const std::string obj_file_name,
+  Eigen::PlainObjectBase<DerivedV>& V,
+  Eigen::PlainObjectBase<DerivedTC>& TC,
+  Eigen::PlainObjectBase<DerivedCN>& CN,
+  Eigen::PlainObjectBase<DerivedF>& F,
+  Eigen::PlainObjectBase<DerivedFTC>& FTC,
+  Eigen::PlainObjectBase<DerivedFN>& FN)
+{
+  switch(fast_obj::read(obj_file_name,V,TC,CN,F,FTC,FN,nullptr))
+  {
+    case FAST_READOBJ_SUCCESS:
+      return true;
+    case FAST_READOBJ_CANNOT_OPEN:
+      fprintf(stderr,"IOError: fast_readOBJ() could not open %s\n",
+        obj_file_name.c_str());
+      return false;
+    case FAST_READOBJ_PARSE_ERROR:
+      fprintf(stderr,"Error: fast_readOBJ() failed to parse %s\n",
+        obj_file_name.c_str());
+      return false;
+    case FAST_READOBJ_WRONG_FIXED_SIZE:
+      fprintf(stderr,
+        "Error: fast_readOBJ() output matrix has wrong fixed size for %s\n",
+        obj_file_name.c_str());
+      return false;
+    case FAST_READOBJ_NOT_RECTANGULAR:
+    default:
+      // Not an error: callers may fall back to readOBJ
+      return false;
+  }
+}
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE bool igl::fast_readOBJ(
+  const std::string obj_file_name,
+  Eigen::PlainObjectBase<DerivedV>& V,
+  Eigen::PlainObjectBase<DerivedF>& F)
+{
+  Eigen::MatrixXd TC,CN;
+  Eigen::MatrixXi FTC,FN;
+  return fast_readOBJ(obj_file_name,V,TC,CN,F,FTC,FN);
+}
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE igl::FastReadOBJStatus igl::fast_readOBJ(
+  const std::string obj_file_name,
+  Eigen::PlainObjectBase<DerivedV>& V,
+  Eigen::PlainObjectBase<DerivedF>& F,
+  std::vector<std::vector<int> > & P)
+{
+  Eigen::MatrixXd TC,CN;
+  Eigen::MatrixXi FTC,FN;
+  return fast_obj::read(obj_file_name,V,TC,CN,F,FTC,FN,&P);
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template bool igl::fast_readOBJ<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::string, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+template igl::FastReadOBJStatus igl::fast_readOBJ<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::string, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, std::vector<std::vector<int, std::allocator<int> >, std::allocator<std::vector<int, std::allocator<int> > > >&);
+template bool igl::fast_readOBJ<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::string, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+#endif
@@ -0,0 +1,98 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_FAST_READOBJ_H
+#define IGL_FAST_READOBJ_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+namespace igl
+{
+  enum FastReadOBJStatus
+  {
+    FAST_READOBJ_SUCCESS = 0,
+    // The file could not be opened
+    FAST_READOBJ_CANNOT_OPEN = 1,
+    // A line could not be parsed
+    FAST_READOBJ_PARSE_ERROR = 2,
+    // The data is not rectangular, see below
+    FAST_READOBJ_NOT_RECTANGULAR = 3,
+    // A fixed size output does not have the number of columns of the data
+    FAST_READOBJ_WRONG_FIXED_SIZE = 4
+  };
+  // Read a mesh from an ascii obj file directly into Eigen matrices. The file
+  // is memory mapped, split into chunks at line boundaries and each chunk is
+  // parsed in parallel: a first pass counts elements per chunk, a second pass
+  // parses numbers with a fast (correctly rounded) float parser and writes
+  // straight into the preallocated outputs.
+  //
+  // Unlike readOBJ, which supports faces of any degree via vectors of
+  // vectors, this only succeeds if the data is "rectangular" (same
+  // requirement as the Eigen wrappers of readOBJ): all vertices have the same
+  // number of coordinates, all faces have the same degree and the same
+  // combination of texture/normal indices. Unknown lines are ignored.
+  //
+  // Inputs:
+  //   obj_file_name  path to .obj file
+  // Outputs:
+  //   V  #V by dim matrix of vertex positions (dim is usually 3)
+  //   TC  #TC by 2|3 matrix of texture coordinates (empty if none)
+  //   CN  #CN by 3 matrix of corner normals (empty if none)
+  //   F  #F by ss list of face indices into vertex positions
+  //   FTC  #F by ss list of face indices into texture coordinates (empty if
+  //     none)
+  //   FN  #F by ss list of face indices into normals (empty if none)
+  // Returns true on success, false on errors or non-rectangular data. Errors
+  // are reported on stderr, non-rectangular data is rejected silently so that
+  // callers can fall back to readOBJ.
+  //
+  // See also: readOBJ
+  template <
+    typename DerivedV,
+    typename DerivedTC,
+    typename DerivedCN,
+    typename DerivedF,
+    typename DerivedFTC,
+    typename DerivedFN>
+  IGL_INLINE bool fast_readOBJ(
+    const std::string obj_file_name,
+    Eigen::PlainObjectBase<DerivedV>& V,
+    Eigen::PlainObjectBase<DerivedTC>& TC,
+    Eigen::PlainObjectBase<DerivedCN>& CN,
+    Eigen::PlainObjectBase<DerivedF>& F,
+    Eigen::PlainObjectBase<DerivedFTC>& FTC,
+    Eigen::PlainObjectBase<DerivedFN>& FN);
+  // Just V and F
+  template <typename DerivedV, typename DerivedF>
+  IGL_INLINE bool fast_readOBJ(
+    const std::string obj_file_name,
+    Eigen::PlainObjectBase<DerivedV>& V,
+    Eigen::PlainObjectBase<DerivedF>& F);
+  // Quiet version of the above for callers with a fallback of their own
+  // (e.g. read_triangle_mesh): nothing is printed, the returned status tells
+  // why reading failed. Faces of mixed degrees are not rejected but returned
+  // in P (F is then empty), e.g. to triangulate with
+  // polygon_mesh_to_triangle_mesh.
+  //
+  // Outputs:
+  //   V  #V by dim matrix of vertex positions
+  //   F  #F by ss list of face indices if all faces have the same degree,
+  //     otherwise empty
+  //   P  #F list of faces of any degree if F is empty, otherwise empty
+  template <typename DerivedV, typename DerivedF>
+  IGL_INLINE FastReadOBJStatus fast_readOBJ(
+    const std::string obj_file_name,
+    Eigen::PlainObjectBase<DerivedV>& V,
+    Eigen::PlainObjectBase<DerivedF>& F,
+    std::vector<std::vector<int> > & P);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "fast_readOBJ.cpp"
+#endif
+
+#endif
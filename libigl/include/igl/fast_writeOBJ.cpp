@@ -0,0 +1,145 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "fast_writeOBJ.h"
+#include "parallel_for.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if __cplusplus >= 201703L
+#  include <charconv>
+#endif
+
+namespace igl
+{
+  namespace fast_obj
+  {
+    // Longest output of format_double/format_index plus separator
+    const size_t max_number_chars = 32;
+
+    // Print x with the shortest representation that round trips, returns
+    // pointer past the last written character
+    inline char * format_double(char * p, const double x)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      return std::to_chars(p,p+max_number_chars,x).ptr;
+#else
+      return p + snprintf(p,max_number_chars,"%0.17g",x);
+#endif
+    }
+
+    inline char * format_index(char * p, unsigned long i)
+    {
+      char digits[24];
+      int n = 0;
+      do
+      {
+        digits[n++] = (char)('0' + i%10);
+        i /= 10;
+      }while(i > 0);
+      while(n > 0) *p++ = digits[--n];
+      return p;
+    }
+
+    // Format a whole mesh into buffer
+    template <typename DerivedV, typename DerivedF>
+    inline void format_obj(
+      const Eigen::MatrixBase<DerivedV>& V,
+      const Eigen::MatrixBase<DerivedF>& F,
+      std::vector<char> & buffer)
+    {
+      buffer.resize(
+        V.rows()*(2+V.cols()*max_number_chars) +
+        F.rows()*(2+F.cols()*max_number_chars) + 1);
+      char * p = buffer.data();
+      for(int i = 0;i<(int)V.rows();i++)
+      {
+        *p++ = 'v';
+        for(int j = 0;j<(int)V.cols();j++)
+        {
+          *p++ = ' ';
+          p = format_double(p,(double)V(i,j));
+        }
+        *p++ = '\n';
+      }
+      for(int i = 0;i<(int)F.rows();i++)
+      {
+        *p++ = 'f';
+        for(int j = 0;j<(int)F.cols();j++)
+        {
+          *p++ = ' ';
+          // OBJ is 1-indexed
+          p = format_index(p,(unsigned long)(F(i,j)+1));
+        }
+        *p++ = '\n';
+      }
+      buffer.resize(p-buffer.data());
+    }
+
+    inline bool write_buffer(
+      const std::string & str,
+      const std::vector<char> & buffer)
+    {
+      FILE * obj_file = fopen(str.c_str(),"wb");
+      if(NULL==obj_file)
+      {
+        fprintf(stderr,"IOError: fast_writeOBJ() could not open %s\n",
+          str.c_str());
+        return false;
+      }
+      const size_t written = fwrite(buffer.data(),1,buffer.size(),obj_file);
+      fclose(obj_file);
+      return written == buffer.size();
+    }
+  }
+}
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE bool igl::fast_writeOBJ(
+  const std::string str,
+  const Eigen::MatrixBase<DerivedV>& V,
+  const Eigen::MatrixBase<DerivedF>& F)
+{
+  std::vector<char> buffer;
+  fast_obj::format_obj(V,F,buffer);
+  return fast_obj::write_buffer(str,buffer);
+}
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE bool igl::fast_writeOBJ(
+  const std::vector<std::string> & str,
+  const std::vector<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF>& F)
+{
+  if(str.size() != V.size())
+  {
+    fprintf(stderr,"Error: fast_writeOBJ() expects one path per mesh\n");
+    return false;
+  }
+  std::vector<char> ok(V.size(),0);
+  // Formatting dominates, so each mesh is formatted (and written) on its own
+  // thread
+  igl::parallel_for(V.size(),[&](const size_t m)
+  {
+    std::vector<char> buffer;
+    fast_obj::format_obj(V[m],F,buffer);
+    ok[m] = fast_obj::write_buffer(str[m],buffer);
+  },2);
+  for(const char o : ok)
+  {
+    if(!o)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template bool igl::fast_writeOBJ<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::string, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template bool igl::fast_writeOBJ<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::vector<std::string> const&, std::vector<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+#endif
@@ -0,0 +1,53 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_FAST_WRITEOBJ_H
+#define IGL_FAST_WRITEOBJ_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <string>
+#include <vector>
+
+namespace igl
+{
+  // Write a mesh in an ascii obj file. The whole file is formatted into one
+  // memory buffer and written with a single call. Coordinates are printed
+  // with the shortest representation that parses back to the same double
+  // (std::to_chars when compiled as C++17, "%.17g" otherwise), so files are
+  // both smaller than and as exact as those of writeOBJ.
+  //
+  // Inputs:
+  //   str  path to outputfile
+  //   V  #V by dim mesh vertex positions
+  //   F  #F by ss mesh indices into V, if F is empty only vertex positions
+  //     are written (e.g., when connectivity is shared with a template)
+  // Returns true on success, false on error
+  //
+  // See also: writeOBJ, fast_readOBJ
+  template <typename DerivedV, typename DerivedF>
+  IGL_INLINE bool fast_writeOBJ(
+    const std::string str,
+    const Eigen::MatrixBase<DerivedV>& V,
+    const Eigen::MatrixBase<DerivedF>& F);
+  // Write several meshes sharing the same connectivity concurrently.
+  //
+  // Inputs:
+  //   str  #meshes list of paths to outputfiles
+  //   V  #meshes list of #V by dim vertex positions
+  //   F  #F by ss mesh indices shared by all meshes, if empty only vertex
+  //     positions are written
+  // Returns true iff all files were written
+  template <typename DerivedV, typename DerivedF>
+  IGL_INLINE bool fast_writeOBJ(
+    const std::vector<std::string> & str,
+    const std::vector<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF>& F);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "fast_writeOBJ.cpp"
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "heat_geodesics.h"
+#include "cotmatrix_massmatrix.h"
+#include "grad.h"
+#include "doublearea.h"
+#include "avg_edge_length.h"
+#include "vertex_components.h"
+#include "parallel_for.h"
+#include <cmath>
+#include <limits>
+
+template <typename DerivedV, typename DerivedF, typename Scalar>
+IGL_INLINE bool igl::heat_geodesics_precompute(
+  const Eigen::PlainObjectBase<DerivedV> & V,
+  const Eigen::PlainObjectBase<DerivedF> & F,
+  const Scalar t,
+  heat_geodesics_data<Scalar> & data)
+{
+  typedef Eigen::SparseMatrix<Scalar> SparseMatrixS;
+  typedef Eigen::Triplet<Scalar> T;
+  const int n = V.rows();
+  cotmatrix_massmatrix_data<Scalar> cm;
+  cotmatrix_massmatrix_precompute(n,F,cm);
+  SparseMatrixS L,M;
+  cotmatrix_massmatrix(V,MASSMATRIX_TYPE_DEFAULT,cm,L,M);
+
+  Eigen::SparseMatrix<typename DerivedV::Scalar> G;
+  grad(V,F,G);
+  data.Grad = G.template cast<Scalar>();
+  Eigen::Matrix<Scalar,Eigen::Dynamic,1> dblA;
+  doublearea(V,F,dblA);
+  // Div Grad = L
+  const Eigen::Matrix<Scalar,Eigen::Dynamic,1> A = 0.5*dblA.replicate(3,1);
+  data.Div = -(data.Grad.transpose()*A.asDiagonal());
+
+  // Connected components, with unreferenced vertices alone in theirs
+  Eigen::VectorXi C;
+  vertex_components(F,C);
+  std::vector<bool> referenced(n,false);
+  for(int f = 0;f<F.rows();f++)
+  {
+    for(int c = 0;c<F.cols();c++)
+    {
+      referenced[F(f,c)] = true;
+    }
+  }
+  data.C.resize(n);
+  data.num_components = C.size() ? C.maxCoeff()+1 : 0;
+  for(int i = 0;i<n;i++)
+  {
+    data.C(i) = i<C.size() && referenced[i] ? C(i) : data.num_components++;
+  }
+
+  // Heat flow, with identity rows for unreferenced vertices
+  std::vector<T> IJV;
+  for(int i = 0;i<n;i++)
+  {
+    if(!referenced[i])
+    {
+      IJV.emplace_back(i,i,1);
+    }
+  }
+  SparseMatrixS I(n,n);
+  I.setFromTriplets(IJV.begin(),IJV.end());
+  data.heat.compute(M-t*L+I);
+  if(data.heat.info() != Eigen::Success)
+  {
+    return false;
+  }
+
+  // Poisson problem, fixing the first vertex of each component
+  std::vector<bool> fixed(data.num_components,false);
+  data.poisson_row.resize(n);
+  int num_free = 0;
+  for(int i = 0;i<n;i++)
+  {
+    if(fixed[data.C(i)])
+    {
+      data.poisson_row(i) = num_free++;
+    }else
+    {
+      fixed[data.C(i)] = true;
+      data.poisson_row(i) = -1;
+    }
+  }
+  IJV.clear();
+  IJV.reserve(L.nonZeros());
+  for(int k = 0;k<L.outerSize();k++)
+  {
+    for(typename SparseMatrixS::InnerIterator it(L,k);it;++it)
+    {
+      const int r = data.poisson_row(it.row());
+      const int c = data.poisson_row(it.col());
+      if(r >= 0 && c >= 0)
+      {
+        IJV.emplace_back(r,c,-it.value());
+      }
+    }
+  }
+  SparseMatrixS K(num_free,num_free);
+  K.setFromTriplets(IJV.begin(),IJV.end());
+  data.poisson.compute(K);
+  return data.poisson.info() == Eigen::Success;
+}
+
+template <typename DerivedV, typename DerivedF, typename Scalar>
+IGL_INLINE bool igl::heat_geodesics_precompute(
+  const Eigen::PlainObjectBase<DerivedV> & V,
+  const Eigen::PlainObjectBase<DerivedF> & F,
+  heat_geodesics_data<Scalar> & data)
+{
+  const Scalar h = avg_edge_length(V,F);
+  return heat_geodesics_precompute(V,F,h*h,data);
+}
+
+template <typename Scalar, typename Derivedgamma, typename DerivedD>
+IGL_INLINE void igl::heat_geodesics_solve(
+  const heat_geodesics_data<Scalar> & data,
+  const Eigen::MatrixBase<Derivedgamma> & gamma,
+  Eigen::PlainObjectBase<DerivedD> & D)
+{
+  std::vector<std::vector<int> > gammas(1);
+  for(int i = 0;i<gamma.size();i++)
+  {
+    gammas[0].push_back(gamma(i));
+  }
+  heat_geodesics_solve(data,gammas,D);
+}
+
+template <typename Scalar, typename DerivedD>
+IGL_INLINE void igl::heat_geodesics_solve(
+  const heat_geodesics_data<Scalar> & data,
+  const std::vector<std::vector<int> > & gammas,
+  Eigen::PlainObjectBase<DerivedD> & D)
+{
+  typedef Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic> MatrixXS;
+  const int n = data.C.size();
+  const int k = gammas.size();
+  // Heat flow from the sources
+  MatrixXS U0 = MatrixXS::Zero(n,k);
+  for(int q = 0;q<k;q++)
+  {
+    for(const int i : gammas[q])
+    {
+      U0(i,q) = 1;
+    }
+  }
+  const MatrixXS U = data.heat.solve(U0);
+  // Unit vector field pointing away from the sources
+  MatrixXS X = data.Grad*U;
+  const int m = X.rows()/3;
+  parallel_for(m,[&](const int f)
+  {
+    for(int q = 0;q<k;q++)
+    {
+      const Scalar norm = std::sqrt(
+        X(f,q)*X(f,q)+X(m+f,q)*X(m+f,q)+X(2*m+f,q)*X(2*m+f,q));
+      const Scalar s = norm > 0 ? -1./norm : 0;
+      X(f,q) *= s;
+      X(m+f,q) *= s;
+      X(2*m+f,q) *= s;
+    }
+  },1000);
+  // Distances whose gradients best match it: -L D = -Div X
+  const MatrixXS B = -(data.Div*X);
+  const int num_free = data.poisson.rows();
+  MatrixXS Bf(num_free,k);
+  for(int i = 0;i<n;i++)
+  {
+    if(data.poisson_row(i) >= 0)
+    {
+      Bf.row(data.poisson_row(i)) = B.row(i);
+    }
+  }
+  const MatrixXS Df = data.poisson.solve(Bf);
+  D.resize(n,k);
+  for(int i = 0;i<n;i++)
+  {
+    for(int q = 0;q<k;q++)
+    {
+      D(i,q) = data.poisson_row(i) >= 0 ? Df(data.poisson_row(i),q) : 0;
+    }
+  }
+  // Shift each component so that its sources are at distance 0 on average
+  for(int q = 0;q<k;q++)
+  {
+    Eigen::Matrix<Scalar,Eigen::Dynamic,1> shift =
+      Eigen::Matrix<Scalar,Eigen::Dynamic,1>::Zero(data.num_components);
+    Eigen::VectorXi count = Eigen::VectorXi::Zero(data.num_components);
+    for(const int i : gammas[q])
+    {
+      shift(data.C(i)) += D(i,q);
+      count(data.C(i))++;
+    }
+    for(int i = 0;i<n;i++)
+    {
+      const int c = data.C(i);
+      D(i,q) = count(c) ?
+        D(i,q)-shift(c)/count(c) : std::numeric_limits<Scalar>::infinity();
+    }
+  }
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template bool igl::heat_geodesics_precompute<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, double>(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, double, igl::heat_geodesics_data<double>&);
+template bool igl::heat_geodesics_precompute<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, double>(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::heat_geodesics_data<double>&);
+template void igl::heat_geodesics_solve<double, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, 1, 0, -1, 1> >(igl::heat_geodesics_data<double> const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&);
+template void igl::heat_geodesics_solve<double, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(igl::heat_geodesics_data<double> const&, std::vector<std::vector<int, std::allocator<int> >, std::allocator<std::vector<int, std::allocator<int> > > > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+#endif
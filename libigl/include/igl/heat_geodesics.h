@@ -0,0 +1,89 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_HEAT_GEODESICS_H
+#define IGL_HEAT_GEODESICS_H
+#include "igl_inline.h"
+#include "SparseLLT.h"
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <vector>
+
+namespace igl
+{
+  template <typename Scalar>
+  struct heat_geodesics_data;
+  // Precompute the operators and factorize the two systems of the heat method
+  // for geodesic distances [Crane et al. 2013]: the heat flow (M - t L) and
+  // the Poisson problem (-L, with one vertex fixed per connected component).
+  // Every later query then costs two back substitutions.
+  //
+  // Inputs:
+  //   V  #V by 3 list of mesh vertex positions
+  //   F  #F by 3 list of mesh triangle indices into V
+  //   t  time step of the heat flow (larger is smoother) {squared average
+  //     edge length}
+  // Outputs:
+  //   data  precomputed operators and factorizations
+  // Returns false if a factorization failed (e.g. degenerate triangles)
+  template <typename DerivedV, typename DerivedF, typename Scalar>
+  IGL_INLINE bool heat_geodesics_precompute(
+    const Eigen::PlainObjectBase<DerivedV> & V,
+    const Eigen::PlainObjectBase<DerivedF> & F,
+    const Scalar t,
+    heat_geodesics_data<Scalar> & data);
+  template <typename DerivedV, typename DerivedF, typename Scalar>
+  IGL_INLINE bool heat_geodesics_precompute(
+    const Eigen::PlainObjectBase<DerivedV> & V,
+    const Eigen::PlainObjectBase<DerivedF> & F,
+    heat_geodesics_data<Scalar> & data);
+  // Approximate geodesic distances to a set of source vertices
+  //
+  // Inputs:
+  //   data  precomputed by heat_geodesics_precompute
+  //   gamma  #gamma list of source vertex indices
+  // Outputs:
+  //   D  #V list of distances to the nearest source. Vertices of connected
+  //     components without sources get infinity.
+  template <typename Scalar, typename Derivedgamma, typename DerivedD>
+  IGL_INLINE void heat_geodesics_solve(
+    const heat_geodesics_data<Scalar> & data,
+    const Eigen::MatrixBase<Derivedgamma> & gamma,
+    Eigen::PlainObjectBase<DerivedD> & D);
+  // Distances for a batch of queries, solved together as multiple right hand
+  // sides
+  //
+  // Inputs:
+  //   gammas  #queries lists of source vertex indices
+  // Outputs:
+  //   D  #V by #queries distances, column q to the sources gammas[q]
+  template <typename Scalar, typename DerivedD>
+  IGL_INLINE void heat_geodesics_solve(
+    const heat_geodesics_data<Scalar> & data,
+    const std::vector<std::vector<int> > & gammas,
+    Eigen::PlainObjectBase<DerivedD> & D);
+}
+
+template <typename Scalar>
+struct igl::heat_geodesics_data
+{
+  // Gradient (#F*3 by #V) and divergence (#V by #F*3) operators
+  Eigen::SparseMatrix<Scalar> Grad, Div;
+  // Factorizations of M - t L and of -L restricted to the free vertices
+  igl::SparseLLT<Scalar> heat, poisson;
+  // Connected component of each vertex
+  Eigen::VectorXi C;
+  // Row of each vertex in the Poisson system, -1 for the vertex fixed in
+  // each component
+  Eigen::VectorXi poisson_row;
+  int num_components;
+  heat_geodesics_data():num_components(0){}
+};
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "heat_geodesics.cpp"
+#endif
+
+#endif
@@ -8,9 +8,9 @@
 #ifndef IGL_INFINITE_COST_STOPPING_CONDITION_H
 #define IGL_INFINITE_COST_STOPPING_CONDITION_H
 #include "igl_inline.h"
+#include "decimate_callback_types.h"
 #include <Eigen/Core>
 #include <vector>
-#include <set>
 #include <functional>
 namespace igl
 {
@@ -23,58 +23,12 @@ namespace igl
   //   stopping_condition
   //
   IGL_INLINE void infinite_cost_stopping_condition(
-    const std::function<void(
-      const int,
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      double &,
-      Eigen::RowVectorXd &)> & cost_and_placement,
-    std::function<bool(
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const std::set<std::pair<double,int> > &,
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,
-      const Eigen::MatrixXd &,
-      const int,
-      const int,
-      const int,
-      const int,
-      const int)> & stopping_condition);
+    const decimate_cost_and_placement_callback & cost_and_placement,
+    decimate_stopping_condition_callback & stopping_condition);
   IGL_INLINE 
-    std::function<bool(
-      const Eigen::MatrixXd &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::VectorXi &,
-      const Eigen::MatrixXi &,
-      const Eigen::MatrixXi &,
-      const std::set<std::pair<double,int> > &,
-      const std::vector<std::set<std::pair<double,int> >::iterator > &,
-      const Eigen::MatrixXd &,
-      const int,
-      const int,
-      const int,
-      const int,
-      const int)> 
+    decimate_stopping_condition_callback
     infinite_cost_stopping_condition(
-      const std::function<void(
-        const int,
-        const Eigen::MatrixXd &,
-        const Eigen::MatrixXi &,
-        const Eigen::MatrixXi &,
-        const Eigen::VectorXi &,
-        const Eigen::MatrixXi &,
-        const Eigen::MatrixXi &,
-        double &,
-        Eigen::RowVectorXd &)> & cost_and_placement);
+      const decimate_cost_and_placement_callback & cost_and_placement);
 }
 
 #ifndef IGL_STATIC_LIBRARY
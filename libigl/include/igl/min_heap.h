@@ -0,0 +1,20 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MIN_HEAP_H
+#define IGL_MIN_HEAP_H
+#include <functional>
+#include <queue>
+#include <vector>
+namespace igl
+{
+  // Binary min heap in contiguous storage (std::priority_queue with the sort
+  // order reversed). Entries cannot be updated or removed in place: callers
+  // keeping a per item timestamp (see collapse_edge) push a new entry on each
+  // update and skip stale entries when they reach the top.
+  template<class T> using min_heap = 
+    std::priority_queue< T, std::vector<T >, std::greater<T > >;
+}
+#endif
@@ -452,7 +452,7 @@ IGL_INLINE bool igl::min_quad_with_fixed_solve(
     switch(data.solver_type)
     {
       case igl::min_quad_with_fixed_data<T>::LLT:
-        sol = data.llt.solve(NB);
+        sol.derived() = data.llt.solve(NB);
         break;
       case igl::min_quad_with_fixed_data<T>::LDLT:
         sol = data.ldlt.solve(NB);
@@ -8,6 +8,7 @@
 #ifndef IGL_MIN_QUAD_WITH_FIXED_H
 #define IGL_MIN_QUAD_WITH_FIXED_H
 #include "igl_inline.h"
+#include "SparseLLT.h"
 
 #define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
 #include <Eigen/Core>
@@ -147,7 +148,19 @@ struct igl::min_quad_with_fixed_data
     NUM_SOLVER_TYPES = 4
   } solver_type;
   // Solvers
-  Eigen::SimplicialLLT <Eigen::SparseMatrix<T > > llt;
+  //
+  // The LLT solver used to be an Eigen::SimplicialLLT. igl::SparseLLT only
+  // has the compute/info/solve subset of its interface. It solves the
+  // columns of the right hand side concurrently, which is at most 3 threads
+  // for #V by 3 positions. With CHOLMOD it uses the supernodal LLT instead.
+  // Code relying on the Eigen type (e.g. matrixL() or permutationP()) can
+  // define IGL_MIN_QUAD_WITH_FIXED_EIGEN_LLT to get it back.
+#ifdef IGL_MIN_QUAD_WITH_FIXED_EIGEN_LLT
+  typedef Eigen::SimplicialLLT<Eigen::SparseMatrix<T> > LLTSolver;
+#else
+  typedef igl::SparseLLT<T> LLTSolver;
+#endif
+  LLTSolver llt;
   Eigen::SimplicialLDLT<Eigen::SparseMatrix<T > > ldlt;
   Eigen::SparseLU<Eigen::SparseMatrix<T, Eigen::ColMajor>, Eigen::COLAMDOrdering<int> >   lu;
   // QR factorization
@@ -0,0 +1,249 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "min_quad_with_fixed_session.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+template <typename T>
+IGL_INLINE bool igl::min_quad_with_fixed_session<T>::precompute(
+  const Eigen::SparseMatrix<T> & A,
+  const Eigen::VectorXi & known,
+  const VectorXT & W)
+{
+  assert(A.rows() == A.cols() && "A should be square");
+  assert(W.size() == A.rows() && "W should have one weight per row of A");
+  n = A.rows();
+  m_A = A;
+  m_A.makeCompressed();
+  // Pattern of A plus an explicit diagonal
+  {
+    Eigen::SparseMatrix<T> D(n,n);
+    std::vector<Eigen::Triplet<T> > IJV;
+    IJV.reserve(n);
+    for(int i = 0;i<n;i++)
+    {
+      IJV.emplace_back(i,i,0);
+    }
+    D.setFromTriplets(IJV.begin(),IJV.end());
+    m_M = m_A + D;
+    m_M.makeCompressed();
+  }
+  // Both patterns list rows in increasing order within a column
+  m_A_to_M.resize(m_A.nonZeros());
+  m_diagonal.resize(n);
+  for(int j = 0;j<n;j++)
+  {
+    int k = m_M.outerIndexPtr()[j];
+    for(int a = m_A.outerIndexPtr()[j];a<m_A.outerIndexPtr()[j+1];a++)
+    {
+      while(m_M.innerIndexPtr()[k] != m_A.innerIndexPtr()[a])
+      {
+        k++;
+      }
+      m_A_to_M[a] = k;
+    }
+    m_diagonal[j] = std::lower_bound(
+      m_M.innerIndexPtr()+m_M.outerIndexPtr()[j],
+      m_M.innerIndexPtr()+m_M.outerIndexPtr()[j+1],
+      j) - m_M.innerIndexPtr();
+  }
+  // Known rows and columns are zeroed numerically, so the analysis holds for
+  // any set of known rows
+  m_llt.analyzePattern(m_M);
+  m_W = W;
+  return factorize(known);
+}
+
+template <typename T>
+IGL_INLINE bool igl::min_quad_with_fixed_session<T>::update(
+  const Eigen::SparseMatrix<T> & A,
+  const Eigen::VectorXi & known,
+  const VectorXT & W)
+{
+  Eigen::SparseMatrix<T> cA = A;
+  cA.makeCompressed();
+  const bool same_pattern =
+    cA.rows() == n && cA.cols() == n &&
+    cA.nonZeros() == m_A.nonZeros() &&
+    std::equal(
+      cA.outerIndexPtr(),cA.outerIndexPtr()+n+1,m_A.outerIndexPtr()) &&
+    std::equal(
+      cA.innerIndexPtr(),cA.innerIndexPtr()+cA.nonZeros(),
+      m_A.innerIndexPtr());
+  if(!same_pattern)
+  {
+    return precompute(cA,known,W);
+  }
+  std::copy(cA.valuePtr(),cA.valuePtr()+cA.nonZeros(),m_A.valuePtr());
+  m_W = W;
+  return factorize(known);
+}
+
+template <typename T>
+IGL_INLINE bool igl::min_quad_with_fixed_session<T>::update_weights(
+  const VectorXT & W)
+{
+  assert(W.size() == n && "W should have one weight per row of A");
+  m_W = W;
+  std::vector<int> U;
+  for(int i = 0;i<n;i++)
+  {
+    if(!m_is_known[i] && m_W(i) != m_factorized_W(i))
+    {
+      U.push_back(i);
+    }
+  }
+  if((int)U.size() > max_update_rank)
+  {
+    return factorize(m_known);
+  }
+  const int r = U.size();
+  m_U = Eigen::Map<Eigen::VectorXi>(U.data(),r);
+  m_delta.resize(r);
+  if(r == 0)
+  {
+    m_X.resize(n,0);
+    return true;
+  }
+  MatrixXT E = MatrixXT::Zero(n,r);
+  for(int u = 0;u<r;u++)
+  {
+    E(m_U(u),u) = 1;
+    m_delta(u) = m_W(m_U(u))-m_factorized_W(m_U(u));
+  }
+  m_X = m_llt.solve(E);
+  MatrixXT C = MatrixXT::Identity(r,r);
+  for(int u = 0;u<r;u++)
+  {
+    for(int v = 0;v<r;v++)
+    {
+      C(u,v) += m_delta(u)*m_X(m_U(u),v);
+    }
+  }
+  m_capacitance.compute(C);
+  // A weight dropping to make the system (nearly) singular
+  if(!(m_capacitance.rcond() > std::numeric_limits<T>::epsilon()))
+  {
+    return factorize(m_known);
+  }
+  return true;
+}
+
+template <typename T>
+template <
+  typename DerivedB,
+  typename DerivedY,
+  typename DerivedS,
+  typename DerivedZ>
+IGL_INLINE bool igl::min_quad_with_fixed_session<T>::solve(
+  const Eigen::MatrixBase<DerivedB> & B,
+  const Eigen::MatrixBase<DerivedY> & Y,
+  const Eigen::MatrixBase<DerivedS> & S,
+  Eigen::PlainObjectBase<DerivedZ> & Z) const
+{
+  const int cols = B.cols();
+  assert(B.rows() == n && "B should have one row per variable");
+  assert((m_known.size() == 0 || Y.rows() == m_known.size()) &&
+    "Y should have one row per known row");
+  MatrixXT rhs = -B.template cast<T>();
+  for(int i = 0;i<n;i++)
+  {
+    if(!m_is_known[i] && m_W(i) != 0)
+    {
+      assert(S.rows() == n && S.cols() == cols);
+      rhs.row(i) += m_W(i)*S.row(i).template cast<T>();
+    }
+  }
+  if(m_known.size() > 0)
+  {
+    assert(Y.cols() == cols);
+    // Move known values to the right hand side
+    MatrixXT Yn = MatrixXT::Zero(n,cols);
+    for(int k = 0;k<m_known.size();k++)
+    {
+      Yn.row(m_known(k)) = Y.row(k).template cast<T>();
+    }
+    rhs -= m_A*Yn;
+    for(int k = 0;k<m_known.size();k++)
+    {
+      rhs.row(m_known(k)) = Y.row(k).template cast<T>();
+    }
+  }
+  MatrixXT sol = m_llt.solve(rhs);
+  if(m_llt.info() != Eigen::Success)
+  {
+    std::cerr<<"Error: solve failed."<<std::endl;
+    return false;
+  }
+  if(m_U.size() > 0)
+  {
+    MatrixXT DU(m_U.size(),cols);
+    for(int u = 0;u<m_U.size();u++)
+    {
+      DU.row(u) = m_delta(u)*sol.row(m_U(u));
+    }
+    sol -= m_X*m_capacitance.solve(DU);
+  }
+  Z = sol.template cast<typename DerivedZ::Scalar>();
+  return true;
+}
+
+template <typename T>
+IGL_INLINE bool igl::min_quad_with_fixed_session<T>::factorize(
+  const Eigen::VectorXi & known)
+{
+  m_known = known;
+  m_is_known.assign(n,false);
+  for(int k = 0;k<m_known.size();k++)
+  {
+    assert(m_known(k) >= 0 && m_known(k) < n && "known should be in [0,n)");
+    m_is_known[m_known(k)] = true;
+  }
+  T * M = m_M.valuePtr();
+  std::fill(M,M+m_M.nonZeros(),T(0));
+  for(int j = 0;j<n;j++)
+  {
+    if(m_is_known[j])
+    {
+      continue;
+    }
+    for(int a = m_A.outerIndexPtr()[j];a<m_A.outerIndexPtr()[j+1];a++)
+    {
+      if(!m_is_known[m_A.innerIndexPtr()[a]])
+      {
+        M[m_A_to_M[a]] = m_A.valuePtr()[a];
+      }
+    }
+  }
+  for(int i = 0;i<n;i++)
+  {
+    M[m_diagonal[i]] += m_is_known[i] ? T(1) : m_W(i);
+  }
+  m_llt.factorize(m_M);
+  m_factorized_W = m_W;
+  m_U.resize(0);
+  m_delta.resize(0);
+  m_X.resize(n,0);
+  switch(m_llt.info())
+  {
+    case Eigen::Success:
+      return true;
+    case Eigen::NumericalIssue:
+      std::cerr<<"Error: Numerical issue."<<std::endl;
+      return false;
+    default:
+      std::cerr<<"Error: Other."<<std::endl;
+      return false;
+  }
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template class igl::min_quad_with_fixed_session<double>;
+template bool igl::min_quad_with_fixed_session<double>::solve<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
+#endif
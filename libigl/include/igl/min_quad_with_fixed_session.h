@@ -0,0 +1,143 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MIN_QUAD_WITH_FIXED_SESSION_H
+#define IGL_MIN_QUAD_WITH_FIXED_SESSION_H
+#include "igl_inline.h"
+#include "SparseLLT.h"
+
+#define EIGEN_YES_I_KNOW_SPARSE_MODULE_IS_NOT_STABLE_YET
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <vector>
+
+namespace igl
+{
+  // Repeatedly minimize a quadratic energy with soft and fixed values
+  //
+  // trace( 0.5*Z'*A*Z + Z'*B + 0.5*(Z-S)'*diag(W)*(Z-S) )
+  //
+  // subject to
+  //
+  //   Z(known,:) = Y
+  //
+  // where A(unknown,unknown)+diag(W(unknown)) is positive definite, while the
+  // values of A, the weights W and the set of known rows change between
+  // solves but the sparsity pattern of A does not. Unlike
+  // min_quad_with_fixed_precompute, which slices out the unknown rows and
+  // analyzes the resulting pattern anew, the system is kept at full size with
+  // known rows and columns replaced by identity ones, so that the pattern of
+  // A plus its diagonal is analyzed once and every change of values, weights
+  // or known rows only needs a numeric refactorization. When only a few
+  // weights change (soft constraints toggling on and off), the previous
+  // factorization is kept and solves are corrected with a low rank
+  // (Sherman-Morrison-Woodbury) update instead.
+  //
+  // Equality constraints (Aeq) are not supported, see min_quad_with_fixed.
+  //
+  // Templates:
+  //   T  scalar type of the sparse matrices (e.g. double)
+  template <typename T>
+  class min_quad_with_fixed_session
+  {
+  public:
+    typedef Eigen::Matrix<T,Eigen::Dynamic,1> VectorXT;
+    typedef Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> MatrixXT;
+    // Number of variables
+    int n;
+    // Most weights update_weights handles with a low rank update before
+    // refactorizing {16}
+    int max_update_rank;
+  private:
+    // Pattern of A plus its diagonal, with the values of the system
+    Eigen::SparseMatrix<T> m_M;
+    // Current A
+    Eigen::SparseMatrix<T> m_A;
+    // Index into m_M.valuePtr() of each nonzero of A and of each diagonal
+    std::vector<int> m_A_to_M;
+    std::vector<int> m_diagonal;
+    // Known rows mask and current weights
+    std::vector<bool> m_is_known;
+    Eigen::VectorXi m_known;
+    VectorXT m_W;
+    // Weights of the factorized system
+    VectorXT m_factorized_W;
+    SparseLLT<T> m_llt;
+    // Low rank correction: rows m_U whose weights changed by m_delta since
+    // the factorization, m_X = M \ I(:,m_U) and the LU of the capacitance
+    // matrix I + diag(m_delta)*m_X(m_U,:)
+    Eigen::VectorXi m_U;
+    VectorXT m_delta;
+    MatrixXT m_X;
+    Eigen::PartialPivLU<MatrixXT> m_capacitance;
+  public:
+    min_quad_with_fixed_session():n(0),max_update_rank(16){}
+    // Analyze the pattern of A and factorize
+    //
+    // Inputs:
+    //   A  n by n symmetric matrix of quadratic coefficients
+    //   known  list of indices of known rows in Z
+    //   W  n list of soft constraint weights (>= 0)
+    // Returns true on success, false if the factorization failed
+    IGL_INLINE bool precompute(
+      const Eigen::SparseMatrix<T> & A,
+      const Eigen::VectorXi & known,
+      const VectorXT & W);
+    // Refactorize with new values, reusing the analysis if A has the pattern
+    // of the previous call (otherwise falls back to precompute)
+    //
+    // Inputs:
+    //   A  n by n symmetric matrix of quadratic coefficients
+    //   known  list of indices of known rows in Z
+    //   W  n list of soft constraint weights (>= 0)
+    // Returns true on success, false if the factorization failed
+    IGL_INLINE bool update(
+      const Eigen::SparseMatrix<T> & A,
+      const Eigen::VectorXi & known,
+      const VectorXT & W);
+    // Change the soft constraint weights only. If at most max_update_rank
+    // weights of unknown rows differ from those of the last factorization,
+    // the factorization is kept and solves apply a low rank correction,
+    // otherwise the system is refactorized.
+    //
+    // Inputs:
+    //   W  n list of soft constraint weights (>= 0)
+    // Returns true on success, false if the factorization or the low rank
+    // update failed
+    IGL_INLINE bool update_weights(const VectorXT & W);
+    // Number of weights currently handled by the low rank correction
+    int update_rank() const { return m_U.size(); }
+    // Solve for the current values, weights and known rows
+    //
+    // Inputs:
+    //   B  n by k list of linear coefficients
+    //   Y  #known by k list of fixed values
+    //   S  n by k list of soft constraint targets (only rows with nonzero
+    //     weight are read)
+    // Outputs:
+    //   Z  n by k solution
+    // Returns true on success, false on error
+    template <
+      typename DerivedB,
+      typename DerivedY,
+      typename DerivedS,
+      typename DerivedZ>
+    IGL_INLINE bool solve(
+      const Eigen::MatrixBase<DerivedB> & B,
+      const Eigen::MatrixBase<DerivedY> & Y,
+      const Eigen::MatrixBase<DerivedS> & S,
+      Eigen::PlainObjectBase<DerivedZ> & Z) const;
+  private:
+    // Set known rows, fill values of m_M and factorize
+    IGL_INLINE bool factorize(const Eigen::VectorXi & known);
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "min_quad_with_fixed_session.cpp"
+#endif
+
+#endif
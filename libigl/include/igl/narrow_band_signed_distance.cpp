@@ -0,0 +1,304 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "narrow_band_signed_distance.h"
+#include "AABB.h"
+#include "WindingNumberAABB.h"
+#include "parallel_for.h"
+#include "per_edge_normals.h"
+#include "per_face_normals.h"
+#include "per_vertex_normals.h"
+#include "pseudonormal_test.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename Derivedorigin,
+  typename DerivedS,
+  typename DerivedGV,
+  typename DerivedGI,
+  typename DerivedCI>
+IGL_INLINE void igl::narrow_band_signed_distance(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const Eigen::MatrixBase<Derivedorigin> & origin,
+  const typename DerivedV::Scalar h,
+  const typename DerivedV::Scalar band,
+  const SignedDistanceType sign_type,
+  Eigen::PlainObjectBase<DerivedS> & S,
+  Eigen::PlainObjectBase<DerivedGV> & GV,
+  Eigen::PlainObjectBase<DerivedGI> & GI,
+  Eigen::PlainObjectBase<DerivedCI> & CI)
+{
+  typedef typename DerivedV::Scalar Scalar;
+  typedef typename DerivedF::Scalar Index;
+  typedef Eigen::Matrix<Scalar,1,3> RowVector3S;
+  assert(V.cols() == 3 && "V should have 3d positions");
+  assert(F.cols() == 3 && "F should contain triangles");
+  assert(h > 0 && "h should be positive");
+
+  // Lattice coordinates packed into one integer, ordered by z, y, then x
+  const int bits = 21;
+  const int64_t bias = int64_t(1)<<(bits-1);
+  const int64_t mask = (int64_t(1)<<bits)-1;
+  const auto key = [&](const int64_t i,const int64_t j,const int64_t k)
+  {
+    assert(std::abs(i)<bias && std::abs(j)<bias && std::abs(k)<bias);
+    return ((k+bias)<<(2*bits)) | ((j+bias)<<bits) | (i+bias);
+  };
+  const auto coordinate = [&](const int64_t key, const int c)->int
+  {
+    return int(((key>>(c*bits))&mask)-bias);
+  };
+  const auto point = [&](const int64_t key)
+  {
+    return RowVector3S(
+      RowVector3S(origin.template cast<Scalar>()) +
+      h*RowVector3S(coordinate(key,0),coordinate(key,1),coordinate(key,2)));
+  };
+  const int64_t neighbors[6] = {
+    key(1,0,0)-key(0,0,0), key(0,0,0)-key(1,0,0),
+    key(0,1,0)-key(0,0,0), key(0,0,0)-key(0,1,0),
+    key(0,0,1)-key(0,0,0), key(0,0,0)-key(0,0,1)};
+
+  // Prepare distance and sign computation
+  AABB<DerivedV,3> tree;
+  tree.init(V,F);
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3> FN,VN,EN;
+  Eigen::Matrix<Index,Eigen::Dynamic,2> E;
+  Eigen::Matrix<Index,Eigen::Dynamic,1> EMAP;
+  WindingNumberAABB<RowVector3S,DerivedV,DerivedF> hier;
+  switch(sign_type)
+  {
+    default:
+      assert(false && "Unknown SignedDistanceType");
+      // Empty band rather than unsigned distances in release builds
+      S.resize(0,1);
+      GV.resize(0,3);
+      GI.resize(0,3);
+      CI.resize(0,8);
+      return;
+    case SIGNED_DISTANCE_TYPE_UNSIGNED:
+      break;
+    case SIGNED_DISTANCE_TYPE_DEFAULT:
+    case SIGNED_DISTANCE_TYPE_WINDING_NUMBER:
+      hier.set_mesh(V,F);
+      hier.grow();
+      break;
+    case SIGNED_DISTANCE_TYPE_PSEUDONORMAL:
+      per_face_normals(V,F,FN);
+      per_vertex_normals(V,F,PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE,FN,VN);
+      per_edge_normals(
+        V,F,PER_EDGE_NORMALS_WEIGHTING_TYPE_UNIFORM,FN,EN,E,EMAP);
+      break;
+  }
+  const bool winding_number =
+    sign_type == SIGNED_DISTANCE_TYPE_DEFAULT ||
+    sign_type == SIGNED_DISTANCE_TYPE_WINDING_NUMBER;
+  const auto exact_sign = [&](const RowVector3S & q)->Scalar
+  {
+    return hier.winding_number(q) > 0.5 ? -1 : 1;
+  };
+
+  const Scalar band_h = std::max(band,Scalar(std::sqrt(3.0)))*h;
+  const Scalar up_sqr_d = band_h*band_h;
+
+  // Grow the band breadth first from the lattice points closest to the
+  // vertices. Distances of a whole layer are computed in parallel; points
+  // outside the band end the growth. The squared distance of a point is
+  // up_sqr_d if it lies outside of the band.
+  std::vector<int64_t> K;
+  std::vector<Scalar> sqrD, sgn;
+  // Index into K of each visited lattice point
+  std::unordered_map<int64_t,int> visited;
+  for(int v = 0;v<V.rows();v++)
+  {
+    const RowVector3S g = (V.row(v)-origin.template cast<Scalar>())/h;
+    const int64_t k = key(
+      std::llround(g(0)),std::llround(g(1)),std::llround(g(2)));
+    if(visited.emplace(k,int(K.size())).second)
+    {
+      K.push_back(k);
+    }
+  }
+  for(size_t begin = 0;begin<K.size();)
+  {
+    const size_t end = K.size();
+    sqrD.resize(end);
+    sgn.resize(end,1);
+    parallel_for(end-begin,[&](const int e)
+    {
+      const size_t p = begin+e;
+      const RowVector3S q = point(K[p]);
+      RowVector3S c;
+      int i = -1;
+      sqrD[p] = tree.squared_distance(V,F,q,up_sqr_d,i,c);
+      if(sign_type == SIGNED_DISTANCE_TYPE_PSEUDONORMAL && sqrD[p]<up_sqr_d)
+      {
+        RowVector3S n;
+        pseudonormal_test(V,F,FN,VN,EN,EMAP,q,i,c,sgn[p],n);
+      }
+    },1000);
+    for(size_t p = begin;p<end;p++)
+    {
+      if(sqrD[p] >= up_sqr_d)
+      {
+        continue;
+      }
+      for(const int64_t offset : neighbors)
+      {
+        if(visited.emplace(K[p]+offset,int(K.size())).second)
+        {
+          K.push_back(K[p]+offset);
+        }
+      }
+    }
+    begin = end;
+  }
+
+  // Points of the band in lattice order, re-index visited points into them
+  std::vector<int> B;
+  for(int p = 0;p<int(K.size());p++)
+  {
+    if(sqrD[p] < up_sqr_d)
+    {
+      B.push_back(p);
+    }
+  }
+  std::sort(B.begin(),B.end(),[&](const int a,const int b){return K[a]<K[b];});
+  for(auto & kv : visited)
+  {
+    kv.second = -1;
+  }
+  for(int b = 0;b<int(B.size());b++)
+  {
+    visited[K[B[b]]] = b;
+  }
+
+  if(winding_number)
+  {
+    // Exact signs only next to the surface: the segment from a point further
+    // than h to any of its neighbors cannot cross the surface, so its sign is
+    // the neighbor's
+    std::vector<char> known(B.size(),0);
+    const Scalar sqr_h = h*h;
+    parallel_for(B.size(),[&](const int b)
+    {
+      if(sqrD[B[b]] <= sqr_h)
+      {
+        sgn[B[b]] = exact_sign(point(K[B[b]]));
+        known[b] = 1;
+      }
+    },1000);
+    std::vector<int> queue;
+    for(int b = 0;b<int(B.size());b++)
+    {
+      if(known[b])
+      {
+        queue.push_back(b);
+      }
+    }
+    for(size_t front = 0;front<queue.size();front++)
+    {
+      const int b = queue[front];
+      for(const int64_t offset : neighbors)
+      {
+        const auto it = visited.find(K[B[b]]+offset);
+        if(it != visited.end() && it->second >= 0 && !known[it->second])
+        {
+          sgn[B[it->second]] = sgn[B[b]];
+          known[it->second] = 1;
+          queue.push_back(it->second);
+        }
+      }
+    }
+    // Points not connected to the surface through the band
+    parallel_for(B.size(),[&](const int b)
+    {
+      if(!known[b])
+      {
+        sgn[B[b]] = exact_sign(point(K[B[b]]));
+      }
+    },1000);
+  }
+
+  S.resize(B.size(),1);
+  GV.resize(B.size(),3);
+  GI.resize(B.size(),3);
+  parallel_for(B.size(),[&](const int b)
+  {
+    const int p = B[b];
+    S(b) = sgn[p]*std::sqrt(sqrD[p]);
+    GV.row(b) = point(K[p]).template cast<typename DerivedGV::Scalar>();
+    for(int c = 0;c<3;c++)
+    {
+      GI(b,c) = coordinate(K[p],c);
+    }
+  },1000);
+
+  // Cells with all corners in the band, keyed by their first corner
+  const int64_t corners[8] = {
+    key(0,0,0), key(1,0,0), key(1,1,0), key(0,1,0),
+    key(0,0,1), key(1,0,1), key(1,1,1), key(0,1,1)};
+  std::vector<Eigen::Matrix<typename DerivedCI::Scalar,1,8> > cells;
+  for(int b = 0;b<int(B.size());b++)
+  {
+    Eigen::Matrix<typename DerivedCI::Scalar,1,8> cell;
+    cell(0) = b;
+    int c = 1;
+    for(;c<8;c++)
+    {
+      const auto it = visited.find(K[B[b]]+corners[c]-corners[0]);
+      if(it == visited.end() || it->second < 0)
+      {
+        break;
+      }
+      cell(c) = it->second;
+    }
+    if(c == 8)
+    {
+      cells.push_back(cell);
+    }
+  }
+  CI.resize(cells.size(),8);
+  for(int c = 0;c<int(cells.size());c++)
+  {
+    CI.row(c) = cells[c];
+  }
+}
+
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename Derivedorigin,
+  typename DerivedS,
+  typename DerivedGV,
+  typename DerivedCI>
+IGL_INLINE void igl::narrow_band_signed_distance(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const Eigen::MatrixBase<Derivedorigin> & origin,
+  const typename DerivedV::Scalar h,
+  const typename DerivedV::Scalar band,
+  const SignedDistanceType sign_type,
+  Eigen::PlainObjectBase<DerivedS> & S,
+  Eigen::PlainObjectBase<DerivedGV> & GV,
+  Eigen::PlainObjectBase<DerivedCI> & CI)
+{
+  Eigen::MatrixXi GI;
+  return narrow_band_signed_distance(V,F,origin,h,band,sign_type,S,GV,GI,CI);
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template void igl::narrow_band_signed_distance<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, 1, 3, 1, 1, 3>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> > const&, double, double, igl::SignedDistanceType, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+template void igl::narrow_band_signed_distance<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, 1, 3, 1, 1, 3>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> > const&, double, double, igl::SignedDistanceType, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+#endif
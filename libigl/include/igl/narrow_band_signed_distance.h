@@ -0,0 +1,91 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_NARROW_BAND_SIGNED_DISTANCE_H
+#define IGL_NARROW_BAND_SIGNED_DISTANCE_H
+#include "igl_inline.h"
+#include "signed_distance.h"
+#include <Eigen/Core>
+
+namespace igl
+{
+  // Signed distances to a triangle mesh at the points of the infinite lattice
+  // origin + h*(i,j,k) lying within a band around the surface. The band is
+  // grown from the lattice points closest to the mesh vertices, so time and
+  // memory scale with the area of the surface rather than with the volume of
+  // its bounding box.
+  //
+  // Only points at most h from the surface get their sign computed with
+  // sign_type; points further away take the sign of a neighbor closer to the
+  // surface (no surface can pass between them).
+  //
+  // Inputs:
+  //   V  #V by 3 list of vertex positions
+  //   F  #F by 3 list of triangle indices
+  //   origin  1 by 3 position of the lattice point (0,0,0)
+  //   h  lattice spacing
+  //   band  half width of the band in units of h. Values below sqrt(3) are
+  //     raised to sqrt(3) so that every cell crossing the surface is output.
+  //   sign_type  SIGNED_DISTANCE_TYPE_PSEUDONORMAL, _WINDING_NUMBER (_DEFAULT)
+  //     or _UNSIGNED, see signed_distance.h. Any other value asserts, and
+  //     gives empty outputs when asserts are disabled.
+  // Outputs:
+  //   S  #GV list of signed distances
+  //   GV  #GV by 3 list of lattice point positions within the band, sorted
+  //     by lattice coordinates (z, then y, then x)
+  //   GI  #GV by 3 list of integer lattice coordinates (i,j,k) of GV
+  //   CI  #CI by 8 list of indices into GV of the corners of the lattice cells
+  //     whose 8 corners all lie within the band, in the corner order of
+  //     igl::copyleft::marching_cubes for a dense grid, so that
+  //     copyleft::marching_cubes(S,GV,CI,SV,SF) extracts the zero level set
+  //
+  // Known bugs: Like signed_distance, only distances to triangles are
+  // computed. Lattice coordinates are limited to (-2^20,2^20).
+  //
+  // See also: signed_distance, sparse_voxel_grid
+  template <
+    typename DerivedV,
+    typename DerivedF,
+    typename Derivedorigin,
+    typename DerivedS,
+    typename DerivedGV,
+    typename DerivedGI,
+    typename DerivedCI>
+  IGL_INLINE void narrow_band_signed_distance(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const Eigen::MatrixBase<Derivedorigin> & origin,
+    const typename DerivedV::Scalar h,
+    const typename DerivedV::Scalar band,
+    const SignedDistanceType sign_type,
+    Eigen::PlainObjectBase<DerivedS> & S,
+    Eigen::PlainObjectBase<DerivedGV> & GV,
+    Eigen::PlainObjectBase<DerivedGI> & GI,
+    Eigen::PlainObjectBase<DerivedCI> & CI);
+  // Without lattice coordinates
+  template <
+    typename DerivedV,
+    typename DerivedF,
+    typename Derivedorigin,
+    typename DerivedS,
+    typename DerivedGV,
+    typename DerivedCI>
+  IGL_INLINE void narrow_band_signed_distance(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const Eigen::MatrixBase<Derivedorigin> & origin,
+    const typename DerivedV::Scalar h,
+    const typename DerivedV::Scalar band,
+    const SignedDistanceType sign_type,
+    Eigen::PlainObjectBase<DerivedS> & S,
+    Eigen::PlainObjectBase<DerivedGV> & GV,
+    Eigen::PlainObjectBase<DerivedCI> & CI);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "narrow_band_signed_distance.cpp"
+#endif
+
+#endif
@@ -101,11 +101,14 @@ IGL_INLINE void igl::opengl::ViewerData::set_normals(const Eigen::MatrixXd& N)
   {
     set_face_based(false);
     V_normals = N;
+    // Custom normals must not be partially overwritten by compute_normals
+    normals_data = igl::per_vertex_normals_cached_data<double>();
   }
   else if (N.rows() == F.rows() || N.rows() == F.rows()*3)
   {
     set_face_based(true);
     F_normals = N;
+    normals_data = igl::per_vertex_normals_cached_data<double>();
   }
   else
     cerr << "ERROR (set_normals): Please provide a normal per face, per corner or per vertex."<<endl;
@@ -362,12 +365,25 @@ IGL_INLINE void igl::opengl::ViewerData::clear()
   labels_strings.clear();
 
   face_based = false;
+  normals_data = igl::per_vertex_normals_cached_data<double>();
 }
 
 IGL_INLINE void igl::opengl::ViewerData::compute_normals()
 {
-  igl::per_face_normals(V, F, F_normals);
-  igl::per_vertex_normals(V, F, F_normals, V_normals);
+  // Connectivity usually stays the same between calls (set_vertices)
+  if(normals_data.F.rows() == F.rows() && normals_data.F.cols() == F.cols() &&
+    normals_data.F == F &&
+    normals_data.V.rows() == V.rows() && V_normals.rows() == V.rows())
+  {
+    igl::per_vertex_normals_cached(V, normals_data, V_normals);
+  }
+  else
+  {
+    igl::per_vertex_normals_cached_precompute(
+      V, F, igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT, normals_data,
+      V_normals);
+  }
+  F_normals = normals_data.FN;
   dirty |= MeshGL::DIRTY_NORMAL;
 }
 
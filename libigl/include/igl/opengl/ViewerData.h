@@ -10,6 +10,7 @@
 
 #include "../igl_inline.h"
 #include "MeshGL.h"
+#include "../per_vertex_normals.h"
 #include <cassert>
 #include <cstdint>
 #include <Eigen/Core>
@@ -200,6 +201,10 @@ public:
   // OpenGL representation of the mesh
   igl::opengl::MeshGL meshgl;
 
+  // Adjacency and previous positions of compute_normals, so that moving a
+  // few vertices only updates their neighborhood
+  igl::per_vertex_normals_cached_data<double> normals_data;
+
   // Update contents from a 'Data' instance
   IGL_INLINE void updateGL(
     const igl::opengl::ViewerData& data,
@@ -8,6 +8,7 @@
 #ifndef IGL_PARALLEL_FOR_H
 #define IGL_PARALLEL_FOR_H
 #include "igl_inline.h"
+#include <cstddef>
 #include <functional>
 
 //#warning "Defining IGL_PARALLEL_FOR_FORCE_SERIAL"
@@ -29,6 +30,14 @@ namespace igl
   // available on the current hardware to parallelize this for loop so long as
   // loop_size<min_parallel, otherwise it will just use a serial for loop.
   //
+  // Loops are dispatched onto a persistent process-wide pool (see
+  // igl::ThreadPool) and iterations are handed out dynamically in chunks, so
+  // short loops do not pay for thread creation and iterations of uneven cost
+  // are balanced. The number of threads is igl::default_num_threads(), which
+  // can be set with the environment variable IGL_NUM_THREADS. Calling
+  // parallel_for from within the func of another parallel_for is safe: the
+  // inner loop runs serially on the calling thread.
+  //
   // Inputs:
   //   loop_size  number of iterations. I.e. for(int i = 0;i<loop_size;i++) ...
   //   func  function handle taking iteration index as only argument to compute
@@ -89,6 +98,9 @@ namespace igl
 
 // Implementation
 
+#include "ThreadPool.h"
+#include "default_num_threads.h"
+#include <atomic>
 #include <cmath>
 #include <cassert>
 #include <thread>
@@ -123,16 +135,15 @@ inline bool igl::parallel_for(
 {
   assert(loop_size>=0);
   if(loop_size==0) return false;
-  // Estimate number of threads in the pool
-  // http://ideone.com/Z7zldb
-  const static size_t sthc = std::thread::hardware_concurrency();
+  // Nested loops run serially on the thread of the enclosing loop
   const size_t nthreads = 
 #ifdef IGL_PARALLEL_FOR_FORCE_SERIAL
     0;
 #else
-    loop_size<min_parallel?0:(sthc==0?8:sthc);
+    (loop_size<min_parallel || igl::ThreadPool::in_job()) ? 
+      0 : igl::default_num_threads();
 #endif
-  if(nthreads==0)
+  if(nthreads<=1)
   {
     // serial
     prep_func(1);
@@ -141,44 +152,38 @@ inline bool igl::parallel_for(
     return false;
   }else
   {
-    // Size of a slice for the range functions
-    Index slice = 
-      std::max(
-        (Index)std::round((loop_size+1)/static_cast<double>(nthreads)),(Index)1);
- 
-    // [Helper] Inner loop
-    const auto & range = [&func](const Index k1, const Index k2, const size_t t)
+    // Threads claim chunks of iterations from a shared counter, so uneven
+    // iterations balance out. Several chunks per thread keep the tail short
+    // while keeping the number of atomic operations low.
+    const size_t size = static_cast<size_t>(loop_size);
+    const size_t chunk = std::max(size/(8*nthreads),static_cast<size_t>(1));
+    std::atomic<size_t> next(0);
+    const std::function<void(const size_t)> job = 
+      [&func,&next,size,chunk](const size_t t)
     {
-      for(Index k = k1; k < k2; k++) func(k,t);
+      for(size_t k1 = next.fetch_add(chunk);k1<size;k1 = next.fetch_add(chunk))
+      {
+        const size_t k2 = std::min(k1+chunk,size);
+        for(Index k = static_cast<Index>(k1);k<static_cast<Index>(k2);k++)
+        {
+          func(k,t);
+        }
+      }
     };
     prep_func(nthreads);
-    // Create pool and launch jobs
-    std::vector<std::thread> pool;
-    pool.reserve(nthreads);
-    // Inner range extents
-    Index i1 = 0;
-    Index i2 = std::min(0 + slice, loop_size);
+    // The pool declines if another thread's loop is running: then this loop
+    // runs serially as thread 0 (still valid for the nthreads prepared)
+    const bool pooled = igl::ThreadPool::instance().run(nthreads,job);
+    if(!pooled)
     {
-      size_t t = 0;
-      for (; t+1 < nthreads && i1 < loop_size; ++t)
-      {
-        pool.emplace_back(range, i1, i2, t);
-        i1 = i2;
-        i2 = std::min(i2 + slice, loop_size);
-      }
-      if (i1 < loop_size)
-      {
-        pool.emplace_back(range, i1, loop_size, t);
-      }
+      job(0);
     }
-    // Wait for jobs to finish
-    for (std::thread &t : pool) if (t.joinable()) t.join();
     // Accumulate across threads
     for(size_t t = 0;t<nthreads;t++)
     {
       accum_func(t);
     }
-    return true;
+    return pooled;
   }
 }
  
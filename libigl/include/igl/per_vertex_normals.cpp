@@ -11,7 +11,98 @@
 #include "per_face_normals.h"
 #include "doublearea.h"
 #include "parallel_for.h"
+#include "default_num_threads.h"
 #include "internal_angles.h"
+#include "slice.h"
+
+namespace igl
+{
+  namespace per_vertex_normals_helpers
+  {
+    // Corners f*3+c incident on each vertex i, in increasing order:
+    // corner(start(i):start(i+1)-1)
+    template <typename DerivedF>
+    inline void vertex_corners(
+      const Eigen::MatrixBase<DerivedF>& F,
+      const int n,
+      Eigen::VectorXi & start,
+      Eigen::VectorXi & corner)
+    {
+      start = Eigen::VectorXi::Zero(n+1);
+      for(int i = 0;i<F.rows();i++)
+      {
+        for(int j = 0;j<3;j++)
+        {
+          start(F(i,j)+1)++;
+        }
+      }
+      for(int i = 0;i<n;i++)
+      {
+        start(i+1) += start(i);
+      }
+      corner.resize(3*F.rows());
+      Eigen::VectorXi next = start.head(n);
+      for(int i = 0;i<F.rows();i++)
+      {
+        for(int j = 0;j<3;j++)
+        {
+          corner(next(F(i,j))++) = 3*i+j;
+        }
+      }
+    }
+
+    // #F by 3 weights of the face normal at each corner
+    template <typename DerivedV, typename DerivedF, typename DerivedW>
+    inline void corner_weights(
+      const Eigen::MatrixBase<DerivedV>& V,
+      const Eigen::MatrixBase<DerivedF>& F,
+      const igl::PerVertexNormalsWeightingType weighting,
+      Eigen::PlainObjectBase<DerivedW> & W)
+    {
+      W.resize(F.rows(),3);
+      switch(weighting)
+      {
+        case PER_VERTEX_NORMALS_WEIGHTING_TYPE_UNIFORM:
+          W.setConstant(1.);
+          break;
+        default:
+          assert(false && "Unknown weighting type");
+        case PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT:
+        case PER_VERTEX_NORMALS_WEIGHTING_TYPE_AREA:
+        {
+          Eigen::Matrix<typename DerivedW::Scalar,DerivedF::RowsAtCompileTime,1> A;
+          doublearea(V,F,A);
+          W = A.replicate(1,3);
+          break;
+        }
+        case PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE:
+          internal_angles(V,F,W);
+          break;
+      }
+    }
+
+    // Normal of vertex i: normalized sum of the weighted normals of its
+    // corners, summed in the order of the serial accumulation
+    template <typename DerivedW, typename DerivedFN, typename DerivedN>
+    inline void gather(
+      const Eigen::VectorXi & start,
+      const Eigen::VectorXi & corner,
+      const Eigen::MatrixBase<DerivedW>& W,
+      const Eigen::MatrixBase<DerivedFN>& FN,
+      const int i,
+      Eigen::PlainObjectBase<DerivedN> & N)
+    {
+      Eigen::Matrix<typename DerivedN::Scalar,1,3> n(0,0,0);
+      for(int k = start(i);k<start(i+1);k++)
+      {
+        const int f = corner(k)/3;
+        n += W(f,corner(k)%3) * FN.row(f);
+      }
+      n.normalize();
+      N.row(i) = n;
+    }
+  }
+}
 
 template <
   typename DerivedV,
@@ -46,62 +137,37 @@ IGL_INLINE void igl::per_vertex_normals(
   Eigen::PlainObjectBase<DerivedN> & N)
 {
   using namespace std;
+  using namespace per_vertex_normals_helpers;
   // Resize for output
   N.setZero(V.rows(),3);
 
-  Eigen::Matrix<typename DerivedN::Scalar,DerivedF::RowsAtCompileTime,3>
-    W(F.rows(),3);
-  switch(weighting)
-  {
-    case PER_VERTEX_NORMALS_WEIGHTING_TYPE_UNIFORM:
-      W.setConstant(1.);
-      break;
-    default:
-      assert(false && "Unknown weighting type");
-    case PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT:
-    case PER_VERTEX_NORMALS_WEIGHTING_TYPE_AREA:
-    {
-      Eigen::Matrix<typename DerivedN::Scalar,DerivedF::RowsAtCompileTime,1> A;
-      doublearea(V,F,A);
-      W = A.replicate(1,3);
-      break;
-    }
-    case PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE:
-      internal_angles(V,F,W);
-      break;
-  }
+  Eigen::Matrix<typename DerivedN::Scalar,DerivedF::RowsAtCompileTime,3> W;
+  corner_weights(V,F,weighting,W);
 
-  // loop over faces
-  for(int i = 0;i<F.rows();i++)
+  // Building the adjacency for the race-free gather costs about as much as
+  // the serial accumulation, so it only pays off on several threads
+  if(F.rows() < 10000 || igl::default_num_threads() <= 1)
   {
-    // throw normal at each corner
-    for(int j = 0; j < 3;j++)
+    // loop over faces
+    for(int i = 0;i<F.rows();i++)
     {
-      N.row(F(i,j)) += W(i,j) * FN.row(i);
+      // throw normal at each corner
+      for(int j = 0; j < 3;j++)
+      {
+        N.row(F(i,j)) += W(i,j) * FN.row(i);
+      }
     }
+    // take average via normalization
+    N.rowwise().normalize();
+    return;
   }
 
-  //// loop over faces
-  //std::mutex critical;
-  //std::vector<DerivedN> NN;
-  //parallel_for(
-  //  F.rows(),
-  //  [&NN,&N](const size_t n){ NN.resize(n,DerivedN::Zero(N.rows(),3));},
-  //  [&F,&W,&FN,&NN,&critical](const int i, const size_t t)
-  //  {
-  //    // throw normal at each corner
-  //    for(int j = 0; j < 3;j++)
-  //    {
-  //      // Q: Does this need to be critical?
-  //      // A: Yes. Different (i,j)'s could produce the same F(i,j)
-  //      NN[t].row(F(i,j)) += W(i,j) * FN.row(i);
-  //    }
-  //  },
-  //  [&N,&NN](const size_t t){ N += NN[t]; },
-  //  1000l);
-
-  // take average via normalization
-  N.rowwise().normalize();
+  Eigen::VectorXi start,corner;
+  vertex_corners(F,V.rows(),start,corner);
+  parallel_for(
+    V.rows(),
+    [&](const int i){ gather(start,corner,W,FN,i,N); },
+    1000);
 }
 
 template <
@@ -119,6 +185,151 @@ IGL_INLINE void igl::per_vertex_normals(
     per_vertex_normals(V,F,PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT,FN,N);
 }
 
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename Scalar,
+  typename DerivedN>
+IGL_INLINE void igl::per_vertex_normals_cached_precompute(
+  const Eigen::MatrixBase<DerivedV>& V,
+  const Eigen::MatrixBase<DerivedF>& F,
+  const igl::PerVertexNormalsWeightingType weighting,
+  per_vertex_normals_cached_data<Scalar> & data,
+  Eigen::PlainObjectBase<DerivedN> & N)
+{
+  using namespace per_vertex_normals_helpers;
+  assert(F.cols() == 3 && "Only triangle meshes are supported");
+  data.weighting = weighting;
+  data.F = F.template cast<int>();
+  data.V = V.template cast<Scalar>();
+  data.face_mark.assign(F.rows(),0);
+  data.vertex_mark.assign(V.rows(),0);
+  vertex_corners(data.F,V.rows(),data.corner_start,data.corner);
+  per_face_normals(data.V,data.F,data.FN);
+  corner_weights(data.V,data.F,weighting,data.W);
+  N.resize(V.rows(),3);
+  parallel_for(
+    V.rows(),
+    [&](const int i){ gather(data.corner_start,data.corner,data.W,data.FN,i,N); },
+    1000);
+}
+
+template <typename DerivedV, typename Scalar, typename DerivedN>
+IGL_INLINE int igl::per_vertex_normals_cached(
+  const Eigen::MatrixBase<DerivedV>& V,
+  per_vertex_normals_cached_data<Scalar> & data,
+  Eigen::PlainObjectBase<DerivedN> & N)
+{
+  assert(V.rows() == data.V.rows() && "V does not match precomputed data");
+  std::vector<char> & moved_mark = data.vertex_mark;
+  parallel_for(
+    V.rows(),
+    [&](const int i)
+    {
+      moved_mark[i] = (V.row(i).template cast<Scalar>() != data.V.row(i));
+    },
+    10000);
+  std::vector<int> moved;
+  for(int i = 0;i<V.rows();i++)
+  {
+    if(moved_mark[i])
+    {
+      moved.push_back(i);
+      moved_mark[i] = 0;
+    }
+  }
+  if(!moved.empty())
+  {
+    per_vertex_normals_cached(
+      V,Eigen::Map<const Eigen::VectorXi>(moved.data(),moved.size()),data,N);
+  }
+  return moved.size();
+}
+
+template <
+  typename DerivedV,
+  typename Derivedmoved,
+  typename Scalar,
+  typename DerivedN>
+IGL_INLINE void igl::per_vertex_normals_cached(
+  const Eigen::MatrixBase<DerivedV>& V,
+  const Eigen::MatrixBase<Derivedmoved>& moved,
+  per_vertex_normals_cached_data<Scalar> & data,
+  Eigen::PlainObjectBase<DerivedN> & N)
+{
+  using namespace per_vertex_normals_helpers;
+  assert(V.rows() == data.V.rows() && "V does not match precomputed data");
+  if(N.rows() != V.rows() || N.cols() != 3 || 4*moved.size() > V.rows())
+  {
+    // Most of the mesh moved: recompute everything (in parallel)
+    data.V = V.template cast<Scalar>();
+    per_face_normals(data.V,data.F,data.FN);
+    corner_weights(data.V,data.F,data.weighting,data.W);
+    N.resize(V.rows(),3);
+    parallel_for(
+      V.rows(),
+      [&](const int i){ gather(data.corner_start,data.corner,data.W,data.FN,i,N); },
+      1000);
+    return;
+  }
+  for(int k = 0;k<moved.size();k++)
+  {
+    data.V.row(moved(k)) = V.row(moved(k)).template cast<Scalar>();
+  }
+  // Faces incident on moved vertices
+  std::vector<int> faces;
+  for(int k = 0;k<moved.size();k++)
+  {
+    const int i = moved(k);
+    for(int c = data.corner_start(i);c<data.corner_start(i+1);c++)
+    {
+      const int f = data.corner(c)/3;
+      if(!data.face_mark[f])
+      {
+        data.face_mark[f] = 1;
+        faces.push_back(f);
+      }
+    }
+  }
+  // Recompute their normals and weights with the same routines as the full
+  // computation
+  const Eigen::Map<const Eigen::VectorXi> I(faces.data(),faces.size());
+  Eigen::MatrixXi F_moved;
+  slice(data.F,I,1,F_moved);
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3> FN_moved,W_moved;
+  per_face_normals(data.V,F_moved,FN_moved);
+  corner_weights(data.V,F_moved,data.weighting,W_moved);
+  // Vertices whose normal changed
+  std::vector<int> vertices;
+  for(int k = 0;k<(int)faces.size();k++)
+  {
+    const int f = faces[k];
+    data.face_mark[f] = 0;
+    data.FN.row(f) = FN_moved.row(k);
+    data.W.row(f) = W_moved.row(k);
+    for(int j = 0;j<3;j++)
+    {
+      const int i = data.F(f,j);
+      if(!data.vertex_mark[i])
+      {
+        data.vertex_mark[i] = 1;
+        vertices.push_back(i);
+      }
+    }
+  }
+  parallel_for(
+    vertices.size(),
+    [&](const size_t k)
+    {
+      gather(data.corner_start,data.corner,data.W,data.FN,vertices[k],N);
+    },
+    1000);
+  for(const int i : vertices)
+  {
+    data.vertex_mark[i] = 0;
+  }
+}
+
 #ifdef IGL_STATIC_LIBRARY
 // Explicit template instantiation
 // generated by autoexplicit.sh
@@ -130,4 +341,7 @@ template void igl::per_vertex_normals<Eigen::Matrix<double, -1, -1, 0, -1, -1>,
 template void igl::per_vertex_normals<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix<double, -1, 3, 0, -1, 3> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::PerVertexNormalsWeightingType, Eigen::MatrixBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&);
 template void igl::per_vertex_normals<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::PerVertexNormalsWeightingType, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
 template void igl::per_vertex_normals<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+template void igl::per_vertex_normals_cached_precompute<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, double, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::PerVertexNormalsWeightingType, igl::per_vertex_normals_cached_data<double>&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+template int igl::per_vertex_normals_cached<Eigen::Matrix<double, -1, -1, 0, -1, -1>, double, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, igl::per_vertex_normals_cached_data<double>&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+template void igl::per_vertex_normals_cached<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, double, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> > const&, igl::per_vertex_normals_cached_data<double>&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
 #endif
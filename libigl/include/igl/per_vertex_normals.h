@@ -9,6 +9,7 @@
 #define IGL_PER_VERTEX_NORMALS_H
 #include "igl_inline.h"
 #include <Eigen/Core>
+#include <vector>
 // Note: It would be nice to support more or all of the methods here:
 // "A comparison of algorithms for vertex normal computation"
 namespace igl
@@ -25,7 +26,12 @@ namespace igl
     PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT = 3,
     NUM_PER_VERTEX_NORMALS_WEIGHTING_TYPE = 4
   };
-  // Compute vertex normals via vertex position list, face list
+  // Compute vertex normals via vertex position list, face list. Large meshes
+  // are processed in parallel: every vertex gathers the weighted normals of
+  // its incident faces (in the same order as the serial accumulation), so
+  // there are no write conflicts and results do not depend on the number of
+  // threads.
+  //
   // Inputs:
   //   V  #V by 3 eigen Matrix of mesh vertex 3D positions
   //   F  #F by 3 eigne Matrix of face (triangle) indices
@@ -71,8 +77,87 @@ namespace igl
     const Eigen::MatrixBase<DerivedFN>& FN,
     Eigen::PlainObjectBase<DerivedN> & N);
 
+  template <typename Scalar>
+  struct per_vertex_normals_cached_data;
+  // Incremental vertex normals for a mesh whose connectivity is fixed but
+  // whose vertices move (e.g., an animated or interactively deformed mesh).
+  // The precomputation stores the vertex-corner adjacency, face normals and
+  // corner weights. Updates recompute face normals and weights only for
+  // faces incident on moved vertices and vertex normals only for the
+  // vertices of those faces.
+  //
+  // Inputs:
+  //   V  #V by 3 eigen Matrix of mesh vertex 3D positions
+  //   F  #F by 3 eigne Matrix of face (triangle) indices
+  //   weighting  Weighting type
+  // Outputs:
+  //   data  adjacency, positions, face normals (data.FN) and weights
+  //   N  #V by 3 eigen Matrix of mesh vertex 3D normals
+  //
+  // See also: sparse_cached
+  template <
+    typename DerivedV,
+    typename DerivedF,
+    typename Scalar,
+    typename DerivedN>
+  IGL_INLINE void per_vertex_normals_cached_precompute(
+    const Eigen::MatrixBase<DerivedV>& V,
+    const Eigen::MatrixBase<DerivedF>& F,
+    const igl::PerVertexNormalsWeightingType weighting,
+    per_vertex_normals_cached_data<Scalar> & data,
+    Eigen::PlainObjectBase<DerivedN> & N);
+  // Update normals for new positions, moved vertices are found by comparing
+  // V to the positions of the previous call.
+  //
+  // Inputs:
+  //   V  #V by 3 new vertex positions
+  //   data  as left by a previous call
+  //   N  #V by 3 normals of the previous call
+  // Outputs:
+  //   data  updated positions, face normals and weights
+  //   N  #V by 3 updated normals
+  // Returns number of moved vertices
+  template <typename DerivedV, typename Scalar, typename DerivedN>
+  IGL_INLINE int per_vertex_normals_cached(
+    const Eigen::MatrixBase<DerivedV>& V,
+    per_vertex_normals_cached_data<Scalar> & data,
+    Eigen::PlainObjectBase<DerivedN> & N);
+  // Inputs:
+  //   moved  list of indices of vertices whose positions changed
+  template <
+    typename DerivedV,
+    typename Derivedmoved,
+    typename Scalar,
+    typename DerivedN>
+  IGL_INLINE void per_vertex_normals_cached(
+    const Eigen::MatrixBase<DerivedV>& V,
+    const Eigen::MatrixBase<Derivedmoved>& moved,
+    per_vertex_normals_cached_data<Scalar> & data,
+    Eigen::PlainObjectBase<DerivedN> & N);
 }
 
+template <typename Scalar>
+struct igl::per_vertex_normals_cached_data
+{
+  PerVertexNormalsWeightingType weighting;
+  Eigen::MatrixXi F;
+  // Corners f*3+c incident on vertex i are
+  // corner(corner_start(i):corner_start(i+1)-1), in increasing order
+  Eigen::VectorXi corner_start;
+  Eigen::VectorXi corner;
+  // Positions of the last update
+  Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic> V;
+  // #F by 3 unit face normals
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3> FN;
+  // #F by 3 corner weights
+  Eigen::Matrix<Scalar,Eigen::Dynamic,3> W;
+  // Scratch marks of the incremental update
+  std::vector<char> face_mark;
+  std::vector<char> vertex_mark;
+  per_vertex_normals_cached_data():
+    weighting(PER_VERTEX_NORMALS_WEIGHTING_TYPE_DEFAULT){}
+};
+
 #ifndef IGL_STATIC_LIBRARY
 #  include "per_vertex_normals.cpp"
 #endif
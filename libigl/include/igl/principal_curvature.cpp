@@ -14,15 +14,16 @@
 #include <list>
 #include <cmath>
 #include <limits>
+#include <algorithm>
 
 #include <Eigen/SparseCholesky>
 
 // Lib IGL includes
-#include <igl/adjacency_list.h>
 #include <igl/per_face_normals.h>
 #include <igl/per_vertex_normals.h>
 #include <igl/avg_edge_length.h>
 #include <igl/vertex_triangle_adjacency.h>
+#include <igl/parallel_for.h>
 
 typedef enum
 {
@@ -36,17 +37,28 @@ typedef enum
   PROJ_PLANE
 } normalType;
 
+class comparer
+{
+public:
+  IGL_INLINE bool operator() (const std::pair<int, double>& lhs, const std::pair<int, double>&rhs) const
+  {
+    return lhs.second>rhs.second;
+  }
+};
+
 class CurvatureCalculator
 {
 public:
   /* Row number i represents the i-th vertex, whose columns are:
-   curv[i][0] : K2
-   curv[i][1] : K1
-   curvDir[i][0] : PD1
-   curvDir[i][1] : PD2
+   curv(i,0) : K2
+   curv(i,1) : K1
+   curvDir.row(i).head<3>() : PD1
+   curvDir.row(i).tail<3>() : PD2
+   computed[i] : whether curv and curvDir of vertex i are set
    */
-  std::vector< std::vector<double> > curv;
-  std::vector< std::vector<Eigen::Vector3d> > curvDir;
+  Eigen::MatrixXd curv;
+  Eigen::MatrixXd curvDir;
+  std::vector<char> computed;
   bool curvatureComputed;
   class Quadric
   {
@@ -139,6 +151,38 @@ public:
     }
   };
 
+  // Per thread buffers, reused from one vertex to the next
+  class Scratch
+  {
+  public:
+    // Vertex v was visited by the current search iff visited[v] == stamp
+    std::vector<int> visited;
+    int stamp;
+    std::vector<int> queue;
+    std::vector<std::pair<int,int> > ring_queue;
+    std::priority_queue<std::pair<int, double>, std::vector<std::pair<int, double> >, comparer > extra_candidates;
+    std::vector<int> vv;
+    std::vector<int> vvtmp;
+    std::vector<Eigen::Vector3d> points;
+
+    IGL_INLINE Scratch() : stamp(0) {}
+
+    // Start a new search on a mesh with n vertices
+    IGL_INLINE void new_search(const int n)
+    {
+      if ((int)visited.size() != n)
+      {
+        visited.assign(n,0);
+        stamp = 0;
+      }
+      if (++stamp == std::numeric_limits<int>::max())
+      {
+        std::fill(visited.begin(),visited.end(),0);
+        stamp = 1;
+      }
+    }
+  };
+
 public:
 
   Eigen::MatrixXd vertices;
@@ -146,9 +190,8 @@ public:
   // The i-th row contains the indices of the vertices that forms the i-th face in ccw order
   Eigen::MatrixXi faces;
 
-  std::vector<std::vector<int> > vertex_to_vertices;
-  std::vector<std::vector<int> > vertex_to_faces;
-  std::vector<std::vector<int> > vertex_to_faces_index;
+  // Flat adjacency and cached rings
+  const igl::principal_curvature_data * data;
   Eigen::MatrixXd face_normals;
   Eigen::MatrixXd vertex_normals;
 
@@ -174,22 +217,32 @@ public:
   int maxSize; /* The maximum limit of the radius in the benchmark */
 
   IGL_INLINE CurvatureCalculator();
-  IGL_INLINE void init(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F);
+  IGL_INLINE void init(const Eigen::MatrixXd& V, const igl::principal_curvature_data& data);
 
   IGL_INLINE void finalEigenStuff(int, const std::vector<Eigen::Vector3d>&, Quadric&);
-  IGL_INLINE void fitQuadric(const Eigen::Vector3d&, const std::vector<Eigen::Vector3d>& ref, const std::vector<int>& , Quadric *);
-  IGL_INLINE void applyProjOnPlane(const Eigen::Vector3d&, const std::vector<int>&, std::vector<int>&);
-  IGL_INLINE void getSphere(const int, const double, std::vector<int>&, int min);
-  IGL_INLINE void getKRing(const int, const double,std::vector<int>&);
-  IGL_INLINE Eigen::Vector3d project(const Eigen::Vector3d&, const Eigen::Vector3d&, const Eigen::Vector3d&);
-  IGL_INLINE void computeReferenceFrame(int, const Eigen::Vector3d&, std::vector<Eigen::Vector3d>&);
-  IGL_INLINE void getAverageNormal(int, const std::vector<int>&, Eigen::Vector3d&);
-  IGL_INLINE void getProjPlane(int, const std::vector<int>&, Eigen::Vector3d&);
-  IGL_INLINE void applyMontecarlo(const std::vector<int>&,std::vector<int>*);
+  IGL_INLINE void fitQuadric(const Eigen::Vector3d&, const std::vector<Eigen::Vector3d>& ref, const int *, const int, Quadric *, Scratch&) const;
+  IGL_INLINE void applyProjOnPlane(const Eigen::Vector3d&, const int *, const int, std::vector<int>&) const;
+  IGL_INLINE void getSphere(const int, const double, std::vector<int>&, int min, Scratch&) const;
+  IGL_INLINE void getKRing(const int, const int *&, int&) const;
+  IGL_INLINE Eigen::Vector3d project(const Eigen::Vector3d&, const Eigen::Vector3d&, const Eigen::Vector3d&) const;
+  IGL_INLINE void computeReferenceFrame(int, const Eigen::Vector3d&, std::vector<Eigen::Vector3d>&) const;
+  IGL_INLINE void getAverageNormal(int, const int *, const int, Eigen::Vector3d&) const;
+  IGL_INLINE void getProjPlane(int, const int *, const int, Eigen::Vector3d&) const;
+  IGL_INLINE void applyMontecarlo(const int *, const int, std::vector<int>*) const;
+  IGL_INLINE void computeVertexCurvature(const int, Scratch&);
   IGL_INLINE void computeCurvature();
   IGL_INLINE void printCurvature(const std::string& outpath);
   IGL_INLINE double getAverageEdge();
 
+  // Ring of radius k around start by breadth first search over (VV_start,VV)
+  IGL_INLINE static void kRingSearch(
+    const Eigen::VectorXi& VV_start,
+    const Eigen::VectorXi& VV,
+    const int start,
+    const int k,
+    std::vector<int>& vv,
+    Scratch& scratch);
+
   IGL_INLINE static int rotateForward (double *v0, double *v1, double *v2)
   {
     double t;
@@ -292,17 +345,9 @@ public:
 
 };
 
-class comparer
-{
-public:
-  IGL_INLINE bool operator() (const std::pair<int, double>& lhs, const std::pair<int, double>&rhs) const
-  {
-    return lhs.second>rhs.second;
-  }
-};
-
 IGL_INLINE CurvatureCalculator::CurvatureCalculator()
 {
+  this->data=nullptr;
   this->localMode=true;
   this->projectionPlaneCheck=true;
   this->sphereRadius=5;
@@ -315,7 +360,7 @@ IGL_INLINE CurvatureCalculator::CurvatureCalculator()
   this->expStep=true;
 }
 
-IGL_INLINE void CurvatureCalculator::init(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F)
+IGL_INLINE void CurvatureCalculator::init(const Eigen::MatrixXd& V, const igl::principal_curvature_data& data)
 {
   // Normalize vertices
   vertices = V;
@@ -324,19 +369,19 @@ IGL_INLINE void CurvatureCalculator::init(const Eigen::MatrixXd& V, const Eigen:
 //  vertices = vertices.array() / vertices.maxCoeff();
 //  vertices = vertices.array() * (1.0/igl::avg_edge_length(V,F));
 
-  faces = F;
-  igl::adjacency_list(F, vertex_to_vertices);
-  igl::vertex_triangle_adjacency(V, F, vertex_to_faces, vertex_to_faces_index);
-  igl::per_face_normals(V, F, face_normals);
-  igl::per_vertex_normals(V, F, face_normals, vertex_normals);
+  faces = data.F;
+  this->data = &data;
+  igl::per_face_normals(V, faces, face_normals);
+  igl::per_vertex_normals(V, faces, face_normals, vertex_normals);
 }
 
-IGL_INLINE void CurvatureCalculator::fitQuadric(const Eigen::Vector3d& v, const std::vector<Eigen::Vector3d>& ref, const std::vector<int>& vv, Quadric *q)
+IGL_INLINE void CurvatureCalculator::fitQuadric(const Eigen::Vector3d& v, const std::vector<Eigen::Vector3d>& ref, const int * vv, const int nv, Quadric *q, Scratch& scratch) const
 {
-  std::vector<Eigen::Vector3d> points;
-  points.reserve (vv.size());
+  std::vector<Eigen::Vector3d>& points = scratch.points;
+  points.clear();
+  points.reserve (nv);
 
-  for (unsigned int i = 0; i < vv.size(); ++i) {
+  for (int i = 0; i < nv; ++i) {
 
     Eigen::Vector3d  cp = vertices.row(vv[i]);
 
@@ -424,118 +469,122 @@ IGL_INLINE void CurvatureCalculator::finalEigenStuff(int i, const std::vector<Ei
 
   if (c_val[0] > c_val[1])
   {
-    curv[i]=std::vector<double>(2);
-    curv[i][0]=c_val(1);
-    curv[i][1]=c_val(0);
-    curvDir[i]=std::vector<Eigen::Vector3d>(2);
-    curvDir[i][0]=v2global;
-    curvDir[i][1]=v1global;
+    curv.row(i) << c_val(1), c_val(0);
+    curvDir.row(i) << v2global.transpose(), v1global.transpose();
   }
   else
   {
-    curv[i]=std::vector<double>(2);
-    curv[i][0]=c_val(0);
-    curv[i][1]=c_val(1);
-    curvDir[i]=std::vector<Eigen::Vector3d>(2);
-    curvDir[i][0]=v1global;
-    curvDir[i][1]=v2global;
+    curv.row(i) << c_val(0), c_val(1);
+    curvDir.row(i) << v1global.transpose(), v2global.transpose();
   }
+  computed[i] = 1;
   // ---- end Eigen stuff
 }
 
-IGL_INLINE void CurvatureCalculator::getKRing(const int start, const double r, std::vector<int>&vv)
+IGL_INLINE void CurvatureCalculator::kRingSearch(
+  const Eigen::VectorXi& VV_start,
+  const Eigen::VectorXi& VV,
+  const int start,
+  const int k,
+  std::vector<int>& vv,
+  Scratch& scratch)
 {
-  int bufsize=vertices.rows();
-  vv.reserve(bufsize);
-  std::list<std::pair<int,int> > queue;
-  bool* visited = (bool*)calloc(bufsize,sizeof(bool));
+  scratch.new_search(VV_start.size()-1);
+  std::vector<std::pair<int,int> >& queue = scratch.ring_queue;
+  queue.clear();
   queue.push_back(std::pair<int,int>(start,0));
-  visited[start]=true;
-  while (!queue.empty())
+  scratch.visited[start]=scratch.stamp;
+  for (size_t head = 0; head < queue.size(); ++head)
   {
-    int toVisit=queue.front().first;
-    int distance=queue.front().second;
-    queue.pop_front();
+    int toVisit=queue[head].first;
+    int distance=queue[head].second;
     vv.push_back(toVisit);
-    if (distance<(int)r)
+    if (distance<k)
     {
-      for (unsigned int i=0; i<vertex_to_vertices[toVisit].size(); ++i)
+      for (int i=VV_start(toVisit); i<VV_start(toVisit+1); ++i)
       {
-        int neighbor=vertex_to_vertices[toVisit][i];
-        if (!visited[neighbor])
+        int neighbor=VV(i);
+        if (scratch.visited[neighbor]!=scratch.stamp)
         {
           queue.push_back(std::pair<int,int> (neighbor,distance+1));
-          visited[neighbor]=true;
+          scratch.visited[neighbor]=scratch.stamp;
         }
       }
     }
   }
-  free(visited);
-  return;
 }
 
+IGL_INLINE void CurvatureCalculator::getKRing(const int start, const int *& vv, int& nv) const
+{
+  // Rings only depend on the connectivity and are cached in data: point
+  // into the cache rather than copying it
+  vv = data->ring.data()+data->ring_start(start);
+  nv = data->ring_start(start+1)-data->ring_start(start);
+}
 
-IGL_INLINE void CurvatureCalculator::getSphere(const int start, const double r, std::vector<int> &vv, int min)
+
+IGL_INLINE void CurvatureCalculator::getSphere(const int start, const double r, std::vector<int> &vv, int min, Scratch& scratch) const
 {
-  int bufsize=vertices.rows();
-  vv.reserve(bufsize);
-  std::list<int>* queue= new std::list<int>();
-  bool* visited = (bool*)calloc(bufsize,sizeof(bool));
-  queue->push_back(start);
-  visited[start]=true;
+  const Eigen::VectorXi& VV_start = data->VV_start;
+  const Eigen::VectorXi& VV = data->VV;
+  scratch.new_search(vertices.rows());
+  std::vector<int>& visited = scratch.visited;
+  const int stamp = scratch.stamp;
+  std::vector<int>& queue = scratch.queue;
+  queue.clear();
+  queue.push_back(start);
+  visited[start]=stamp;
   Eigen::Vector3d me=vertices.row(start);
-  std::priority_queue<std::pair<int, double>, std::vector<std::pair<int, double> >, comparer >* extra_candidates= new  std::priority_queue<std::pair<int, double>, std::vector<std::pair<int, double> >, comparer >();
-  while (!queue->empty())
+  auto& extra_candidates = scratch.extra_candidates;
+  while (!extra_candidates.empty())
+    extra_candidates.pop();
+  for (size_t head = 0; head < queue.size(); ++head)
   {
-    int toVisit=queue->front();
-    queue->pop_front();
+    int toVisit=queue[head];
     vv.push_back(toVisit);
-    for (unsigned int i=0; i<vertex_to_vertices[toVisit].size(); ++i)
+    for (int i=VV_start(toVisit); i<VV_start(toVisit+1); ++i)
     {
-      int neighbor=vertex_to_vertices[toVisit][i];
-      if (!visited[neighbor])
+      int neighbor=VV(i);
+      if (visited[neighbor]!=stamp)
       {
         Eigen::Vector3d neigh=vertices.row(neighbor);
         double distance=(me-neigh).norm();
         if (distance<r)
-          queue->push_back(neighbor);
+          queue.push_back(neighbor);
         else if ((int)vv.size()<min)
-          extra_candidates->push(std::pair<int,double>(neighbor,distance));
-        visited[neighbor]=true;
+          extra_candidates.push(std::pair<int,double>(neighbor,distance));
+        visited[neighbor]=stamp;
       }
     }
   }
-  while (!extra_candidates->empty() && (int)vv.size()<min)
+  while (!extra_candidates.empty() && (int)vv.size()<min)
   {
-    std::pair<int, double> cand=extra_candidates->top();
-    extra_candidates->pop();
+    std::pair<int, double> cand=extra_candidates.top();
+    extra_candidates.pop();
     vv.push_back(cand.first);
-    for (unsigned int i=0; i<vertex_to_vertices[cand.first].size(); ++i)
+    for (int i=VV_start(cand.first); i<VV_start(cand.first+1); ++i)
     {
-      int neighbor=vertex_to_vertices[cand.first][i];
-      if (!visited[neighbor])
+      int neighbor=VV(i);
+      if (visited[neighbor]!=stamp)
       {
         Eigen::Vector3d neigh=vertices.row(neighbor);
         double distance=(me-neigh).norm();
-        extra_candidates->push(std::pair<int,double>(neighbor,distance));
-        visited[neighbor]=true;
+        extra_candidates.push(std::pair<int,double>(neighbor,distance));
+        visited[neighbor]=stamp;
       }
     }
   }
-  free(extra_candidates);
-  free(queue);
-  free(visited);
 }
 
-IGL_INLINE Eigen::Vector3d CurvatureCalculator::project(const Eigen::Vector3d& v, const Eigen::Vector3d& vp, const Eigen::Vector3d& ppn)
+IGL_INLINE Eigen::Vector3d CurvatureCalculator::project(const Eigen::Vector3d& v, const Eigen::Vector3d& vp, const Eigen::Vector3d& ppn) const
 {
   return (vp - (ppn * ((vp - v).dot(ppn))));
 }
 
-IGL_INLINE void CurvatureCalculator::computeReferenceFrame(int i, const Eigen::Vector3d& normal, std::vector<Eigen::Vector3d>& ref )
+IGL_INLINE void CurvatureCalculator::computeReferenceFrame(int i, const Eigen::Vector3d& normal, std::vector<Eigen::Vector3d>& ref ) const
 {
 
-  Eigen::Vector3d longest_v=Eigen::Vector3d(vertices.row(vertex_to_vertices[i][0]));
+  Eigen::Vector3d longest_v=Eigen::Vector3d(vertices.row(data->VV(data->VV_start(i))));
 
   longest_v=(project(vertices.row(i),longest_v,normal)-Eigen::Vector3d(vertices.row(i))).normalized();
 
@@ -547,20 +596,20 @@ IGL_INLINE void CurvatureCalculator::computeReferenceFrame(int i, const Eigen::V
   ref[2]=normal;
 }
 
-IGL_INLINE void CurvatureCalculator::getAverageNormal(int j, const std::vector<int>& vv, Eigen::Vector3d& normal)
+IGL_INLINE void CurvatureCalculator::getAverageNormal(int j, const int * vv, const int nv, Eigen::Vector3d& normal) const
 {
   normal=(vertex_normals.row(j)).normalized();
   if (localMode)
     return;
 
-  for (unsigned int i=0; i<vv.size(); ++i)
+  for (int i=0; i<nv; ++i)
   {
     normal+=vertex_normals.row(vv[i]).normalized();
   }
   normal.normalize();
 }
 
-IGL_INLINE void CurvatureCalculator::getProjPlane(int j, const std::vector<int>& vv, Eigen::Vector3d& ppn)
+IGL_INLINE void CurvatureCalculator::getProjPlane(int j, const int * vv, const int nv, Eigen::Vector3d& ppn) const
 {
   int nr;
   double a, b, c;
@@ -571,9 +620,9 @@ IGL_INLINE void CurvatureCalculator::getProjPlane(int j, const std::vector<int>&
 
   if (localMode)
   {
-    for (unsigned int i=0; i<vertex_to_faces.at(j).size(); ++i)
+    for (int i=data->VF_start(j); i<data->VF_start(j+1); ++i)
     {
-      Eigen::Vector3d faceNormal=face_normals.row(vertex_to_faces.at(j).at(i));
+      Eigen::Vector3d faceNormal=face_normals.row(data->VF(i));
       a += faceNormal[0];
       b += faceNormal[1];
       c += faceNormal[2];
@@ -581,7 +630,7 @@ IGL_INLINE void CurvatureCalculator::getProjPlane(int j, const std::vector<int>&
   }
   else
   {
-    for (unsigned int i=0; i<vv.size(); ++i)
+    for (int i=0; i<nv; ++i)
     {
       a+= vertex_normals.row(vv[i])[0];
       b+= vertex_normals.row(vv[i])[1];
@@ -624,23 +673,23 @@ IGL_INLINE double CurvatureCalculator::getAverageEdge()
 }
 
 
-IGL_INLINE void CurvatureCalculator::applyProjOnPlane(const Eigen::Vector3d& ppn, const std::vector<int>& vin, std::vector<int> &vout)
+IGL_INLINE void CurvatureCalculator::applyProjOnPlane(const Eigen::Vector3d& ppn, const int * vin, const int nin, std::vector<int> &vout) const
 {
-  for (std::vector<int>::const_iterator vpi = vin.begin(); vpi != vin.end(); ++vpi)
+  for (const int * vpi = vin; vpi != vin+nin; ++vpi)
     if (vertex_normals.row(*vpi) * ppn > 0.0)
       vout.push_back(*vpi);
 }
 
-IGL_INLINE void CurvatureCalculator::applyMontecarlo(const std::vector<int>& vin, std::vector<int> *vout)
+IGL_INLINE void CurvatureCalculator::applyMontecarlo(const int * vin, const int nin, std::vector<int> *vout) const
 {
-  if (montecarloN >= vin.size ())
+  if (montecarloN >= (unsigned int)nin)
   {
-    *vout = vin;
+    vout->assign(vin,vin+nin);
     return;
   }
 
-  float p = ((float) montecarloN) / (float) vin.size();
-  for (std::vector<int>::const_iterator vpi = vin.begin(); vpi != vin.end(); ++vpi)
+  float p = ((float) montecarloN) / (float) nin;
+  for (const int * vpi = vin; vpi != vin+nin; ++vpi)
   {
     float r;
     if ((r = ((float)rand () / RAND_MAX)) < p)
@@ -650,97 +699,112 @@ IGL_INLINE void CurvatureCalculator::applyMontecarlo(const std::vector<int>& vin
   }
 }
 
-IGL_INLINE void CurvatureCalculator::computeCurvature()
+IGL_INLINE void CurvatureCalculator::computeVertexCurvature(const int i, Scratch& scratch)
 {
-  //CHECK che esista la mesh
-  const size_t vertices_count=vertices.rows();
-
-  if (vertices_count ==0)
-    return;
-
-  curvDir=std::vector< std::vector<Eigen::Vector3d> >(vertices_count);
-  curv=std::vector<std::vector<double> >(vertices_count);
-
-
+  std::vector<int>& vv = scratch.vv;
+  std::vector<int>& vvtmp = scratch.vvtmp;
+  // Current neighbourhood: either a cached k-ring or one of the buffers
+  const int * nb = nullptr;
+  int nnb = 0;
+  Eigen::Vector3d normal;
 
-  scaledRadius=getAverageEdge()*sphereRadius;
+  vv.clear();
+  vvtmp.clear();
+  Eigen::Vector3d me=vertices.row(i);
+  switch (st)
+  {
+    case SPHERE_SEARCH:
+      getSphere(i,scaledRadius,vv,6,scratch);
+      nb = vv.data();
+      nnb = vv.size();
+      break;
+    case K_RING_SEARCH:
+      getKRing(i,nb,nnb);
+      break;
+  }
 
-  std::vector<int> vv;
-  std::vector<int> vvtmp;
-  Eigen::Vector3d normal;
+  if (nnb<6)
+  {
+    //std::cerr << "Could not compute curvature of radius " << scaledRadius << std::endl;
+    return;
+  }
 
-  //double time_spent;
-  //double searchtime=0, ref_time=0, fit_time=0, final_time=0;
 
-  for (size_t i=0; i<vertices_count; ++i)
+  if (projectionPlaneCheck)
   {
-    vv.clear();
-    vvtmp.clear();
-    Eigen::Vector3d me=vertices.row(i);
-    switch (st)
+    vvtmp.reserve (nnb);
+    applyProjOnPlane (vertex_normals.row(i), nb, nnb, vvtmp);
+    if (vvtmp.size() >= 6 && (int)vvtmp.size()<nnb)
     {
-      case SPHERE_SEARCH:
-        getSphere(i,scaledRadius,vv,6);
-        break;
-      case K_RING_SEARCH:
-        getKRing(i,kRing,vv);
-        break;
-      default:
-        fprintf(stderr,"Error: search type not recognized");
-        return;
+      vv.swap(vvtmp);
+      nb = vv.data();
+      nnb = vv.size();
     }
+  }
 
-    if (vv.size()<6)
-    {
-      //std::cerr << "Could not compute curvature of radius " << scaledRadius << std::endl;
-      continue;
-    }
 
+  switch (nt)
+  {
+    case AVERAGE:
+      getAverageNormal(i,nb,nnb,normal);
+      break;
+    case PROJ_PLANE:
+      getProjPlane(i,nb,nnb,normal);
+      break;
+  }
+  if (nnb<6)
+  {
+    //std::cerr << "Could not compute curvature of radius " << scaledRadius << std::endl;
+    return;
+  }
+  if (montecarlo)
+  {
+    if(montecarloN<6)
+      return;
+    // nb may point into vv, so sample into the other buffer
+    std::vector<int>& out = nb == vv.data() ? vvtmp : vv;
+    out.clear();
+    out.reserve(nnb);
+    applyMontecarlo(nb,nnb,&out);
+    nb = out.data();
+    nnb = out.size();
+  }
 
-    if (projectionPlaneCheck)
-    {
-      vvtmp.reserve (vv.size ());
-      applyProjOnPlane (vertex_normals.row(i), vv, vvtmp);
-      if (vvtmp.size() >= 6 && vvtmp.size()<vv.size())
-        vv = vvtmp;
-    }
+  if (nnb<6)
+    return;
+  std::vector<Eigen::Vector3d> ref(3);
+  computeReferenceFrame(i,normal,ref);
 
+  Quadric q;
+  fitQuadric (me, ref, nb, nnb, &q, scratch);
+  finalEigenStuff(i,ref,q);
+}
 
-    switch (nt)
-    {
-      case AVERAGE:
-        getAverageNormal(i,vv,normal);
-        break;
-      case PROJ_PLANE:
-        getProjPlane(i,vv,normal);
-        break;
-      default:
-        fprintf(stderr,"Error: normal type not recognized");
-        return;
-    }
-    if (vv.size()<6)
-    {
-      //std::cerr << "Could not compute curvature of radius " << scaledRadius << std::endl;
-      continue;
-    }
-    if (montecarlo)
-    {
-      if(montecarloN<6)
-        break;
-      vvtmp.reserve(vv.size());
-      applyMontecarlo(vv,&vvtmp);
-      vv=vvtmp;
-    }
+IGL_INLINE void CurvatureCalculator::computeCurvature()
+{
+  //CHECK che esista la mesh
+  const size_t vertices_count=vertices.rows();
 
-    if (vv.size()<6)
-      return;
-    std::vector<Eigen::Vector3d> ref(3);
-    computeReferenceFrame(i,normal,ref);
+  if (vertices_count ==0)
+    return;
 
-    Quadric q;
-    fitQuadric (me, ref, vv, &q);
-    finalEigenStuff(i,ref,q);
-  }
+  curv.setZero(vertices_count,2);
+  curvDir.setZero(vertices_count,6);
+  computed.assign(vertices_count,0);
+
+  if (st == SPHERE_SEARCH)
+    scaledRadius=getAverageEdge()*sphereRadius;
+
+  // Vertices are independent: each thread gathers neighbourhoods and fits
+  // quadrics with its own buffers. Montecarlo sampling draws from rand() and
+  // stays serial.
+  std::vector<Scratch> scratch;
+  igl::parallel_for(
+    vertices_count,
+    [&scratch](const int nt){ scratch.resize(nt); },
+    [this,&scratch](const int i, const int t){ computeVertexCurvature(i,scratch[t]); },
+    [](const int){},
+    montecarlo ? vertices_count+1 : 1000);
 
   lastRadius=sphereRadius;
   curvatureComputed=true;
@@ -765,39 +829,119 @@ IGL_INLINE void CurvatureCalculator::printCurvature(const std::string& outpath)
   of << vertices_count << endl;
   for (int i=0; i<vertices_count; ++i)
   {
-    of << curv[i][0] << " " << curv[i][1] << " " << curvDir[i][0][0] << " " << curvDir[i][0][1] << " " << curvDir[i][0][2] << " " <<
-    curvDir[i][1][0] << " " << curvDir[i][1][1] << " " << curvDir[i][1][2] << endl;
+    of << curv(i,0) << " " << curv(i,1) << " " << curvDir(i,0) << " " << curvDir(i,1) << " " << curvDir(i,2) << " " <<
+    curvDir(i,3) << " " << curvDir(i,4) << " " << curvDir(i,5) << endl;
   }
 
   of.close();
 
 }
 
+template <typename DerivedF>
+IGL_INLINE void igl::principal_curvature_precompute(
+  const int n,
+  const Eigen::MatrixBase<DerivedF>& F,
+  unsigned radius,
+  const bool useKring,
+  principal_curvature_data & data)
+{
+  if (radius < 2)
+  {
+    radius = 2;
+    std::cout << "WARNING: igl::principal_curvature needs a radius >= 2, fixing it to 2." << std::endl;
+  }
+  data.n = n;
+  data.F = F.template cast<int>();
+  data.radius = radius;
+  data.useKring = useKring;
+
+  // Vertex-vertex adjacency (sorted, without duplicates, as adjacency_list)
+  {
+    Eigen::VectorXi count = Eigen::VectorXi::Zero(n+1);
+    for (int f = 0; f < data.F.rows(); ++f)
+      for (int j = 0; j < 3; ++j)
+        count(data.F(f,j)+1) += 2;
+    for (int i = 0; i < n; ++i)
+      count(i+1) += count(i);
+    Eigen::VectorXi all(count(n));
+    Eigen::VectorXi next = count.head(n);
+    for (int f = 0; f < data.F.rows(); ++f)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        const int s = data.F(f,j);
+        const int d = data.F(f,(j+1)%3);
+        all(next(s)++) = d;
+        all(next(d)++) = s;
+      }
+    }
+    data.VV_start.resize(n+1);
+    data.VV_start(0) = 0;
+    igl::parallel_for(n,[&](const int i)
+    {
+      std::sort(all.data()+count(i),all.data()+count(i+1));
+      next(i) =
+        std::unique(all.data()+count(i),all.data()+count(i+1))-all.data()-count(i);
+    },1000);
+    for (int i = 0; i < n; ++i)
+      data.VV_start(i+1) = data.VV_start(i)+next(i);
+    data.VV.resize(data.VV_start(n));
+    igl::parallel_for(n,[&](const int i)
+    {
+      std::copy(
+        all.data()+count(i),all.data()+count(i)+next(i),
+        data.VV.data()+data.VV_start(i));
+    },1000);
+  }
+  igl::vertex_triangle_adjacency(data.F,n,data.VF,data.VF_start);
+
+  data.ring_start.resize(0);
+  data.ring.resize(0);
+  if (useKring)
+  {
+    // Rings in breadth first order, gathered in parallel into per vertex
+    // lists then flattened
+    std::vector<std::vector<int> > rings(n);
+    std::vector<CurvatureCalculator::Scratch> scratch;
+    igl::parallel_for(
+      n,
+      [&](const int nt){ scratch.resize(nt); },
+      [&](const int i, const int t)
+      {
+        CurvatureCalculator::kRingSearch(
+          data.VV_start,data.VV,i,radius,rings[i],scratch[t]);
+      },
+      [](const int){},
+      1000);
+    data.ring_start.resize(n+1);
+    data.ring_start(0) = 0;
+    for (int i = 0; i < n; ++i)
+      data.ring_start(i+1) = data.ring_start(i)+rings[i].size();
+    data.ring.resize(data.ring_start(n));
+    igl::parallel_for(n,[&](const int i)
+    {
+      std::copy(rings[i].begin(),rings[i].end(),data.ring.data()+data.ring_start(i));
+    },1000);
+  }
+}
+
 template <
   typename DerivedV,
-  typename DerivedF,
   typename DerivedPD1,
   typename DerivedPD2,
   typename DerivedPV1,
   typename DerivedPV2,
   typename Index>
 IGL_INLINE void igl::principal_curvature(
-  const Eigen::PlainObjectBase<DerivedV>& V,
-  const Eigen::PlainObjectBase<DerivedF>& F,
+  const Eigen::MatrixBase<DerivedV>& V,
+  const principal_curvature_data & data,
   Eigen::PlainObjectBase<DerivedPD1>& PD1,
   Eigen::PlainObjectBase<DerivedPD2>& PD2,
   Eigen::PlainObjectBase<DerivedPV1>& PV1,
   Eigen::PlainObjectBase<DerivedPV2>& PV2,
-  std::vector<Index>& bad_vertices,
-  unsigned radius,
-  bool useKring)
+  std::vector<Index>& bad_vertices)
 {
-
-  if (radius < 2)
-  {
-    radius = 2;
-    std::cout << "WARNING: igl::principal_curvature needs a radius >= 2, fixing it to 2." << std::endl;
-  }
+  assert(V.rows() == data.n && "V should have as many rows as in precompute");
 
   // Preallocate memory
   PD1.resize(V.rows(),3);
@@ -809,12 +953,12 @@ IGL_INLINE void igl::principal_curvature(
 
   // Precomputation
   CurvatureCalculator cc;
-  cc.init(V.template cast<double>(),F.template cast<int>());
-  cc.sphereRadius = radius;
+  cc.init(V.template cast<double>(),data);
+  cc.sphereRadius = data.radius;
 
-  if (useKring)
+  if (data.useKring)
   {
-    cc.kRing = radius;
+    cc.kRing = data.radius;
     cc.st = K_RING_SEARCH;
   }
 
@@ -824,10 +968,10 @@ IGL_INLINE void igl::principal_curvature(
   // Copy it back
   for (unsigned i=0; i<V.rows(); ++i)
   {
-    if (!cc.curv[i].empty())
+    if (cc.computed[i])
     {
-      PD1.row(i) << cc.curvDir[i][0][0], cc.curvDir[i][0][1], cc.curvDir[i][0][2];
-      PD2.row(i) << cc.curvDir[i][1][0], cc.curvDir[i][1][1], cc.curvDir[i][1][2];
+      PD1.row(i) << cc.curvDir(i,0), cc.curvDir(i,1), cc.curvDir(i,2);
+      PD2.row(i) << cc.curvDir(i,3), cc.curvDir(i,4), cc.curvDir(i,5);
       PD1.row(i).normalize();
       PD2.row(i).normalize();
 
@@ -837,8 +981,8 @@ IGL_INLINE void igl::principal_curvature(
         PD2.row(i) << 0,0,0;
       }
 
-      PV1(i) = cc.curv[i][0];
-      PV2(i) = cc.curv[i][1];
+      PV1(i) = cc.curv(i,0);
+      PV2(i) = cc.curv(i,1);
 
       if (PD1.row(i) * PD2.row(i).transpose() > 10e-6)
       {
@@ -856,7 +1000,30 @@ IGL_INLINE void igl::principal_curvature(
       PD2.row(i) << 0,0,0;
     }
   }
+}
 
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename DerivedPD1,
+  typename DerivedPD2,
+  typename DerivedPV1,
+  typename DerivedPV2,
+  typename Index>
+IGL_INLINE void igl::principal_curvature(
+  const Eigen::PlainObjectBase<DerivedV>& V,
+  const Eigen::PlainObjectBase<DerivedF>& F,
+  Eigen::PlainObjectBase<DerivedPD1>& PD1,
+  Eigen::PlainObjectBase<DerivedPD2>& PD2,
+  Eigen::PlainObjectBase<DerivedPV1>& PV1,
+  Eigen::PlainObjectBase<DerivedPV2>& PV2,
+  std::vector<Index>& bad_vertices,
+  unsigned radius,
+  bool useKring)
+{
+  principal_curvature_data data;
+  principal_curvature_precompute(V.rows(),F,radius,useKring,data);
+  principal_curvature(V,data,PD1,PD2,PV1,PV2,bad_vertices);
 }
 
 template <
@@ -876,59 +1043,12 @@ IGL_INLINE void igl::principal_curvature(
   unsigned radius,
   bool useKring)
 {
-  if (radius < 2)
+  std::vector<int> bad_vertices;
+  principal_curvature(V,F,PD1,PD2,PV1,PV2,bad_vertices,radius,useKring);
+  for (const int i : bad_vertices)
   {
-    radius = 2;
-    std::cout << "WARNING: igl::principal_curvature needs a radius >= 2, fixing it to 2." << std::endl;
+    std::cerr << "PRINCIPAL_CURVATURE: Something is wrong with vertex: " << i << std::endl;
   }
-
-  // Preallocate memory
-  PD1.resize(V.rows(),3);
-  PD2.resize(V.rows(),3);
-
-  // Preallocate memory
-  PV1.resize(V.rows(),1);
-  PV2.resize(V.rows(),1);
-
-  // Precomputation
-  CurvatureCalculator cc;
-  cc.init(V.template cast<double>(),F.template cast<int>());
-  cc.sphereRadius = radius;
-
-  if (useKring)
-  {
-    cc.kRing = radius;
-    cc.st = K_RING_SEARCH;
-  }
-
-  // Compute
-  cc.computeCurvature();
-
-  // Copy it back
-  for (unsigned i=0; i<V.rows(); ++i)
-  {
-    PD1.row(i) << cc.curvDir[i][0][0], cc.curvDir[i][0][1], cc.curvDir[i][0][2];
-    PD2.row(i) << cc.curvDir[i][1][0], cc.curvDir[i][1][1], cc.curvDir[i][1][2];
-    PD1.row(i).normalize();
-    PD2.row(i).normalize();
-
-    if (std::isnan(PD1(i,0)) || std::isnan(PD1(i,1)) || std::isnan(PD1(i,2)) || std::isnan(PD2(i,0)) || std::isnan(PD2(i,1)) || std::isnan(PD2(i,2)))
-    {
-      PD1.row(i) << 0,0,0;
-      PD2.row(i) << 0,0,0;
-    }
-
-    PV1(i) = cc.curv[i][0];
-    PV2(i) = cc.curv[i][1];
-
-    if (PD1.row(i) * PD2.row(i).transpose() > 10e-6)
-    {
-      std::cerr << "PRINCIPAL_CURVATURE: Something is wrong with vertex: " << i << std::endl;
-      PD1.row(i) *= 0;
-      PD2.row(i) *= 0;
-    }
-  }
-
 }
 
 #ifdef IGL_STATIC_LIBRARY
@@ -938,4 +1058,7 @@ template void igl::principal_curvature<Eigen::Matrix<double, -1, -1, 0, -1, -1>,
 template void igl::principal_curvature<Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix<int, -1, 3, 0, -1, 3>, Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, 1, 0, -1, 1> >(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 3, 0, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, unsigned int, bool);
 template void igl::principal_curvature<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, unsigned int, bool);
 template void igl::principal_curvature<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, int>(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, std::vector<int, std::allocator<int> >&, unsigned int, bool);
-#endif
\ No newline at end of file
+
+template void igl::principal_curvature_precompute<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(int, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, unsigned int, bool, igl::principal_curvature_data&);
+template void igl::principal_curvature<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, int>(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, igl::principal_curvature_data const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, std::vector<int, std::allocator<int> >&);
+#endif
@@ -83,8 +83,82 @@ IGL_INLINE void principal_curvature(
   unsigned radius = 5,
   bool useKring = true);
 
+  struct principal_curvature_data;
+  // Precompute the connectivity used by principal_curvature: vertex-vertex
+  // and vertex-face adjacency in flat (compressed row) arrays and, for k-ring
+  // neighbourhoods, the ring of every vertex. Repeated evaluation on meshes
+  // sharing F (e.g. faces registered to one template) then skips all
+  // topology work.
+  //
+  // Inputs:
+  //   n  number of vertices
+  //   F  #F by 3 list of mesh faces (must be triangles)
+  //   radius  controls the size of the neighbourhood used, 1 = average edge
+  //     length
+  //   useKring  whether to use k-ring (connectivity only) or sphere (geometry
+  //     dependent, searched at every evaluation) neighbourhoods
+  // Outputs:
+  //   data  precomputed adjacency and rings
+  template <typename DerivedF>
+  IGL_INLINE void principal_curvature_precompute(
+    const int n,
+    const Eigen::MatrixBase<DerivedF>& F,
+    unsigned radius,
+    const bool useKring,
+    principal_curvature_data & data);
+  // Same as above with connectivity and neighbourhood from
+  // principal_curvature_precompute. Vertices are processed in parallel.
+  //
+  // Inputs:
+  //   V  #V by 3 vertex positions
+  //   data  precomputed adjacency and rings
+  // Outputs:
+  //   PD1 #V by 3 maximal curvature direction for each vertex.
+  //   PD2 #V by 3 minimal curvature direction for each vertex.
+  //   PV1 #V by 1 maximal curvature value for each vertex.
+  //   PV2 #V by 1 minimal curvature value for each vertex.
+  //   bad_vertices  indices of vertices where curvature could not be
+  //     computed (appended to)
+  template <
+    typename DerivedV,
+    typename DerivedPD1,
+    typename DerivedPD2,
+    typename DerivedPV1,
+    typename DerivedPV2,
+    typename Index>
+  IGL_INLINE void principal_curvature(
+    const Eigen::MatrixBase<DerivedV>& V,
+    const principal_curvature_data & data,
+    Eigen::PlainObjectBase<DerivedPD1>& PD1,
+    Eigen::PlainObjectBase<DerivedPD2>& PD2,
+    Eigen::PlainObjectBase<DerivedPV1>& PV1,
+    Eigen::PlainObjectBase<DerivedPV2>& PV2,
+    std::vector<Index>& bad_vertices);
 }
 
+struct igl::principal_curvature_data
+{
+  // Number of vertices
+  int n;
+  // #F by 3 triangles
+  Eigen::MatrixXi F;
+  // Neighbourhood size, see principal_curvature
+  unsigned radius;
+  bool useKring;
+  // Neighbours of vertex i, in increasing order, are
+  // VV(VV_start(i):VV_start(i+1)-1)
+  Eigen::VectorXi VV_start;
+  Eigen::VectorXi VV;
+  // Faces incident on vertex i are VF(VF_start(i):VF_start(i+1)-1)
+  Eigen::VectorXi VF_start;
+  Eigen::VectorXi VF;
+  // With useKring, the radius-ring of vertex i in breadth first order
+  // (starting with i) is ring(ring_start(i):ring_start(i+1)-1)
+  Eigen::VectorXi ring_start;
+  Eigen::VectorXi ring;
+  principal_curvature_data():n(0),radius(5),useKring(true){}
+};
+
 
 #ifndef IGL_STATIC_LIBRARY
 #include "principal_curvature.cpp"
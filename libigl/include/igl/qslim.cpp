@@ -10,6 +10,7 @@
 #include "collapse_edge.h"
 #include "connect_boundary_to_infinity.h"
 #include "decimate.h"
+#include "decimate_parallel.h"
 #include "edge_flaps.h"
 #include "is_edge_manifold.h"
 #include "max_faces_stopping_condition.h"
@@ -28,6 +29,19 @@ IGL_INLINE bool igl::qslim(
   Eigen::MatrixXi & G,
   Eigen::VectorXi & J,
   Eigen::VectorXi & I)
+{
+  return qslim(V,F,max_m,false,U,G,J,I);
+}
+
+IGL_INLINE bool igl::qslim(
+  const Eigen::MatrixXd & V,
+  const Eigen::MatrixXi & F,
+  const size_t max_m,
+  const bool parallel,
+  Eigen::MatrixXd & U,
+  Eigen::MatrixXi & G,
+  Eigen::VectorXi & J,
+  Eigen::VectorXi & I)
 {
   using namespace igl;
 
@@ -58,56 +72,76 @@ IGL_INLINE bool igl::qslim(
   int v1 = -1;
   int v2 = -1;
   // Callbacks for computing and updating metric
-  std::function<void(
-    const int e,
-    const Eigen::MatrixXd &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::VectorXi &,
-    const Eigen::MatrixXi &,
-    const Eigen::MatrixXi &,
-    double &,
-    Eigen::RowVectorXd &)> cost_and_placement;
-  std::function<bool(
-    const Eigen::MatrixXd &                                         ,/*V*/
-    const Eigen::MatrixXi &                                         ,/*F*/
-    const Eigen::MatrixXi &                                         ,/*E*/
-    const Eigen::VectorXi &                                         ,/*EMAP*/
-    const Eigen::MatrixXi &                                         ,/*EF*/
-    const Eigen::MatrixXi &                                         ,/*EI*/
-    const std::set<std::pair<double,int> > &                        ,/*Q*/
-    const std::vector<std::set<std::pair<double,int> >::iterator > &,/*Qit*/
-    const Eigen::MatrixXd &                                         ,/*C*/
-    const int                                                        /*e*/
-    )> pre_collapse;
-  std::function<void(
-    const Eigen::MatrixXd &                                         ,   /*V*/
-    const Eigen::MatrixXi &                                         ,   /*F*/
-    const Eigen::MatrixXi &                                         ,   /*E*/
-    const Eigen::VectorXi &                                         ,/*EMAP*/
-    const Eigen::MatrixXi &                                         ,  /*EF*/
-    const Eigen::MatrixXi &                                         ,  /*EI*/
-    const std::set<std::pair<double,int> > &                        ,   /*Q*/
-    const std::vector<std::set<std::pair<double,int> >::iterator > &, /*Qit*/
-    const Eigen::MatrixXd &                                         ,   /*C*/
-    const int                                                       ,   /*e*/
-    const int                                                       ,  /*e1*/
-    const int                                                       ,  /*e2*/
-    const int                                                       ,  /*f1*/
-    const int                                                       ,  /*f2*/
-    const bool                                                  /*collapsed*/
-    )> post_collapse;
+  decimate_cost_and_placement_callback cost_and_placement;
+  decimate_pre_collapse_callback pre_collapse;
+  decimate_post_collapse_callback post_collapse;
   qslim_optimal_collapse_edge_callbacks(
     E,quadrics,v1,v2, cost_and_placement, pre_collapse,post_collapse);
-  // Call to greedy decimator
-  bool ret = decimate(
-    VO, FO,
-    cost_and_placement,
-    max_faces_stopping_condition(m,orig_m,max_m),
-    pre_collapse,
-    post_collapse,
-    E, EMAP, EF, EI,
-    U, G, J, I);
+  bool ret;
+  if(parallel)
+  {
+    // (v1,v2) are shared by all edges: remember the endpoints of each edge
+    // instead so that the collapses of a round can run concurrently
+    Eigen::MatrixXi EV(E.rows(),2);
+    pre_collapse = [&EV](
+      const Eigen::MatrixXd &                                         ,/*V*/
+      const Eigen::MatrixXi &                                         ,/*F*/
+      const Eigen::MatrixXi & E,
+      const Eigen::VectorXi &                                         ,/*EMAP*/
+      const Eigen::MatrixXi &                                         ,/*EF*/
+      const Eigen::MatrixXi &                                         ,/*EI*/
+      const decimate_queue &                                          ,/*Q*/
+      const Eigen::VectorXi &                                         ,/*EQ*/
+      const Eigen::MatrixXd &                                         ,/*C*/
+      const int e)->bool
+    {
+      EV.row(e) = E.row(e);
+      return true;
+    };
+    post_collapse = [&EV,&quadrics](
+      const Eigen::MatrixXd &                                         ,   /*V*/
+      const Eigen::MatrixXi &                                         ,   /*F*/
+      const Eigen::MatrixXi &                                         ,   /*E*/
+      const Eigen::VectorXi &                                         ,/*EMAP*/
+      const Eigen::MatrixXi &                                         ,  /*EF*/
+      const Eigen::MatrixXi &                                         ,  /*EI*/
+      const decimate_queue &                                          ,   /*Q*/
+      const Eigen::VectorXi &                                         ,  /*EQ*/
+      const Eigen::MatrixXd &                                         ,   /*C*/
+      const int e,
+      const int                                                       ,  /*e1*/
+      const int                                                       ,  /*e2*/
+      const int                                                       ,  /*f1*/
+      const int                                                       ,  /*f2*/
+      const bool collapsed)->void
+    {
+      if(collapsed)
+      {
+        const int v1 = EV(e,0);
+        const int v2 = EV(e,1);
+        quadrics[v1<v2?v1:v2] = quadrics[v1] + quadrics[v2];
+      }
+    };
+    ret = decimate_parallel(
+      VO, FO,
+      cost_and_placement,
+      max_faces_stopping_condition(m,orig_m,max_m),
+      pre_collapse,
+      post_collapse,
+      E, EMAP, EF, EI,
+      U, G, J, I);
+  }else
+  {
+    // Call to greedy decimator
+    ret = decimate(
+      VO, FO,
+      cost_and_placement,
+      max_faces_stopping_condition(m,orig_m,max_m),
+      pre_collapse,
+      post_collapse,
+      E, EMAP, EF, EI,
+      U, G, J, I);
+  }
   // Remove phony boundary faces and clean up
   const Eigen::Array<bool,Eigen::Dynamic,1> keep = (J.array()<orig_m);
   igl::slice_mask(Eigen::MatrixXi(G),keep,1,G);
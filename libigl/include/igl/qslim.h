@@ -38,6 +38,18 @@ namespace igl
     Eigen::MatrixXi & G,
     Eigen::VectorXi & J,
     Eigen::VectorXi & I);
+  // Inputs:
+  //   parallel  whether to collapse independent sets of edges concurrently
+  //     (see decimate_parallel)
+  IGL_INLINE bool qslim(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    const size_t max_m,
+    const bool parallel,
+    Eigen::MatrixXd & U,
+    Eigen::MatrixXi & G,
+    Eigen::VectorXi & J,
+    Eigen::VectorXi & I);
 }
 #ifndef IGL_STATIC_LIBRARY
 #  include "qslim.cpp"
@@ -10,6 +10,7 @@
 #include "list_to_matrix.h"
 #include "readMESH.h"
 #include "readOBJ.h"
+#include "fast_readOBJ.h"
 #include "readOFF.h"
 #include "readSTL.h"
 #include "readPLY.h"
@@ -84,6 +85,39 @@ IGL_INLINE bool igl::read_triangle_mesh(
   pathinfo(filename,dir,base,ext,name);
   // Convert extension to lower case
   transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  if(ext == "obj")
+  {
+    // Parsed in parallel directly into matrices. Polygons of any degree are
+    // triangulated from what was read; readOBJ below only handles what the
+    // fast parser cannot (e.g. vertices of mixed dimension), and reports the
+    // errors.
+    MatrixXd vV;
+    MatrixXi vF;
+    vector<vector<int> > vP;
+    switch(fast_readOBJ(filename,vV,vF,vP))
+    {
+      case FAST_READOBJ_SUCCESS:
+        // Annoyingly obj can store 4 coordinates, truncate to xyz
+        V = vV.leftCols(std::min<int>(vV.cols(),3)).template cast<typename DerivedV::Scalar>();
+        if(!vP.empty())
+        {
+          polygon_mesh_to_triangle_mesh(vP,F);
+        }else if(vF.cols() == 3 || vF.rows() == 0)
+        {
+          F = vF.template cast<typename DerivedF::Scalar>();
+        }else
+        {
+          polygon_mesh_to_triangle_mesh(vF,F);
+        }
+        return true;
+      case FAST_READOBJ_CANNOT_OPEN:
+        fprintf(stderr,"IOError: %s could not be opened...\n",
+                filename.c_str());
+        return false;
+      default:
+        break;
+    }
+  }
   FILE * fp = fopen(filename.c_str(),"rb");
   if(NULL==fp)
   {
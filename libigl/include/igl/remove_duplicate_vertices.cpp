@@ -6,11 +6,17 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file, You can 
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "remove_duplicate_vertices.h"
+#include "parallel_for.h"
 #include "round.h"
 #include "unique_rows.h"
 #include "colon.h"
 #include "slice.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <utility>
+#include <vector>
 
 template <
   typename DerivedV, 
@@ -20,20 +26,249 @@ template <
 IGL_INLINE void igl::remove_duplicate_vertices(
   const Eigen::MatrixBase<DerivedV>& V,
   const double epsilon,
+  const RemoveDuplicateVerticesMethod method,
   Eigen::PlainObjectBase<DerivedSV>& SV,
   Eigen::PlainObjectBase<DerivedSVI>& SVI,
   Eigen::PlainObjectBase<DerivedSVJ>& SVJ)
 {
-  if(epsilon > 0)
+  if(method == REMOVE_DUPLICATE_VERTICES_ROUND)
   {
-    DerivedV rV,rSV;
-    round((V/(10.0*epsilon)).eval(),rV);
-    unique_rows(rV,rSV,SVI,SVJ);
-    slice(V,SVI,colon<int>(0,V.cols()-1),SV);
-  }else
+    if(epsilon > 0)
+    {
+      DerivedV rV,rSV;
+      round((V/(10.0*epsilon)).eval(),rV);
+      unique_rows(rV,rSV,SVI,SVJ);
+      slice(V,SVI,colon<int>(0,V.cols()-1),SV);
+    }else
+    {
+      unique_rows(V,SV,SVI,SVJ);
+    }
+    return;
+  }
+  const int n = V.rows();
+  const int dim = V.cols();
+  const bool exact = !(epsilon > 0);
+  // Vertices are hashed into a grid with cells of size 16*epsilon, so the
+  // epsilon neighborhood of a vertex only meets its own cell and, along the
+  // axes where it lies within epsilon of a cell border, the adjacent cell
+  // across that border. With epsilon = 0 the cells are the exact positions.
+  const double cell_size = 16.0*epsilon;
+  const auto cell = [&](const double x) -> std::int64_t
+  {
+    if(exact)
+    {
+      // +0.0 so that -0.0 and 0.0 hash the same
+      return (std::int64_t)std::hash<double>()(x+0.0);
+    }
+    // Far away cells may be clamped together: that only costs distance tests
+    const double c = std::floor(x/cell_size);
+    const double max_c = 4611686018427387904.0;
+    return (std::int64_t)std::max(-max_c,std::min(max_c,c));
+  };
+  // Direction of the cell across the border x is close to, if any (with some
+  // slack for round-off)
+  const auto side = [&](const double x) -> int
+  {
+    const double f = x/cell_size-std::floor(x/cell_size);
+    return f < 0.07 ? -1 : (f > 0.93 ? 1 : 0);
+  };
+  const auto mix = [](std::uint64_t h,const std::int64_t c) -> std::uint64_t
+  {
+    // Nearby cells differ in low bits only: multiply and fold the high bits
+    // back so that they land in unrelated buckets
+    h = (h ^ (std::uint64_t)c)*0x9e3779b97f4a7c15ULL;
+    return h ^ (h>>32);
+  };
+  // Buckets in a table of size a power of two >= n
+  std::uint64_t num_buckets = 1;
+  while(num_buckets < (std::uint64_t)std::max(n,1))
+  {
+    num_buckets <<= 1;
+  }
+  std::vector<int> B(n);
+  igl::parallel_for(n,[&](const int i)
+  {
+    std::uint64_t h = 0;
+    for(int d = 0;d<dim;d++)
+    {
+      h = mix(h,cell(double(V(i,d))));
+    }
+    B[i] = (int)(h & (num_buckets-1));
+  },10000);
+  // Counting sort by bucket, stable so that buckets list increasing indices
+  std::vector<int> start(num_buckets+1,0);
+  for(int i = 0;i<n;i++)
+  {
+    start[B[i]+1]++;
+  }
+  for(std::uint64_t b = 0;b<num_buckets;b++)
+  {
+    start[b+1] += start[b];
+  }
+  std::vector<int> order(n);
+  {
+    std::vector<int> next(start.begin(),start.end()-1);
+    for(int i = 0;i<n;i++)
+    {
+      order[next[B[i]]++] = i;
+    }
+  }
+  // Positions in bucket order, so that scanning a bucket reads contiguous
+  // memory
+  std::vector<double> P((size_t)n*dim);
+  igl::parallel_for(n,[&](const int k)
+  {
+    for(int d = 0;d<dim;d++)
+    {
+      P[(size_t)k*dim+d] = double(V(order[k],d));
+    }
+  },10000);
+
+  // Bit d of a neighboring cell's number says whether it lies across the
+  // border along axis d, cell 0 is the vertex's own
+  const int num_cells = exact ? 1 : 1<<dim;
+  const double sqr_epsilon = epsilon*epsilon;
+  // Pairs (i,j), j<i, of vertices closer than epsilon
+  std::vector<std::vector<std::pair<int,int> > > thread_pairs;
+  std::vector<std::pair<int,int> > pairs;
+  igl::parallel_for(
+    n,
+    [&](const size_t nt){ thread_pairs.resize(nt); },
+    [&](const int ki,const size_t t)
+    {
+      // Visit vertices in bucket order too
+      const int i = order[ki];
+      const double * pi = &P[(size_t)ki*dim];
+      for(int o = 0;o<num_cells;o++)
+      {
+        std::uint64_t h = 0;
+        bool skip = false;
+        for(int d = 0;d<dim && !skip;d++)
+        {
+          int s = 0;
+          if((o>>d)&1)
+          {
+            s = side(pi[d]);
+            skip = s == 0;
+          }
+          h = mix(h,cell(pi[d])+s);
+        }
+        if(skip)
+        {
+          continue;
+        }
+        const int b = (int)(h & (num_buckets-1));
+        for(int k = start[b];k<start[b+1] && order[k]<i;k++)
+        {
+          const int j = order[k];
+          const double * pj = &P[(size_t)k*dim];
+          if(std::equal(pi,pi+dim,pj))
+          {
+            // Exact duplicate: every other vertex close to i is linked to j
+            // directly (if smaller than j) or links to j (if larger), so
+            // stacks of duplicates stay linear
+            thread_pairs[t].emplace_back(i,j);
+            return;
+          }
+          if(!exact)
+          {
+            double sqr_d = 0;
+            for(int d = 0;d<dim;d++)
+            {
+              sqr_d += (pj[d]-pi[d])*(pj[d]-pi[d]);
+            }
+            if(sqr_d <= sqr_epsilon)
+            {
+              thread_pairs[t].emplace_back(i,j);
+            }
+          }
+        }
+      }
+    },
+    [&](const size_t t)
+    {
+      pairs.insert(pairs.end(),thread_pairs[t].begin(),thread_pairs[t].end());
+    },
+    10000);
+
+  // Connected components of the pairs, represented by their first vertex
+  std::vector<int> root(n);
+  for(int i = 0;i<n;i++)
+  {
+    root[i] = i;
+  }
+  const auto find = [&root](int i) -> int
+  {
+    while(root[i] != i)
+    {
+      root[i] = root[root[i]];
+      i = root[i];
+    }
+    return i;
+  };
+  for(const auto & p : pairs)
+  {
+    const int a = find(p.first);
+    const int b = find(p.second);
+    root[std::max(a,b)] = std::min(a,b);
+  }
+  SVJ.resize(n,1);
+  int num_unique = 0;
+  for(int i = 0;i<n;i++)
+  {
+    const int r = find(i);
+    SVJ(i) = r == i ? num_unique++ : SVJ(r);
+  }
+  SVI.resize(num_unique,1);
+  for(int i = 0;i<n;i++)
+  {
+    if(root[i] == i)
+    {
+      SVI(SVJ(i)) = i;
+    }
+  }
+  DerivedSV S(num_unique,dim);
+  for(int s = 0;s<num_unique;s++)
   {
-    unique_rows(V,SV,SVI,SVJ);
+    S.row(s) = V.row(SVI(s)).template cast<typename DerivedSV::Scalar>();
   }
+  SV = S;
+}
+
+template <
+  typename DerivedV, 
+  typename DerivedSV, 
+  typename DerivedSVI, 
+  typename DerivedSVJ>
+IGL_INLINE void igl::remove_duplicate_vertices(
+  const Eigen::MatrixBase<DerivedV>& V,
+  const double epsilon,
+  Eigen::PlainObjectBase<DerivedSV>& SV,
+  Eigen::PlainObjectBase<DerivedSVI>& SVI,
+  Eigen::PlainObjectBase<DerivedSVJ>& SVJ)
+{
+  remove_duplicate_vertices(
+    V,epsilon,REMOVE_DUPLICATE_VERTICES_ROUND,SV,SVI,SVJ);
+}
+
+template <
+  typename DerivedV, 
+  typename DerivedF,
+  typename DerivedSV, 
+  typename DerivedSVI, 
+  typename DerivedSVJ,
+  typename DerivedSF>
+IGL_INLINE void igl::remove_duplicate_vertices(
+  const Eigen::MatrixBase<DerivedV>& V,
+  const Eigen::MatrixBase<DerivedF>& F,
+  const double epsilon,
+  Eigen::PlainObjectBase<DerivedSV>& SV,
+  Eigen::PlainObjectBase<DerivedSVI>& SVI,
+  Eigen::PlainObjectBase<DerivedSVJ>& SVJ,
+  Eigen::PlainObjectBase<DerivedSF>& SF)
+{
+  remove_duplicate_vertices(
+    V,F,epsilon,REMOVE_DUPLICATE_VERTICES_ROUND,SV,SVI,SVJ,SF);
 }
 
 template <
@@ -47,6 +282,7 @@ IGL_INLINE void igl::remove_duplicate_vertices(
   const Eigen::MatrixBase<DerivedV>& V,
   const Eigen::MatrixBase<DerivedF>& F,
   const double epsilon,
+  const RemoveDuplicateVerticesMethod method,
   Eigen::PlainObjectBase<DerivedSV>& SV,
   Eigen::PlainObjectBase<DerivedSVI>& SVI,
   Eigen::PlainObjectBase<DerivedSVJ>& SVJ,
@@ -54,7 +290,7 @@ IGL_INLINE void igl::remove_duplicate_vertices(
 {
   using namespace Eigen;
   using namespace std;
-  remove_duplicate_vertices(V,epsilon,SV,SVI,SVJ);
+  remove_duplicate_vertices(V,epsilon,method,SV,SVI,SVJ);
   SF.resizeLike(F);
   for(int f = 0;f<F.rows();f++)
   {
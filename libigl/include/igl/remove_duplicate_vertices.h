@@ -11,17 +11,36 @@
 #include <Eigen/Dense>
 namespace igl
 {
+  enum RemoveDuplicateVerticesMethod
+  {
+    // Round V/(10*epsilon) to integers and keep unique rows: vertices falling
+    // in the same cell of size about 10*epsilon are merged (two vertices a
+    // hair apart may still fall in different cells)
+    REMOVE_DUPLICATE_VERTICES_ROUND = 0,
+    // Weld vertices closer than epsilon (Euclidean distance) and chains of
+    // such vertices: each connected component of the "closer than epsilon"
+    // graph becomes one vertex placed at its first vertex. Vertices are
+    // hashed into a grid of cells of size 16*epsilon, so this takes expected
+    // linear time (in parallel) as long as epsilon neighborhoods hold a
+    // bounded number of distinct positions.
+    REMOVE_DUPLICATE_VERTICES_DISTANCE = 1
+  };
   // REMOVE_DUPLICATE_VERTICES Remove duplicate vertices upto a uniqueness
   // tolerance (epsilon)
   //
   // Inputs:
   //   V  #V by dim list of vertex positions
   //   epsilon  uniqueness tolerance (significant digit), can probably think of
-  //     this as a tolerance on L1 distance
+  //     this as a tolerance on L1 distance, only exact duplicates are removed
+  //     if epsilon <= 0
+  //   method  how epsilon is interpreted (see above), defaults to
+  //     REMOVE_DUPLICATE_VERTICES_ROUND
   // Outputs:
-  //   SV  #SV by dim new list of vertex positions
-  //   SVI #V by 1 list of indices so SV = V(SVI,:) 
-  //   SVJ #SV by 1 list of indices so V = SV(SVJ,:)
+  //   SV  #SV by dim new list of vertex positions, sorted lexicographically by
+  //     rounded positions with REMOVE_DUPLICATE_VERTICES_ROUND, in order of
+  //     first occurrence in V with REMOVE_DUPLICATE_VERTICES_DISTANCE
+  //   SVI #SV by 1 list of indices so SV = V(SVI,:) 
+  //   SVJ #V by 1 list of indices so V(i,:) is welded into SV(SVJ(i),:)
   //
   // Example:
   //   % Mesh in (V,F)
@@ -29,6 +48,18 @@ namespace igl
   //   % remap faces
   //   SF = SVJ(F);
   //
+  template <
+    typename DerivedV, 
+    typename DerivedSV, 
+    typename DerivedSVI, 
+    typename DerivedSVJ>
+  IGL_INLINE void remove_duplicate_vertices(
+    const Eigen::MatrixBase<DerivedV>& V,
+    const double epsilon,
+    const RemoveDuplicateVerticesMethod method,
+    Eigen::PlainObjectBase<DerivedSV>& SV,
+    Eigen::PlainObjectBase<DerivedSVI>& SVI,
+    Eigen::PlainObjectBase<DerivedSVJ>& SVJ);
   template <
     typename DerivedV, 
     typename DerivedSV, 
@@ -56,6 +87,22 @@ namespace igl
     Eigen::PlainObjectBase<DerivedSVI>& SVI,
     Eigen::PlainObjectBase<DerivedSVJ>& SVJ,
     Eigen::PlainObjectBase<DerivedSF>& SF);
+  template <
+    typename DerivedV, 
+    typename DerivedF,
+    typename DerivedSV, 
+    typename DerivedSVI, 
+    typename DerivedSVJ,
+    typename DerivedSF>
+  IGL_INLINE void remove_duplicate_vertices(
+    const Eigen::MatrixBase<DerivedV>& V,
+    const Eigen::MatrixBase<DerivedF>& F,
+    const double epsilon,
+    const RemoveDuplicateVerticesMethod method,
+    Eigen::PlainObjectBase<DerivedSV>& SV,
+    Eigen::PlainObjectBase<DerivedSVI>& SVI,
+    Eigen::PlainObjectBase<DerivedSVJ>& SVJ,
+    Eigen::PlainObjectBase<DerivedSF>& SF);
 }
 
 #ifndef IGL_STATIC_LIBRARY
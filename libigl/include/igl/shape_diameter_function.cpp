@@ -8,7 +8,6 @@
 #include "shape_diameter_function.h"
 #include "random_dir.h"
 #include "barycenter.h"
-#include "ray_mesh_intersect.h"
 #include "per_vertex_normals.h"
 #include "per_face_normals.h"
 #include "EPS.h"
@@ -107,41 +106,64 @@ IGL_INLINE void igl::shape_diameter_function(
 }
 
 template <
-  typename DerivedV,
-  typename DerivedF,
   typename DerivedP,
   typename DerivedN,
   typename DerivedS >
 IGL_INLINE void igl::shape_diameter_function(
-  const Eigen::PlainObjectBase<DerivedV> & V,
-  const Eigen::PlainObjectBase<DerivedF> & F,
+  const igl::RayBVH & bvh,
   const Eigen::PlainObjectBase<DerivedP> & P,
   const Eigen::PlainObjectBase<DerivedN> & N,
   const int num_samples,
   Eigen::PlainObjectBase<DerivedS> & S)
 {
-  if(F.rows() < 100)
+  using namespace Eigen;
+  const int n = P.rows();
+  S.resize(n,1);
+  const MatrixXf D = random_dir_stratified(num_samples).cast<float>();
+  parallel_for(n,[&](const int p)
   {
-    // Super naive
-    const auto & shoot_ray = [&V,&F](
-      const Eigen::Vector3f& _s,
-      const Eigen::Vector3f& dir)->double
+    const RowVector3f origin = P.row(p).template cast<float>();
+    const RowVector3f normal = N.row(p).template cast<float>();
+    Matrix<float,Dynamic,3> O(num_samples,3),Dp(num_samples,3);
+    for(int s = 0;s<num_samples;s++)
     {
-      Eigen::Vector3f s = _s+1e-4*dir;
-      igl::Hit hit;
-      if(ray_mesh_intersect(s,dir,V,F,hit))
-      {
-        return hit.t;
-      }else
+      // Shoot _inward_
+      Dp.row(s) = (D.row(s).dot(normal) > 0 ? -1.f : 1.f)*D.row(s);
+      O.row(s) = origin+1e-4f*Dp.row(s);
+    }
+    std::vector<igl::Hit> hits;
+    bvh.intersect_rays(O,Dp,hits);
+    int num_hits = 0;
+    double total_distance = 0;
+    for(const auto & hit : hits)
+    {
+      if(hit.id >= 0)
       {
-        return std::numeric_limits<double>::infinity();
+        total_distance += hit.t;
+        num_hits++;
       }
-    };
-    return shape_diameter_function(shoot_ray,P,N,num_samples,S);
-  }
-  AABB<DerivedV,3> aabb;
-  aabb.init(V,F);
-  return shape_diameter_function(aabb,V,F,P,N,num_samples,S);
+    }
+    S(p) = total_distance/(double)num_hits;
+  },1000);
+}
+
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename DerivedP,
+  typename DerivedN,
+  typename DerivedS >
+IGL_INLINE void igl::shape_diameter_function(
+  const Eigen::PlainObjectBase<DerivedV> & V,
+  const Eigen::PlainObjectBase<DerivedF> & F,
+  const Eigen::PlainObjectBase<DerivedP> & P,
+  const Eigen::PlainObjectBase<DerivedN> & N,
+  const int num_samples,
+  Eigen::PlainObjectBase<DerivedS> & S)
+{
+  RayBVH bvh;
+  bvh.init(V,F);
+  return shape_diameter_function(bvh,P,N,num_samples,S);
 }
 
 template <
@@ -1,6 +1,7 @@
 #include "sparse_voxel_grid.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <array>
 #include <vector>
 
@@ -45,42 +46,62 @@ IGL_INLINE void igl::sparse_voxel_grid(const Eigen::MatrixBase<DerivedP0>& p0,
   CV_vector.reserve(8 * expected_number_of_cubes);
   CS_vector.reserve(8 * expected_number_of_cubes);
 
-  // Track visisted neighbors
-  std::unordered_map<Eigen::RowVector3i, int, IndexRowVectorHash> visited;
+  // Track visisted cubes
+  std::unordered_set<Eigen::RowVector3i, IndexRowVectorHash> visited;
   visited.reserve(6 * expected_number_of_cubes);
   visited.max_load_factor(0.5);
 
+  // Cube corners keyed by twice their offset from p0 in units of eps, so the
+  // scalar function is evaluated once per corner and cubes sharing a corner
+  // (also diagonally) share its vertex. Corners of cubes not crossing the
+  // surface are cached but not output (index -1).
+  struct Corner { ScalarS scalar; int index; };
+  std::unordered_map<Eigen::RowVector3i, Corner, IndexRowVectorHash> corners;
+  corners.reserve(8 * expected_number_of_cubes);
+  corners.max_load_factor(0.5);
+
   // BFS Queue
   std::vector<Eigen::RowVector3i> queue;
   queue.reserve(expected_number_of_cubes * 8);
   queue.push_back(Eigen::RowVector3i(0, 0, 0));
 
+  // X, Y, Z basis vectors, and array of neighbor offsets used to construct cubes
+  const Eigen::RowVector3i bx(1, 0, 0), by(0, 1, 0), bz(0, 0, -1);
+  const std::array<Eigen::RowVector3i, 6> neighbors = {
+    bx, -bx, by, -by, bz, -bz
+  };
+  const std::array<Eigen::RowVector3i, 8> cornerOffsets = {
+    bx+by+bz, bx+by-bz, -bx+by-bz, -bx+by+bz,
+    bx-by+bz, bx-by-bz, -bx-by-bz, -bx-by+bz
+  };
+
   while (queue.size() > 0)
   {
     Eigen::RowVector3i pi = queue.back();
     queue.pop_back();
+    // A cube can be queued by several neighbors before it is processed
+    if (!visited.insert(pi).second) {
+      continue;
+    }
 
     VertexRowVector ctr = p0 + eps*pi.cast<ScalarV>(); // R^3 center of this cube
 
-    // X, Y, Z basis vectors, and array of neighbor offsets used to construct cubes
-    const Eigen::RowVector3i bx(1, 0, 0), by(0, 1, 0), bz(0, 0, -1);
-    const std::array<Eigen::RowVector3i, 6> neighbors = {
-      bx, -bx, by, -by, bz, -bz
-    };
-
     // Compute the position of the cube corners and the scalar values at those corners
-    std::array<VertexRowVector, 8> cubeCorners = {
-      ctr+half_eps*(bx+by+bz).cast<ScalarV>(), ctr+half_eps*(bx+by-bz).cast<ScalarV>(), ctr+half_eps*(-bx+by-bz).cast<ScalarV>(), ctr+half_eps*(-bx+by+bz).cast<ScalarV>(),
-      ctr+half_eps*(bx-by+bz).cast<ScalarV>(), ctr+half_eps*(bx-by-bz).cast<ScalarV>(), ctr+half_eps*(-bx-by-bz).cast<ScalarV>(), ctr+half_eps*(-bx-by+bz).cast<ScalarV>()
-    };
-    std::array<ScalarS, 8> cubeScalars;
-    for (int i = 0; i < 8; i++) { cubeScalars[i] = scalarFunc(cubeCorners[i]); }
+    std::array<Corner*, 8> cubeCorners;
+    for (int i = 0; i < 8; i++) {
+      auto inserted = corners.insert({2*pi + cornerOffsets[i], Corner{ScalarS(0), -1}});
+      if (inserted.second) {
+        const VertexRowVector p = ctr+half_eps*cornerOffsets[i].cast<ScalarV>();
+        inserted.first->second.scalar = scalarFunc(p);
+      }
+      cubeCorners[i] = &inserted.first->second;
+    }
 
     // If this cube doesn't intersect the surface, disregard it
     bool validCube = false;
-    int sign = sgn(cubeScalars[0]);
+    int sign = sgn(cubeCorners[0]->scalar);
     for (int i = 1; i < 8; i++) {
-      if (sign != sgn(cubeScalars[i])) {
+      if (sign != sgn(cubeCorners[i]->scalar)) {
         validCube = true;
         break;
       }
@@ -91,39 +112,23 @@ IGL_INLINE void igl::sparse_voxel_grid(const Eigen::MatrixBase<DerivedP0>& p0,
 
     // Add the cube vertices and indices to the output arrays if they are not there already
     IndexRowVector cube;
-    uint8_t vertexAlreadyAdded = 0; // This is a bimask. If a bit is 1, it has been visited already by the BFS
-    constexpr std::array<uint8_t, 6> zv = {
-      (1 << 0) | (1 << 1) | (1 << 4) | (1 << 5),
-      (1 << 2) | (1 << 3) | (1 << 6) | (1 << 7),
-      (1 << 0) | (1 << 1) | (1 << 2) | (1 << 3),
-      (1 << 4) | (1 << 5) | (1 << 6) | (1 << 7),
-      (1 << 0) | (1 << 3) | (1 << 4) | (1 << 7),
-      (1 << 1) | (1 << 2) | (1 << 5) | (1 << 6), };
-    constexpr std::array<std::array<int, 4>, 6> zvv {{
-        {{0, 1, 4, 5}}, {{3, 2, 7, 6}}, {{0, 1, 2, 3}},
-        {{4, 5, 6, 7}}, {{0, 3, 4, 7}}, {{1, 2, 5, 6}} }};
-
-    for (int n = 0; n < 6; n++) { // For each neighbor, check the hash table to see if its been added before
-      Eigen::RowVector3i nkey = pi + neighbors[n];
-      auto nbr = visited.find(nkey);
-      if (nbr != visited.end()) { // We've already visited this neighbor, use references to its vertices instead of duplicating them
-        vertexAlreadyAdded |= zv[n];
-        for (int i = 0; i < 4; i++) { cube[zvv[n][i]] = CI_vector[nbr->second][zvv[n % 2 == 0 ? n + 1 : n - 1][i]]; }
-      } else {
-        queue.push_back(nkey); // Otherwise, we have not visited the neighbor, put it in the BFS queue
+    for (int i = 0; i < 8; i++) {
+      Corner & c = *cubeCorners[i];
+      if (c.index < 0) {
+        c.index = CS_vector.size();
+        CV_vector.push_back(ctr+half_eps*cornerOffsets[i].cast<ScalarV>());
+        CS_vector.push_back(c.scalar);
       }
+      cube[i] = c.index;
     }
+    CI_vector.push_back(cube);
 
-    for (int i = 0; i < 8; i++) { // Add new, non-visited,2 vertices to the arrays
-      if (0 == ((1 << i) & vertexAlreadyAdded)) {
-        cube[i] = CS_vector.size();
-        CV_vector.push_back(cubeCorners[i]);
-        CS_vector.push_back(cubeScalars[i]);
+    for (int n = 0; n < 6; n++) {
+      Eigen::RowVector3i nkey = pi + neighbors[n];
+      if (visited.count(nkey) == 0) {
+        queue.push_back(nkey);
       }
     }
-
-    visited[pi] = CI_vector.size();
-    CI_vector.push_back(cube);
   }
 
   CV.conservativeResize(CV_vector.size(), 3);
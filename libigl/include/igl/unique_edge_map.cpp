@@ -7,7 +7,6 @@
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "unique_edge_map.h"
 #include "oriented_facets.h"
-#include "unique_simplices.h"
 #include <cassert>
 #include <algorithm>
 template <
@@ -28,11 +27,66 @@ IGL_INLINE void igl::unique_edge_map(
   // All occurrences of directed edges
   oriented_facets(F,E);
   const size_t ne = E.rows();
-  // This is 2x faster to create than a map from pairs to lists of edges and 5x
-  // faster to access (actually access is probably assympotically faster O(1)
-  // vs. O(log m)
-  Matrix<typename DerivedEMAP::Scalar,Dynamic,1> IA;
-  unique_simplices(E,uE,IA,EMAP);
+  // Order the directed edges by (min,max) endpoints without comparison
+  // sorting: least significant digit radix sort with a counting sort on the
+  // larger endpoint followed by one on the smaller endpoint, each
+  // O(#E+#V). Both passes are stable so each unique edge is represented by
+  // its first occurrence in E. uE comes out sorted as with
+  // unique_simplices.
+  vector<size_t> lo(ne),hi(ne);
+  size_t n = 0;
+  for(size_t e = 0;e<ne;e++)
+  {
+    lo[e] = static_cast<size_t>(std::min(E(e,0),E(e,1)));
+    hi[e] = static_cast<size_t>(std::max(E(e,0),E(e,1)));
+    n = std::max(n,hi[e]+1);
+  }
+  // Stable counting sort of the edges in `in` by key[e] into `out`
+  vector<size_t> next(n+1);
+  const auto counting_sort = [&next,n](
+    const vector<size_t> & key,
+    const vector<size_t> & in,
+    vector<size_t> & out)
+  {
+    std::fill(next.begin(),next.end(),0);
+    for(const size_t e : in)
+    {
+      next[key[e]+1]++;
+    }
+    for(size_t v = 0;v<n;v++)
+    {
+      next[v+1] += next[v];
+    }
+    for(const size_t e : in)
+    {
+      out[next[key[e]]++] = e;
+    }
+  };
+  vector<size_t> order(ne),by_hi(ne);
+  for(size_t e = 0;e<ne;e++)
+  {
+    order[e] = e;
+  }
+  counting_sort(hi,order,by_hi);
+  counting_sort(lo,by_hi,order);
+  // First occurrence of each unique edge
+  vector<size_t> IA;
+  IA.reserve(ne/2+1);
+  EMAP.resize(ne,1);
+  for(size_t i = 0;i<ne;i++)
+  {
+    const size_t e = order[i];
+    if(i == 0 || lo[e] != lo[order[i-1]] || hi[e] != hi[order[i-1]])
+    {
+      IA.push_back(e);
+    }
+    EMAP(e) = IA.size()-1;
+  }
+  uE.resize(IA.size(),2);
+  for(size_t u = 0;u<IA.size();u++)
+  {
+    uE.row(u) = E.row(IA[u]);
+  }
   uE2E.resize(uE.rows());
   // This does help a little
   for_each(uE2E.begin(),uE2E.end(),[](vector<uE2EType > & v){v.reserve(2);});
@@ -19,7 +19,8 @@ namespace igl
   //   F  #F by 3  list of simplices
   // Outputs:
   //   E  #F*3 by 2 list of all of directed edges
-  //   uE  #uE by 2 list of unique undirected edges
+  //   uE  #uE by 2 list of unique undirected edges, sorted by their (smaller,
+  //     larger) endpoints, each oriented as its first occurrence in E
   //   EMAP #F*3 list of indices into uE, mapping each directed edge to unique
   //     undirected edge
   //   uE2E  #uE list of lists of indices into E of coexisting edges
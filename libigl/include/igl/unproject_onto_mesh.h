@@ -9,6 +9,7 @@
 #define IGL_UNPROJECT_ONTO_MESH
 #include "igl_inline.h"
 #include "Hit.h"
+#include "RayBVH.h"
 #include <Eigen/Core>
 #include <functional>
 
@@ -39,6 +40,17 @@ namespace igl
     const Eigen::PlainObjectBase<DerivedF> & F,
     int & fid,
     Eigen::PlainObjectBase<Derivedbc> & bc);
+  // Inputs:
+  //    bvh  ray tracing hierarchy around the mesh, to reuse across calls
+  template <typename Derivedbc>
+  IGL_INLINE bool unproject_onto_mesh(
+    const Eigen::Vector2f& pos,
+    const Eigen::Matrix4f& model,
+    const Eigen::Matrix4f& proj,
+    const Eigen::Vector4f& viewport,
+    const igl::RayBVH & bvh,
+    int & fid,
+    Eigen::PlainObjectBase<Derivedbc> & bc);
   //
   // Inputs:
   //    pos        screen space coordinates
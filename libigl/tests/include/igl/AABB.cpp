@@ -0,0 +1,116 @@
+#include <test_common.h>
+#include <igl/AABB.h>
+#include <igl/default_num_threads.h>
+#include <igl/point_simplex_squared_distance.h>
+
+namespace AABB_test
+{
+  inline void brute_force(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    const Eigen::MatrixXd & P,
+    Eigen::VectorXd & sqrD)
+  {
+    sqrD.resize(P.rows());
+    for(int p = 0;p<P.rows();p++)
+    {
+      sqrD(p) = std::numeric_limits<double>::infinity();
+      for(int f = 0;f<F.rows();f++)
+      {
+        double d;
+        Eigen::RowVector3d c;
+        igl::point_simplex_squared_distance<3>(
+          Eigen::RowVector3d(P.row(p)),V,F,f,d,c);
+        sqrD(p) = std::min(sqrD(p),d);
+      }
+    }
+  }
+}
+
+TEST(AABB, squared_distance)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(30,0,V,F);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Random(2000,3);
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  Eigen::VectorXd sqrD,gt;
+  Eigen::VectorXi I;
+  Eigen::MatrixXd C;
+  tree.squared_distance(V,F,P,sqrD,I,C);
+  AABB_test::brute_force(V,F,P,gt);
+  for(int p = 0;p<P.rows();p++)
+  {
+    ASSERT_EQ(sqrD(p),gt(p));
+    ASSERT_NEAR((P.row(p)-C.row(p)).squaredNorm(),sqrD(p),1e-12);
+  }
+}
+
+TEST(AABB, refit)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(30,0,V,F);
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  // A copy is built node by node and refits recursively
+  igl::AABB<Eigen::MatrixXd,3> copy = tree;
+  test_common::wavy_grid(30,1.5,V,F);
+  V *= 1.5;
+  tree.refit(V,F);
+  copy.refit(V,F);
+  Eigen::MatrixXd P = Eigen::MatrixXd::Random(2000,3);
+  Eigen::VectorXd sqrD,copy_sqrD,gt;
+  Eigen::VectorXi I;
+  Eigen::MatrixXd C;
+  tree.squared_distance(V,F,P,sqrD,I,C);
+  copy.squared_distance(V,F,P,copy_sqrD,I,C);
+  AABB_test::brute_force(V,F,P,gt);
+  for(int p = 0;p<P.rows();p++)
+  {
+    ASSERT_EQ(sqrD(p),gt(p));
+    ASSERT_EQ(copy_sqrD(p),gt(p));
+  }
+  ASSERT_TRUE(tree.m_box.isApprox(copy.m_box));
+  // Nothing to refit
+  igl::AABB<Eigen::MatrixXd,3> empty;
+  empty.refit(V,F);
+  ASSERT_TRUE(empty.m_box.isEmpty());
+}
+
+TEST(AABB, squared_distance_ties)
+{
+  // Queries above, below and on the vertices of a flat grid are closest to
+  // a vertex, at the same distance from all its faces
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(60,V,F);
+  V.col(2).setZero();
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  Eigen::MatrixXd P(3*V.rows(),3);
+  P << V,V,V;
+  P.middleRows(0,V.rows()).col(2).setConstant(1);
+  P.middleRows(V.rows(),V.rows()).col(2).setConstant(-0.5);
+  const unsigned int num_threads = igl::default_num_threads();
+  Eigen::VectorXd sqrD,serial_sqrD;
+  Eigen::VectorXi I,serial_I;
+  Eigen::MatrixXd C,serial_C;
+  igl::default_num_threads(1);
+  tree.squared_distance(V,F,P,serial_sqrD,serial_I,serial_C);
+  igl::default_num_threads(std::max(4u,num_threads));
+  tree.squared_distance(V,F,P,sqrD,I,C);
+  igl::default_num_threads(num_threads);
+  test_common::assert_eq(I,serial_I);
+  test_common::assert_eq(sqrD,serial_sqrD);
+  test_common::assert_eq(C,serial_C);
+  // Same primitive as a single query
+  for(int p = 0;p<P.rows();p++)
+  {
+    int i;
+    Eigen::RowVector3d c;
+    tree.squared_distance(V,F,Eigen::RowVector3d(P.row(p)),i,c);
+    ASSERT_EQ(I(p),i);
+  }
+}
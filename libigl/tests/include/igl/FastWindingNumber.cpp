@@ -0,0 +1,137 @@
+#include <test_common.h>
+#include <igl/FastWindingNumber.h>
+#include <igl/fast_winding_number.h>
+#include <igl/winding_number.h>
+#include <igl/per_face_normals.h>
+#include <igl/doublearea.h>
+#include <igl/barycenter.h>
+#include <cmath>
+
+namespace FastWindingNumber_test
+{
+  // Random queries in [-1.5,1.5]^3 plus points just off the surface
+  inline Eigen::MatrixXd queries(const Eigen::MatrixXd & V)
+  {
+    srand(0);
+    Eigen::MatrixXd Q(1000+V.rows(),3);
+    Q.topRows(1000) = 1.5*Eigen::MatrixXd::Random(1000,3);
+    for(int i = 0;i<V.rows();i++)
+    {
+      Q.row(1000+i) = (i%2 ? 1.01 : 0.99)*V.row(i);
+    }
+    return Q;
+  }
+}
+
+TEST(FastWindingNumber, mesh)
+{
+  using namespace FastWindingNumber_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(4,V,F);
+  // Dented, so that it is no longer convex
+  V.col(2) = V.col(2).array()*(1.-0.6*(-4.*V.col(0).array().square()).exp());
+  const Eigen::MatrixXd Q = queries(V);
+  Eigen::VectorXd gt_W;
+  igl::winding_number(V,F,Q,gt_W);
+  for(const int order : {0,1,2})
+  {
+    igl::FastWindingNumber<double> fwn;
+    fwn.expansion_order = order;
+    fwn.set_mesh(V,F);
+    ASSERT_EQ(fwn.size(),F.rows());
+    Eigen::VectorXd W;
+    fwn.winding_number(Q,W);
+    // Far field error is bounded by beta; near field is exact
+    test_common::assert_near(W,gt_W,order==2 ? 1e-2 : 4e-2);
+    for(int i = 0;i<Q.rows();i++)
+    {
+      ASSERT_EQ(W(i)>0.5,gt_W(i)>0.5);
+    }
+    // Single queries agree with batched ones
+    ASSERT_NEAR(fwn.winding_number(Eigen::RowVector3d(Q.row(7))),W(7),1e-15);
+  }
+  // Direct evaluation is exact
+  igl::FastWindingNumber<double> fwn;
+  fwn.beta = 0;
+  fwn.set_mesh(V,F);
+  Eigen::VectorXd W;
+  fwn.winding_number(Q,W);
+  test_common::assert_near(W,gt_W,1e-10);
+}
+
+TEST(FastWindingNumber, points)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(4,V,F);
+  Eigen::MatrixXd P,N;
+  Eigen::VectorXd A;
+  igl::barycenter(V,F,P);
+  igl::per_face_normals(V,F,N);
+  igl::doublearea(V,F,A);
+  A /= 2.;
+  const Eigen::MatrixXd Q = 1.5*Eigen::MatrixXd::Random(500,3);
+  igl::FastWindingNumber<double> gt_fwn;
+  gt_fwn.beta = 0;
+  gt_fwn.set_points(P,N,A);
+  Eigen::VectorXd gt_W;
+  gt_fwn.winding_number(Q,gt_W);
+  igl::FastWindingNumber<double> fwn;
+  fwn.set_points(P,N,A);
+  Eigen::VectorXd W;
+  fwn.winding_number(Q,W);
+  test_common::assert_near(W,gt_W,2e-2);
+  // Same accuracy as the functional interface
+  Eigen::VectorXd fn_W;
+  igl::fast_winding_number(P,N,A,Q,fn_W);
+  test_common::assert_near(gt_W,Eigen::VectorXd(fn_W),2e-2);
+}
+
+TEST(FastWindingNumber, refit)
+{
+  using namespace FastWindingNumber_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(3,V,F);
+  igl::FastWindingNumber<double> fwn;
+  fwn.set_mesh(V,F);
+  // Twist and stretch
+  Eigen::MatrixXd U(V.rows(),3);
+  for(int i = 0;i<V.rows();i++)
+  {
+    const double a = 1.5*V(i,2);
+    U(i,0) = std::cos(a)*V(i,0)-std::sin(a)*V(i,1);
+    U(i,1) = std::sin(a)*V(i,0)+std::cos(a)*V(i,1);
+    U(i,2) = 2.*V(i,2);
+  }
+  fwn.refit(U);
+  igl::FastWindingNumber<double> gt_fwn;
+  gt_fwn.set_mesh(U,F);
+  const Eigen::MatrixXd Q = queries(U);
+  Eigen::VectorXd W,gt_W,exact_W;
+  fwn.winding_number(Q,W);
+  gt_fwn.winding_number(Q,gt_W);
+  igl::winding_number(U,F,Q,exact_W);
+  test_common::assert_near(W,exact_W,5e-3);
+  test_common::assert_near(W,gt_W,5e-3);
+
+  // Point clouds keep their original indexing through refit
+  Eigen::MatrixXd P,N;
+  Eigen::VectorXd A;
+  igl::barycenter(V,F,P);
+  igl::per_face_normals(V,F,N);
+  igl::doublearea(V,F,A);
+  igl::FastWindingNumber<double> pfwn;
+  pfwn.set_points(P,N,A);
+  igl::barycenter(U,F,P);
+  igl::per_face_normals(U,F,N);
+  igl::doublearea(U,F,A);
+  pfwn.refit(P,N,A);
+  igl::FastWindingNumber<double> gt_pfwn;
+  gt_pfwn.set_points(P,N,A);
+  pfwn.beta = gt_pfwn.beta = 0;
+  pfwn.winding_number(Q,W);
+  gt_pfwn.winding_number(Q,gt_W);
+  test_common::assert_near(W,gt_W,1e-10);
+}
@@ -0,0 +1,102 @@
+#include <test_common.h>
+#include <igl/RayBVH.h>
+#include <igl/ray_mesh_intersect.h>
+#include <igl/ambient_occlusion.h>
+#include <igl/shape_diameter_function.h>
+#include <igl/per_vertex_normals.h>
+#include <cmath>
+
+namespace RayBVH_test
+{
+  // Unit sphere with a crease so that rays from the surface hit it
+  inline void folded_sphere(
+    const int subdivisions,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    test_common::sphere(subdivisions,V,F);
+    V.col(2) = V.col(2).array()*(1.-0.8*(-4.*V.col(0).array().square()).exp());
+  }
+}
+
+TEST(RayBVH, brute_force)
+{
+  using namespace RayBVH_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  folded_sphere(3,V,F);
+  igl::RayBVH bvh;
+  bvh.init(V,F);
+  ASSERT_EQ(bvh.size(),F.rows());
+  srand(0);
+  const int n = 1000;
+  Eigen::Matrix<float,Eigen::Dynamic,3> O(n,3),D(n,3);
+  O = 1.5f*Eigen::MatrixXf::Random(n,3);
+  D = Eigen::MatrixXf::Random(n,3);
+  std::vector<igl::Hit> hits;
+  bvh.intersect_rays(O,D,hits);
+  Eigen::Array<bool,Eigen::Dynamic,1> H;
+  bvh.intersect_any(O,D,H);
+  int num_hits = 0;
+  for(int i = 0;i<n;i++)
+  {
+    const Eigen::Vector3f o = O.row(i), d = D.row(i);
+    igl::Hit gt_hit;
+    const bool gt = igl::ray_mesh_intersect(o,d,V,F,gt_hit);
+    igl::Hit hit;
+    ASSERT_EQ(bvh.intersect_ray(o,d,hit),gt);
+    ASSERT_EQ(bvh.intersect_any(o,d),gt);
+    ASSERT_EQ(H(i),gt);
+    ASSERT_EQ(hits[i].id >= 0,gt);
+    if(gt)
+    {
+      num_hits++;
+      ASSERT_EQ(hit.id,gt_hit.id);
+      ASSERT_NEAR(hit.t,gt_hit.t,1e-4);
+      ASSERT_NEAR(hit.u,gt_hit.u,1e-4);
+      ASSERT_NEAR(hit.v,gt_hit.v,1e-4);
+      ASSERT_EQ(hits[i].id,hit.id);
+      ASSERT_EQ(hits[i].t,hit.t);
+      // Segments ending before the first hit miss
+      ASSERT_FALSE(bvh.intersect_any(o,d,0,0.999f*hit.t));
+    }
+  }
+  ASSERT_GT(num_hits,n/10);
+}
+
+TEST(RayBVH, ambient_occlusion)
+{
+  using namespace RayBVH_test;
+  Eigen::MatrixXd V,N;
+  Eigen::MatrixXi F;
+  folded_sphere(3,V,F);
+  igl::per_vertex_normals(V,F,N);
+  igl::AABB<Eigen::MatrixXd,3> aabb;
+  aabb.init(V,F);
+  igl::RayBVH bvh;
+  bvh.init(V,F);
+  // Same directions for both
+  for(const bool sdf : {false,true})
+  {
+    Eigen::VectorXd S,gt_S;
+    srand(0);
+    if(sdf)
+    {
+      igl::shape_diameter_function(aabb,V,F,V,N,64,gt_S);
+    }else
+    {
+      igl::ambient_occlusion(aabb,V,F,V,N,64,gt_S);
+    }
+    srand(0);
+    if(sdf)
+    {
+      igl::shape_diameter_function(bvh,V,N,64,S);
+    }else
+    {
+      igl::ambient_occlusion(bvh,V,N,64,S);
+    }
+    // Single precision may flip rays grazing the surface
+    test_common::assert_near(S,gt_S,sdf ? 5e-2 : 2./64.);
+    ASSERT_GT(S.maxCoeff(),0);
+  }
+}
@@ -0,0 +1,98 @@
+#include <test_common.h>
+#include <igl/SparseLLT.h>
+#include <igl/cotmatrix.h>
+#include <igl/massmatrix.h>
+#include <igl/get_seconds.h>
+#include <iostream>
+
+namespace SparseLLT_test
+{
+  // Implicit smoothing system M - t*L (positive definite)
+  inline void smoothing_system(
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F,
+    Eigen::SparseMatrix<double> & Q)
+  {
+    Eigen::SparseMatrix<double> L,M;
+    igl::cotmatrix(V,F,L);
+    igl::massmatrix(V,F,igl::MASSMATRIX_TYPE_VORONOI,M);
+    Q = M - 1e-3*L;
+  }
+}
+
+TEST(SparseLLT, simplicial)
+{
+  using namespace SparseLLT_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  for(const int n : {5,40})
+  {
+    test_common::wavy_grid(n,V,F);
+    Eigen::SparseMatrix<double> Q;
+    smoothing_system(V,F,Q);
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double> > gt_llt(Q);
+    ASSERT_EQ(gt_llt.info(),Eigen::Success);
+    igl::SparseLLT<double> llt;
+    // Exercise the concurrent path on the small system too
+    llt.min_parallel_rows = 0;
+    llt.analyzePattern(Q);
+    llt.factorize(Q);
+    ASSERT_EQ(llt.info(),Eigen::Success);
+    ASSERT_EQ(llt.rows(),Q.rows());
+    const Eigen::MatrixXd B = Q*V;
+    const Eigen::MatrixXd X = llt.solve(B);
+    test_common::assert_near(X,V,1e-10);
+    const Eigen::MatrixXd gt_X = gt_llt.solve(B);
+    test_common::assert_near(X,gt_X,1e-12);
+    const Eigen::VectorXd x = llt.compute(Q).solve(B.col(1));
+    test_common::assert_near(x,gt_X.col(1).eval(),1e-12);
+  }
+}
+
+TEST(SparseLLT, not_positive_definite)
+{
+  Eigen::SparseMatrix<double> A(2,2);
+  A.insert(0,0) = 1;
+  A.insert(1,1) = -1;
+  igl::SparseLLT<double> llt;
+  llt.compute(A);
+  ASSERT_NE(llt.info(),Eigen::Success);
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests
+TEST(SparseLLT, DISABLED_benchmark)
+{
+  // Not a correctness test: reports the time of #V by 3 solves against
+  // Eigen::SimplicialLLT, on a grid with as many vertices as the face
+  // templates (~2.3k) and on a larger one
+  using namespace SparseLLT_test;
+  for(const int n : {48,200})
+  {
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    test_common::wavy_grid(n,V,F);
+    Eigen::SparseMatrix<double> Q;
+    smoothing_system(V,F,Q);
+    const Eigen::MatrixXd B = Q*V;
+    const int iters = 20;
+    Eigen::SimplicialLLT<Eigen::SparseMatrix<double> > gt_llt(Q);
+    igl::SparseLLT<double> llt;
+    llt.compute(Q);
+    Eigen::MatrixXd X;
+    double t = igl::get_seconds();
+    for(int it = 0;it<iters;it++)
+    {
+      X = gt_llt.solve(B);
+    }
+    const double simplicial = igl::get_seconds()-t;
+    t = igl::get_seconds();
+    for(int it = 0;it<iters;it++)
+    {
+      X = llt.solve(B);
+    }
+    const double sparse_llt = igl::get_seconds()-t;
+    std::cout<<"#V="<<V.rows()<<" x"<<iters<<" SimplicialLLT: "<<simplicial<<
+      "s SparseLLT"<<(igl::SparseLLT<double>::supernodal?" (CHOLMOD)":"")<<
+      ": "<<sparse_llt<<"s"<<std::endl;
+  }
+}
@@ -0,0 +1,136 @@
+#include <test_common.h>
+#include <igl/copyleft/marching_cubes.h>
+#include <igl/default_num_threads.h>
+#include <igl/edges.h>
+#include <igl/is_edge_manifold.h>
+#include <igl/boundary_facets.h>
+#include <functional>
+#include <cmath>
+
+namespace marching_cubes_test
+{
+  // Signed distance to a torus around the z-axis
+  inline double torus(const Eigen::RowVector3d & p)
+  {
+    const double q = std::sqrt(p(0)*p(0)+p(1)*p(1))-0.6;
+    return std::sqrt(q*q+p(2)*p(2))-0.25;
+  }
+
+  // n by n by n grid over [-1,1]^3 sampling the torus
+  inline void torus_grid(
+    const int n,
+    Eigen::VectorXd & S,
+    Eigen::MatrixXd & GV)
+  {
+    GV.resize(n*n*n,3);
+    S.resize(n*n*n);
+    for(int z = 0;z<n;z++)
+    {
+      for(int y = 0;y<n;y++)
+      {
+        for(int x = 0;x<n;x++)
+        {
+          const int i = x+n*(y+n*z);
+          GV.row(i) =
+            Eigen::RowVector3d(x,y,z)*(2.0/(n-1))-Eigen::RowVector3d::Ones();
+          S(i) = torus(GV.row(i));
+        }
+      }
+    }
+  }
+
+  // Closed (every edge shared by exactly two faces) and no face is degenerate
+  inline void assert_watertight(const Eigen::MatrixXi & F)
+  {
+    ASSERT_GT(F.rows(),0);
+    ASSERT_TRUE(igl::is_edge_manifold(F));
+    Eigen::MatrixXi E;
+    igl::boundary_facets(F,E);
+    ASSERT_EQ(E.rows(),0);
+    Eigen::MatrixXi uE;
+    igl::edges(F,uE);
+    ASSERT_EQ(3*F.rows(),2*uE.rows());
+  }
+}
+
+TEST(marching_cubes, dense_threads)
+{
+  using namespace marching_cubes_test;
+  Eigen::VectorXd S;
+  Eigen::MatrixXd GV;
+  // Few layers (one slab) and many layers (several slabs, even with one
+  // thread)
+  for(const int n : {5,41})
+  {
+    torus_grid(n,S,GV);
+    // Reference: the cubes in the order of a serial sweep, extracted by the
+    // indexed version, which hashes the edges of one cube at a time
+    Eigen::MatrixXi C((n-1)*(n-1)*(n-1),8);
+    for(int z = 0;z<n-1;z++)
+    {
+      for(int y = 0;y<n-1;y++)
+      {
+        for(int x = 0;x<n-1;x++)
+        {
+          const int i = x+n*(y+n*z);
+          C.row(x+(n-1)*(y+(n-1)*z)) <<
+            i,i+1,i+1+n,i+n,i+n*n,i+1+n*n,i+1+n+n*n,i+n+n*n;
+        }
+      }
+    }
+    Eigen::MatrixXd gt_V;
+    Eigen::MatrixXi gt_F;
+    igl::copyleft::marching_cubes(S,GV,C,gt_V,gt_F);
+    const unsigned nthreads = igl::default_num_threads();
+    for(const unsigned t : {1u,4u})
+    {
+      Eigen::MatrixXd V;
+      Eigen::MatrixXi F;
+      igl::default_num_threads(t);
+      igl::copyleft::marching_cubes(S,GV,n,n,n,V,F);
+      igl::default_num_threads(nthreads);
+      test_common::assert_eq(V,gt_V);
+      test_common::assert_eq(F,gt_F);
+      // Vertices on the planes between slabs are not duplicated
+      assert_watertight(F);
+    }
+  }
+}
+
+TEST(marching_cubes, dense_on_surface)
+{
+  using namespace marching_cubes_test;
+  const int n = 33;
+  Eigen::VectorXd S;
+  Eigen::MatrixXd GV;
+  torus_grid(n,S,GV);
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::copyleft::marching_cubes(S,GV,n,n,n,V,F);
+  const double h = 2.0/(n-1);
+  for(int i = 0;i<V.rows();i++)
+  {
+    ASSERT_LT(std::abs(torus(V.row(i))),0.1*h);
+  }
+  // Empty grid
+  Eigen::VectorXd O = Eigen::VectorXd::Ones(S.rows());
+  igl::copyleft::marching_cubes(O,GV,n,n,n,V,F);
+  ASSERT_EQ(V.rows(),0);
+  ASSERT_EQ(F.rows(),0);
+}
+
+TEST(marching_cubes, sparse)
+{
+  using namespace marching_cubes_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  const std::function<double(const Eigen::RowVector3d &)> f = torus;
+  const double eps = 2.0/40;
+  igl::copyleft::marching_cubes(
+    Eigen::RowVector3d(0.85,0,0),f,eps,1000,V,F);
+  assert_watertight(F);
+  for(int i = 0;i<V.rows();i++)
+  {
+    ASSERT_LT(std::abs(torus(V.row(i))),0.1*eps);
+  }
+}
@@ -1,5 +1,7 @@
 #include <test_common.h>
 #include <igl/cotmatrix.h>
+#include <igl/cotmatrix_massmatrix.h>
+#include <igl/massmatrix.h>
 
 class cotmatrix : public ::testing::TestWithParam<std::string> {};
 
@@ -21,6 +23,33 @@ TEST_P(cotmatrix, constant_in_null_space)
   ASSERT_LT(((L*C)-(Z)).norm(),1e-12);
 }
 
+TEST_P(cotmatrix, cached_pattern)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::load_mesh(GetParam(), V, F);
+  if(F.cols() != 3) return;
+  Eigen::SparseMatrix<double> L,M,L_cached,M_cached;
+  igl::cotmatrix_massmatrix_data<double> data;
+  igl::cotmatrix_massmatrix_precompute(V.rows(),F,data);
+  // Second round only refills values of the existing patterns
+  for(const double scale : {1.0,2.0})
+  {
+    const Eigen::MatrixXd U = scale*V;
+    igl::cotmatrix(U,F,L);
+    igl::massmatrix(U,F,igl::MASSMATRIX_TYPE_VORONOI,M);
+    igl::cotmatrix_massmatrix(
+      U,igl::MASSMATRIX_TYPE_VORONOI,data,L_cached,M_cached);
+    ASSERT_EQ(L.nonZeros(),L_cached.nonZeros());
+    ASSERT_LT((L-L_cached).norm(),1e-12*(1.0+L.norm()));
+    // Degenerate faces give NaN areas in both
+    if(Eigen::Map<Eigen::VectorXd>(M.valuePtr(),M.nonZeros()).allFinite())
+    {
+      ASSERT_LT((M-M_cached).norm(),1e-12*(1.0+M.norm()));
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P
 (
  all_meshes,
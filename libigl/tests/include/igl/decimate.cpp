@@ -1,11 +1,17 @@
 #include <test_common.h>
 #include <igl/decimate.h>
+#include <igl/get_seconds.h>
+#include <igl/qslim.h>
+#include <igl/max_faces_stopping_condition.h>
+#include <igl/shortest_edge_and_midpoint.h>
 #include <igl/sort.h>
 #include <igl/sortrows.h>
 #include <igl/normalize_row_lengths.h>
 #include <igl/slice.h>
 #include <igl/matlab_format.h>
+#include <cmath>
 #include <iostream>
+#include <set>
 
 class decimate : public ::testing::TestWithParam<std::string> {};
 
@@ -75,3 +81,269 @@ INSTANTIATE_TEST_CASE_P
   ::testing::ValuesIn(test_common::closed_genus_0_meshes()),
   test_common::string_test_name
 );
+
+namespace
+{
+  // Torus with n by m quads split into triangles (closed manifold)
+  void torus(const int n, const int m, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    V.resize(n*m,3);
+    for(int i = 0;i<n;i++)
+    {
+      for(int j = 0;j<m;j++)
+      {
+        const double u = 2*M_PI*i/n, v = 2*M_PI*j/m;
+        V.row(i*m+j) <<
+          (1+0.4*std::cos(v))*std::cos(u),
+          (1+0.4*std::cos(v))*std::sin(u),
+          0.4*std::sin(v);
+        // Snap so that results do not depend on the last bits of sin/cos
+        V.row(i*m+j) = (V.row(i*m+j)*1048576.0).array().round()/1048576.0;
+      }
+    }
+    F.resize(2*n*m,3);
+    for(int i = 0;i<n;i++)
+    {
+      for(int j = 0;j<m;j++)
+      {
+        const int a = i*m+j, b = ((i+1)%n)*m+j;
+        const int c = i*m+(j+1)%m, d = ((i+1)%n)*m+(j+1)%m;
+        F.row(2*(i*m+j)) << a,b,d;
+        F.row(2*(i*m+j)+1) << a,d,c;
+      }
+    }
+  }
+}
+
+TEST(decimate, same_as_set_queue)
+{
+  // Attempted collapses (-1-e for failed ones) and outputs recorded with the
+  // previous std::set based queue. The heap must pop edges in the same
+  // order, including ties (the torus has many equal edge lengths).
+  const std::vector<int> expected_sequence = {
+    0, 11, 48, 55, 84, 91, 120, 127, 21, 61, 97, 133, 30, 37, 66, 73,
+    102, 109, 138, 141, 43, 79, 115, 143, 12, 56, 92, 128};
+  Eigen::MatrixXd decimate_U(20,3);
+  decimate_U<<
+    1.2999997138977051, 0, 0.17320489883422852,
+    0.59748744964599609, 0.24748730659484863, 0.17320489883422852,
+    1, 0, -0.34640979766845703,
+    0.91923856735229492, 0.91923856735229492, 0.17320489883422852,
+    0.70710659027099609, 0.70710659027099609, -0.34640979766845703,
+    0, 1.2999997138977051, 0.17320489883422852,
+    -0.24748730659484863, 0.59748744964599609, 0.17320489883422852,
+    0, 1, -0.34640979766845703,
+    -0.91923856735229492, 0.91923856735229492, 0.17320489883422852,
+    -0.70710659027099609, 0.70710659027099609, -0.34640979766845703,
+    -1.2999997138977051, 0, 0.17320489883422852,
+    -0.59748744964599609, -0.24748730659484863, 0.17320489883422852,
+    -1, 0, -0.34640979766845703,
+    -0.91923856735229492, -0.91923856735229492, 0.17320489883422852,
+    -0.70710659027099609, -0.70710659027099609, -0.34640979766845703,
+    -0, -1.2999997138977051, 0.17320489883422852,
+    0.24748730659484863, -0.59748744964599609, 0.17320489883422852,
+    -0, -1, -0.34640979766845703,
+    0.91923856735229492, -0.91923856735229492, 0.17320489883422852,
+    0.70710659027099609, -0.70710659027099609, -0.34640979766845703;
+  Eigen::MatrixXi decimate_G(40,3);
+  decimate_G<<
+    0, 3, 1, 1, 4, 2, 2, 4, 3, 2, 3, 0,
+    3, 5, 6, 3, 6, 1, 1, 6, 7, 1, 7, 4,
+    4, 7, 5, 4, 5, 3, 5, 8, 6, 6, 9, 7,
+    7, 9, 8, 7, 8, 5, 8, 10, 11, 8, 11, 6,
+    6, 11, 12, 6, 12, 9, 9, 12, 10, 9, 10, 8,
+    10, 13, 11, 11, 14, 12, 12, 14, 13, 12, 13, 10,
+    13, 15, 16, 13, 16, 11, 11, 16, 17, 11, 17, 14,
+    14, 17, 15, 14, 15, 13, 15, 18, 16, 16, 19, 17,
+    17, 19, 18, 17, 18, 15, 18, 0, 1, 18, 1, 16,
+    16, 1, 2, 16, 2, 19, 19, 2, 0, 19, 0, 18;
+  Eigen::MatrixXd qslim_U(20,3);
+  qslim_U<<
+    1.3618198552841188, -0.034126812076693949, 0.1963284833512362,
+    0.79020741261236371, -0.26584119229723019, 0.33949101158217554,
+    0.6229642103546692, 0.27828290297202907, -0.23476878943674517,
+    1.188890611602299, -0.36550329627764705, -0.36133612266080317,
+    0.98708326115420819, 0.93882081169639542, 0.19632844681883088,
+    0.26584119229723019, 0.79020741261236382, 0.33949101158217548,
+    0.36550329627764677, 1.1888906116022997, -0.36133612266080284,
+    0.034126812076693963, 1.361819855284119, 0.19632848335123637,
+    -0.27828290297202901, 0.6229642103546692, -0.23476878943674517,
+    -0.93882081169639675, 0.98708326115420775, 0.19632844681883088,
+    -0.79020741261236371, 0.26584119229723008, 0.33949101158217548,
+    -1.1888906116022997, 0.36550329627764672, -0.36133612266080273,
+    -1.361819855284119, 0.034126812076694019, 0.19632848335123632,
+    -0.6229642103546692, -0.27828290297202907, -0.23476878943674517,
+    -0.98708326115420819, -0.93882081169639542, 0.19632844681883088,
+    -0.26584119229723019, -0.79020741261236382, 0.33949101158217548,
+    -0.36550329627764677, -1.1888906116022997, -0.36133612266080284,
+    -0.034126812076693963, -1.361819855284119, 0.19632848335123637,
+    0.27828290297202901, -0.6229642103546692, -0.23476878943674517,
+    0.93882081169639675, -0.98708326115420775, 0.19632844681883088;
+  Eigen::MatrixXi qslim_G(40,3);
+  qslim_G<<
+    0, 4, 5, 0, 5, 1, 1, 5, 2, 2, 6, 3,
+    3, 6, 4, 3, 4, 0, 4, 7, 5, 5, 8, 2,
+    2, 8, 6, 6, 7, 4, 7, 9, 10, 7, 10, 5,
+    5, 10, 8, 8, 11, 6, 6, 11, 9, 6, 9, 7,
+    9, 12, 10, 10, 13, 8, 8, 13, 11, 11, 12, 9,
+    12, 14, 15, 12, 15, 10, 10, 15, 13, 13, 16, 11,
+    11, 16, 14, 11, 14, 12, 14, 17, 15, 15, 18, 13,
+    13, 18, 16, 16, 17, 14, 17, 19, 1, 17, 1, 15,
+    15, 1, 18, 18, 3, 16, 16, 3, 19, 16, 19, 17,
+    19, 0, 1, 1, 2, 18, 18, 2, 3, 3, 0, 19;
+
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  Eigen::VectorXi J,I;
+  torus(8,6,V,F);
+  int m = F.rows();
+  std::vector<int> sequence;
+  igl::decimate(
+    V,F,
+    igl::shortest_edge_and_midpoint,
+    igl::max_faces_stopping_condition(m,m,40),
+    [](const Eigen::MatrixXd &,const Eigen::MatrixXi &,
+      const Eigen::MatrixXi &,const Eigen::VectorXi &,
+      const Eigen::MatrixXi &,const Eigen::MatrixXi &,
+      const igl::decimate_queue &,const Eigen::VectorXi &,
+      const Eigen::MatrixXd &,const int)->bool{ return true; },
+    [&](const Eigen::MatrixXd &,const Eigen::MatrixXi &,
+      const Eigen::MatrixXi &,const Eigen::VectorXi &,
+      const Eigen::MatrixXi &,const Eigen::MatrixXi &,
+      const igl::decimate_queue &,const Eigen::VectorXi &,
+      const Eigen::MatrixXd &,const int e,const int,const int,const int,
+      const int,const bool collapsed)
+    {
+      sequence.push_back(collapsed ? e : -1-e);
+    },
+    U,G,J,I);
+  ASSERT_EQ(sequence,expected_sequence);
+  test_common::assert_eq(U,decimate_U);
+  test_common::assert_eq(G,decimate_G);
+
+  igl::qslim(V,F,40,U,G,J,I);
+  test_common::assert_near(U,qslim_U,1e-12);
+  test_common::assert_eq(G,qslim_G);
+}
+
+TEST(decimate, removed_edges_leave_queue)
+{
+  // After a successful collapse, the collapsed edge and the two other
+  // removed edges have no current entry in the queue
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  Eigen::VectorXi J,I;
+  torus(8,6,V,F);
+  int m = F.rows();
+  const igl::decimate_stopping_condition_callback max_faces =
+    igl::max_faces_stopping_condition(m,m,40);
+  int num_collapses = 0;
+  igl::decimate(
+    V,F,
+    igl::shortest_edge_and_midpoint,
+    [&](const Eigen::MatrixXd & V,const Eigen::MatrixXi & F,
+      const Eigen::MatrixXi & E,const Eigen::VectorXi & EMAP,
+      const Eigen::MatrixXi & EF,const Eigen::MatrixXi & EI,
+      const igl::decimate_queue & Q,const Eigen::VectorXi & EQ,
+      const Eigen::MatrixXd & C,const int e,const int e1,const int e2,
+      const int f1,const int f2)->bool
+    {
+      EXPECT_EQ(EQ(e),-1);
+      EXPECT_EQ(EQ(e1),-1);
+      EXPECT_EQ(EQ(e2),-1);
+      num_collapses++;
+      return max_faces(V,F,E,EMAP,EF,EI,Q,EQ,C,e,e1,e2,f1,f2);
+    },
+    U,G,J,I);
+  ASSERT_GT(num_collapses,0);
+  ASSERT_EQ(G.rows(),40);
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests
+TEST(decimate, DISABLED_benchmark)
+{
+  // Not a correctness test: reports decimation times of a 100k face height
+  // field and the cost of queue updates of the previous std::set queue
+  // against decimate_queue
+  const int n = 225;
+  Eigen::MatrixXd V(n*n,3);
+  Eigen::MatrixXi F(2*(n-1)*(n-1),3);
+  for(int i = 0;i<n;i++)
+  {
+    for(int j = 0;j<n;j++)
+    {
+      const double x = double(i)/(n-1);
+      const double y = double(j)/(n-1);
+      V.row(i*n+j) << x,y,0.1*std::sin(10.0*x)*std::cos(7.0*y);
+    }
+  }
+  for(int i = 0,f = 0;i+1<n;i++)
+  {
+    for(int j = 0;j+1<n;j++)
+    {
+      F.row(f++) << i*n+j,(i+1)*n+j,(i+1)*n+j+1;
+      F.row(f++) << i*n+j,(i+1)*n+j+1,i*n+j+1;
+    }
+  }
+  Eigen::MatrixXd U;
+  Eigen::MatrixXi G;
+  Eigen::VectorXi J,I;
+  double t = igl::get_seconds();
+  igl::decimate(V,F,F.rows()/10,U,G,J,I);
+  const double decimate_time = igl::get_seconds()-t;
+  t = igl::get_seconds();
+  igl::qslim(V,F,F.rows()/10,U,G,J,I);
+  const double qslim_time = igl::get_seconds()-t;
+
+  // Same churn as collapse_edge: pop the minimum, update 10 neighbors
+  const int m = 150000;
+  const auto & cost = [](const int e,const int r){ return ((e*7919+r*104729)%m)/double(m); };
+  t = igl::get_seconds();
+  {
+    std::set<std::pair<double,int> > Q;
+    std::vector<std::set<std::pair<double,int> >::iterator > Qit(m);
+    for(int e = 0;e<m;e++) Qit[e] = Q.insert(std::make_pair(cost(e,0),e)).first;
+    for(int r = 1;r<m/2;r++)
+    {
+      const int e = Q.begin()->second;
+      Q.erase(Q.begin());
+      Qit[e] = Q.end();
+      for(int k = 1;k<=10;k++)
+      {
+        const int ek = (e+k*r)%m;
+        if(Qit[ek] == Q.end()) continue;
+        Q.erase(Qit[ek]);
+        Qit[ek] = Q.insert(std::make_pair(cost(ek,r),ek)).first;
+      }
+    }
+  }
+  const double set_time = igl::get_seconds()-t;
+  t = igl::get_seconds();
+  {
+    igl::decimate_queue Q;
+    Eigen::VectorXi EQ = Eigen::VectorXi::Zero(m);
+    for(int e = 0;e<m;e++) Q.emplace(cost(e,0),e,0);
+    for(int r = 1;r<m/2;r++)
+    {
+      int e;
+      do
+      {
+        e = std::get<1>(Q.top());
+        const bool current = std::get<2>(Q.top()) == EQ(e);
+        Q.pop();
+        if(current) break;
+      }while(true);
+      EQ(e) = -1;
+      for(int k = 1;k<=10;k++)
+      {
+        const int ek = (e+k*r)%m;
+        if(EQ(ek) == -1) continue;
+        Q.emplace(cost(ek,r),ek,++EQ(ek));
+      }
+    }
+  }
+  const double heap_time = igl::get_seconds()-t;
+  std::cout<<"#F="<<F.rows()<<" decimate: "<<decimate_time<<"s qslim: "<<
+    qslim_time<<"s queue updates std::set: "<<set_time<<"s decimate_queue: "<<
+    heap_time<<"s"<<std::endl;
+}
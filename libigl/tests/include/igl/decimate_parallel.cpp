@@ -0,0 +1,41 @@
+#include <test_common.h>
+#include <igl/decimate_parallel.h>
+#include <igl/is_edge_manifold.h>
+#include <igl/qslim.h>
+
+TEST(decimate_parallel, max_faces)
+{
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  Eigen::VectorXi J,I;
+  test_common::wavy_grid(60,V,F);
+  const int max_m = F.rows()/10;
+  ASSERT_TRUE(igl::decimate_parallel(V,F,max_m,U,G,J,I));
+  ASSERT_TRUE(igl::is_edge_manifold(G));
+  // At most one round past the target
+  ASSERT_LE(G.rows(),max_m);
+  ASSERT_GT(G.rows(),0.9*max_m);
+  ASSERT_EQ(J.rows(),G.rows());
+  ASSERT_EQ(I.rows(),U.rows());
+  // Birth vertices of a height field stay on the grid's footprint
+  for(int i = 0;i<U.rows();i++)
+  {
+    ASSERT_GE(I(i),0);
+    ASSERT_LT(I(i),V.rows());
+    ASSERT_GE(U(i,0),-1e-12);
+    ASSERT_LE(U(i,0),1+1e-12);
+  }
+}
+
+TEST(decimate_parallel, qslim)
+{
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  Eigen::VectorXi J,I;
+  test_common::wavy_grid(60,V,F);
+  const int max_m = F.rows()/10;
+  ASSERT_TRUE(igl::qslim(V,F,max_m,true,U,G,J,I));
+  ASSERT_TRUE(igl::is_edge_manifold(G));
+  ASSERT_LE(G.rows(),max_m);
+  ASSERT_GT(G.rows(),0.9*max_m);
+}
@@ -0,0 +1,243 @@
+#include <test_common.h>
+#include <igl/fast_readOBJ.h>
+#include <igl/readOBJ.h>
+#include <igl/read_triangle_mesh.h>
+#include <igl/polygon_mesh_to_triangle_mesh.h>
+#include <igl/get_seconds.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+class fast_readOBJ : public ::testing::TestWithParam<std::string> {};
+
+TEST_P(fast_readOBJ, same_as_readOBJ)
+{
+  Eigen::MatrixXd V,U,TC,TC_fast,CN,CN_fast;
+  Eigen::MatrixXi F,G,FTC,FTC_fast,FN,FN_fast;
+  ASSERT_TRUE(igl::readOBJ(test_common::data_path(GetParam()),V,TC,CN,F,FTC,FN));
+  ASSERT_TRUE(igl::fast_readOBJ(
+    test_common::data_path(GetParam()),U,TC_fast,CN_fast,G,FTC_fast,FN_fast));
+  // Parsing is correctly rounded so results should be bit identical
+  test_common::assert_eq(V,U);
+  test_common::assert_eq(F,G);
+  if(TC.size() > 0) test_common::assert_eq(TC,TC_fast);
+  if(CN.size() > 0) test_common::assert_eq(CN,CN_fast);
+  if(FTC.size() > 0) test_common::assert_eq(FTC,FTC_fast);
+  if(FN.size() > 0) test_common::assert_eq(FN,FN_fast);
+}
+
+INSTANTIATE_TEST_CASE_P
+(
+ obj_meshes,
+ fast_readOBJ,
+ ::testing::Values(
+   "cube.obj",
+   "decimated-knight.obj",
+   "hemisphere.obj",
+   "TinyTorus.obj",
+   "truck.obj"),
+ test_common::string_test_name
+);
+
+namespace
+{
+  // Write contents to a file in the test temp directory and return its path
+  std::string write_obj(const std::string & name, const std::string & contents)
+  {
+    const std::string path = ::testing::TempDir() + name;
+    std::ofstream(path) << contents;
+    return path;
+  }
+}
+
+TEST(fast_readOBJ, negative_indices)
+{
+  const std::string path = write_obj("fast_readOBJ_negative.obj",
+    "v 0 0 0\n"
+    "v 1 0 0\n"
+    "v 0 1 0\n"
+    "f -3 -2 -1\n"
+    "v 1 1 0\n"
+    "f 2 4 -2\n"
+    "f -1 -2 -3\n");
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  ASSERT_TRUE(igl::readOBJ(path,V,F));
+  ASSERT_TRUE(igl::fast_readOBJ(path,U,G));
+  test_common::assert_eq(V,U);
+  test_common::assert_eq(F,G);
+  // Relative to the vertices read so far, not to the whole file
+  Eigen::MatrixXi F_expected(3,3);
+  F_expected<<0,1,2, 1,3,2, 3,2,1;
+  test_common::assert_eq(G,F_expected);
+}
+
+TEST(fast_readOBJ, texture_and_normal_indices)
+{
+  const std::string vertices =
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+    "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+    "vn 0 0 1\nvn 0 0 -1\n";
+  const std::vector<std::string> faces = {
+    // v/vt/vn
+    "f 1/1/1 2/2/1 3/3/1\nf 2/2/2 4/4/2 3/3/2\n",
+    // v//vn
+    "f 1//1 2//1 3//1\nf 2//2 4//2 3//2\n",
+    // v/vt, with negative indices
+    "f -4/-4 -3/-3 -2/-2\nf 2/2 4/4 3/3\n"};
+  for(int i = 0;i<(int)faces.size();i++)
+  {
+    const std::string path = write_obj(
+      "fast_readOBJ_corners_"+std::to_string(i)+".obj",vertices+faces[i]);
+    Eigen::MatrixXd V,U,TC,TC_fast,CN,CN_fast;
+    Eigen::MatrixXi F,G,FTC,FTC_fast,FN,FN_fast;
+    ASSERT_TRUE(igl::readOBJ(path,V,TC,CN,F,FTC,FN));
+    ASSERT_TRUE(igl::fast_readOBJ(path,U,TC_fast,CN_fast,G,FTC_fast,FN_fast));
+    test_common::assert_eq(V,U);
+    test_common::assert_eq(F,G);
+    test_common::assert_eq(TC,TC_fast);
+    test_common::assert_eq(CN,CN_fast);
+    ASSERT_EQ(FTC.size() > 0,FTC_fast.size() > 0);
+    ASSERT_EQ(FN.size() > 0,FN_fast.size() > 0);
+    if(FTC.size() > 0) test_common::assert_eq(FTC,FTC_fast);
+    if(FN.size() > 0) test_common::assert_eq(FN,FN_fast);
+  }
+}
+
+TEST(fast_readOBJ, ignored_lines)
+{
+  // Comments, groups, materials, smoothing groups, free form data and
+  // trailing comments are skipped
+  const std::string path = write_obj("fast_readOBJ_ignored.obj",
+    "# comment\n"
+    "mtllib foo.mtl\n"
+    "o object\n"
+    "g group\n"
+    "v 0 0 0 # trailing\r\n"
+    "v 1 0 0\n"
+    "\n"
+    "   v 0 1 0\n"
+    "vp 0.5 0.5\n"
+    "usemtl bar\n"
+    "s off\n"
+    "f 1 2 3 # trailing\n"
+    "l 1 2\n");
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  ASSERT_TRUE(igl::fast_readOBJ(path,V,F));
+  ASSERT_EQ(V.rows(),3);
+  ASSERT_EQ(V.cols(),3);
+  ASSERT_EQ(F.rows(),1);
+  ASSERT_EQ(F(0,0),0);
+  ASSERT_EQ(F(0,1),1);
+  ASSERT_EQ(F(0,2),2);
+  ASSERT_EQ(V(2,1),1.0);
+}
+
+TEST(fast_readOBJ, malformed_lines)
+{
+  const std::vector<std::string> bad = {
+    // Not a number
+    "v 0 0 0\nv 1 x 0\nv 0 1 0\nf 1 2 3\n",
+    // Not an index
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 a 3\n",
+    // Missing texture index where the other faces have one
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nf 1/1 2/ 3/1\n"};
+  for(int i = 0;i<(int)bad.size();i++)
+  {
+    const std::string path = write_obj(
+      "fast_readOBJ_malformed_"+std::to_string(i)+".obj",bad[i]);
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    ASSERT_FALSE(igl::fast_readOBJ(path,V,F)) << bad[i];
+  }
+}
+
+TEST(fast_readOBJ, not_rectangular)
+{
+  // Mixed triangles and quads are rejected by the matrix overloads (the
+  // polygon overload returns them, see below), pure quads are read as is
+  const std::string vertices =
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nv 2 0 0\n";
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  ASSERT_FALSE(igl::fast_readOBJ(write_obj("fast_readOBJ_mixed.obj",
+    vertices+"f 1 2 4 3\nf 2 5 4\n"),V,F));
+  ASSERT_TRUE(igl::fast_readOBJ(write_obj("fast_readOBJ_quads.obj",
+    vertices+"f 1 2 4 3\nf 2 5 4 4\n"),V,F));
+  ASSERT_EQ(F.rows(),2);
+  ASSERT_EQ(F.cols(),4);
+}
+
+TEST(fast_readOBJ, polygons)
+{
+  // Mixed degrees (with and without texture indices) come back as a polygon
+  // list, triangulated by read_triangle_mesh like readOBJ's
+  const std::string path = write_obj("fast_readOBJ_polygons.obj",
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nv 2 0 0\nv 2 1 0\nvt 0 0\n"
+    "f 1 2 4 3\nf 2/1 5/1 4/1\nf 5 6 4 -3 -4\n");
+  Eigen::MatrixXd V,U;
+  Eigen::MatrixXi F,G;
+  std::vector<std::vector<int> > P;
+  ASSERT_EQ(igl::fast_readOBJ(path,V,F,P),igl::FAST_READOBJ_SUCCESS);
+  ASSERT_EQ(F.rows(),0);
+  const std::vector<std::vector<int> > gt_P = {{0,1,3,2},{1,4,3},{4,5,3,3,2}};
+  ASSERT_EQ(P,gt_P);
+  std::vector<std::vector<double> > vV,vTC,vN;
+  std::vector<std::vector<int> > vF,vFTC,vFN;
+  ASSERT_TRUE(igl::readOBJ(path,vV,vTC,vN,vF,vFTC,vFN));
+  Eigen::MatrixXi gt_F;
+  igl::polygon_mesh_to_triangle_mesh(vF,gt_F);
+  ASSERT_TRUE(igl::read_triangle_mesh(path,U,G));
+  test_common::assert_eq(U,V);
+  test_common::assert_eq(G,gt_F);
+  // Same degree: the matrix is filled and P left empty
+  ASSERT_EQ(igl::fast_readOBJ(write_obj("fast_readOBJ_polygons_quads.obj",
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 4 3\n"),V,F,P),
+    igl::FAST_READOBJ_SUCCESS);
+  ASSERT_EQ(F.cols(),4);
+  ASSERT_TRUE(P.empty());
+}
+
+TEST(fast_readOBJ, quiet_status)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  std::vector<std::vector<int> > P;
+  ::testing::internal::CaptureStderr();
+  ASSERT_EQ(
+    igl::fast_readOBJ(::testing::TempDir()+"fast_readOBJ_missing.obj",V,F,P),
+    igl::FAST_READOBJ_CANNOT_OPEN);
+  ASSERT_EQ(igl::fast_readOBJ(write_obj("fast_readOBJ_quiet_malformed.obj",
+    "v 0 0 0\nv 1 x 0\nv 0 1 0\nf 1 2 3\n"),V,F,P),
+    igl::FAST_READOBJ_PARSE_ERROR);
+  ASSERT_EQ(igl::fast_readOBJ(write_obj("fast_readOBJ_quiet_dimensions.obj",
+    "v 0 0 0\nv 1 0 0 1\nv 0 1 0\nf 1 2 3\n"),V,F,P),
+    igl::FAST_READOBJ_NOT_RECTANGULAR);
+  ASSERT_EQ(::testing::internal::GetCapturedStderr(),"");
+  // read_triangle_mesh reports a missing file once
+  ::testing::internal::CaptureStderr();
+  ASSERT_FALSE(igl::read_triangle_mesh(
+    ::testing::TempDir()+"fast_readOBJ_missing.obj",V,F));
+  const std::string err = ::testing::internal::GetCapturedStderr();
+  ASSERT_EQ(std::count(err.begin(),err.end(),'\n'),1) << err;
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests
+TEST(fast_readOBJ, DISABLED_benchmark)
+{
+  // Not a correctness test: reports timings of both readers on the largest
+  // test mesh
+  const std::string path = test_common::data_path("truck.obj");
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  const int reps = 5;
+  double t = igl::get_seconds();
+  for(int r = 0;r<reps;r++) ASSERT_TRUE(igl::readOBJ(path,V,F));
+  const double slow = (igl::get_seconds()-t)/reps;
+  t = igl::get_seconds();
+  for(int r = 0;r<reps;r++) ASSERT_TRUE(igl::fast_readOBJ(path,V,F));
+  const double fast = (igl::get_seconds()-t)/reps;
+  std::cout<<"readOBJ: "<<slow<<"s fast_readOBJ: "<<fast<<"s ("<<
+    slow/fast<<"x)"<<std::endl;
+}
@@ -0,0 +1,79 @@
+#include <test_common.h>
+#include <igl/fast_writeOBJ.h>
+#include <igl/fast_readOBJ.h>
+#include <igl/readOBJ.h>
+#include <limits>
+
+namespace
+{
+  // Coordinates that need all 17 significant digits, plus extremes
+  Eigen::MatrixXd hard_coordinates()
+  {
+    Eigen::MatrixXd V = Eigen::MatrixXd::Random(100,3);
+    V.row(0) << 0.1, 1.0/3.0, -2.0/3.0;
+    V.row(1) << 1e-300, -1e300, 5e-324;
+    V.row(2) << 0.0, -0.0, 123456789012345678.0;
+    V.row(3) <<
+      std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::min(),
+      std::numeric_limits<double>::epsilon();
+    V.row(4) << 1.0+std::numeric_limits<double>::epsilon(), 1e-7, 9007199254740993.0;
+    return V;
+  }
+}
+
+TEST(fast_writeOBJ, round_trip)
+{
+  const Eigen::MatrixXd V = hard_coordinates();
+  Eigen::MatrixXi F(3,3);
+  F<<0,1,2, 2,3,4, 99,98,97;
+  const std::string path = ::testing::TempDir() + "fast_writeOBJ_round_trip.obj";
+  ASSERT_TRUE(igl::fast_writeOBJ(path,V,F));
+  // Bit identical whichever reader parses it back
+  Eigen::MatrixXd U;
+  Eigen::MatrixXi G;
+  ASSERT_TRUE(igl::readOBJ(path,U,G));
+  test_common::assert_eq(V,U);
+  test_common::assert_eq(F,G);
+  ASSERT_TRUE(igl::fast_readOBJ(path,U,G));
+  test_common::assert_eq(V,U);
+  test_common::assert_eq(F,G);
+}
+
+TEST(fast_writeOBJ, vertices_only)
+{
+  const Eigen::MatrixXd V = hard_coordinates();
+  const std::string path = ::testing::TempDir() + "fast_writeOBJ_vertices.obj";
+  ASSERT_TRUE(igl::fast_writeOBJ(path,V,Eigen::MatrixXi()));
+  Eigen::MatrixXd U;
+  Eigen::MatrixXi G;
+  ASSERT_TRUE(igl::fast_readOBJ(path,U,G));
+  test_common::assert_eq(V,U);
+  ASSERT_EQ(G.rows(),0);
+}
+
+TEST(fast_writeOBJ, several_meshes)
+{
+  Eigen::MatrixXi F(2,3);
+  F<<0,1,2, 0,2,3;
+  std::vector<std::string> paths;
+  std::vector<Eigen::MatrixXd> Vs;
+  for(int i = 0;i<5;i++)
+  {
+    paths.push_back(
+      ::testing::TempDir()+"fast_writeOBJ_"+std::to_string(i)+".obj");
+    Vs.push_back(Eigen::MatrixXd::Random(4,3));
+  }
+  ASSERT_TRUE(igl::fast_writeOBJ(paths,Vs,F));
+  for(int i = 0;i<5;i++)
+  {
+    Eigen::MatrixXd U;
+    Eigen::MatrixXi G;
+    ASSERT_TRUE(igl::readOBJ(paths[i],U,G));
+    test_common::assert_eq(Vs[i],U);
+    test_common::assert_eq(F,G);
+  }
+  // Unwritable path
+  paths[2] = ::testing::TempDir()+"does/not/exist.obj";
+  ASSERT_FALSE(igl::fast_writeOBJ(paths,Vs,F));
+}
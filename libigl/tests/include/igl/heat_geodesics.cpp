@@ -0,0 +1,71 @@
+#include <test_common.h>
+#include <igl/heat_geodesics.h>
+#include <igl/exact_geodesic.h>
+#include <cmath>
+
+TEST(heat_geodesics, sphere)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(5,V,F);
+  igl::heat_geodesics_data<double> data;
+  ASSERT_TRUE(igl::heat_geodesics_precompute(V,F,data));
+  // Vertex 4 is the north pole, vertex 0 lies on the equator
+  Eigen::VectorXd D;
+  igl::heat_geodesics_solve(data,(Eigen::VectorXi(1)<<4).finished(),D);
+  ASSERT_EQ(D.size(),V.rows());
+  for(int i = 0;i<V.rows();i++)
+  {
+    const double gt = std::acos(std::max(-1.,std::min(1.,V(i,2))));
+    ASSERT_NEAR(D(i),gt,0.05);
+  }
+  // Nearest of two sources
+  igl::heat_geodesics_solve(data,(Eigen::VectorXi(2)<<4,5).finished(),D);
+  for(int i = 0;i<V.rows();i++)
+  {
+    const double gt = std::acos(std::min(1.,std::abs(V(i,2))));
+    ASSERT_NEAR(D(i),gt,0.05);
+  }
+}
+
+TEST(heat_geodesics, batch)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(3,V,F);
+  // Second, unreachable copy
+  Eigen::MatrixXd VV(2*V.rows(),3);
+  VV<<V,V.rowwise()+Eigen::RowVector3d(3,0,0);
+  Eigen::MatrixXi FF(2*F.rows(),3);
+  FF<<F,F.array()+V.rows();
+  igl::heat_geodesics_data<double> data;
+  ASSERT_TRUE(igl::heat_geodesics_precompute(VV,FF,data));
+  const std::vector<std::vector<int> > gammas = {{4},{0,1},{7,int(V.rows())+5}};
+  Eigen::MatrixXd D;
+  igl::heat_geodesics_solve(data,gammas,D);
+  ASSERT_EQ(D.cols(),3);
+  for(int q = 0;q<3;q++)
+  {
+    Eigen::VectorXi gamma(gammas[q].size());
+    for(int j = 0;j<gamma.size();j++)
+    {
+      gamma(j) = gammas[q][j];
+    }
+    Eigen::VectorXd Dq;
+    igl::heat_geodesics_solve(data,gamma,Dq);
+    for(int i = 0;i<VV.rows();i++)
+    {
+      if(std::isinf(Dq(i)))
+      {
+        ASSERT_TRUE(std::isinf(D(i,q)));
+      }else
+      {
+        ASSERT_NEAR(D(i,q),Dq(i),1e-10);
+      }
+    }
+  }
+  // Components without sources are unreachable
+  ASSERT_TRUE(std::isinf(D(V.rows(),0)));
+  ASSERT_FALSE(std::isinf(D(V.rows(),2)));
+  ASSERT_NEAR(D(V.rows()+5,2),0,1e-2);
+}
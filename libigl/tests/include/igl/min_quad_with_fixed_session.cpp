@@ -0,0 +1,92 @@
+#include <test_common.h>
+#include <igl/min_quad_with_fixed_session.h>
+#include <igl/min_quad_with_fixed.h>
+#include <igl/boundary_loop.h>
+#include <igl/cotmatrix.h>
+#include <cstdlib>
+
+namespace min_quad_with_fixed_session_test
+{
+  // Same energy with min_quad_with_fixed: soft constraints folded into A and B
+  inline void reference(
+    const Eigen::SparseMatrix<double> & A,
+    const Eigen::VectorXi & known,
+    const Eigen::VectorXd & W,
+    const Eigen::MatrixXd & B,
+    const Eigen::MatrixXd & Y,
+    const Eigen::MatrixXd & S,
+    Eigen::MatrixXd & Z)
+  {
+    Eigen::SparseMatrix<double> D(W.size(),W.size());
+    D = Eigen::SparseMatrix<double>(W.asDiagonal());
+    const Eigen::SparseMatrix<double> AW = A + D;
+    const Eigen::MatrixXd BW = B - W.asDiagonal()*S;
+    igl::min_quad_with_fixed(
+      AW,BW,known,Y,Eigen::SparseMatrix<double>(),Eigen::MatrixXd(),true,Z);
+  }
+}
+
+TEST(min_quad_with_fixed_session, reference)
+{
+  using namespace min_quad_with_fixed_session_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(20,0,V,F);
+  const int n = V.rows();
+  Eigen::SparseMatrix<double> L;
+  igl::cotmatrix(V,F,L);
+  Eigen::SparseMatrix<double> A = -L;
+  Eigen::VectorXi known;
+  igl::boundary_loop(F,known);
+  std::srand(0);
+  Eigen::VectorXd W = Eigen::VectorXd::Zero(n);
+  for(int i = 0;i<n;i+=7)
+  {
+    W(i) = 10;
+  }
+  const Eigen::MatrixXd B = Eigen::MatrixXd::Random(n,3);
+  const Eigen::MatrixXd S = V + 0.1*Eigen::MatrixXd::Random(n,3);
+  Eigen::MatrixXd Y;
+  Eigen::MatrixXd Z,gt_Z;
+  const auto check = [&](igl::min_quad_with_fixed_session<double> & session)
+  {
+    Y.resize(known.size(),3);
+    for(int k = 0;k<known.size();k++)
+    {
+      Y.row(k) = V.row(known(k));
+    }
+    ASSERT_TRUE(session.solve(B,Y,S,Z));
+    reference(A,known,W,B,Y,S,gt_Z);
+    test_common::assert_near(Z,gt_Z,1e-8);
+  };
+  igl::min_quad_with_fixed_session<double> session;
+  ASSERT_TRUE(session.precompute(A,known,W));
+  check(session);
+  // A few constraints toggle: low rank update
+  W(42) = 0;
+  W(50) = 10;
+  W(51) = 5;
+  ASSERT_TRUE(session.update_weights(W));
+  ASSERT_EQ(session.update_rank(),3);
+  check(session);
+  // Many toggle: refactorization
+  for(int i = 0;i<n;i+=3)
+  {
+    W(i) = W(i) == 0 ? 10 : 0;
+  }
+  ASSERT_TRUE(session.update_weights(W));
+  ASSERT_EQ(session.update_rank(),0);
+  check(session);
+  // New values and known rows with the same pattern
+  test_common::wavy_grid(20,1.0,V,F);
+  igl::cotmatrix(V,F,L);
+  A = -L;
+  known.conservativeResize(known.size()+2);
+  known.tail(2) << 105,210;
+  ASSERT_TRUE(session.update(A,known,W));
+  check(session);
+  // Different pattern: falls back to precompute
+  A = -L + Eigen::SparseMatrix<double>(L*L);
+  ASSERT_TRUE(session.update(A,known,W));
+  check(session);
+}
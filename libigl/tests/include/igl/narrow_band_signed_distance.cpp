@@ -0,0 +1,103 @@
+#include <test_common.h>
+#include <igl/narrow_band_signed_distance.h>
+#include <igl/signed_distance.h>
+#include <igl/copyleft/marching_cubes.h>
+#include <igl/boundary_facets.h>
+#include <igl/is_edge_manifold.h>
+#include <cmath>
+
+namespace narrow_band_signed_distance_test
+{
+  // Unit sphere squashed along y and z
+  inline void ellipsoid(
+    const int subdivisions,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    test_common::sphere(subdivisions,V,F);
+    V.col(1) *= 0.7;
+    V.col(2) *= 0.5;
+  }
+}
+
+TEST(narrow_band_signed_distance, dense)
+{
+  using namespace narrow_band_signed_distance_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  ellipsoid(3,V,F);
+  const Eigen::RowVector3d origin(0.013,-0.021,0.007);
+  const double h = 0.1;
+  const double band = 2.5;
+  for(const igl::SignedDistanceType type :
+    {igl::SIGNED_DISTANCE_TYPE_PSEUDONORMAL,
+     igl::SIGNED_DISTANCE_TYPE_WINDING_NUMBER})
+  {
+    Eigen::VectorXd S;
+    Eigen::MatrixXd GV;
+    Eigen::MatrixXi GI,CI;
+    igl::narrow_band_signed_distance(V,F,origin,h,band,type,S,GV,GI,CI);
+    ASSERT_GT(S.rows(),0);
+    // Same as signed_distance on a dense lattice, restricted to the band
+    const int n = 16;
+    Eigen::MatrixXd P((2*n+1)*(2*n+1)*(2*n+1),3);
+    Eigen::MatrixXi PI(P.rows(),3);
+    int p = 0;
+    for(int k = -n;k<=n;k++)
+      for(int j = -n;j<=n;j++)
+        for(int i = -n;i<=n;i++,p++)
+        {
+          PI.row(p) << i,j,k;
+          P.row(p) = origin+h*Eigen::RowVector3d(i,j,k);
+        }
+    Eigen::VectorXd gt_S;
+    Eigen::VectorXi I;
+    Eigen::MatrixXd C,N;
+    igl::signed_distance(P,V,F,type,gt_S,I,C,N);
+    int b = 0;
+    for(p = 0;p<P.rows();p++)
+    {
+      if(std::abs(gt_S(p)) >= band*h)
+      {
+        continue;
+      }
+      // Both lists are in lattice order
+      ASSERT_LT(b,S.rows());
+      ASSERT_EQ(GI.row(b),PI.row(p));
+      ASSERT_NEAR(std::abs(S(b)),std::abs(gt_S(p)),1e-12);
+      ASSERT_EQ(S(b)<0,gt_S(p)<0);
+      test_common::assert_near(GV.row(b),P.row(p),1e-12);
+      b++;
+    }
+    ASSERT_EQ(b,S.rows());
+    // Cells are lattice cubes in marching cubes corner order
+    for(int c = 0;c<CI.rows();c++)
+    {
+      ASSERT_EQ(GI.row(CI(c,6))-GI.row(CI(c,0)),Eigen::RowVector3i(1,1,1));
+      ASSERT_EQ(GI.row(CI(c,3))-GI.row(CI(c,0)),Eigen::RowVector3i(0,1,0));
+    }
+  }
+}
+
+TEST(narrow_band_signed_distance, marching_cubes)
+{
+  using namespace narrow_band_signed_distance_test;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  ellipsoid(4,V,F);
+  Eigen::VectorXd S;
+  Eigen::MatrixXd GV;
+  Eigen::MatrixXi CI;
+  // Narrowest band
+  igl::narrow_band_signed_distance(
+    V,F,Eigen::RowVector3d(0,0,0),0.05,0.0,
+    igl::SIGNED_DISTANCE_TYPE_WINDING_NUMBER,S,GV,CI);
+  Eigen::MatrixXd SV;
+  Eigen::MatrixXi SF;
+  igl::copyleft::marching_cubes(S,GV,CI,SV,SF);
+  ASSERT_GT(SF.rows(),0);
+  ASSERT_TRUE(igl::is_edge_manifold(SF));
+  Eigen::MatrixXi B;
+  igl::boundary_facets(SF,B);
+  ASSERT_EQ(B.rows(),0);
+}
@@ -0,0 +1,98 @@
+#include <test_common.h>
+#include <igl/parallel_for.h>
+#include <igl/default_num_threads.h>
+#include <igl/get_seconds.h>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+TEST(parallel_for, accumulate)
+{
+  const int n = 100000;
+  Eigen::VectorXd S;
+  double sum = 0;
+  size_t num_prepared = 0;
+  igl::parallel_for(
+    n,
+    [&](const size_t m){ num_prepared = m; S = Eigen::VectorXd::Zero(m); },
+    [&](const int i, const size_t t)
+    {
+      ASSERT_LT(t,num_prepared);
+      S(t) += i;
+    },
+    [&](const size_t t){ sum += S(t); },
+    1000);
+  ASSERT_EQ(sum,double(n)*double(n-1)/2.0);
+}
+
+TEST(parallel_for, nested)
+{
+  std::atomic<int> count(0);
+  igl::parallel_for(100,[&](const int)
+  {
+    igl::parallel_for(100,[&](const int){ count++; });
+  });
+  ASSERT_EQ(count,100*100);
+}
+
+TEST(parallel_for, concurrent_callers)
+{
+  std::atomic<int> count(0);
+  const auto & loop = [&]()
+  {
+    for(int r = 0;r<100;r++)
+    {
+      igl::parallel_for(1000,[&](const int){ count++; });
+    }
+  };
+  std::thread a(loop),b(loop);
+  a.join();
+  b.join();
+  ASSERT_EQ(count,2*100*1000);
+}
+
+namespace parallel_for_test
+{
+  // The implementation parallel_for replaced: one std::thread per slice,
+  // created and joined on every call
+  template <typename Func>
+  void spawn_per_call(const int loop_size, const Func & func)
+  {
+    const size_t nthreads = igl::default_num_threads();
+    const int slice = std::max(
+      (int)std::round((loop_size+1)/static_cast<double>(nthreads)),1);
+    std::vector<std::thread> pool;
+    for(int i1 = 0;i1<loop_size;i1 += slice)
+    {
+      const int i2 = std::min(i1+slice,loop_size);
+      pool.emplace_back([&func,i1,i2](){ for(int k = i1;k<i2;k++) func(k); });
+    }
+    for(std::thread & t : pool) t.join();
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests
+TEST(parallel_for, DISABLED_benchmark)
+{
+  // Not a correctness test: reports the per-call overhead of parallel_for
+  // against spawning threads on every call, for loops as short as those of
+  // per-face quantities on small meshes
+  for(const int n : {100,10000,1000000})
+  {
+    const int reps = std::max(10,1000000/n);
+    Eigen::VectorXd X = Eigen::VectorXd::Zero(n);
+    const auto & func = [&X](const int i){ X(i) = std::sqrt(X(i)+i); };
+    double t = igl::get_seconds();
+    for(int r = 0;r<reps;r++) parallel_for_test::spawn_per_call(n,func);
+    const double spawn = (igl::get_seconds()-t)/reps;
+    t = igl::get_seconds();
+    for(int r = 0;r<reps;r++) igl::parallel_for(n,func);
+    const double pooled = (igl::get_seconds()-t)/reps;
+    std::cout<<"n="<<n<<" threads="<<igl::default_num_threads()<<
+      " spawn per call: "<<spawn*1e6<<"us pool: "<<pooled*1e6<<"us ("<<
+      spawn/pooled<<"x)"<<std::endl;
+  }
+}
@@ -0,0 +1,72 @@
+#include <test_common.h>
+#include <igl/per_vertex_normals.h>
+
+namespace
+{
+  // Bumpy n by n height field, large enough for the parallel path
+  void height_field(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    V.resize(n*n,3);
+    for(int i = 0;i<n;i++)
+    {
+      for(int j = 0;j<n;j++)
+      {
+        const double x = double(i)/(n-1), y = double(j)/(n-1);
+        V.row(i*n+j) << x, y, 0.1*std::sin(10*x)*std::cos(7*y);
+      }
+    }
+    F.resize(2*(n-1)*(n-1),3);
+    int f = 0;
+    for(int i = 0;i+1<n;i++)
+    {
+      for(int j = 0;j+1<n;j++)
+      {
+        const int a = i*n+j, b = a+n;
+        F.row(f++) << a, b, a+1;
+        F.row(f++) << a+1, b, b+1;
+      }
+    }
+  }
+}
+
+TEST(per_vertex_normals, cached_matches_full)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  height_field(150,V,F);
+  for(const igl::PerVertexNormalsWeightingType weighting :
+    {igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_UNIFORM,
+     igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_AREA,
+     igl::PER_VERTEX_NORMALS_WEIGHTING_TYPE_ANGLE})
+  {
+    Eigen::MatrixXd N,N_cached,N_moved;
+    igl::per_vertex_normals(V,F,weighting,N);
+    igl::per_vertex_normals_cached_data<double> data,data_moved;
+    igl::per_vertex_normals_cached_precompute(V,F,weighting,data,N_cached);
+    igl::per_vertex_normals_cached_precompute(V,F,weighting,data_moved,N_moved);
+    test_common::assert_eq(N,N_cached);
+
+    Eigen::MatrixXd U = V;
+    srand(0);
+    for(int iter = 0;iter<3;iter++)
+    {
+      // Move a random subset of the vertices, including the boundary
+      Eigen::VectorXi moved(200);
+      for(int k = 0;k<moved.size();k++)
+      {
+        moved(k) = k == 0 ? 0 : rand()%U.rows();
+        U.row(moved(k)) += 0.01*Eigen::RowVector3d::Random();
+      }
+      igl::per_vertex_normals(U,F,weighting,N);
+      // Moved vertices found by comparison
+      ASSERT_LE(igl::per_vertex_normals_cached(U,data,N_cached),moved.size());
+      test_common::assert_eq(N,N_cached);
+      // Moved vertices given as a list (with duplicates)
+      igl::per_vertex_normals_cached(U,moved,data_moved,N_moved);
+      test_common::assert_eq(N,N_moved);
+    }
+    // Nothing moved
+    ASSERT_EQ(igl::per_vertex_normals_cached(U,data,N_cached),0);
+    test_common::assert_eq(N,N_cached);
+  }
+}
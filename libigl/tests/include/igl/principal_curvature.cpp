@@ -0,0 +1,55 @@
+#include <test_common.h>
+#include <igl/principal_curvature.h>
+#include <cmath>
+
+TEST(principal_curvature, sphere)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(4,V,F);
+  for(const bool useKring : {true,false})
+  {
+    Eigen::MatrixXd PD1,PD2;
+    Eigen::VectorXd PV1,PV2;
+    std::vector<int> bad;
+    igl::principal_curvature(V,F,PD1,PD2,PV1,PV2,bad,3,useKring);
+    ASSERT_TRUE(bad.empty());
+    for(int i = 0;i<V.rows();i++)
+    {
+      ASSERT_NEAR(std::abs(PV1(i)),1.0,0.05);
+      ASSERT_NEAR(std::abs(PV2(i)),1.0,0.05);
+      // Directions are nearly tangent (normals are averaged per vertex)
+      ASSERT_NEAR(PD1.row(i).dot(V.row(i)),0.0,0.02);
+      ASSERT_NEAR(PD2.row(i).dot(V.row(i)),0.0,0.02);
+    }
+  }
+}
+
+TEST(principal_curvature, precompute)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::sphere(3,V,F);
+  for(const bool useKring : {true,false})
+  {
+    igl::principal_curvature_data data;
+    igl::principal_curvature_precompute(V.rows(),F,4,useKring,data);
+    // Same connectivity, changing positions
+    for(const double s : {1.0,2.0})
+    {
+      Eigen::MatrixXd U = V;
+      U.col(2) *= s;
+      Eigen::MatrixXd PD1,PD2,gt_PD1,gt_PD2;
+      Eigen::VectorXd PV1,PV2,gt_PV1,gt_PV2;
+      std::vector<int> bad,gt_bad;
+      igl::principal_curvature(U,data,PD1,PD2,PV1,PV2,bad);
+      igl::principal_curvature(
+        U,F,gt_PD1,gt_PD2,gt_PV1,gt_PV2,gt_bad,4,useKring);
+      test_common::assert_eq(PD1,gt_PD1);
+      test_common::assert_eq(PD2,gt_PD2);
+      test_common::assert_eq(PV1,gt_PV1);
+      test_common::assert_eq(PV2,gt_PV2);
+      ASSERT_EQ(bad,gt_bad);
+    }
+  }
+}
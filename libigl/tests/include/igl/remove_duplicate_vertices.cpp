@@ -0,0 +1,204 @@
+#include <test_common.h>
+#include <igl/remove_duplicate_vertices.h>
+#include <igl/round.h>
+#include <igl/slice.h>
+#include <igl/colon.h>
+#include <igl/unique_rows.h>
+#include <cstdlib>
+#include <vector>
+
+namespace remove_duplicate_vertices_test
+{
+  // Triangle soup of a wavy n by n grid: every face has its own three
+  // corners, perturbed by less than noise
+  inline void grid_soup(
+    const int n,
+    const double noise,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd GV;
+    Eigen::MatrixXi GF;
+    test_common::wavy_grid(n,GV,GF);
+    F.resize(GF.rows(),3);
+    V.resize(3*F.rows(),3);
+    std::srand(0);
+    for(int f = 0;f<F.rows();f++)
+    {
+      for(int c = 0;c<3;c++)
+      {
+        const double r = noise*(2.0*std::rand()/RAND_MAX-1.0)/2.0;
+        V.row(3*f+c) = GV.row(GF(f,c));
+        V(3*f+c,0) += r;
+        F(f,c) = 3*f+c;
+      }
+    }
+  }
+
+  // Previous implementation of the default (rounding) method
+  template <typename DerivedV>
+  inline void rounding(
+    const DerivedV & V,
+    const double epsilon,
+    DerivedV & SV,
+    Eigen::VectorXi & SVI,
+    Eigen::VectorXi & SVJ)
+  {
+    if(epsilon > 0)
+    {
+      DerivedV rV,rSV;
+      igl::round((V/(10.0*epsilon)).eval(),rV);
+      igl::unique_rows(rV,rSV,SVI,SVJ);
+      igl::slice(V,SVI,igl::colon<int>(0,V.cols()-1),SV);
+    }else
+    {
+      igl::unique_rows(V,SV,SVI,SVJ);
+    }
+  }
+
+  // Connected components of the "closer than epsilon" graph by brute force
+  inline void brute_force(
+    const Eigen::MatrixXd & V,
+    const double epsilon,
+    Eigen::VectorXi & SVJ)
+  {
+    std::vector<int> label(V.rows(),-1);
+    int num = 0;
+    for(int i = 0;i<V.rows();i++)
+    {
+      if(label[i] >= 0)
+      {
+        continue;
+      }
+      std::vector<int> stack(1,i);
+      label[i] = num;
+      while(!stack.empty())
+      {
+        const int a = stack.back();
+        stack.pop_back();
+        for(int b = 0;b<V.rows();b++)
+        {
+          if(label[b] < 0 && (V.row(a)-V.row(b)).norm() <= epsilon)
+          {
+            label[b] = num;
+            stack.push_back(b);
+          }
+        }
+      }
+      num++;
+    }
+    SVJ = Eigen::Map<Eigen::VectorXi>(label.data(),label.size());
+  }
+}
+
+TEST(remove_duplicate_vertices, cell_border)
+{
+  // Rounding to cells separates these although they are 2e-8 apart
+  const double epsilon = 1e-7;
+  Eigen::MatrixXd V(4,3);
+  V<<
+    0.5e-6-1e-8,0,0,
+    1,1,1,
+    0.5e-6+1e-8,0,0,
+    1,1,1;
+  Eigen::MatrixXd SV;
+  Eigen::VectorXi SVI,SVJ;
+  igl::remove_duplicate_vertices(
+    V,epsilon,igl::REMOVE_DUPLICATE_VERTICES_DISTANCE,SV,SVI,SVJ);
+  ASSERT_EQ(SV.rows(),2);
+  ASSERT_EQ(SVJ(0),0);
+  ASSERT_EQ(SVJ(1),1);
+  ASSERT_EQ(SVJ(2),0);
+  ASSERT_EQ(SVJ(3),1);
+  ASSERT_EQ(SVI(0),0);
+  ASSERT_EQ(SVI(1),1);
+  test_common::assert_eq(Eigen::MatrixXd(SV.row(0)),Eigen::MatrixXd(V.row(0)));
+}
+
+TEST(remove_duplicate_vertices, brute_force)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  remove_duplicate_vertices_test::grid_soup(12,1e-6,V,F);
+  for(const double epsilon : {0.0,1e-6,0.1})
+  {
+    Eigen::MatrixXd SV;
+    Eigen::MatrixXi SF;
+    Eigen::VectorXi SVI,SVJ,gt_SVJ;
+    igl::remove_duplicate_vertices(
+      V,F,epsilon,igl::REMOVE_DUPLICATE_VERTICES_DISTANCE,SV,SVI,SVJ,SF);
+    remove_duplicate_vertices_test::brute_force(V,epsilon,gt_SVJ);
+    test_common::assert_eq(SVJ,gt_SVJ);
+    ASSERT_EQ(SV.rows(),gt_SVJ.maxCoeff()+1);
+    for(int s = 0;s<SV.rows();s++)
+    {
+      ASSERT_EQ(SVJ(SVI(s)),s);
+      test_common::assert_eq(
+        Eigen::MatrixXd(SV.row(s)),Eigen::MatrixXd(V.row(SVI(s))));
+    }
+    for(int f = 0;f<F.rows();f++)
+    {
+      for(int c = 0;c<3;c++)
+      {
+        ASSERT_EQ(SF(f,c),SVJ(F(f,c)));
+      }
+    }
+  }
+  // Exact duplicates only
+  Eigen::MatrixXd SV;
+  Eigen::VectorXi SVI,SVJ;
+  remove_duplicate_vertices_test::grid_soup(12,0,V,F);
+  igl::remove_duplicate_vertices(
+    V,0,igl::REMOVE_DUPLICATE_VERTICES_DISTANCE,SV,SVI,SVJ);
+  ASSERT_EQ(SV.rows(),12*12);
+}
+
+TEST(remove_duplicate_vertices, same_as_rounding)
+{
+  // The default keeps the rounding semantics (and output order) relied upon
+  // by the callers: 1e-10 on remeshed scans (assignment6 Preprocessor) and in
+  // triangle::cdt, 2.2204e-15 on isoline vertices
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  remove_duplicate_vertices_test::grid_soup(20,1e-9,V,F);
+  for(const double epsilon : {0.0,2.2204e-15,1e-10,1e-7,0.01})
+  {
+    Eigen::MatrixXd SV,gt_SV;
+    Eigen::MatrixXi SF;
+    Eigen::VectorXi SVI,SVJ,gt_SVI,gt_SVJ;
+    igl::remove_duplicate_vertices(V,F,epsilon,SV,SVI,SVJ,SF);
+    remove_duplicate_vertices_test::rounding(V,epsilon,gt_SV,gt_SVI,gt_SVJ);
+    test_common::assert_eq(SV,gt_SV);
+    test_common::assert_eq(SVI,gt_SVI);
+    test_common::assert_eq(SVJ,gt_SVJ);
+    for(int f = 0;f<F.rows();f++)
+    {
+      for(int c = 0;c<3;c++)
+      {
+        ASSERT_EQ(SF(f,c),gt_SVJ(F(f,c)));
+      }
+    }
+  }
+  // Segments in the plane with shared end points, as in cdt and isolines
+  Eigen::MatrixXd P(6,2);
+  P<<
+    0,0,
+    1,0,
+    1,0,
+    1,1,
+    1,1+1e-16,
+    0,0;
+  Eigen::MatrixXi E(3,2);
+  E<<0,1, 2,3, 4,5;
+  for(const double epsilon : {2.2204e-15,1e-10})
+  {
+    Eigen::MatrixXd SP,gt_SP;
+    Eigen::MatrixXi SE;
+    Eigen::VectorXi SVI,SVJ,gt_SVI,gt_SVJ;
+    igl::remove_duplicate_vertices(P,E,epsilon,SP,SVI,SVJ,SE);
+    remove_duplicate_vertices_test::rounding(P,epsilon,gt_SP,gt_SVI,gt_SVJ);
+    test_common::assert_eq(SP,gt_SP);
+    test_common::assert_eq(SVJ,gt_SVJ);
+    ASSERT_EQ(SP.rows(),3);
+  }
+}
@@ -0,0 +1,85 @@
+#include <test_common.h>
+#include <igl/unique_edge_map.h>
+#include <igl/oriented_facets.h>
+#include <igl/unique_simplices.h>
+#include <algorithm>
+#include <cstdlib>
+
+namespace unique_edge_map_test
+{
+  // Triangulated n by n grid with faces in random order
+  inline void shuffled_grid(const int n, Eigen::MatrixXi & F)
+  {
+    test_common::grid_faces(n,F);
+    std::srand(0);
+    for(int i = F.rows()-1;i>0;i--)
+    {
+      F.row(i).swap(F.row(std::rand()%(i+1)));
+    }
+  }
+
+  // The previous implementation, sorting all directed edges
+  inline void sorting_unique_edge_map(
+    const Eigen::MatrixXi & F,
+    Eigen::MatrixXi & E,
+    Eigen::MatrixXi & uE,
+    Eigen::VectorXi & EMAP,
+    std::vector<std::vector<int> > & uE2E)
+  {
+    igl::oriented_facets(F,E);
+    Eigen::VectorXi IA;
+    igl::unique_simplices(E,uE,IA,EMAP);
+    uE2E.assign(uE.rows(),std::vector<int>());
+    for(int e = 0;e<E.rows();e++)
+    {
+      uE2E[EMAP(e)].push_back(e);
+    }
+  }
+}
+
+TEST(unique_edge_map, sorting)
+{
+  Eigen::MatrixXi F;
+  unique_edge_map_test::shuffled_grid(40,F);
+  // Non-manifold fin and a duplicate face
+  F.conservativeResize(F.rows()+2,3);
+  F.row(F.rows()-2) << F(5,1),F(5,0),40*40;
+  F.row(F.rows()-1) = F.row(7);
+  Eigen::MatrixXi E,uE,gt_E,gt_uE;
+  Eigen::VectorXi EMAP,gt_EMAP;
+  std::vector<std::vector<int> > uE2E,gt_uE2E;
+  igl::unique_edge_map(F,E,uE,EMAP,uE2E);
+  unique_edge_map_test::sorting_unique_edge_map(F,gt_E,gt_uE,gt_EMAP,gt_uE2E);
+  test_common::assert_eq(E,gt_E);
+  test_common::assert_eq(EMAP,gt_EMAP);
+  ASSERT_TRUE(uE2E == gt_uE2E);
+  ASSERT_EQ(uE.rows(),gt_uE.rows());
+  for(int u = 0;u<uE.rows();u++)
+  {
+    // Same undirected edge, oriented as its first occurrence
+    ASSERT_EQ(std::min(uE(u,0),uE(u,1)),std::min(gt_uE(u,0),gt_uE(u,1)));
+    ASSERT_EQ(std::max(uE(u,0),uE(u,1)),std::max(gt_uE(u,0),gt_uE(u,1)));
+    ASSERT_EQ(uE(u,0),E(uE2E[u][0],0));
+    ASSERT_EQ(uE(u,1),E(uE2E[u][0],1));
+  }
+}
+
+TEST(unique_edge_map, high_valence)
+{
+  // Fan around vertex 0 in shuffled order: a single vertex with a very
+  // large valence must not make sorting its edges quadratic
+  const int n = 20000;
+  Eigen::MatrixXi F(n,3);
+  for(int f = 0;f<n;f++)
+  {
+    const int i = (f*7919)%n;
+    F.row(f) << 0,1+i,1+(i+1)%n;
+  }
+  Eigen::MatrixXi E,uE,gt_E,gt_uE;
+  Eigen::VectorXi EMAP,gt_EMAP;
+  std::vector<std::vector<int> > uE2E,gt_uE2E;
+  igl::unique_edge_map(F,E,uE,EMAP,uE2E);
+  unique_edge_map_test::sorting_unique_edge_map(F,gt_E,gt_uE,gt_EMAP,gt_uE2E);
+  test_common::assert_eq(EMAP,gt_EMAP);
+  ASSERT_TRUE(uE2E == gt_uE2E);
+}
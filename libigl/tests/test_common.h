@@ -4,11 +4,13 @@
 #include <igl/read_triangle_mesh.h>
 #include <igl/find.h>
 #include <igl/readDMAT.h>
+#include <igl/upsample.h>
 
 #include <Eigen/Core>
 #include <gtest/gtest.h>
 
 #include <cctype>
+#include <cmath>
 #include <string>
 #include <functional>
 #include <algorithm>
@@ -79,6 +81,77 @@ namespace test_common
     return std::string(LIBIGL_DATA_DIR) + "/" + s;
   };
 
+  // Generated meshes, for tests that need a size or shape none of the data
+  // meshes have
+
+  // Triangles of an n by n grid of vertices, vertex (i,j) is i*n+j
+  inline void grid_faces(const int n, Eigen::MatrixXi & F)
+  {
+    F.resize(2*(n-1)*(n-1),3);
+    int f = 0;
+    for(int i = 0;i+1<n;i++)
+    {
+      for(int j = 0;j+1<n;j++)
+      {
+        F.row(f++) << i*n+j,(i+1)*n+j,(i+1)*n+j+1;
+        F.row(f++) << i*n+j,(i+1)*n+j+1,i*n+j+1;
+      }
+    }
+  }
+
+  // Wavy height field over an n by n grid of [0,1]^2, t shifts the waves
+  inline void wavy_grid(
+    const int n,
+    const double t,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    V.resize(n*n,3);
+    for(int i = 0;i<n;i++)
+    {
+      for(int j = 0;j<n;j++)
+      {
+        const double x = double(i)/(n-1);
+        const double y = double(j)/(n-1);
+        V.row(i*n+j) << x,y,0.1*std::sin(10.0*x+t)*std::cos(7.0*y-t);
+      }
+    }
+    grid_faces(n,F);
+  }
+  inline void wavy_grid(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    wavy_grid(n,0,V,F);
+  }
+
+  // Unit sphere: octahedron subdivided subdivisions times with vertices
+  // pushed to the surface
+  inline void sphere(
+    const int subdivisions,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    V.resize(6,3);
+    V<<
+      1,0,0,
+      -1,0,0,
+      0,1,0,
+      0,-1,0,
+      0,0,1,
+      0,0,-1;
+    F.resize(8,3);
+    F<<
+      0,2,4,
+      2,1,4,
+      1,3,4,
+      3,0,4,
+      2,0,5,
+      1,2,5,
+      3,1,5,
+      0,3,5;
+    igl::upsample(Eigen::MatrixXd(V),Eigen::MatrixXi(F),V,F,subdivisions);
+    V.rowwise().normalize();
+  }
+
   // TODO: this seems like a pointless indirection. Should just find and
   // replace test_common::load_mesh(X,...) with
   // igl::read_triangle_mesh(test_common::data_path(X),...)
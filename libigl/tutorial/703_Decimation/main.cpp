@@ -6,7 +6,6 @@
 #include <igl/opengl/glfw/Viewer.h>
 #include <Eigen/Core>
 #include <iostream>
-#include <set>
 
 #include "tutorial_shared_path.h"
 
@@ -33,9 +32,8 @@ int main(int argc, char * argv[])
   // Prepare array-based edge data structures and priority queue
   VectorXi EMAP;
   MatrixXi E,EF,EI;
-  typedef std::set<std::pair<double,int> > PriorityQueue;
-  PriorityQueue Q;
-  std::vector<PriorityQueue::iterator > Qit;
+  igl::decimate_queue Q;
+  VectorXi EQ;
   // If an edge were collapsed, we'd collapse it to these points:
   MatrixXd C;
   int num_collapsed;
@@ -46,18 +44,18 @@ int main(int argc, char * argv[])
     F = OF;
     V = OV;
     edge_flaps(F,E,EMAP,EF,EI);
-    Qit.resize(E.rows());
 
     C.resize(E.rows(),V.cols());
     VectorXd costs(E.rows());
-    Q.clear();
+    Q = igl::decimate_queue();
+    EQ = VectorXi::Zero(E.rows());
     for(int e = 0;e<E.rows();e++)
     {
       double cost = e;
       RowVectorXd p(1,3);
       shortest_edge_and_midpoint(e,V,F,E,EMAP,EF,EI,cost,p);
       C.row(e) = p;
-      Qit[e] = Q.insert(std::pair<double,int>(cost,e)).first;
+      Q.emplace(cost,e,0);
     }
     num_collapsed = 0;
     viewer.data().clear();
@@ -76,7 +74,7 @@ int main(int argc, char * argv[])
       for(int j = 0;j<max_iter;j++)
       {
         if(!collapse_edge(
-          shortest_edge_and_midpoint, V,F,E,EMAP,EF,EI,Q,Qit,C))
+          shortest_edge_and_midpoint, V,F,E,EMAP,EF,EI,Q,EQ,C))
         {
           break;
         }